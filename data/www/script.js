@@ -7,17 +7,29 @@ let debugActive = false;
 // --- Graph State ---
 let graphSamples = [];   // {t, c, s, st} from backend
 let graphEvents = [];    // {t, st} from backend
-let deviceNow = 0;       // device uptime (seconds) at last history fetch
+let deviceNow = 0;       // device history clock (seconds) at last history fetch
 let localAtFetch = 0;    // Date.now() when history was fetched
 let graphInited = false;
+let historyCursor = 0;   // "latest" from the last history response
+let historySyncing = false;
+const HISTORY_SYNC_SEC = 20;  // HISTORY_SAMPLE_INTERVAL
+const HISTORY_DETAIL_SEC = 43200;  // longest fixed graph range, loaded unreduced
 let graphRangeSec = 14400; // 0 = all data
 
 // System Log
 var logEntries = [];
 var logLastSeq = 0;
-var logPollTimer = null;
-var LOG_POLL_MS = 3000;
+var logPollGen = 0;      // bumped to stop the running poll loop
+var logPolling = false;
+var LOG_POLL_MS = 3000;  // retry delay after an error, or while the stream delivers
+var LOG_WAIT_MS = 20000; // long poll: the device holds the request until a new line
 var LOG_MAX_DISPLAY = 500;
+var logBackfilled = false;
+
+// Event stream (/api/events); polling is the fallback while it is down
+var eventStream = null;
+var eventStreamOpen = false;
+var statusPollTimer = null;
 
 // Performance metrics
 var perfStats = { fps: 0, frameMs: 0, apiMs: 0, graphMs: 0, pidDrawMs: 0 };
@@ -29,7 +41,8 @@ var perfFpsLast = 0;
 document.addEventListener('DOMContentLoaded', function() {
   fetchHistory();
   updateStatus();
-  setInterval(updateStatus, POLL_MS);
+  startStatusPolling();
+  openEventStream();
   window.addEventListener('resize', function() {
     canvasCacheDirty = true;
     drawGraph();
@@ -70,6 +83,61 @@ async function post(endpoint, params) {
   }
 }
 
+// --- Event Stream ---
+// The device pushes a status frame every control tick, plus history and log
+// frames when there is something new. While the stream is down (or the
+// browser has no EventSource) status is polled instead.
+function startStatusPolling() {
+  if (!statusPollTimer) statusPollTimer = setInterval(updateStatus, POLL_MS);
+}
+
+function stopStatusPolling() {
+  if (statusPollTimer) {
+    clearInterval(statusPollTimer);
+    statusPollTimer = null;
+  }
+}
+
+function openEventStream() {
+  if (!window.EventSource) return;
+  eventStream = new EventSource(API + '/events');
+  eventStream.onopen = function() {
+    eventStreamOpen = true;
+    stopStatusPolling();
+  };
+  eventStream.onerror = function() {
+    // EventSource reconnects by itself; poll meanwhile
+    eventStreamOpen = false;
+    startStatusPolling();
+  };
+  eventStream.addEventListener('status', function(e) {
+    try {
+      apiOk = true;
+      perfStats.apiMs = 0;
+      updateUI(JSON.parse(e.data));
+    } catch (err) { console.error('status event', err); }
+  });
+  eventStream.addEventListener('history', function(e) {
+    try {
+      var d = JSON.parse(e.data);
+      if (!graphInited) return;
+      // A frame was dropped or coalesced away: catch up over HTTP
+      if (d.since > historyCursor) { syncHistory(); return; }
+      mergeHistory(d.samples.map(function(a) {
+        return {t: a[0], c: a[1] / 10, s: a[2] / 10, st: a[3]};
+      }), d.events.map(function(a) {
+        return {t: a[0], st: a[1]};
+      }), d.latest);
+      deviceNow = d.latest;
+      localAtFetch = Date.now();
+    } catch (err) { console.error('history event', err); }
+  });
+  eventStream.addEventListener('log', function(e) {
+    try { appendLogs(JSON.parse(e.data).logs || []); }
+    catch (err) { console.error('log event', err); }
+  });
+}
+
 // --- Status Polling ---
 async function updateStatus() {
   try {
@@ -185,24 +253,111 @@ function updateUI(s) {
 var STATE_NAMES = ['Idle','Startup','Running','Cooldown','Stopped','Error','Reignite'];
 var STATE_COLORS = ['#57534e','#e8842c','#4ade80','#38bdf8','#facc15','#ef4444','#d4621a'];
 
+// Packed history (/api/history?format=bin), little-endian:
+//   header 'S','H',version,0, now u32, latest u32
+//   'B' time u32, seconds u16, min/max/mean/setpoint i16 (x10), state u8
+//   'S' time u32, temp/setpoint i16 (x10), state u8
+//   'E' time u32, state u8
+function parseHistory(buf) {
+  var v = new DataView(buf);
+  var out = { now: 0, latest: 0, samples: [], events: [] };
+  if (v.byteLength < 12 || v.getUint8(0) !== 0x53 || v.getUint8(1) !== 0x48) return null;
+  out.now = v.getUint32(4, true);
+  out.latest = v.getUint32(8, true);
+  var o = 12;
+  while (o < v.byteLength) {
+    var type = v.getUint8(o);
+    if (type === 0x42 && o + 16 <= v.byteLength) {
+      // Folded bucket: plot at its mean
+      out.samples.push({t: v.getUint32(o + 1, true), c: v.getInt16(o + 11, true) / 10,
+                        s: v.getInt16(o + 13, true) / 10, st: v.getUint8(o + 15)});
+      o += 16;
+    } else if (type === 0x53 && o + 10 <= v.byteLength) {
+      out.samples.push({t: v.getUint32(o + 1, true), c: v.getInt16(o + 5, true) / 10,
+                        s: v.getInt16(o + 7, true) / 10, st: v.getUint8(o + 9)});
+      o += 10;
+    } else if (type === 0x45 && o + 6 <= v.byteLength) {
+      out.events.push({t: v.getUint32(o + 1, true), st: v.getUint8(o + 5)});
+      o += 6;
+    } else {
+      break;    // unknown or truncated record
+    }
+  }
+  return out;
+}
+
+// Whole history thinned to about one point per chart pixel (?points=), so
+// the first paint does not wait for days of samples; then the last
+// HISTORY_DETAIL_SEC unreduced for the zoomed ranges
 async function fetchHistory() {
+  historySyncing = true;
   try {
-    var r = await fetch(API + '/history');
+    var r = await fetch(API + '/history?format=bin&points=' + graphPointCount());
     if (!r.ok) return;
-    var d = await r.json();
-    // Compact format: samples are [time, temp*10, setpoint*10, state]
-    graphSamples = (d.samples || []).map(function(a) {
-      return {t: a[0], c: a[1] / 10, s: a[2] / 10, st: a[3]};
-    });
-    // Events are [time, state]
-    graphEvents = (d.events || []).map(function(a) {
-      return {t: a[0], st: a[1]};
-    });
-    deviceNow = d.now || 0;
+    var d = parseHistory(await r.arrayBuffer());
+    if (!d) return;
+    graphSamples = d.samples;
+    graphEvents = d.events;
+    historyCursor = d.latest;
+    deviceNow = d.now;
     localAtFetch = Date.now();
     graphInited = true;
     drawGraph();
-  } catch (e) { console.error('fetchHistory', e); }
+
+    var since = d.latest > HISTORY_DETAIL_SEC ? d.latest - HISTORY_DETAIL_SEC : 0;
+    r = await fetch(API + '/history?format=bin&since=' + since);
+    if (!r.ok) return;
+    var detail = parseHistory(await r.arrayBuffer());
+    if (!detail) return;
+    var older = graphSamples.filter(function(p) { return !p.live && p.t <= since; });
+    graphSamples = older.concat(detail.samples.filter(function(p) { return p.t > since; }));
+    graphEvents = graphEvents.concat(detail.events.filter(function(e) { return e.t > historyCursor; }));
+    if (detail.latest > historyCursor) historyCursor = detail.latest;
+    deviceNow = detail.now;
+    localAtFetch = Date.now();
+    drawGraph();
+  } catch (e) {
+    console.error('fetchHistory', e);
+  } finally {
+    historySyncing = false;
+  }
+}
+
+// Points to ask for: the graph's width in CSS pixels
+function graphPointCount() {
+  var canvas = document.getElementById('temp-graph');
+  var w = canvas ? Math.round(canvas.getBoundingClientRect().width) : 0;
+  if (w <= 0) w = 800;    // dashboard hidden at load
+  return Math.max(300, Math.min(2000, w));
+}
+
+// Pull only what the device recorded since the last fetch and swap it in for
+// the points estimated from status polls
+async function syncHistory() {
+  if (historySyncing) return;
+  historySyncing = true;
+  try {
+    var r = await fetch(API + '/history?format=bin&since=' + historyCursor);
+    if (!r.ok) return;
+    var d = parseHistory(await r.arrayBuffer());
+    if (!d) return;
+    mergeHistory(d.samples, d.events, d.latest);
+    deviceNow = d.now;
+    localAtFetch = Date.now();
+  } catch (e) {
+    console.error('syncHistory', e);
+  } finally {
+    historySyncing = false;
+  }
+}
+
+// Swap the estimated points for recorded ones newer than the cursor
+function mergeHistory(samples, events, latest) {
+  samples = samples.filter(function(p) { return p.t > historyCursor; });
+  events = events.filter(function(e) { return e.t > historyCursor; });
+  graphSamples = graphSamples.filter(function(p) { return !p.live; }).concat(samples);
+  graphEvents = graphEvents.filter(function(e) { return !e.live; }).concat(events);
+  if (latest > historyCursor) historyCursor = latest;
 }
 
 function appendGraphPoint(s) {
@@ -211,18 +366,21 @@ function appendGraphPoint(s) {
   var estNow = deviceNow + (Date.now() - localAtFetch) / 1000;
   var stIdx = STATE_NAMES.indexOf(s.state);
   if (stIdx < 0) stIdx = 0;
-  graphSamples.push({t: Math.round(estNow), c: s.temp, s: s.setpoint, st: stIdx});
+  graphSamples.push({t: Math.round(estNow), c: s.temp, s: s.setpoint, st: stIdx, live: true});
   // Detect state changes vs last sample
   if (graphSamples.length >= 2) {
     var prev = graphSamples[graphSamples.length - 2];
     if (prev.st !== stIdx) {
-      graphEvents.push({t: Math.round(estNow), st: stIdx});
+      graphEvents.push({t: Math.round(estNow), st: stIdx, live: true});
     }
   }
-  // Trim to backend capacity (~24 hours)
-  var cutoff = estNow - 86400;
+  // Trim to backend capacity (~12 days across all tiers)
+  var cutoff = estNow - 12 * 86400;
   while (graphSamples.length > 1 && graphSamples[0].t < cutoff) graphSamples.shift();
   while (graphEvents.length > 0 && graphEvents[0].t < cutoff) graphEvents.shift();
+  // Replace estimates with recorded samples once the device has a new one
+  // (pushed over the event stream when it is up)
+  if (!eventStreamOpen && estNow - historyCursor >= HISTORY_SYNC_SEC) syncHistory();
   drawGraph();
 }
 
@@ -652,15 +810,13 @@ function switchTab(tab) {
     requestAnimationFrame(drawGraph);
   }
   if (tab === 'logs') {
-    if (!logPollTimer) {
-      pollLogs();
-      logPollTimer = setInterval(pollLogs, LOG_POLL_MS);
-    }
-  } else {
-    if (logPollTimer) {
-      clearInterval(logPollTimer);
-      logPollTimer = null;
+    if (!logPolling) {
+      logPolling = true;
+      pollLogs(++logPollGen);
     }
+  } else if (logPolling) {
+    logPolling = false;
+    logPollGen++;
   }
 
   updatePerfDisplay();
@@ -2094,41 +2250,72 @@ function appendLogDOM(container, entry) {
   container.appendChild(div);
 }
 
-async function pollLogs() {
-  try {
-    var url = API + '/logs';
-    if (logLastSeq > 0) url += '?since=' + logLastSeq;
-    var r = await fetch(url);
-    if (!r.ok) return;
-    var d = await r.json();
-    if (!d.logs || d.logs.length === 0) return;
-
-    var container = document.getElementById('log-container');
-    var autoScroll = document.getElementById('log-autoscroll').checked;
-    var filterLevel = parseInt(document.getElementById('log-level-filter').value);
-
-    for (var i = 0; i < d.logs.length; i++) {
-      var e = d.logs[i];
-      var entry = { seq: e[0], time: e[1], pri: e[2], tag: e[3], msg: e[4] };
-      logEntries.push(entry);
-      logLastSeq = entry.seq;
-      if (entry.pri <= filterLevel) {
-        appendLogDOM(container, entry);
-      }
-    }
+function appendLogs(logs) {
+  if (logs.length === 0) return;
+  var container = document.getElementById('log-container');
+  var autoScroll = document.getElementById('log-autoscroll').checked;
+  var filterLevel = parseInt(document.getElementById('log-level-filter').value);
 
-    // Trim old DOM entries
-    while (container.children.length > LOG_MAX_DISPLAY) {
-      container.removeChild(container.firstChild);
+  for (var i = 0; i < logs.length; i++) {
+    var e = logs[i];
+    var entry = { seq: e[0], time: e[1], pri: e[2], tag: e[3], msg: e[4] };
+    if (entry.seq <= logLastSeq) continue;
+    logEntries.push(entry);
+    logLastSeq = entry.seq;
+    if (entry.pri <= filterLevel) {
+      appendLogDOM(container, entry);
     }
+  }
 
-    if (autoScroll) {
-      container.scrollTop = container.scrollHeight;
-    }
+  // Trim old DOM entries
+  while (container.children.length > LOG_MAX_DISPLAY) {
+    container.removeChild(container.firstChild);
+  }
 
-    document.getElementById('log-count').textContent = logEntries.length + ' entries';
-  } catch (e) {
-    // silently ignore fetch errors
+  if (autoScroll) {
+    container.scrollTop = container.scrollHeight;
+  }
+
+  document.getElementById('log-count').textContent = logEntries.length + ' entries';
+}
+
+function logPause(ms) {
+  return new Promise(function(ok) { setTimeout(ok, ms); });
+}
+
+// Backlog first, then long polls: each request is held by the device until a
+// newer line arrives, so the viewer updates at once and an idle one costs a
+// single open request
+async function pollLogs(gen) {
+  while (gen === logPollGen) {
+    // New lines arrive over the event stream once the backlog is loaded
+    if (eventStreamOpen && logBackfilled) {
+      await logPause(LOG_POLL_MS);
+      continue;
+    }
+    try {
+      var url = API + '/logs';
+      if (logBackfilled) url += '?since=' + logLastSeq + '&wait=' + LOG_WAIT_MS;
+      var r = await fetch(url);
+      if (!r.ok) throw new Error(r.status);
+      var d = await r.json();
+      if (gen !== logPollGen) return;
+      if (!logBackfilled) {
+        // Whole ring first, then any newer lines the stream delivered meanwhile
+        var streamed = logEntries.map(function(e) { return [e.seq, e.time, e.pri, e.tag, e.msg]; });
+        logEntries = [];
+        logLastSeq = 0;
+        document.getElementById('log-container').innerHTML = '';
+        logBackfilled = true;
+        appendLogs(d.logs || []);
+        appendLogs(streamed);
+        continue;
+      }
+      appendLogs(d.logs || []);
+    } catch (e) {
+      // Offline or busy: try again shortly
+      await logPause(LOG_POLL_MS);
+    }
   }
 }
 
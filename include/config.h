@@ -35,6 +35,7 @@
 #define PIN_TM1638_STB    6   // D6 header pin - Strobe
 #define PIN_TM1638_CLK    9   // D9 header pin - Clock
 #define PIN_TM1638_DIO    14  // A4 header pin - Data I/O
+#define TM1638_REFRESH_MS 100 // ms between bus updates; only changes are sent
 
 // I2C Pins (STEMMA QT connector on Feather ESP32-S3)
 #define PIN_I2C_SDA           3   // GPIO3 - STEMMA QT SDA
@@ -69,6 +70,14 @@
 #define TEMP_MIN_SETPOINT        150   // Minimum allowed setpoint (°F)
 #define TEMP_MAX_SETPOINT        500   // Maximum allowed setpoint (°F)
 
+// Dedicated control task (sensor read, state machine, relays) pinned to the
+// app core with a fixed period, isolated from network/UI work in loop()
+#define ENABLE_CONTROL_TASK      true
+#define CONTROL_TASK_CORE        1     // APP_CPU (WiFi/lwIP stack lives on PRO_CPU)
+#define CONTROL_TASK_PRIORITY    10    // Preempts loop() (1) and async_tcp (3)
+#define CONTROL_TASK_STACK       6144  // bytes
+#define CONTROL_DIAG_DELAY       10000 // ms after boot to run MAX31865 diagnostic
+
 // PID Configuration - Proportional Band Method (from PiSmoker)
 // This method uses negative gains with 0.5 centering for stable control
 #define PID_PROPORTIONAL_BAND    60.0  // Proportional band in °F
@@ -82,6 +91,8 @@
 
 // Auger Cycle Time for time-proportioning control
 #define AUGER_CYCLE_TIME         20000 // ms (20 seconds - matches PiSmoker)
+// On/off edges within the cycle run from a one-shot timer, not the 2s tick
+#define AUGER_EDGE_RETRY_MS      10    // ms to retry an edge while a tick holds the controller
 
 // Persistent PID Integral Storage (NVS)
 #define ENABLE_PID_PERSISTENCE     true     // Save/restore integral across sessions
@@ -104,13 +115,37 @@
 #define LID_CLOSE_RECOVERY_TIME        30000   // ms - stable before declaring lid closed
 #define LID_OPEN_MIN_DURATION          5000    // ms - minimum to avoid false triggers
 
-// Temperature History (ring buffer for web graph)
-// Budget: ~30KB for history (ESP32-S3 no PSRAM needs ~100KB free for WiFi)
-// 2500 samples × 12 bytes = 30KB → ~14 hours at 20s intervals
-#define HISTORY_MAX_SAMPLES        2500     // ~14 hours at 20-second intervals
+// Temperature History (multi-resolution rings for web graph)
+// Budget: <40KB for history (ESP32-S3 no PSRAM needs ~100KB free for WiFi)
+// Raw samples are delta-compressed into fixed blocks; as they age they fold into
+// 2-minute, then 10-minute min/max/mean buckets:
+//   raw    64 × 128 bytes  =  8.0KB → ~38 hours at 20 s (~1.2 bytes/sample)
+//   tier 1 720 × 16 bytes  = 11.3KB → 24 hours at 2 min
+//   tier 2 1152 × 16 bytes = 18.0KB → 8 days at 10 min
+#define HISTORY_RAW_BLOCKS         64       // compressed raw sample blocks
+#define HISTORY_BLOCK_BYTES        128      // bytes per block, header included
 #define HISTORY_SAMPLE_INTERVAL    20000    // ms between history samples
+#define HISTORY_TIER1_BUCKETS      720      // 2-minute buckets (24 hours)
+#define HISTORY_TIER1_FOLD         6        // raw samples per tier 1 bucket
+#define HISTORY_TIER2_BUCKETS      1152     // 10-minute buckets (8 days)
+#define HISTORY_TIER2_FOLD         5        // tier 1 buckets per tier 2 bucket
 #define HISTORY_MAX_EVENTS         64       // State change events to keep
 
+// History Journal (append-only, CRC-checked segments on FFat; survives reboots)
+// Samples are batched in RAM and written once per flush interval, so a reboot
+// loses at most one interval. Flash wear per flush is bounded by ~3 sector
+// programs (data cluster, FAT, directory entry): a 14-hour cook flushes 168
+// times ≈ 504 sector programs, spread by wear levelling over the ~3.7MB FFat
+// partition (~940 sectors) ≈ 0.5 erase cycles per sector per cook.
+// 8 × 16KB segments at ~2.8 bytes/sample ≈ 10 days, covering every RAM tier.
+#define ENABLE_HISTORY_JOURNAL         true
+#define HISTORY_JOURNAL_DIR            "/history"
+#define HISTORY_JOURNAL_SEGMENT_BYTES  16384    // roll to a new segment past this
+#define HISTORY_JOURNAL_SEGMENTS       8        // segments kept (oldest deleted)
+#define HISTORY_JOURNAL_FLUSH_INTERVAL 300000   // ms between flash writes (5 min)
+#define HISTORY_JOURNAL_PENDING_BLOCKS 4        // RAM batch blocks between flushes
+#define HISTORY_JOURNAL_PENDING_EVENTS 16       // RAM batch events between flushes
+
 // Temperature thresholds
 #define STARTUP_TEMP_THRESHOLD   115   // Absolute °F to transition from startup to running
 #define IGNITER_CUTOFF_TEMP      100   // Turn off igniter when temp exceeds this
@@ -149,9 +184,31 @@
   #define WIFI_AP_PASS "your-ap-password"
 #endif
 
+// Wi-Fi link management: setup() never waits for the network. The station
+// connects in the background and retries with backoff; network services
+// start on the first IP (or when the AP opens)
+#define WIFI_POLL_INTERVAL       100     // ms between link state checks
+#define WIFI_CONNECT_TIMEOUT_MS  15000   // attempt abandoned without an IP by then
+#define WIFI_RETRY_MIN_MS        1000    // retry delay, doubled per failure...
+#define WIFI_RETRY_MAX_MS        60000   // ...up to this
+#define WIFI_AP_FALLBACK_MS      10000   // AP opens if no IP this long after boot
+
 // Web Server Port
 #define WEB_SERVER_PORT 80
 
+// Server-sent events (/api/events): status every control tick plus history
+// deltas and new log lines, pushed instead of polled. Each frame is
+// serialized once for all subscribers; while clients are still draining
+// earlier frames, ticks are coalesced into the next frame instead of queued.
+#define ENABLE_EVENT_STREAM       true
+#define EVENT_STREAM_MAX_CLIENTS  4      // further subscribers are refused
+#define EVENT_STREAM_BACKLOG      2      // avg frames queued per client before coalescing
+#define EVENT_STREAM_FRAME_BYTES  1024   // largest frame (bounds history/log deltas)
+#define EVENT_STREAM_RETRY_MS     3000   // browser reconnect delay
+
+// Largest /api/status body (formatted once per tick by StatusCache)
+#define STATUS_JSON_BYTES         448
+
 // ============================================================================
 // MQTT CONFIGURATION
 // ============================================================================
@@ -190,8 +247,40 @@
 
 #define ENABLE_SERIAL_DEBUG  true
 #define SERIAL_BAUD_RATE     115200
+#define SERIAL_BOOT_WAIT_MS  0       // Wait this long for a USB serial host at boot (0: don't)
 #define LOG_BUFFER_SIZE      256
 
+// Log levels. Calls below LOG_LEVEL_COMPILE are removed at compile time
+// (arguments not evaluated); the rest are filtered at runtime per tag and
+// sink, starting from LOG_LEVEL_DEFAULT (see /api/log/levels)
+#define LOG_LEVEL_COMPILE        LOG_DEBUG
+#define LOG_LEVEL_DEFAULT        LOG_DEBUG
+#define LOG_FILTER_MAX_TAGS      32    // distinct [TAG]s with their own levels
+
+// Flood control: each DUAL_LOGF / LOG_EVENT call site has a token bucket, and
+// the drain task folds a site's identical consecutive messages into one
+// "previous message repeated N times" line
+#define ENABLE_LOG_RATE_LIMIT    true
+#define LOG_RATE_BURST           10      // messages a call site may send at once
+#define LOG_RATE_INTERVAL_MS     1000    // then one per interval
+#define LOG_REPEAT_WINDOW_MS     600000  // a folded message is written again after 10 min
+#define LOG_SITE_FLUSH_MS        5000    // report a quiet site's pending suppressed counts
+#define LOG_SITE_WATCH           16      // call sites the drain task watches for pending counts
+
+// Asynchronous logging: callers only format into a lock-free queue; a
+// low-priority task writes Serial, Telnet, Syslog and the log ring
+#define ENABLE_LOG_QUEUE         true
+#define LOG_QUEUE_DEPTH          32    // Entries (power of two), LOG_BUFFER_SIZE bytes each
+#define LOG_DRAIN_TASK_CORE      0     // PRO_CPU, away from the control task
+#define LOG_DRAIN_TASK_PRIORITY  1     // Same as loop(), below async_tcp and control
+#define LOG_DRAIN_TASK_STACK     4096  // bytes
+
+// LOG_EVENT records as binary UDP frames for tools/logdecode instead of
+// syslog text (Serial, Telnet and the web log still get expanded text)
+#define ENABLE_BINARY_LOG        false
+#define BINARY_LOG_PORT          9545                    // logdecode --udp port
+#define BINARY_LOG_FRAME_BYTES   1024                    // One UDP datagram, under the MTU
+
 // Syslog Configuration (Cribl/Elastic Stack)
 #define ENABLE_SYSLOG        true                    // Enable remote syslog
 #ifndef SYSLOG_SERVER
@@ -202,6 +291,23 @@
 #define SYSLOG_APP_NAME      "smoker"                // Application name in logs
 #define SYSLOG_FACILITY      LOG_LOCAL0              // Syslog facility (local0 = 16)
 
+// Syslog batching: messages are packed into one datagram (or TCP write) of up
+// to SYSLOG_BATCH_BYTES and sent when full, when the oldest is
+// SYSLOG_BATCH_FLUSH_MS old, or at once for a warning or worse
+#define ENABLE_SYSLOG_BATCH         true
+#define SYSLOG_BATCH_BYTES          1400                 // Under the 1472-byte UDP payload MTU
+#define SYSLOG_BATCH_FLUSH_MS       250
+#define SYSLOG_BATCH_FLUSH_PRIORITY 4                    // LOG_WARNING and more severe
+
+// Syslog transport for batches: UDP (newline-separated messages) or TCP with
+// RFC 6587 octet counting, reconnecting in the drain task
+#define SYSLOG_TRANSPORT_UDP        0
+#define SYSLOG_TRANSPORT_TCP        1
+#define SYSLOG_TRANSPORT            SYSLOG_TRANSPORT_UDP
+#define SYSLOG_TCP_PORT             9544                 // Cribl syslog TCP port
+#define SYSLOG_TCP_RECONNECT_MS     5000                 // Between connect attempts
+#define SYSLOG_TCP_CONNECT_TIMEOUT  1000                 // ms, blocks the drain task only
+
 // Telnet Server Configuration (Remote Serial Monitor)
 #define ENABLE_TELNET        true                    // Enable telnet server
 #define TELNET_PORT          23                      // Standard telnet port
@@ -209,12 +315,54 @@
 // TUI Server Configuration (Real-time Status Interface)
 #define ENABLE_TUI           false                   // Enable TUI telnet server (DISABLED - debugging)
 #define TUI_PORT             2323                    // TUI telnet port
+#define TUI_UPDATE_INTERVAL  1000                    // ms between frames while a client is connected
+#define TUI_ROWS             34                      // Screen buffer size; the layout fills it
+#define TUI_COLS             80
+#define TUI_MERGE_GAP        4                       // Unchanged cells resent rather than a cursor move
+#define TUI_CHUNK_BYTES      256                     // Bytes per telnet write while presenting a frame
 
 // Log Ring Buffer for Web UI (system log viewer)
 #define ENABLE_LOG_RING          true
 #define LOG_RING_SIZE            64                   // Number of log entries to keep
 #define LOG_RING_TAG_LEN         12                   // Max tag length (incl null)
-#define LOG_RING_MSG_LEN         80                   // Max message length (incl null)
+#define LOG_RING_MSG_LEN         80                   // Max message length, JSON-escaped (incl null)
+#define LOG_POLL_MAX_WAITERS     4                    // /api/logs long polls held at once
+#define LOG_POLL_MAX_WAIT_MS     25000                // Longest a long poll is held
+
+// Post-mortem record in RTC memory: the last log ring lines and controller
+// snapshot survive a panic, watchdog or brownout reset and are reported at
+// /api/crashlog and on MQTT <root>/crashlog after the next boot
+#define ENABLE_CRASH_LOG         true
+#define CRASH_LOG_LINES          16                   // Log lines kept
+#define CRASH_LOG_LINE_LEN       96                   // Per line (incl null)
+#define CRASH_LOG_JSON_BYTES     4096                 // Report body buffer (web, MQTT)
+
+// Loop profiler: per-stage latency histograms for loop() and the control
+// tick, at /api/perf and on MQTT <root>/perf. false builds it out entirely.
+#define ENABLE_PROFILER          true
+#define PROFILER_BUCKETS         16                   // Power-of-two buckets from 16us
+#define PROFILER_JSON_BYTES      6144                 // Report body buffer (web, MQTT)
+
+// Heap health: free, minimum-ever free, largest block and fragmentation,
+// at /api/perf/heap and in MQTT telemetry. The allocation tracer tags live
+// allocations by subsystem; it needs the malloc wrappers, so it is turned on
+// by building the feather_esp32s3_heaptrace environment, not here.
+#define HEAP_SAMPLE_INTERVAL     1000                 // ms between heap readings
+#ifndef ENABLE_HEAP_TRACE
+#define ENABLE_HEAP_TRACE        false
+#endif
+#define HEAP_TRACE_SLOTS         1024                 // Live pointer table (power of two)
+#define HEAP_JSON_BYTES          2048                 // Report body buffer (web)
+
+// loop() scheduler: periodic work runs as jobs at their deadlines and the
+// loop task sleeps in between
+#define SCHED_MAX_JOBS           16
+#define SCHED_MAX_SLEEP_MS       100                  // Longest single sleep
+#define SCHED_POLL_INTERVAL      20                   // ms between network polls (OTA, telnet, MQTT)
+#define SCHED_STATUS_INTERVAL    100                  // ms between status refreshes and event pushes
+#define SCHED_HEARTBEAT_INTERVAL 1000                 // ms between heartbeat LED toggles
+#define SCHED_REPORT_INTERVAL    10000                // ms between periodic status lines
+#define HTTP_OTA_POLL_INTERVAL   1000                 // ms between HTTP OTA timer/request checks
 
 // MAX31865 Verbose Debugging (logs every sensor read with resistance values)
 #define ENABLE_MAX31865_VERBOSE  false               // Disable to reduce Serial load
@@ -0,0 +1,53 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "max31865.h"
+#include "temperature_control.h"
+
+// Runs TemperatureController::tick() from a dedicated FreeRTOS task pinned to
+// CONTROL_TASK_CORE, woken every TEMP_CONTROL_INTERVAL ms by vTaskDelayUntil.
+// loop() keeps network and UI work; a stalled MQTT reconnect or HTTPS check
+// there no longer delays sensor reads, PID updates or auger edges.
+class ControlTask {
+public:
+  ControlTask(TemperatureController* controller, MAX31865* sensor);
+
+  // Create and start the task. Returns false if the task could not be created.
+  bool begin();
+  bool isRunning(void) { return _handle != nullptr; }
+
+  // Scheduling statistics. Jitter is the wake-up time relative to the ideal
+  // fixed-period schedule; exec is the time spent inside tick().
+  struct Stats {
+    uint32_t cycles;
+    int32_t lastJitterUs;
+    int32_t minJitterUs;
+    int32_t maxJitterUs;
+    uint32_t meanAbsJitterUs;
+    uint32_t lastExecUs;
+    uint32_t maxExecUs;
+    uint32_t overruns;         // cycles whose tick() ran past the next deadline
+    uint32_t stackHighWater;   // bytes of stack never used
+    uint32_t firstTickUs;      // start of the first tick since boot; kept by resetStats()
+  };
+  Stats getStats(void);
+  void resetStats(void);
+
+private:
+  TemperatureController* _controller;
+  MAX31865* _sensor;
+  TaskHandle_t _handle;
+  portMUX_TYPE _statsMux;
+  Stats _stats;
+  uint64_t _absJitterSumUs;
+  bool _diagRan;
+
+  static void taskEntry(void* arg);
+  void run();
+  void runDeferredDiagnostic();
+  void recordCycle(int64_t wakeUs, int32_t jitterUs, uint32_t execUs);
+};
+
+#endif // CONTROL_TASK_H
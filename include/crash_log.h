@@ -0,0 +1,129 @@
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "temperature_control.h"
+
+// Reset causes, numbered as esp_reset_reason_t so the value can be stored
+// as-is (and tested without ESP-IDF)
+#define CRASH_RESET_UNKNOWN    0
+#define CRASH_RESET_POWERON    1
+#define CRASH_RESET_EXT        2
+#define CRASH_RESET_SW         3
+#define CRASH_RESET_PANIC      4
+#define CRASH_RESET_INT_WDT    5
+#define CRASH_RESET_TASK_WDT   6
+#define CRASH_RESET_WDT        7
+#define CRASH_RESET_DEEPSLEEP  8
+#define CRASH_RESET_BROWNOUT   9
+#define CRASH_RESET_SDIO       10
+
+#define CRASH_LOG_MAGIC        0x43524C47u   // "CRLG"
+#define CRASH_LOG_VERSION      1             // bump when CrashRecord changes
+
+// Controller state at the last control tick, relays packed into a bit mask
+struct CrashSnapshot {
+  uint32_t uptime;          // millis() when recorded
+  float currentTemp;
+  float setpoint;
+  float pidOutput;          // 0.0 - 1.0
+  uint8_t state;            // ControllerState
+  uint8_t relays;           // CRASH_RELAY_* bits
+  uint8_t errorCount;
+  uint8_t reigniteAttempts;
+  bool lidOpen;
+  uint32_t check;           // logHash of the fields above, 0 = never written
+};
+
+#define CRASH_RELAY_AUGER    0x01
+#define CRASH_RELAY_FAN      0x02
+#define CRASH_RELAY_IGNITER  0x04
+
+struct CrashLogLine {
+  uint32_t time;            // millis()
+  uint8_t priority;
+  char text[CRASH_LOG_LINE_LEN];   // "[TAG] message", truncated
+};
+
+// What one boot leaves behind. Lives in RTC memory that a soft reset, panic,
+// watchdog or brownout does not clear, so it is only ever written with plain
+// stores: no checksum over the whole record on the hot path. A power-on
+// leaves garbage, which begin() rejects by magic, version and size.
+struct CrashRecord {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;            // sizeof(CrashRecord)
+  uint32_t bootCount;       // boots since the record was last invalid
+  uint32_t lineCount;       // lines ever appended; the newest is (lineCount - 1) % N
+  CrashLogLine lines[CRASH_LOG_LINES];
+  CrashSnapshot snapshot;
+};
+
+// ============================================================================
+// CrashLog - post-mortem record of the previous boot
+//
+// While running, append() copies each log ring line and recordSnapshot()
+// copies the controller state into the live record; both are a few plain
+// stores into RAM, nothing touches flash. At the next boot begin() moves an
+// intact record into the report, together with the reset reason, and starts
+// a fresh one. The report is served at /api/crashlog and published once over
+// MQTT.
+// ============================================================================
+class CrashLog {
+public:
+  explicit CrashLog(CrashRecord& live);
+
+  // Once at boot, before anything logs. `resetReason` is a CRASH_RESET_* value.
+  void begin(uint8_t resetReason);
+
+  // Any task, hot path
+  void append(uint8_t priority, uint32_t time, const char* text);
+  void recordSnapshot(const TemperatureController::Snapshot& snap);
+
+  // Previous boot
+  bool hasReport() const { return _hasReport; }
+  const CrashRecord& report() const { return _report; }
+  uint8_t resetReason() const { return _resetReason; }
+  // The previous boot ended in a panic, watchdog or brownout
+  bool crashed() const { return isCrash(_resetReason); }
+  uint32_t bootCount() const { return _live.bootCount; }
+
+  // Report lines, 0 = oldest; the text is always terminated
+  uint8_t reportLineCount() const;
+  const CrashLogLine& reportLine(uint8_t index) const;
+  // The report's snapshot passed its check
+  bool reportSnapshotValid() const;
+  // millis() of the last thing the previous boot recorded
+  uint32_t reportUptime() const;
+
+  // /api/crashlog body. Lines that do not fit are dropped oldest-first and
+  // counted in "dropped"; returns the length written (0 if `size` is too
+  // small for even the header).
+  size_t toJson(char* buf, size_t size) const;
+  // toJson() of the whole report, formatted once by begin(): nothing in it
+  // changes during a boot, so the web and MQTT readers share it without a
+  // buffer of their own. Length 0 if it did not fit CRASH_LOG_JSON_BYTES.
+  const char* json() const { return _json; }
+  size_t jsonLength() const { return _jsonLen; }
+
+  static bool isValid(const CrashRecord& record);
+  static bool isCrash(uint8_t resetReason);
+  static const char* resetReasonName(uint8_t resetReason);
+  static uint32_t snapshotCheck(const CrashSnapshot& snap);
+
+private:
+  CrashRecord& _live;
+  CrashRecord _report;
+  uint8_t _resetReason;
+  bool _hasReport;
+  char _json[CRASH_LOG_JSON_BYTES];
+  size_t _jsonLen;
+
+  void reset(uint32_t bootCount);
+};
+
+extern CrashLog crashLog;
+
+#endif // CRASH_LOG_H
@@ -12,10 +12,10 @@ public:
   // Initialize I2C and verify device is present
   bool begin();
 
-  // Poll encoder, returns true if input changed
-  bool update();
+  // Read the encoder, returns true if input changed; every ENCODER_POLL_INTERVAL
+  bool poll();
 
-  // Get rotation delta since last update (signed, in clicks)
+  // Get rotation delta since the last poll (signed, in clicks)
   int8_t getIncrement();
 
   // Edge-detected button press (true once per press)
@@ -35,7 +35,6 @@ private:
   bool     _buttonState;
   bool     _lastButtonState;
   bool     _buttonPressed;
-  unsigned long _lastPoll;
   unsigned long _lastButtonTime;
 
   bool readDevice();
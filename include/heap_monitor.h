@@ -0,0 +1,183 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// One look at the internal 8-bit heap (heap_caps_get_info)
+struct HeapReading {
+  uint32_t freeBytes;
+  uint32_t minFreeBytes;      // lowest free since boot, kept by the allocator
+  uint32_t largestBlock;      // largest single allocation that can succeed
+  uint32_t totalBytes;
+  uint32_t allocatedBlocks;
+  uint32_t freeBlocks;
+};
+
+// ============================================================================
+// HeapTracer - live allocations accounted by subsystem (ENABLE_HEAP_TRACE)
+//
+// The heap-trace build wraps malloc/calloc/realloc/free at link time; each
+// allocation is tagged with the subsystem that made it and kept in a fixed
+// open-addressed table of live pointers, so a free is charged back to the
+// tag that allocated. Allocations made before start() are not in the table
+// and their frees count as untracked; past HEAP_TRACE_SLOTS * 3/4 live
+// entries new allocations are only counted as dropped.
+// Never allocates. The malloc wrappers serialize updates; readers on other
+// tasks go through snapshot(), which copies the counters under the same lock.
+// ============================================================================
+class HeapTracer {
+public:
+  enum Tag : uint8_t {
+    TAG_OTHER,          // loop() outside a tagged scope, unknown tasks
+    TAG_SETUP,          // setup()
+    TAG_NET,            // WiFi driver, lwIP and event tasks
+    TAG_WEB,            // async_tcp: web server and event stream
+    TAG_MQTT,
+    TAG_TUI,
+    TAG_TELNET,
+    TAG_HISTORY,
+    TAG_STATUS,         // status cache
+    TAG_CONTROL,        // control task
+    TAG_LOG,            // log drain task and syslog
+    TAG_OTA,            // ArduinoOTA and HTTP OTA
+    TAG_COUNT
+  };
+
+  struct TagStats {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t bytes;           // allocated in total
+    uint32_t liveBlocks;
+    uint32_t liveBytes;
+    uint32_t peakBytes;       // highest liveBytes
+  };
+
+  struct Stats {
+    uint32_t live;            // table entries in use
+    uint32_t dropped;         // allocations not tracked, table full
+    uint32_t untrackedFrees;  // frees of pointers not in the table
+  };
+
+  HeapTracer();
+
+  void start() { _enabled = true; }
+  void stop() { _enabled = false; }
+  bool enabled() const { return _enabled; }
+
+  void onAlloc(const void* ptr, uint32_t size, Tag tag);
+  // Tag and size of a tracked pointer, removing it; false if not tracked
+  bool onFree(const void* ptr, Tag* tag = nullptr, uint32_t* size = nullptr);
+  // Counters restart; live blocks stay charged to their tags
+  void resetCounts();
+
+  // Tag for allocations by the loop task, set by HEAP_TAG scopes
+  Tag loopTag() const { return _loopTag; }
+  Tag setLoopTag(Tag tag) {
+    Tag previous = _loopTag;
+    _loopTag = tag;
+    return previous;
+  }
+
+  const TagStats& tagStats(Tag tag) const { return _tags[tag]; }
+  Stats getStats() const { return _stats; }
+
+  struct Snapshot {
+    Stats stats;
+    TagStats tags[TAG_COUNT];
+  };
+  Snapshot snapshot() const;
+
+  // "trace" object of the /api/perf/heap body, from a snapshot(); 0 if
+  // `size` is too small
+  size_t toJson(char* buf, size_t size) const;
+
+  static const char* tagName(Tag tag);
+
+private:
+  // ptr 0 marks an empty slot; size and tag share a word
+  struct Slot {
+    uintptr_t ptr;
+    uint32_t sizeTag;         // size << 8 | tag
+  };
+
+  Slot _slots[HEAP_TRACE_SLOTS];
+  TagStats _tags[TAG_COUNT];
+  Stats _stats;
+  Tag _loopTag;
+  bool _enabled;
+
+  static uint32_t slotFor(uintptr_t ptr);
+};
+
+// ============================================================================
+// HeapMonitor - free heap, largest block and fragmentation over time
+//
+// Sampled every HEAP_SAMPLE_INTERVAL. The largest free block is what runs
+// out first on a long cook: String churn leaves the free total roughly flat
+// while the block that a TLS handshake or JSON body needs shrinks, so its
+// low-water mark and when it was hit are kept alongside the allocator's own
+// minimum free.
+// ============================================================================
+class HeapMonitor {
+public:
+  struct Stats {
+    HeapReading last;
+    uint32_t samples;
+    uint32_t minLargestBlock;
+    uint32_t minLargestAt;    // millis() of minLargestBlock
+    uint8_t fragmentation;    // % of free heap not in the largest block
+    uint8_t maxFragmentation;
+  };
+
+  HeapMonitor();
+
+  void sample(const HeapReading& reading, uint32_t now);
+  const Stats& getStats() const { return _stats; }
+
+  // /api/perf/heap body, with the tracer's tags when given; 0 if `size` is
+  // too small
+  size_t toJson(char* buf, size_t size, uint32_t uptimeMs, const HeapTracer* tracer) const;
+
+  static uint8_t fragmentation(const HeapReading& reading);
+#ifdef ARDUINO_ARCH_ESP32
+  static HeapReading read();
+#endif
+
+private:
+  Stats _stats;
+};
+
+extern HeapMonitor heapMonitor;
+
+// ============================================================================
+// Allocation tags. With ENABLE_HEAP_TRACE false these expand to nothing.
+//
+//   {
+//     HEAP_TAG(HeapTracer::TAG_MQTT);    // loop task, until the end of the block
+//     mqttClient->publishStatus();
+//   }
+// ============================================================================
+#if ENABLE_HEAP_TRACE
+
+extern HeapTracer heapTracer;
+
+class HeapTagScope {
+public:
+  explicit HeapTagScope(HeapTracer::Tag tag) : _previous(heapTracer.setLoopTag(tag)) {}
+  ~HeapTagScope() { heapTracer.setLoopTag(_previous); }
+
+private:
+  HeapTracer::Tag _previous;
+};
+
+#define HEAP_TAG(tag) HeapTagScope _heapTagScope(tag)
+
+#else
+
+#define HEAP_TAG(tag)
+
+#endif // ENABLE_HEAP_TRACE
+
+#endif // HEAP_MONITOR_H
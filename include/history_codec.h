@@ -0,0 +1,101 @@
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+
+// Temperature history sample (for web graph)
+// 12 bytes/sample with natural alignment (was 16 with floats)
+struct HistorySample {
+  uint32_t time;     // seconds since boot (millis()/1000)
+  int16_t temp;      // current temperature °F × 10 (2253 = 225.3°F)
+  int16_t setpoint;  // target temperature °F × 10
+  uint8_t state;     // ControllerState enum value
+};
+
+// Block of delta-compressed samples. The header holds the first sample
+// (keyframe) in full; every later sample is coded against its predecessor.
+struct HistoryBlock {
+  uint32_t first;    // absolute index of the keyframe sample
+  uint32_t time;     // keyframe
+  int16_t temp;
+  int16_t setpoint;
+  uint8_t state;
+  uint8_t count;     // samples in block, keyframe included (0 = empty)
+  uint16_t used;     // bytes of data[] in use
+  uint8_t data[HISTORY_BLOCK_BYTES - 16];
+};
+
+static_assert(sizeof(HistoryBlock) == HISTORY_BLOCK_BYTES, "HistoryBlock header must be 16 bytes");
+
+// ============================================================================
+// HistoryCodec - sample delta coding
+//
+// Samples arrive on a fixed interval with small temperature changes, so most
+// code to a single byte:
+//
+//   1zzzzzzz              nominal interval, setpoint and state unchanged,
+//                         zigzag temperature delta in -64..63 (±6.4°F)
+//   0000SPTD [fields...]  general form; each set flag adds a field:
+//                         D: varint zigzag(dt - interval)
+//                         T: varint zigzag(temperature delta)
+//                         P: varint zigzag(setpoint delta)
+//                         S: new state byte
+//
+// State is only written when it changes, so a run of identical states costs
+// nothing past its first sample.
+// ============================================================================
+class HistoryCodec {
+public:
+  // Worst-case bytes for one non-keyframe sample
+  static const uint8_t MAX_SAMPLE_BYTES = 1 + 5 + 3 + 3 + 1;
+
+  // Reset `block` to hold `sample` as its keyframe
+  static void start(HistoryBlock& block, const HistorySample& sample, uint32_t index);
+
+  // Append `sample`, coded against `prev` (the block's last sample).
+  // Returns false, leaving the block untouched, if it does not fit.
+  static bool append(HistoryBlock& block, const HistorySample& prev, const HistorySample& sample);
+
+  // Streams the samples of one block in order
+  class Decoder {
+  public:
+    Decoder() : _block(nullptr), _pos(0), _index(0) {}
+    explicit Decoder(const HistoryBlock& block) { reset(block); }
+
+    void reset(const HistoryBlock& block);
+
+    // Next sample, or false past the end of the block
+    bool next(HistorySample& out);
+
+    // Absolute index of the sample last returned by next()
+    uint32_t index() const { return _block->first + _index - 1; }
+
+  private:
+    const HistoryBlock* _block;
+    uint16_t _pos;
+    uint8_t _index;
+    HistorySample _prev;
+  };
+
+  static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+  static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+private:
+  enum : uint8_t {
+    FAST = 0x80,
+    HAS_DT = 0x01,
+    HAS_TEMP = 0x02,
+    HAS_SETPOINT = 0x04,
+    HAS_STATE = 0x08
+  };
+
+  static uint8_t putVarint(uint8_t* out, uint32_t v);
+  static bool getVarint(const HistoryBlock& block, uint16_t& pos, uint32_t& v);
+};
+
+static_assert(sizeof(HistoryBlock::data) >= HISTORY_TIER1_FOLD * HistoryCodec::MAX_SAMPLE_BYTES,
+              "HistoryBlock must hold at least one whole tier 1 group");
+
+#endif // HISTORY_CODEC_H
@@ -0,0 +1,93 @@
+#ifndef HISTORY_DOWNSAMPLE_H
+#define HISTORY_DOWNSAMPLE_H
+
+#include <stdint.h>
+#include "history_codec.h"
+#include "history_store.h"
+
+// ============================================================================
+// HistorySeries - every tier of a HistoryStore as one time-ordered series
+//
+// Tier 2 buckets, then tier 1 buckets, then raw samples, limited to
+// (since, latest]. Buckets are returned as a sample at their mean. Reads the
+// store in place like SampleReader; nothing is copied out beyond the block
+// being decoded.
+// ============================================================================
+class HistorySeries {
+public:
+  HistorySeries(const HistoryStore& store, uint32_t since, uint32_t latest);
+
+  // Look at the next point without consuming it
+  bool peek(HistorySample& out);
+  bool next(HistorySample& out);
+
+private:
+  const HistoryStore& _store;
+  HistoryStore::SampleReader _reader;
+  uint32_t _latest;
+  uint32_t _lastTime;      // time of the last point returned
+  uint32_t _index;         // next bucket index in the current tier
+  uint8_t _tier;           // 2, 1, then 0 for raw samples
+  HistorySample _peeked;
+  bool _hasPeeked;
+  bool _started;
+
+  bool fetch(HistorySample& out);
+};
+
+// ============================================================================
+// HistoryDownsampler - streaming Largest-Triangle-Three-Buckets reducer
+//
+// Reduces a HistorySeries to about `points` samples for plotting: the first
+// and last points, plus one point per time bucket in between, chosen to form
+// the largest triangle with the previously kept point and the mean of the
+// next non-empty bucket. Buckets are equal slices of time, so dense raw data
+// and sparse folded tiers are thinned to the same on-screen density.
+//
+// Every sample whose state differs from the one before it is always kept, so
+// state-coloured graph segments start exactly where the recorded ones do;
+// this adds at most two points per state change beyond `points`.
+//
+// Runs in a single pass with a second series cursor reading one bucket ahead
+// for the next-bucket mean; no history is buffered.
+// ============================================================================
+class HistoryDownsampler {
+public:
+  HistoryDownsampler(const HistoryStore& store, uint32_t since, uint32_t latest,
+                     uint16_t points);
+
+  bool next(HistorySample& out);
+
+  static const uint16_t MIN_POINTS = 3;
+
+private:
+  HistorySeries _main;
+  HistorySeries _lead;          // reads ahead for next-bucket means
+  uint32_t _start;              // time of the first point
+  uint32_t _end;                // latest: the last point
+  uint16_t _buckets;            // interior buckets between first and last
+  bool _started;
+
+  uint32_t _bucket;             // bucket being scanned by _main
+  HistorySample _kept;          // last point emitted (triangle vertex A)
+  uint8_t _prevState;
+  HistorySample _candidate;     // best point so far in the current bucket
+  int64_t _candidateArea;
+  bool _hasCandidate;
+
+  uint32_t _avgBucket;          // bucket the next-bucket mean was taken over
+  uint32_t _avgTime;
+  int32_t _avgTemp;
+  bool _hasAvg;
+
+  HistorySample _queue[2];      // points ready to return, oldest first
+  uint8_t _queued;
+  uint8_t _queueHead;
+
+  uint32_t bucketOf(uint32_t time) const;
+  void meanAfter(uint32_t bucket);
+  void endBucket();
+  void push(const HistorySample& s);
+};
+
+#endif // HISTORY_DOWNSAMPLE_H
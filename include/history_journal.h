@@ -0,0 +1,99 @@
+#ifndef HISTORY_JOURNAL_H
+#define HISTORY_JOURNAL_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "config.h"
+#include "history_codec.h"
+#include "history_store.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#endif
+
+// ============================================================================
+// HistoryJournal - crash-safe history log on flash
+//
+// An append-only sequence of segment files (HISTORY_JOURNAL_DIR/NNNNNNNN.seg).
+// Each segment is a run of records:
+//
+//   [0xA5] [type] [length u16] [crc32 u32] [payload...]     (little-endian)
+//
+// where the CRC covers type, length and payload. Sample records carry a
+// delta-coded HistoryBlock (header + used bytes); event records a time and
+// state. A power cut mid-write leaves a torn record at the tail of the newest
+// segment; recovery stops at the first record that fails its checks and
+// starts a fresh segment rather than appending after garbage.
+//
+// The control task queues samples and events in RAM (append*); the loop task
+// calls service(), which writes the batch once per
+// HISTORY_JOURNAL_FLUSH_INTERVAL so flash I/O never lands on the control path.
+// ============================================================================
+class HistoryJournal {
+public:
+  struct Stats {
+    uint32_t flushes;          // batches written
+    uint32_t bytesWritten;
+    uint32_t segmentsCreated;
+    uint32_t writeErrors;      // short writes / open failures
+    uint32_t dropped;          // samples or events lost to a full RAM batch
+    uint32_t recoveredSamples;
+    uint32_t recoveredEvents;
+    uint32_t corruptRecords;   // records rejected during recovery
+  };
+
+  explicit HistoryJournal(fs::FS& fs);
+
+  // Replay every intact record into `store` (oldest first) and prepare the
+  // journal for appending. Call once at boot, before samples are recorded.
+  void begin(HistoryStore& store);
+
+  // Queue for the next flush (control task)
+  void appendSample(const HistorySample& sample);
+  void appendEvent(uint32_t time, uint8_t state);
+
+  // Flush if the interval has elapsed or the batch is filling up (loop task)
+  void service();
+  // Write whatever is queued now
+  void flush();
+
+  Stats getStats(void);
+
+  static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+  enum RecordType : uint8_t { RECORD_SAMPLES = 1, RECORD_EVENT = 2 };
+  static const uint8_t RECORD_MAGIC = 0xA5;
+  static const uint8_t RECORD_HEADER_BYTES = 8;
+
+private:
+  fs::FS& _fs;
+  uint32_t _segment;         // sequence of the segment being appended to
+  uint32_t _oldestSegment;
+  uint32_t _segmentBytes;    // size of the current segment
+  bool _needNewSegment;      // tail was torn: never append after it
+  unsigned long _lastFlush;
+  Stats _stats;
+
+  // Pending batch, filled by the control task (guarded by _mux)
+  HistoryBlock _pending[HISTORY_JOURNAL_PENDING_BLOCKS];
+  uint8_t _pendingBlocks;    // blocks in use, the last one still open
+  HistorySample _pendingLast;
+  HistoryEvent _pendingEvents[HISTORY_JOURNAL_PENDING_EVENTS];
+  uint8_t _pendingEventCount;
+  uint32_t _sampleIndex;
+
+  // Flush staging, loop task only
+  uint8_t _writeBuf[HISTORY_JOURNAL_PENDING_BLOCKS * (RECORD_HEADER_BYTES + sizeof(HistoryBlock)) +
+                    HISTORY_JOURNAL_PENDING_EVENTS * (RECORD_HEADER_BYTES + 5)];
+
+#ifdef ARDUINO_ARCH_ESP32
+  portMUX_TYPE _mux;
+#endif
+
+  void segmentPath(uint32_t seq, char* out, size_t len);
+  bool replaySegment(uint32_t seq, HistoryStore& store);
+  size_t putRecord(uint8_t* out, uint8_t type, const uint8_t* payload, uint16_t len);
+  bool startSegment();
+};
+
+#endif // HISTORY_JOURNAL_H
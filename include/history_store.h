@@ -0,0 +1,213 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "history_codec.h"
+#include "seqlock.h"
+
+// Aggregate of consecutive older samples (coarse history tiers)
+struct HistoryBucket {
+  uint32_t time;     // time of the first folded sample
+  int16_t minTemp;   // °F × 10
+  int16_t maxTemp;   // °F × 10
+  int16_t meanTemp;  // °F × 10
+  int16_t setpoint;  // °F × 10 at end of bucket
+  uint8_t state;     // state at end of bucket
+};
+
+// State change event
+struct HistoryEvent {
+  uint32_t time;     // seconds since boot
+  uint8_t state;     // new state entered
+};
+
+// ============================================================================
+// HistoryRing - fixed ring addressed by absolute index
+//
+// Every record ever pushed has an absolute index; [begin(), end()) is the
+// range still held. One writer (the control task) pushes and evicts; readers on
+// other tasks copy records out by absolute index without locking. A read that
+// raced with the slot being recycled is detected and reported as missing.
+//
+// Records are stored as 32-bit relaxed atomics so a racing copy is well
+// defined; the writer publishes eviction before recycling a slot, and readers
+// re-check begin() after copying.
+// ============================================================================
+template <typename T, uint16_t N>
+class HistoryRing {
+public:
+  HistoryRing() { clear(); }
+
+  void clear() {
+    _begin.store(0, std::memory_order_relaxed);
+    _end.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t begin() const { return _begin.load(std::memory_order_acquire); }
+  uint32_t end() const { return _end.load(std::memory_order_acquire); }
+  uint16_t count() const { return (uint16_t)(end() - begin()); }
+  bool full() const { return count() >= N; }
+  static uint16_t capacity() { return N; }
+
+  // Copy record `index` into `out`. Returns false if it is not (or no longer) held.
+  bool read(uint32_t index, T& out) const {
+    if (index < begin() || index >= end()) return false;
+    uint32_t buf[WORDS];
+    const std::atomic<uint32_t>* slot = _words + (index % N) * WORDS;
+    for (uint8_t i = 0; i < WORDS; i++) {
+      buf[i] = slot[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (index < _begin.load(std::memory_order_relaxed)) return false;
+    memcpy(&out, buf, sizeof(T));
+    return true;
+  }
+
+  // Writer side -------------------------------------------------------------
+
+  // Append a record; the caller must evict() first when full()
+  void push(const T& value) {
+    uint32_t e = _end.load(std::memory_order_relaxed);
+    uint32_t buf[WORDS] = {0};
+    memcpy(buf, &value, sizeof(T));
+    std::atomic<uint32_t>* slot = _words + (e % N) * WORDS;
+    for (uint8_t i = 0; i < WORDS; i++) {
+      slot[i].store(buf[i], std::memory_order_relaxed);
+    }
+    _end.store(e + 1, std::memory_order_release);
+  }
+
+  // Drop the `n` oldest records
+  void evict(uint16_t n) {
+    uint32_t b = _begin.load(std::memory_order_relaxed);
+    uint32_t e = _end.load(std::memory_order_relaxed);
+    if (n > e - b) n = e - b;
+    _begin.store(b + n, std::memory_order_relaxed);
+    // Readers that observe a recycled slot must also observe the new begin
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static const size_t STORAGE_BYTES = ((sizeof(T) + 3) / 4) * 4 * N;
+
+private:
+  static const uint8_t WORDS = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> _begin;
+  std::atomic<uint32_t> _end;
+  std::atomic<uint32_t> _words[WORDS * N];
+};
+
+// ============================================================================
+// HistoryStore - multi-resolution temperature history
+//
+// Samples arrive every HISTORY_SAMPLE_INTERVAL into the raw tier, a ring of
+// delta-compressed blocks (see HistoryCodec). The newest block is still being
+// appended to and is published separately through a SeqLock. When the raw
+// ring is full, its oldest block is decoded and folded, HISTORY_TIER1_FOLD
+// samples at a time, into min/max/mean buckets in tier 1; when tier 1 is full,
+// its oldest HISTORY_TIER2_FOLD buckets fold into one tier 2 bucket. Tiers
+// never overlap in time: oldest data lives in tier 2, newest in the raw tier.
+//
+// Blocks always start on a tier 1 group boundary, so evicting a block folds
+// whole groups only. A block that fills mid-group is closed at the group's
+// start and the partial group re-coded into the next block.
+// ============================================================================
+class HistoryStore {
+public:
+  typedef HistoryRing<HistoryBlock, HISTORY_RAW_BLOCKS> BlockRing;
+  typedef HistoryRing<HistoryBucket, HISTORY_TIER1_BUCKETS> Tier1Ring;
+  typedef HistoryRing<HistoryBucket, HISTORY_TIER2_BUCKETS> Tier2Ring;
+  typedef HistoryRing<HistoryEvent, HISTORY_MAX_EVENTS> EventRing;
+
+  HistoryStore();
+
+  void clear();
+  void recordSample(const HistorySample& sample);
+  void recordEvent(uint32_t time, uint8_t state);
+
+  const BlockRing& blocks() const { return _blocks; }
+  const Tier1Ring& tier1() const { return _tier1; }
+  const Tier2Ring& tier2() const { return _tier2; }
+  const EventRing& events() const { return _events; }
+
+  // Raw samples held, as absolute indices [sampleBegin(), sampleEnd())
+  uint32_t sampleBegin() const { return _sampleBegin.load(std::memory_order_acquire); }
+  uint32_t sampleEnd() const { return _sampleEnd.load(std::memory_order_acquire); }
+  uint16_t sampleCount() const { return (uint16_t)(sampleEnd() - sampleBegin()); }
+
+  // Newest sample time (0 = no samples yet)
+  uint32_t latestTime() const { return _latestTime.load(std::memory_order_acquire); }
+
+  // Seconds covered by one bucket of each tier
+  static uint32_t tier1Interval() {
+    return (uint32_t)HISTORY_SAMPLE_INTERVAL / 1000 * HISTORY_TIER1_FOLD;
+  }
+  static uint32_t tier2Interval() { return tier1Interval() * HISTORY_TIER2_FOLD; }
+
+  // Streams the raw tier oldest first, decoding one block at a time. Safe to
+  // use from any task while the control task records; samples evicted before
+  // the reader reaches them are skipped.
+  class SampleReader {
+  public:
+    explicit SampleReader(const HistoryStore& store);
+
+    // Return only samples newer than `time`. Call before the first next();
+    // blocks wholly at or before `time` are skipped without decoding.
+    void skipThrough(uint32_t time);
+
+    bool next(HistorySample& out);
+
+    // Absolute index of the sample last returned by next()
+    uint32_t index() const { return _next - 1; }
+
+  private:
+    const HistoryStore& _store;
+    HistoryBlock _block;
+    HistoryCodec::Decoder _decoder;
+    uint32_t _blockIndex;   // next closed block to load
+    uint32_t _next;         // next absolute sample index wanted
+    uint32_t _after;        // skip samples at or before this time...
+    bool _skipping;         // ... until the first newer one
+    bool _active;           // _decoder has a block loaded
+    bool _onOpen;           // ... and it is the open block
+  };
+
+  static const size_t STORAGE_BYTES = BlockRing::STORAGE_BYTES + Tier1Ring::STORAGE_BYTES +
+                                      Tier2Ring::STORAGE_BYTES + EventRing::STORAGE_BYTES +
+                                      2 * sizeof(HistoryBlock);
+
+private:
+  BlockRing _blocks;
+  Tier1Ring _tier1;
+  Tier2Ring _tier2;
+  EventRing _events;
+  SeqLock<HistoryBlock> _open;    // published copy of _current
+  std::atomic<uint32_t> _sampleBegin;
+  std::atomic<uint32_t> _sampleEnd;
+  std::atomic<uint32_t> _latestTime;
+
+  // Writer-only state
+  HistoryBlock _current;          // open block being appended to
+  HistorySample _last;            // newest sample, for delta coding
+  HistorySample _group[HISTORY_TIER1_FOLD];  // samples of the current tier 1 group
+  uint8_t _groupLen;
+  uint8_t _groupCount;            // _current.count where the group began
+  uint16_t _groupUsed;            // _current.used where the group began
+
+  void closeBlock(const HistoryBlock& block);
+  void foldBlockToTier1(const HistoryBlock& block);
+  void pushTier1(const HistoryBucket& bucket);
+  void foldTier1ToTier2();
+};
+
+// Safety: ESP32-S3 no PSRAM needs ~100KB free heap for WiFi.
+// History buffer must not exceed 40KB to leave headroom.
+static_assert(
+  HistoryStore::STORAGE_BYTES <= 40960,
+  "History buffers exceed 40KB — WiFi will fail on ESP32-S3 without PSRAM"
+);
+
+#endif // HISTORY_STORE_H
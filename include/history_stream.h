@@ -0,0 +1,77 @@
+#ifndef HISTORY_STREAM_H
+#define HISTORY_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "history_downsample.h"
+#include "history_store.h"
+
+// ============================================================================
+// HistoryStream - /api/history body produced a piece at a time
+//
+// A full history is ~100 KB packed and ~200 KB as JSON, more than the largest
+// free heap block on a no-PSRAM S3, so the body is never built in memory.
+// read() formats records straight into the caller's buffer (the chunk buffer
+// of a chunked HTTP response), keeping a cursor over tier 2, tier 1, the raw
+// samples (or the downsampler) and the events between calls. At most one
+// record is held over when it does not fit the buffer.
+//
+// Reads the store in place like SampleReader, so it is safe while the control
+// task records. Anything newer than latest() (read once at construction) is
+// left for the next ?since= request.
+// ============================================================================
+class HistoryStream {
+public:
+  HistoryStream(const HistoryStore& store, uint32_t now, uint32_t since,
+                uint16_t points, bool binary);
+
+  // Copy up to maxLen bytes of the body into buf. Returns 0 once the whole
+  // body has been read.
+  size_t read(uint8_t* buf, size_t maxLen);
+
+  uint32_t latest() const { return _latest; }
+
+private:
+  enum Phase : uint8_t {
+    PHASE_HEADER,
+    PHASE_TIER2,
+    PHASE_TIER1,
+    PHASE_SAMPLES,
+    PHASE_EVENTS,
+    PHASE_END,
+    PHASE_DONE
+  };
+
+  const HistoryStore& _store;
+  uint32_t _now;
+  uint32_t _since;
+  uint32_t _latest;               // declared before _reduced, which uses it
+  uint16_t _points;
+  bool _binary;
+  HistoryStore::SampleReader _reader;
+  HistoryDownsampler _reduced;
+
+  uint8_t _phase;
+  uint32_t _index;                // next index in the tier being read
+  uint32_t _lastBucket;           // start of the last bucket written
+  bool _anyBucket;
+  bool _first;                    // no JSON element written in this array yet
+
+  char _record[72];               // formatted record not yet copied out
+  uint8_t _recordLen;
+  uint8_t _recordPos;
+
+  bool nextRecord();
+  template <typename Ring>
+  bool nextBucket(const Ring& ring, uint32_t span, HistoryBucket& out);
+
+  void text(const char* fmt, ...);
+  void u8(uint8_t v);
+  void u16(uint16_t v);
+  void u32(uint32_t v);
+  void bucket(const HistoryBucket& b, uint32_t span);
+  void sample(const HistorySample& s);
+  void event(const HistoryEvent& e);
+};
+
+#endif // HISTORY_STREAM_H
@@ -0,0 +1,118 @@
+#ifndef LOG_CATALOG_H
+#define LOG_CATALOG_H
+
+#include <stdint.h>
+
+// Syslog severities (same values as logger.h; this header is shared with the
+// host-side decoder, which does not include logger.h)
+#ifndef LOG_EMERG
+#define LOG_EMERG   0
+#define LOG_ALERT   1
+#define LOG_CRIT    2
+#define LOG_ERR     3
+#define LOG_WARNING 4
+#define LOG_NOTICE  5
+#define LOG_INFO    6
+#define LOG_DEBUG   7
+#endif
+
+// ============================================================================
+// Structured log message catalog
+//
+// Each LOG_EVENT(name, args...) call site stores only the message ID and its
+// raw arguments; the text is expanded later (drain task, or the host decoder
+// in tools/logdecode) from this table. Columns:
+//   X(name, priority, tag, printf format, comma-separated field names)
+// Arguments are 32-bit ints, floats or short strings. Append new messages at
+// the end: IDs are positions in this list, and the catalog hash sent with
+// every binary frame tells the decoder when its copy is out of date.
+// ============================================================================
+#define LOG_CATALOG(X) \
+  X(STATE_TRANSITION,   LOG_INFO,    "STATE",    "Transition: %s -> %s (Temp: %.1f°F)", \
+    "from,to,temperature") \
+  X(STATUS,             LOG_INFO,    "STATUS",   "Temp: %.1f°F | Setpoint: %.1f°F | State: %s | Auger: %s | Fan: %s", \
+    "temperature,setpoint,state,relay_auger,relay_fan") \
+  X(REIGNITE_START,     LOG_WARNING, "REIGNITE", "Fire may be out! Temp=%.1f°F < %.0f°F, PID maxed for %us. Attempt %d/%d", \
+    "temperature,threshold,maxed_s,attempt,max_attempts") \
+  X(REIGNITE_EXHAUSTED, LOG_CRIT,    "REIGNITE", "Max attempts (%d) exhausted. Entering ERROR state.", \
+    "max_attempts") \
+  X(REIGNITE_SUCCESS,   LOG_INFO,    "REIGNITE", "Success! Temp=%.1f°F. Returning to RUNNING. (Attempt %d)", \
+    "temperature,attempt") \
+  X(REIGNITE_FAILED,    LOG_CRIT,    "REIGNITE", "Recovery failed after %d attempts. Entering ERROR state.", \
+    "attempt") \
+  X(REIGNITE_RETRY,     LOG_WARNING, "REIGNITE", "Recovery failed (attempt %d/%d). Retrying...", \
+    "attempt,max_attempts") \
+  X(LID_OPEN,           LOG_INFO,    "LID",      "Lid opened detected! dT/dt=%.2f°F/s (threshold=%.1f)", \
+    "dtdt,threshold") \
+  X(LID_CLOSED,         LOG_INFO,    "LID",      "Lid closed. Open for %us. Integral preserved at %.2f", \
+    "open_s,pid_i") \
+  X(PID_RESTORED,       LOG_INFO,    "PID",      "Restored integral=%.1f from NVS (saved@%.0f, current@%.0f, diff=%.0f)", \
+    "pid_i,saved_setpoint,setpoint,setpoint_diff") \
+  X(PID_DISCARDED,      LOG_INFO,    "PID",      "Discarding saved integral (setpoint diff=%.0f > tolerance=%.0f)", \
+    "setpoint_diff,tolerance") \
+  X(SENSOR_FAILURE,     LOG_WARNING, "TEMP",     "SENSOR READ FAILURE #%d of %d", \
+    "errors,threshold") \
+  X(RTD_FAULT,          LOG_ERR,     "MAX31865", "Fault 0x%02X detected, clearing and retrying...", \
+    "fault") \
+  X(RTD_REGISTERS,      LOG_ERR,     "MAX31865", "RTD=0x%04X, HighTh=0x%04X, LowTh=0x%04X", \
+    "rtd_raw,high_threshold,low_threshold") \
+  X(RTD_FAULT_PERSISTS, LOG_ERR,     "MAX31865", "Fault persists after clear: 0x%02X", \
+    "fault") \
+  X(RTD_FAULT_CLEARED,  LOG_INFO,    "MAX31865", "Fault cleared successfully, reading temp", \
+    "") \
+  X(RTD_FAULT_BIT,      LOG_WARNING, "MAX31865", "RTD fault bit set (raw=0x%04X)", \
+    "rtd_raw") \
+  X(RTD_READING,        LOG_DEBUG,   "MAX31865", "Raw ADC: %u, Resistance: %.2f Ω, Temp: %.2f°C (%.2f°F)", \
+    "rtd_raw,resistance,temp_c,temperature")
+
+enum LogMessageId : uint16_t {
+#define LOG_CATALOG_ENUM(name, priority, tag, format, fields) LOG_MSG_##name,
+  LOG_CATALOG(LOG_CATALOG_ENUM)
+#undef LOG_CATALOG_ENUM
+  LOG_MSG_COUNT
+};
+
+// Per-message constants for LOG_EVENT: the format for the compile-time
+// argument check, priority and tag for level filtering
+#define LOG_CATALOG_FORMAT(name, priority, tag, format, fields) \
+  static constexpr char LOG_FORMAT_##name[] = format; \
+  static constexpr uint8_t LOG_PRIORITY_##name = priority; \
+  static constexpr char LOG_TAG_##name[] = tag;
+LOG_CATALOG(LOG_CATALOG_FORMAT)
+#undef LOG_CATALOG_FORMAT
+
+struct LogMessageInfo {
+  const char* name;
+  uint8_t priority;
+  const char* tag;
+  const char* format;
+  const char* fields;
+};
+
+// nullptr for an ID outside the catalog
+const LogMessageInfo* logMessageInfo(uint16_t id);
+
+// FNV-1a over every column, so any edit to the table changes the hash.
+// Written as single-return recursion: the firmware builds as C++11.
+constexpr uint32_t logCatalogFnv(const char* s, uint32_t h) {
+  return *s ? logCatalogFnv(s + 1, (h ^ (uint8_t)*s) * 16777619u)
+            : (h ^ 0xFFu) * 16777619u;    // field separator
+}
+
+// The table as constants for logCatalogHash()
+#define LOG_CATALOG_ROW(name, priority, tag, format, fields) \
+  {#name, priority, tag, format, fields},
+static constexpr LogMessageInfo LOG_CATALOG_ROWS[] = {LOG_CATALOG(LOG_CATALOG_ROW)};
+#undef LOG_CATALOG_ROW
+
+constexpr uint32_t logCatalogRowHash(const LogMessageInfo& row, uint32_t h) {
+  return logCatalogFnv(row.fields, logCatalogFnv(row.format, logCatalogFnv(row.tag,
+           logCatalogFnv(row.name, (h ^ (uint32_t)row.priority) * 16777619u))));
+}
+
+constexpr uint32_t logCatalogHash(uint16_t row = 0, uint32_t h = 2166136261u) {
+  return row < LOG_MSG_COUNT ? logCatalogHash((uint16_t)(row + 1), logCatalogRowHash(LOG_CATALOG_ROWS[row], h))
+                             : h;
+}
+
+#endif // LOG_CATALOG_H
@@ -0,0 +1,214 @@
+#ifndef LOG_CODEC_H
+#define LOG_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "log_catalog.h"
+
+// ============================================================================
+// Binary log records: encoding on the device, expansion on either side
+//
+// A LOG_EVENT payload is a list of tagged arguments:
+//   'i' int32 | 'u' uint32 | 'f' float   -> tag + 4 bytes little-endian
+//   's' string                           -> tag + u8 length + bytes
+// Records travel to the host decoder in UDP frames:
+//   header  'S' 'L' version count | u32 catalog hash | u32 frame sequence
+//   record  u16 message ID | u32 millis() | u8 payload length | payload
+// This file has no Arduino dependencies; tools/logdecode builds it on the host.
+// ============================================================================
+
+#define LOG_EVENT_MAX_PAYLOAD  96    // bytes of encoded arguments per record
+#define LOG_EVENT_MAX_STRING   31    // longer string arguments are truncated
+#define LOG_FRAME_VERSION      1
+#define LOG_FRAME_HEADER_BYTES 12
+#define LOG_FRAME_RECORD_BYTES 7     // record header before the payload
+
+// ============================================================================
+// COMPILE-TIME ARGUMENT CHECK
+// ============================================================================
+
+// Argument type code for each C++ type LOG_EVENT accepts
+template <typename T, typename Enable = void> struct LogArgCode;
+template <typename T>
+struct LogArgCode<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  static constexpr char value = 'f';
+};
+template <typename T>
+struct LogArgCode<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+  static constexpr char value = 'i';
+};
+template <typename T>
+struct LogArgCode<T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type> {
+  static constexpr char value = 'u';
+};
+template <> struct LogArgCode<const char*> { static constexpr char value = 's'; };
+template <> struct LogArgCode<char*> { static constexpr char value = 's'; };
+
+constexpr bool logFormatModifier(char c) {
+  return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || (c >= '0' && c <= '9') ||
+         c == 'h' || c == 'l' || c == 'z' || c == 'j' || c == 't';
+}
+
+// Skip printf flags, width, precision and length modifiers
+constexpr const char* logFormatSkipModifiers(const char* format) {
+  return (*format && logFormatModifier(*format)) ? logFormatSkipModifiers(format + 1) : format;
+}
+
+// Conversion letter of the n-th printf conversion in `format`, or 0.
+// Single-return recursion throughout: the firmware builds as C++11.
+constexpr char logFormatConversion(const char* format, uint8_t n) {
+  return !*format ? 0
+       : *format != '%' ? logFormatConversion(format + 1, n)
+       : format[1] == '%' ? logFormatConversion(format + 2, n)
+       : n == 0 ? *logFormatSkipModifiers(format + 1)
+       : logFormatConversion(logFormatSkipModifiers(format + 1), (uint8_t)(n - 1));
+}
+
+constexpr bool logArgFits(char conversion, char code) {
+  return (code == 'f') ? (conversion == 'f' || conversion == 'e' || conversion == 'g' ||
+                          conversion == 'E' || conversion == 'G')
+       : (code == 's') ? (conversion == 's')
+       : (conversion == 'd' || conversion == 'i' || conversion == 'u' || conversion == 'x' ||
+          conversion == 'X' || conversion == 'o' || conversion == 'c');
+}
+
+// Each argument code must fit its conversion, and the format must have no
+// conversions left over
+template <char... Codes> struct LogSignature;
+template <> struct LogSignature<> {
+  static constexpr bool matches(const char* format, uint8_t index = 0) {
+    return logFormatConversion(format, index) == 0;
+  }
+};
+template <char Code, char... Rest>
+struct LogSignature<Code, Rest...> {
+  static constexpr bool matches(const char* format, uint8_t index = 0) {
+    return logArgFits(logFormatConversion(format, index), Code) &&
+           LogSignature<Rest...>::matches(format, (uint8_t)(index + 1));
+  }
+};
+
+// Only used inside decltype(): the signature of a LOG_EVENT argument list
+template <typename... Args>
+LogSignature<LogArgCode<typename std::decay<Args>::type>::value...> logSignature(Args&&...);
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+class LogArgs {
+public:
+  LogArgs() : _len(0) {}
+
+  void add() {}
+  template <typename T, typename... Rest>
+  void add(T value, Rest... rest) {
+    put(value);
+    add(rest...);
+  }
+
+  const uint8_t* data() const { return _buf; }
+  uint8_t size() const { return _len; }
+
+private:
+  uint8_t _buf[LOG_EVENT_MAX_PAYLOAD];
+  uint8_t _len;
+
+  void putWord(char code, uint32_t word) {
+    if (_len + 5 > LOG_EVENT_MAX_PAYLOAD) return;
+    _buf[_len++] = (uint8_t)code;
+    for (int i = 0; i < 4; i++) _buf[_len++] = (uint8_t)(word >> (8 * i));
+  }
+
+  void put(const char* s) {
+    if (!s) s = "";
+    size_t n = strlen(s);
+    if (n > LOG_EVENT_MAX_STRING) n = LOG_EVENT_MAX_STRING;
+    if (_len + 2 + n > LOG_EVENT_MAX_PAYLOAD) return;
+    _buf[_len++] = 's';
+    _buf[_len++] = (uint8_t)n;
+    memcpy(_buf + _len, s, n);
+    _len += (uint8_t)n;
+  }
+  void put(char* s) { put((const char*)s); }
+
+  template <typename T>
+  void put(T value) {
+    const char code = LogArgCode<T>::value;
+    if (code == 'f') {
+      float f = (float)value;
+      uint32_t word;
+      memcpy(&word, &f, sizeof(word));
+      putWord(code, word);
+    } else if (code == 'i') {
+      putWord(code, (uint32_t)(int32_t)value);
+    } else {
+      putWord(code, (uint32_t)value);
+    }
+  }
+};
+
+// ============================================================================
+// EXPANSION
+// ============================================================================
+
+// Message text from the catalog format and an encoded payload, e.g.
+// "Transition: Startup -> Running (Temp: 180.2°F)". Truncated to `size`.
+size_t logExpand(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size);
+
+// Same as a text log line: "[TAG] message\n"
+size_t logExpandLine(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size);
+
+// Arguments as a JSON object keyed by the catalog field names, numbers as
+// numbers: {"from":"Startup","to":"Running","temperature":180.2}
+size_t logFieldsJson(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size);
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+class LogFrameWriter {
+public:
+  LogFrameWriter(uint8_t* buf, size_t capacity);
+
+  // Start a new frame; records appended after this share the header
+  void begin(uint32_t sequence);
+  // False if the record does not fit; the frame is unchanged
+  bool append(uint16_t id, uint32_t time, const uint8_t* payload, uint8_t len);
+
+  const uint8_t* data() const { return _buf; }
+  size_t size() const { return _len; }
+  uint8_t count() const { return _buf[3]; }
+
+private:
+  uint8_t* _buf;
+  size_t _capacity;
+  size_t _len;
+};
+
+class LogFrameReader {
+public:
+  // Validates the header; valid() is false for anything that is not a frame
+  LogFrameReader(const uint8_t* buf, size_t len);
+
+  bool valid() const { return _valid; }
+  uint32_t catalogHash() const { return _hash; }
+  uint32_t sequence() const { return _sequence; }
+  uint8_t count() const { return _count; }
+
+  // Next record; false at the end of the frame or on a truncated record
+  bool next(uint16_t& id, uint32_t& time, const uint8_t*& payload, uint8_t& len);
+
+private:
+  const uint8_t* _buf;
+  size_t _len;
+  size_t _pos;
+  bool _valid;
+  uint32_t _hash;
+  uint32_t _sequence;
+  uint8_t _count;
+};
+
+#endif // LOG_CODEC_H
@@ -0,0 +1,259 @@
+#ifndef LOG_FILTER_H
+#define LOG_FILTER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+#include "log_catalog.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#endif
+
+// Output sinks a log entry is written to
+#define LOG_SINK_SERIAL   0x01
+#define LOG_SINK_TELNET   0x02
+#define LOG_SINK_SYSLOG   0x04
+#define LOG_SINK_RING     0x08
+#define LOG_SINK_ALL      0x0F
+#define LOG_SINK_COUNT    4
+
+#define LOG_LEVEL_OFF       -1      // sink level that passes nothing
+#define LOG_TAG_DEFAULT     0       // "*": untagged entries and the default levels
+#define LOG_TAG_UNRESOLVED  0xFF    // call-site cache before the first call
+
+// ============================================================================
+// CALL SITES
+// ============================================================================
+
+// Token bucket: `burst` messages at once, then one per `intervalMs`.
+// Callable from any task. A DUAL_LOGF in a function several tasks run (a
+// controller command from the web and the control task) shares one site, so
+// the state is relaxed atomics: calls that race may both take the last token,
+// which lets a shared site pass one extra message per race, but never
+// corrupts the bucket. The suppressed count may be collected from any task.
+class LogRateLimit {
+public:
+  constexpr LogRateLimit(uint8_t burst, uint32_t intervalMs)
+      : _burst(burst), _tokens(burst), _intervalMs(intervalMs), _refilled(0), _suppressed(0) {}
+
+  bool allow(uint32_t now) {
+    if (_intervalMs == 0) return true;
+    uint8_t tokens = _tokens.load(std::memory_order_relaxed);
+    uint32_t refilled = _refilled.load(std::memory_order_relaxed);
+    if (tokens >= _burst) {
+      refilled = now;    // full: the next token is one interval after use
+    } else {
+      uint32_t add = (now - refilled) / _intervalMs;
+      if (add) {
+        tokens = (add >= (uint32_t)(_burst - tokens)) ? _burst : (uint8_t)(tokens + add);
+        refilled += add * _intervalMs;
+      }
+    }
+    _refilled.store(refilled, std::memory_order_relaxed);
+    if (tokens == 0) {
+      _tokens.store(0, std::memory_order_relaxed);
+      _suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    _tokens.store((uint8_t)(tokens - 1), std::memory_order_relaxed);
+    return true;
+  }
+
+  // Messages refused since the last call
+  uint32_t takeSuppressed() { return _suppressed.exchange(0, std::memory_order_relaxed); }
+
+private:
+  uint8_t _burst;
+  std::atomic<uint8_t> _tokens;
+  uint32_t _intervalMs;
+  std::atomic<uint32_t> _refilled;
+  std::atomic<uint32_t> _suppressed;
+};
+
+// A site quiet this long has a full token bucket again: nothing more can be
+// suppressed before its next message reaches the drain task
+#define LOG_SITE_SETTLE_MS \
+  (LOG_SITE_FLUSH_MS > LOG_RATE_BURST * LOG_RATE_INTERVAL_MS ? LOG_SITE_FLUSH_MS \
+                                                             : LOG_RATE_BURST * LOG_RATE_INTERVAL_MS)
+
+// Per-call-site state behind DUAL_LOGF and LOG_EVENT: the cached tag slot,
+// the site's rate limit, and what the drain task needs to fold repeats.
+// Constant-initialized, so a function-local static costs no guard.
+//
+// Repeat and suppressed counts are normally reported ahead of the site's next
+// message. When a storm simply stops there is no next message, so the drain
+// task also watches recent sites and reports their counts once they have gone
+// quiet (see flush()).
+struct LogSite {
+  constexpr LogSite()
+      : tag(LOG_TAG_UNRESOLVED), limit(LOG_RATE_BURST, LOG_RATE_INTERVAL_MS),
+        lastHash(0), lastTime(0), repeats(0), lastSeen(0), priority(0), sinks(0),
+        watched(false) {}
+
+  std::atomic<uint8_t> tag;
+  LogRateLimit limit;
+
+  bool allow(uint32_t now) {
+#if ENABLE_LOG_RATE_LIMIT
+    return limit.allow(now);
+#else
+    (void)now;
+    return true;
+#endif
+  }
+
+  // Drain task only: false if this message (by hash) is the same as the
+  // site's last one within LOG_REPEAT_WINDOW_MS, so it is counted instead of
+  // written. When it returns true, `folded` is how many copies were
+  // swallowed before it (report them first).
+  bool fold(uint32_t hash, uint32_t now, uint32_t& folded) {
+    folded = 0;
+    lastSeen = now;
+    if (hash == lastHash && now - lastTime < LOG_REPEAT_WINDOW_MS) {
+      repeats++;
+      return false;
+    }
+    folded = repeats;
+    repeats = 0;
+    lastHash = hash;
+    lastTime = now;
+    return true;
+  }
+
+  // Drain task only, on its timer: counts to report for a site that has gone
+  // quiet; false if there is nothing to report yet. Suppressed counts go out
+  // after LOG_SITE_FLUSH_MS without a message, as nothing is suppressed
+  // without a burst. Folded repeats wait for a whole LOG_REPEAT_WINDOW_MS: a
+  // slow periodic message (a reminder every few seconds) keeps counting until
+  // its copy is written again after the window and carries the count, rather
+  // than adding a report between every two copies.
+  bool flush(uint32_t now, uint32_t& folded, uint32_t& limited) {
+    folded = 0;
+    limited = 0;
+    if (now - lastSeen < LOG_SITE_FLUSH_MS) return false;
+    limited = limit.takeSuppressed();
+    if (limited || now - lastSeen >= LOG_REPEAT_WINDOW_MS) folded = takeRepeats();
+    return folded || limited;
+  }
+  // Drain task only: quiet, counts reported, and nothing more can be
+  // suppressed until a new message arrives; the site need not be watched
+  bool settled(uint32_t now) const { return !repeats && now - lastSeen >= LOG_SITE_SETTLE_MS; }
+  // Drain task only: repeats folded since the last report. Later copies of
+  // the same message inside the window keep folding.
+  uint32_t takeRepeats() {
+    uint32_t n = repeats;
+    repeats = 0;
+    return n;
+  }
+
+  // Drain task only
+  uint32_t lastHash;    // 0 until the first message
+  uint32_t lastTime;    // millis() of the last message written
+  uint32_t repeats;
+  uint32_t lastSeen;    // millis() of the last message, folded or not
+  uint8_t priority;     // of the last message, for the reports
+  uint8_t sinks;
+  bool watched;         // in the drain task's watch list
+};
+
+// FNV-1a, for comparing messages when folding repeats
+inline uint32_t logHash(const void* data, size_t len, uint32_t h = 2166136261u) {
+  const uint8_t* p = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619u;
+  return h;
+}
+
+// ============================================================================
+// LogFilter - runtime per-tag, per-sink log levels
+//
+// Every tag seen in a "[TAG] ..." format (or a LOG_EVENT catalog tag) gets a
+// slot. Each slot holds a level per sink and, derived from those, the sink
+// mask for each of the eight priorities, so the check in DUAL_LOGF and
+// LOG_EVENT is one array load before anything is formatted. Call sites cache
+// their slot in a function-local static, resolved on the first call.
+//
+// Tags without their own levels follow the "*" row. Levels change from the
+// web API (/api/log/levels) and take effect on the next call.
+// ============================================================================
+class LogFilter {
+public:
+  LogFilter();
+
+  // LOG_SINK_* mask for an entry; 0 means drop it unformatted
+  uint8_t sinks(uint8_t tag, uint8_t priority) const {
+    return _masks[tag][priority & 7].load(std::memory_order_relaxed);
+  }
+
+  // Slot for a call site, resolved from its format ("[TAG] ...") once
+  uint8_t site(LogSite& site, const char* format) {
+    uint8_t tag = site.tag.load(std::memory_order_relaxed);
+    if (tag == LOG_TAG_UNRESOLVED) {
+      tag = tagOf(format);
+      site.tag.store(tag, std::memory_order_relaxed);
+    }
+    return tag;
+  }
+
+  // Same, for a bare tag name (LOG_EVENT)
+  uint8_t siteTag(LogSite& site, const char* tag) {
+    uint8_t slot = site.tag.load(std::memory_order_relaxed);
+    if (slot == LOG_TAG_UNRESOLVED) {
+      slot = tagIndex(tag, strlen(tag));
+      site.tag.store(slot, std::memory_order_relaxed);
+    }
+    return slot;
+  }
+
+  // Slot for the leading "[TAG]" of a message or format; LOG_TAG_DEFAULT if
+  // there is none or the table is full. Registers new tags, so task context
+  // only.
+  uint8_t tagOf(const char* text);
+  // Same, without registering: a tag not seen yet gets LOG_TAG_DEFAULT.
+  // Lock-free, for Logger::post (ISRs)
+  uint8_t lookupTag(const char* text) const;
+  // Find or add a tag's slot
+  uint8_t tagIndex(const char* tag, size_t len);
+
+  // Set `level` (LOG_EMERG..LOG_DEBUG or LOG_LEVEL_OFF) for the sinks in
+  // `sinkMask`. Tag "*" changes the default for every tag without its own
+  // levels. False if the tag table is full.
+  bool setLevel(const char* tag, uint8_t sinkMask, int8_t level);
+  // Drop a tag's own levels; it follows "*" again
+  bool clearLevel(const char* tag);
+
+  // Table access for the web API
+  uint8_t tagCount() const { return _count.load(std::memory_order_acquire); }
+  const char* tagName(uint8_t tag) const { return _names[tag]; }
+  bool hasOwnLevels(uint8_t tag) const { return _custom[tag]; }
+  int8_t level(uint8_t tag, uint8_t sink) const { return _levels[tag][sink]; }
+
+  // "serial", "telnet", "syslog", "ring" for sink index 0..3
+  static const char* sinkName(uint8_t sink);
+  // "debug", "info", ... "emerg", "off" or a number; false if unknown
+  static bool parseLevel(const char* text, int8_t& level);
+  // Comma-separated sink names or "all"; 0 if any name is unknown
+  static uint8_t parseSinks(const char* text);
+  static const char* levelName(int8_t level);
+
+private:
+  char _names[LOG_FILTER_MAX_TAGS][LOG_RING_TAG_LEN];
+  int8_t _levels[LOG_FILTER_MAX_TAGS][LOG_SINK_COUNT];
+  bool _custom[LOG_FILTER_MAX_TAGS];
+  std::atomic<uint8_t> _masks[LOG_FILTER_MAX_TAGS][8];
+  std::atomic<uint8_t> _count;
+#ifdef ARDUINO_ARCH_ESP32
+  portMUX_TYPE _mux;                // registration and level changes
+#endif
+
+  void lock();
+  void unlock();
+  uint8_t find(const char* tag, size_t len) const;
+  static const char* parseTag(const char* text, size_t& len);
+  void rebuild(uint8_t tag);
+};
+
+extern LogFilter logFilter;
+
+#endif // LOG_FILTER_H
@@ -1,11 +1,23 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
+#include <stdarg.h>
+#include "mpsc_queue.h"
+#include "log_codec.h"
+#include "log_filter.h"
+#include "syslog_batch.h"
 #include <Arduino.h>
 #include <WiFiUdp.h>
 #include <Syslog.h>
 #include "config.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
 // Syslog severity levels (RFC 5424)
 #define LOG_EMERG   0  // System is unusable
 #define LOG_ALERT   1  // Action must be taken immediately
@@ -16,31 +28,87 @@
 #define LOG_INFO    6  // Informational messages
 #define LOG_DEBUG   7  // Debug-level messages
 
+class WiFiClient;
+
 #if ENABLE_LOG_RING
 struct LogEntry {
   uint32_t timestamp;               // millis() / 1000 (uptime seconds)
   uint32_t sequence;                // monotonic counter for incremental polling
   uint8_t  priority;                // RFC 5424 severity (0-7)
   char     tag[LOG_RING_TAG_LEN];   // e.g., "STATE", "PID", "WIFI"
-  char     message[LOG_RING_MSG_LEN]; // truncated log message
+  uint8_t  messageLen;
+  char     message[LOG_RING_MSG_LEN]; // JSON-escaped when appended, truncated
 };
 #endif
 
+#define LOG_RECORD_TEXT   0xFFFF    // LogRecord::event for a formatted message
+#define LOG_SLOT_WRITING  0xFFFFFFFFu  // ring slot being (or never) written
+
+// One message waiting for the drain task: formatted text, or a LOG_EVENT
+// message ID with its encoded arguments in `text`
+struct LogRecord {
+  LogSite* site;                    // call site, for folding repeats; may be null
+  uint32_t time;                    // millis() when queued
+  uint8_t  priority;
+  uint8_t  sinks;                   // LOG_SINK_* mask
+  uint16_t length;
+  uint16_t event;                   // LOG_MSG_* or LOG_RECORD_TEXT
+  char     text[LOG_BUFFER_SIZE];
+};
+
 class Logger {
 public:
   Logger();
+  // Set up Syslog and start the drain task (after WiFi)
   void begin();
   void log(uint16_t priority, const char* message);
   void logf(uint16_t priority, const char* format, ...);
   bool isConnected();
 
-  // Dual logging - outputs to Serial, Syslog, Telnet, and ring buffer
+  // Dual logging - outputs to Serial, Syslog, Telnet, and ring buffer.
+  // With ENABLE_LOG_QUEUE the caller only formats and enqueues; the sinks
+  // are written later by the drain task. Task context only (vsnprintf).
+  // Applies the runtime level table (logFilter); prefer DUAL_LOGF, which
+  // also caches the tag lookup and honours LOG_LEVEL_COMPILE.
   void dualLog(uint16_t priority, const char* format, ...);
 
+  // dualLog() to the given LOG_SINK_* mask, already filtered. With a call
+  // site, repeats of its last message are folded (see LogSite).
+  void dualLogTo(LogSite* site, uint8_t sinks, uint16_t priority, const char* format, ...);
+
+  // Enqueue an already formatted message. Constant time and safe from ISRs:
+  // the tag is only looked up, so one never registered follows "*".
+  // Returns false if the queue was full and the message was dropped.
+  bool post(uint16_t priority, const char* message);
+
+  // Enqueue a LOG_EVENT record (catalog ID + encoded arguments) for the
+  // given sinks. Use the LOG_EVENT macro rather than calling this directly.
+  bool postEvent(uint16_t id, LogSite* site, uint8_t sinks, const uint8_t* payload, uint8_t len);
+
+  struct QueueStats {
+    uint32_t queued;       // entries accepted
+    uint32_t written;      // entries the drain task has written out
+    uint32_t dropped;      // entries lost to a full queue
+    uint32_t highWater;    // deepest backlog seen by the drain task
+    uint32_t capacity;
+    uint32_t eventFrames;  // binary frames sent (ENABLE_BINARY_LOG)
+    uint32_t folded;       // repeats folded into "repeated N times" lines
+    uint32_t rateLimited;  // entries refused by call-site rate limits (reported so far)
+    uint32_t syslogSends;  // syslog datagrams / TCP writes (ENABLE_SYSLOG_BATCH)
+    uint32_t syslogLost;   // syslog messages that could not be sent
+  };
+  QueueStats getQueueStats();
+
 #if ENABLE_LOG_RING
   // Ring buffer access for web API
   uint8_t getLogCount();
   const LogEntry& getLogAt(uint8_t index);  // 0 = oldest
+  // Copy of entry `index` for readers on other tasks, with the tag and
+  // message length clamped; false if the drain task rewrote the slot while
+  // it was copied (the ring has moved past the caller's position)
+  bool copyLogAt(uint8_t index, LogEntry& out);
+  // Index of the first entry with sequence > since (getLogCount() if none)
+  uint8_t firstLogAfter(uint32_t since);
   uint32_t getLatestSequence();
 #endif
 
@@ -48,14 +116,79 @@ private:
   WiFiUDP* _udpClient;
   Syslog* _syslog;
   bool _initialized;
+  uint32_t _folded;                 // writer side (drain task or mutex holder)
+  uint32_t _rateLimited;
+
+#ifdef ARDUINO_ARCH_ESP32
+  // Serializes sink writes when ENABLE_LOG_QUEUE is off: dualLog() is
+  // called from both loop() and the control task
+  SemaphoreHandle_t _mutex;
+  TaskHandle_t _drainTask;
+#endif
+
+#if ENABLE_LOG_QUEUE
+  MpscQueue<LogRecord, LOG_QUEUE_DEPTH> _queue;
+  std::atomic<uint32_t> _queued;
+  uint32_t _written;
+  uint32_t _droppedReported;
+  std::atomic_flag _draining;       // one consumer at a time
+
+  // Sites with counts that may still need reporting (drain task only)
+  LogSite* _watched[LOG_SITE_WATCH];
+  uint8_t _watchedCount;
+
+  bool enqueue(uint16_t priority, uint8_t sinks, const char* text);
+  bool enqueuef(LogSite* site, uint16_t priority, uint8_t sinks, const char* format, va_list args);
+  void wakeDrain();
+  void drainPending();
+  void watchSite(LogSite& site);
+  void flushSites(uint32_t now);
+#ifdef ARDUINO_ARCH_ESP32
+  static void drainTaskEntry(void* arg);
+#endif
+#endif
+
+  void formatTo(LogSite* site, uint8_t sinks, uint16_t priority, const char* format, va_list args);
+  void writeRecord(const LogRecord& record);
+  void reportSite(const LogSite& site, uint32_t folded, uint32_t limited, uint32_t time);
+  void writeSinks(uint8_t priority, uint8_t sinks, uint32_t time, const char* text);
+  void writeEvent(const LogRecord& record);
+
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  char _syslogBuf[SYSLOG_BATCH_BYTES];
+  SyslogBatch _syslogBatch;
+  uint32_t _syslogSends;
+  uint32_t _syslogLost;
+#if SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP
+  WiFiClient* _tcpClient;
+  uint32_t _tcpLastAttempt;         // millis() of the last connect, 0 = none yet
+#endif
+
+  void writeSyslog(uint8_t priority, uint32_t time, const char* text);
+  // Send the batch if it is due, or whenever it holds anything with `force`
+  void serviceSyslog(bool force);
+  void flushSyslog();
+  bool sendSyslog(const char* data, size_t len);
+#endif
+
+#if ENABLE_BINARY_LOG
+  uint8_t _eventBuf[BINARY_LOG_FRAME_BYTES];
+  LogFrameWriter _eventFrame;
+  uint32_t _eventFrameSeq;
+
+  void flushEvents();
+#endif
 
 #if ENABLE_LOG_RING
   LogEntry _logRing[LOG_RING_SIZE];
+  // Sequence fully written to each slot, LOG_SLOT_WRITING while it is
+  // rewritten; copyLogAt() checks it on both sides of the copy
+  std::atomic<uint32_t> _logSlotSeq[LOG_RING_SIZE];
   uint8_t  _logHead;
   uint8_t  _logCount;
   uint32_t _logSequence;
 
-  void appendToRing(uint8_t priority, const char* formatted);
+  void appendToRing(uint8_t priority, uint32_t time, const char* formatted);
 #endif
 };
 
@@ -63,13 +196,54 @@ private:
 extern Logger logger;
 
 // Dual logging macros - log to both Serial and Syslog
-// These should be used instead of Serial.print* for production logging
-#define DUAL_LOGF(priority, ...) logger.dualLog(priority, __VA_ARGS__)
-
-// Convenience macros for logging
-#define LOG_INFO_F(...)    logger.logf(LOG_INFO, __VA_ARGS__)
-#define LOG_WARNING_F(...) logger.logf(LOG_WARNING, __VA_ARGS__)
-#define LOG_ERROR_F(...)   logger.logf(LOG_ERR, __VA_ARGS__)
-#define LOG_DEBUG_F(...)   logger.logf(LOG_DEBUG, __VA_ARGS__)
+// These should be used instead of Serial.print* for production logging.
+// Below LOG_LEVEL_COMPILE the call and its arguments compile away; otherwise
+// the call site's [TAG] is looked up once and each call costs one table load
+// before anything is formatted.
+#define DUAL_LOGF(priority, format, ...) do { \
+  if ((priority) <= LOG_LEVEL_COMPILE) { \
+    static LogSite _logSite; \
+    uint8_t _logSinks = logFilter.sinks(logFilter.site(_logSite, format), (priority)); \
+    if (_logSinks && _logSite.allow(millis())) { \
+      logger.dualLogTo(&_logSite, _logSinks, (priority), format, ##__VA_ARGS__); \
+    } \
+  } \
+} while (0)
+
+// Structured logging: records the catalog message ID (log_catalog.h) and the
+// raw arguments; no formatting on the calling task. The argument types are
+// checked against the catalog format at compile time.
+template <typename... Args>
+inline void logEvent(uint16_t id, LogSite* site, uint8_t sinks, Args... args) {
+  LogArgs payload;
+  payload.add(args...);
+  logger.postEvent(id, site, sinks, payload.data(), payload.size());
+}
+
+// LOG_EVENT_TO limits the sinks further, e.g. to keep periodic lines out of
+// the web log ring
+#define LOG_EVENT_TO(sinkMask, name, ...) do { \
+  static_assert(decltype(logSignature(__VA_ARGS__))::matches(LOG_FORMAT_##name), \
+                "LOG_EVENT(" #name "): arguments do not match the catalog format"); \
+  if (LOG_PRIORITY_##name <= LOG_LEVEL_COMPILE) { \
+    static LogSite _logSite; \
+    uint8_t _logSinks = (sinkMask) & logFilter.sinks(logFilter.siteTag(_logSite, LOG_TAG_##name), \
+                                                     LOG_PRIORITY_##name); \
+    if (_logSinks && _logSite.allow(millis())) { \
+      logEvent(LOG_MSG_##name, &_logSite, _logSinks, ##__VA_ARGS__); \
+    } \
+  } \
+} while (0)
+
+#define LOG_EVENT(name, ...) LOG_EVENT_TO(LOG_SINK_ALL, name, ##__VA_ARGS__)
+
+// Convenience macros for logging (Syslog only)
+#define LOG_SYSLOG_F(priority, ...) do { \
+  if ((priority) <= LOG_LEVEL_COMPILE) logger.logf(priority, __VA_ARGS__); \
+} while (0)
+#define LOG_INFO_F(...)    LOG_SYSLOG_F(LOG_INFO, __VA_ARGS__)
+#define LOG_WARNING_F(...) LOG_SYSLOG_F(LOG_WARNING, __VA_ARGS__)
+#define LOG_ERROR_F(...)   LOG_SYSLOG_F(LOG_ERR, __VA_ARGS__)
+#define LOG_DEBUG_F(...)   LOG_SYSLOG_F(LOG_DEBUG, __VA_ARGS__)
 
 #endif // LOGGER_H
@@ -0,0 +1,103 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded multi-producer / single-consumer queue of fixed-size records.
+//
+// Each slot carries a sequence number (Vyukov's bounded queue): producers
+// reserve a position with one compare-and-swap, fill the slot in place and
+// publish it by storing the slot's sequence. No locks, no allocation and no
+// waiting on the consumer, so claim()/commit() are safe from any task or ISR.
+// When every slot is taken the record is dropped and counted instead.
+//
+// The consumer reads slots in order with front()/pop(). A producer that has
+// reserved but not yet committed a slot holds back the consumer (not other
+// producers) until it commits.
+template <typename T, size_t N>
+class MpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue depth must be a power of two");
+
+public:
+  MpscQueue() : _enqueue(0), _dequeue(0), _dropped(0), _highWater(0) {
+    for (size_t i = 0; i < N; i++) _slots[i].seq.store((uint32_t)i, std::memory_order_relaxed);
+  }
+
+  // Producer: reserve the next slot. Returns false (and counts a drop) when
+  // the queue is full; otherwise fill item(ticket) and commit(ticket).
+  bool claim(uint32_t& ticket) {
+    uint32_t pos = _enqueue.load(std::memory_order_relaxed);
+    for (;;) {
+      uint32_t seq = _slots[pos & (N - 1)].seq.load(std::memory_order_acquire);
+      int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0) {
+        if (_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          ticket = pos;
+          return true;
+        }
+      } else if (diff < 0) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = _enqueue.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  T& item(uint32_t ticket) { return _slots[ticket & (N - 1)].item; }
+
+  void commit(uint32_t ticket) {
+    _slots[ticket & (N - 1)].seq.store(ticket + 1, std::memory_order_release);
+  }
+
+  bool push(const T& value) {
+    uint32_t ticket;
+    if (!claim(ticket)) return false;
+    item(ticket) = value;
+    commit(ticket);
+    return true;
+  }
+
+  // Consumer: the oldest committed record, or nullptr if there is none yet
+  T* front() {
+    uint32_t pos = _dequeue.load(std::memory_order_relaxed);
+    Slot& slot = _slots[pos & (N - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1) return nullptr;
+    uint32_t depth = _enqueue.load(std::memory_order_relaxed) - pos;
+    if (depth > _highWater) _highWater = depth;
+    return &slot.item;
+  }
+
+  // Consumer: release the record returned by front()
+  void pop() {
+    uint32_t pos = _dequeue.load(std::memory_order_relaxed);
+    _slots[pos & (N - 1)].seq.store(pos + N, std::memory_order_release);
+    _dequeue.store(pos + 1, std::memory_order_relaxed);
+  }
+
+  // Any context: whether a committed record is waiting for the consumer
+  bool ready() const {
+    uint32_t pos = _dequeue.load(std::memory_order_relaxed);
+    return _slots[pos & (N - 1)].seq.load(std::memory_order_acquire) == pos + 1;
+  }
+
+  static constexpr size_t capacity() { return N; }
+  uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+  uint32_t highWater() const { return _highWater; }   // deepest backlog the consumer saw
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    T item;
+  };
+
+  Slot _slots[N];
+  std::atomic<uint32_t> _enqueue;
+  std::atomic<uint32_t> _dequeue;   // written by the consumer only
+  std::atomic<uint32_t> _dropped;
+  uint32_t _highWater;              // consumer only
+};
+
+#endif // MPSC_QUEUE_H
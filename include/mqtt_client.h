@@ -5,6 +5,7 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include "config.h"
+#include "status_cache.h"
 #include "temperature_control.h"
 
 class MQTTClient {
@@ -22,11 +23,15 @@ public:
   // Check connection status
   bool isConnected(void);
 
-  // Publish current status to MQTT
+  // Publish current status to MQTT; every MQTT_STATUS_INTERVAL
   void publishStatus(void);
 
-  // Main loop - handles connection and subscriptions
-  void update();
+  // Extended telemetry and the loop profile; every MQTT_TELEMETRY_INTERVAL
+  void publishTelemetry();
+
+  // Client housekeeping (keepalive, incoming messages), reconnecting at most
+  // every MQTT_RECONNECT_INTERVAL; call every SCHED_POLL_INTERVAL
+  void poll();
 
   // Reconnect to broker if disconnected
   bool reconnect();
@@ -41,15 +46,25 @@ private:
   const char* _clientId;
   const char* _rootTopic;
 
-  uint32_t _lastPublish;
-  uint32_t _lastTelemetry;
+  uint32_t _lastReconnectAttempt;
   bool _subscribed;
   bool _discoveryPublished;
+  bool _crashLogPublished;
   unsigned long _subscribeTime;  // millis() when subscribed — ignore retained msgs briefly
 
   // Static instance for callback routing
   static MQTTClient* _instance;
 
+  // Status topics (<root>/sensor/<name>), built once by setupTopics()
+  enum StatusTopic {
+    TOPIC_TEMPERATURE, TOPIC_SETPOINT, TOPIC_STATE,
+    TOPIC_AUGER, TOPIC_FAN, TOPIC_IGNITER,
+    TOPIC_PID_OUTPUT, TOPIC_PID_P, TOPIC_PID_I, TOPIC_PID_D,
+    TOPIC_LID_OPEN, TOPIC_REIGNITE_ATTEMPTS,
+    STATUS_TOPIC_COUNT
+  };
+  char _statusTopics[STATUS_TOPIC_COUNT][64];
+
   // Topic management
   void subscribe();
   void setupTopics();
@@ -63,8 +78,10 @@ private:
   void publishDiscoveryEntity(const char* component, const char* objectId,
                               const char* payload);
 
-  // Extended telemetry
-  void publishTelemetry();
+  void publishPerf();
+
+  // Previous boot's report at <root>/crashlog; false to retry on reconnect
+  bool publishCrashLog();
 };
 
 #endif // MQTT_CLIENT_H
@@ -0,0 +1,48 @@
+#ifndef ONE_SHOT_TIMER_H
+#define ONE_SHOT_TIMER_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_timer.h>
+#endif
+
+// ============================================================================
+// OneShotTimer - calls back once, a given number of milliseconds from now
+//
+// On the ESP32 this is an esp_timer: the callback runs on the esp_timer task
+// with microsecond accuracy, whatever loop() or the control task are doing.
+// Keep it short and never block in it (WiFi timers share that task).
+// On native builds the mock fires callbacks from mock_advance_millis() /
+// mock_set_millis(), at their exact deadline on the virtual millis() clock.
+// start() on an armed timer replaces its deadline. Not copyable.
+// ============================================================================
+class OneShotTimer {
+public:
+  typedef void (*Callback)(void* arg);
+
+  OneShotTimer(const char* name, Callback callback, void* arg);
+  ~OneShotTimer();
+
+  void start(uint32_t delayMs);
+  void stop();
+  bool isArmed() const;
+
+private:
+  OneShotTimer(const OneShotTimer&);
+  OneShotTimer& operator=(const OneShotTimer&);
+
+#ifdef ARDUINO_ARCH_ESP32
+  esp_timer_handle_t _handle;
+#else
+  friend void mock_fire_timers(unsigned long until);
+
+  Callback _callback;
+  void* _arg;
+  unsigned long _deadline;
+  bool _armed;
+  OneShotTimer* _next;           // every live mock timer, for mock_fire_timers()
+#endif
+};
+
+#endif // ONE_SHOT_TIMER_H
@@ -0,0 +1,130 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Latency histogram with power-of-two buckets: bucket 0 is < 16 us, bucket
+// b (1 .. PROFILER_BUCKETS-2) is [8 << b, 16 << b) us, the last bucket is
+// everything above
+struct ProfileHistogram {
+  uint32_t count;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t lastUs;
+  uint32_t buckets[PROFILER_BUCKETS];
+
+  void add(uint32_t us);
+  // Upper bucket edge below which `pct` percent of samples fall; 0 if empty,
+  // maxUs for the open-ended last bucket
+  uint32_t percentile(uint8_t pct) const;
+};
+
+// ============================================================================
+// LoopProfiler - where loop() and the control tick spend their time
+//
+// Each loop() stage is timed with the CPU cycle counter (PROFILE_STAGE) and
+// lands in its own histogram; the control task adds its tick's execution time
+// and its wake-up jitter against the TEMP_CONTROL_INTERVAL schedule. Every
+// histogram has a single writer (loop() or the control task) and is read
+// without a lock, so a report can straddle an update by one sample.
+// No Arduino dependencies; the cycle counter is read by the macros below.
+// ============================================================================
+class LoopProfiler {
+public:
+  enum Stage : uint8_t {
+    STAGE_OTA,          // ArduinoOTA.handle()
+    STAGE_HTTP_OTA,     // httpOTA.update()
+    STAGE_TELNET,       // telnetServer.loop()
+    STAGE_TUI,          // tuiServer->poll() and render()
+    STAGE_CONTROL,      // controller->tick(), only without the control task
+    STAGE_STATUS,       // statusCache.refresh()
+    STAGE_HISTORY,      // historyJournal->service()
+    STAGE_EVENTS,       // webServer->publishEvents()
+    STAGE_MQTT,         // mqttClient->poll() and publishes
+    STAGE_WIFI,         // serviceWiFi()
+    STAGE_DISPLAY,      // TM1638 update, LEDs and buttons
+    STAGE_ENCODER,      // handleEncoder()
+    STAGE_LOOP,         // one whole scheduler pass, without the sleep
+    STAGE_TICK,         // control task: TemperatureController::tick()
+    STAGE_COUNT
+  };
+
+  LoopProfiler();
+
+  // Cycle counter rate, for recordCycles()
+  void setCpuMHz(uint32_t mhz) { _cyclesPerUs = mhz ? mhz : 1; }
+
+  void record(Stage stage, uint32_t us);
+  void recordCycles(Stage stage, uint32_t cycles) { record(stage, cycles / _cyclesPerUs); }
+  // Control task, once per tick: wake-up relative to the ideal schedule
+  void recordTick(int32_t jitterUs, uint32_t execUs);
+  void reset();
+
+  const ProfileHistogram& stage(Stage stage) const { return _stages[stage]; }
+  const ProfileHistogram& tickJitter() const { return _jitter; }    // |jitter|
+  int32_t minJitterUs() const { return _minJitterUs; }
+  int32_t maxJitterUs() const { return _maxJitterUs; }
+
+  // /api/perf body; 0 if `size` is too small
+  size_t toJson(char* buf, size_t size, uint32_t uptimeMs) const;
+
+  static const char* stageName(Stage stage);
+  static uint8_t bucketFor(uint32_t us);
+  // Exclusive upper edge of a bucket; 0 for the open-ended last one
+  static uint32_t bucketLimitUs(uint8_t bucket);
+
+private:
+  ProfileHistogram _stages[STAGE_COUNT];
+  ProfileHistogram _jitter;
+  int32_t _minJitterUs;
+  int32_t _maxJitterUs;
+  uint32_t _cyclesPerUs;
+};
+
+// ============================================================================
+// Instrumentation. With ENABLE_PROFILER false these expand to nothing and
+// the profiler is not linked in.
+//
+//   {
+//     PROFILE_STAGE(LoopProfiler::STAGE_MQTT);    // until the end of the block
+//     mqttClient->poll();
+//   }
+//   PROFILE_START(pass);  ...  PROFILE_STOP(pass, LoopProfiler::STAGE_LOOP);
+// ============================================================================
+#if ENABLE_PROFILER
+
+extern LoopProfiler loopProfiler;
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <Arduino.h>
+static inline uint32_t profilerCycles() { return ESP.getCycleCount(); }
+#else
+uint32_t profilerCycles();    // supplied by the test build
+#endif
+
+class ProfileScope {
+public:
+  explicit ProfileScope(LoopProfiler::Stage stage) : _stage(stage), _start(profilerCycles()) {}
+  ~ProfileScope() { loopProfiler.recordCycles(_stage, profilerCycles() - _start); }
+
+private:
+  LoopProfiler::Stage _stage;
+  uint32_t _start;
+};
+
+#define PROFILE_STAGE(stage) ProfileScope _profileScope(stage)
+#define PROFILE_START(name) uint32_t _profileStart_##name = profilerCycles()
+#define PROFILE_STOP(name, stage) \
+  loopProfiler.recordCycles(stage, profilerCycles() - _profileStart_##name)
+
+#else
+
+#define PROFILE_STAGE(stage)
+#define PROFILE_START(name)
+#define PROFILE_STOP(name, stage)
+
+#endif // ENABLE_PROFILER
+
+#endif // PROFILER_H
@@ -46,6 +46,10 @@ public:
   // Interlock protection: prevent auger from running without fan
   void setSafeAuger(RelayState state);
 
+  // Same interlock, without Serial output, for auger edges on the esp_timer
+  // task (which must not block on the UART). False if the interlock refused.
+  bool setSafeAugerQuiet(RelayState state);
+
   // Get relay state as JSON-friendly object
   struct RelayStates {
     bool auger;
@@ -57,6 +61,8 @@ public:
 private:
   uint8_t _pins[RELAY_COUNT];
   RelayState _states[RELAY_COUNT];
+
+  void writeRelay(RelayID relay, RelayState state);
 };
 
 #endif // RELAY_CONTROL_H
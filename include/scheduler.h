@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// ============================================================================
+// Scheduler - cooperative deadline scheduler for loop()
+//
+// Every periodic piece of loop() work is a job with a period, a priority and
+// its next deadline. Pending jobs sit in a min-heap keyed by deadline, so a
+// pass only looks at the jobs that are due; those run most urgent first
+// (lowest priority number, then earliest deadline) and loop() sleeps until
+// the next deadline instead of polling everything every 10 ms.
+//
+// Deadlines advance by whole periods from the previous deadline, so a job
+// keeps its rate however late it starts. A job that falls a full period or
+// more behind skips the missed runs instead of running back to back; each
+// skipped run counts as an overrun in its stats.
+//
+// Times are microseconds from the clock passed in; comparisons are
+// wrap-safe as long as periods stay under 35 minutes.
+// No Arduino dependencies and no heap use.
+// ============================================================================
+class Scheduler {
+public:
+  typedef void (*Task)();
+  typedef uint32_t (*Clock)();    // microseconds
+
+  struct JobStats {
+    const char* name;
+    uint32_t periodUs;
+    uint8_t priority;
+    uint32_t runs;
+    uint32_t overruns;       // Runs skipped because the job fell a period behind
+    uint32_t lastLateUs;     // Start relative to the deadline
+    uint32_t maxLateUs;
+    uint32_t lastExecUs;
+    uint32_t maxExecUs;
+    uint64_t totalExecUs;
+  };
+
+  struct Stats {
+    uint32_t passes;         // runDue() calls
+    uint32_t idlePasses;     // ... that found nothing due
+    uint32_t runs;
+    uint32_t overruns;
+    uint64_t busyUs;         // Time spent in jobs
+    uint32_t sinceUs;        // Clock at construction or resetStats()
+  };
+
+  static const uint8_t INVALID_JOB = 0xFF;
+
+  explicit Scheduler(Clock clock);
+
+  // Adds a job first due `firstDelayMs` from now. periodMs 0 runs it once.
+  // Returns its id, or INVALID_JOB when SCHED_MAX_JOBS are taken.
+  uint8_t addJob(const char* name, Task task, uint32_t periodMs, uint8_t priority,
+                 uint32_t firstDelayMs = 0);
+
+  // Runs every job due now; returns the microseconds until the next deadline
+  // (0 if one is already due, SCHED_MAX_SLEEP_MS when nothing is pending)
+  uint32_t runDue();
+  uint32_t untilNextUs() const;
+
+  uint8_t jobCount() const { return _jobCount; }
+  const JobStats& jobStats(uint8_t id) const { return _jobs[id].stats; }
+  Stats getStats() const { return _stats; }
+  void resetStats();
+
+private:
+  struct Job {
+    Task task;
+    uint32_t deadline;
+    JobStats stats;
+  };
+
+  Clock _clock;
+  Job _jobs[SCHED_MAX_JOBS];
+  uint8_t _jobCount;
+  uint8_t _heap[SCHED_MAX_JOBS];    // Pending job ids, earliest deadline first
+  uint8_t _heapSize;
+  Stats _stats;
+
+  bool before(uint8_t a, uint8_t b) const;
+  void push(uint8_t id);
+  uint8_t pop();
+  void run(uint8_t id);
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,93 @@
+#ifndef SCREEN_BUFFER_H
+#define SCREEN_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// ============================================================================
+// ScreenBuffer - retained-mode character grid for the telnet TUI
+//
+// A frame is drawn into a TUI_ROWS x TUI_COLS grid of cells (one BMP code
+// point and one style byte each). present() compares it with what the
+// terminal was last sent and writes only cursor moves, style changes and the
+// changed runs of cells; a frame where one number changed costs tens of
+// bytes instead of a full repaint. Runs separated by no more than
+// TUI_MERGE_GAP unchanged cells are sent as one, which is cheaper than
+// another cursor move. Every glyph is assumed to be one column wide.
+// No Arduino dependencies and no heap use.
+// ============================================================================
+class ScreenBuffer {
+public:
+  // Receives the output in chunks of up to TUI_CHUNK_BYTES; `data` is also
+  // null-terminated. Returns false if the chunk was not fully written.
+  typedef bool (*Sink)(void* ctx, const char* data, size_t len);
+
+  // Style byte: foreground color in the low 5 bits, plus BOLD
+  enum : uint8_t {
+    STYLE_DEFAULT = 0,
+    FG_BLACK, FG_RED, FG_GREEN, FG_YELLOW, FG_BLUE, FG_MAGENTA, FG_CYAN, FG_WHITE,
+    FG_BRIGHT_BLACK, FG_BRIGHT_RED, FG_BRIGHT_GREEN, FG_BRIGHT_YELLOW,
+    FG_BRIGHT_BLUE, FG_BRIGHT_MAGENTA, FG_BRIGHT_CYAN, FG_BRIGHT_WHITE,
+    FG_MASK = 0x1F,
+    BOLD = 0x80
+  };
+
+  ScreenBuffer();
+
+  // Drawing. Rows and columns are 0-based; text is UTF-8, clipped at the
+  // right edge, and control characters are drawn as spaces.
+  void clear();                                  // blank frame, cursor home
+  void moveTo(uint8_t row, uint8_t col);
+  void setStyle(uint8_t style) { _style = style; }
+  void print(const char* text);
+  void print(uint8_t style, const char* text);
+  void printf(const char* fmt, ...);
+  // `text` cut or padded with spaces to `width` cells
+  void printPadded(const char* text, uint8_t width, bool alignRight = false);
+  void repeat(const char* glyph, uint8_t count);
+  uint8_t row() const { return _row; }
+  uint8_t col() const { return _col; }
+
+  // The next present() clears the terminal and sends every cell (new client)
+  void invalidate() { _fullRepaint = true; }
+  // Send the changes since the last present(); returns the bytes sent. If
+  // the sink fails, the terminal no longer matches what was recorded as
+  // shown, so the next present() is a full repaint.
+  size_t present(Sink sink, void* ctx);
+
+  uint16_t glyphAt(uint8_t row, uint8_t col) const { return _chars[row][col]; }
+  uint8_t styleAt(uint8_t row, uint8_t col) const { return _styles[row][col]; }
+  uint16_t lastChangedCells() const { return _changedCells; }
+
+private:
+  // Frame being drawn
+  uint16_t _chars[TUI_ROWS][TUI_COLS];
+  uint8_t _styles[TUI_ROWS][TUI_COLS];
+  // What the terminal shows
+  uint16_t _shownChars[TUI_ROWS][TUI_COLS];
+  uint8_t _shownStyles[TUI_ROWS][TUI_COLS];
+
+  uint8_t _row;
+  uint8_t _col;
+  uint8_t _style;
+  bool _fullRepaint;
+  uint16_t _changedCells;
+
+  // Output while presenting
+  char _out[TUI_CHUNK_BYTES + 1];
+  size_t _outLen;
+  size_t _sent;
+  bool _sinkFailed;
+  Sink _sink;
+  void* _ctx;
+
+  void putGlyph(uint16_t glyph);
+  bool changed(uint8_t row, uint8_t col) const;
+  void emit(const char* data, size_t len);
+  void emitGlyph(uint16_t glyph);
+  void emitStyle(uint8_t style);
+  void flush();
+};
+
+#endif // SCREEN_BUFFER_H
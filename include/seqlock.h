@@ -0,0 +1,87 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Single-writer sequence lock for publishing a small POD value to readers on
+// other tasks. The writer never blocks; readers copy without locking and retry
+// if a publish overlapped their copy.
+//
+// The payload is stored as 32-bit relaxed atomics so a concurrent copy is a
+// well-defined (if possibly inconsistent) read; the sequence check discards
+// inconsistent copies. Writers must be serialized externally.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock payload must be trivially copyable");
+
+public:
+  SeqLock() : _seq(0) {
+    for (size_t i = 0; i < WORDS; i++) _words[i].store(0, std::memory_order_relaxed);
+  }
+
+  void write(const T& value) {
+    uint32_t buf[WORDS] = {0};
+    memcpy(buf, &value, sizeof(T));
+
+    uint32_t seq = _seq.load(std::memory_order_relaxed);
+    _seq.store(seq + 1, std::memory_order_relaxed);      // odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++) {
+      _words[i].store(buf[i], std::memory_order_relaxed);
+    }
+    _seq.store(seq + 2, std::memory_order_release);      // even: stable
+  }
+
+  // Copy the latest published value. Returns its sequence number, which
+  // advances by 2 per write (0 = never written).
+  uint32_t read(T& out) const {
+    uint32_t buf[WORDS];
+    uint16_t spins = 0;
+    for (;;) {
+      uint32_t before = _seq.load(std::memory_order_acquire);
+      if ((before & 1) == 0) {
+        for (size_t i = 0; i < WORDS; i++) {
+          buf[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) == before) {
+          memcpy(&out, buf, sizeof(T));
+          return before;
+        }
+      }
+      relax(++spins);
+    }
+  }
+
+  // Sequence of the latest publish, without copying the payload
+  uint32_t sequence(void) const {
+    return _seq.load(std::memory_order_acquire) & ~1u;
+  }
+
+private:
+  static const size_t WORDS = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> _seq;
+  std::atomic<uint32_t> _words[WORDS];
+
+  // A reader that preempted the writer on the same core would spin forever;
+  // after a few retries, sleep a tick so the writer can finish.
+  static void relax(uint16_t spins) {
+#ifdef ARDUINO_ARCH_ESP32
+    if (spins > 8) vTaskDelay(1);
+#else
+    (void)spins;
+#endif
+  }
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,154 @@
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+// Every object starts on this boundary (the strictest fundamental alignment)
+#define ARENA_ALIGN alignof(max_align_t)
+
+// Stands in for a type that is compiled out: it takes no room and cannot be
+// made. List optional types as ArenaOptional<ENABLE_FOO, Foo>.
+struct ArenaNone {};
+
+template <bool Enabled, typename T>
+using ArenaOptional = typename std::conditional<Enabled, T, ArenaNone>::type;
+
+// Bytes a type takes in the arena, rounded up to ARENA_ALIGN
+template <typename... Ts>
+struct ArenaSize;
+
+template <>
+struct ArenaSize<> {
+  static constexpr size_t value = 0;
+};
+
+template <typename T, typename... Ts>
+struct ArenaSize<T, Ts...> {
+  static constexpr size_t value =
+      (sizeof(T) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN + ArenaSize<Ts...>::value;
+};
+
+template <typename... Ts>
+struct ArenaSize<ArenaNone, Ts...> {
+  static constexpr size_t value = ArenaSize<Ts...>::value;
+};
+
+// Types that can be made, ArenaNone left out
+template <typename... Ts>
+struct ArenaCount;
+
+template <>
+struct ArenaCount<> {
+  static constexpr uint8_t value = 0;
+};
+
+template <typename T, typename... Ts>
+struct ArenaCount<T, Ts...> {
+  static constexpr uint8_t value =
+      (std::is_same<T, ArenaNone>::value ? 0 : 1) + ArenaCount<Ts...>::value;
+};
+
+// Whether T is one of Ts
+template <typename T, typename... Ts>
+struct ArenaHas;
+
+template <typename T>
+struct ArenaHas<T> {
+  static constexpr bool value = false;
+};
+
+template <typename T, typename U, typename... Ts>
+struct ArenaHas<T, U, Ts...> {
+  static constexpr bool value = ArenaHas<T, Ts...>::value;
+};
+
+template <typename T, typename... Ts>
+struct ArenaHas<T, T, Ts...> {
+  static constexpr bool value = true;
+};
+
+// Position of T in Ts, for the made-types mask (T must be listed)
+template <typename T, typename... Ts>
+struct ArenaIndex;
+
+template <typename T, typename U, typename... Ts>
+struct ArenaIndex<T, U, Ts...> {
+  static constexpr uint8_t value = 1 + ArenaIndex<T, Ts...>::value;
+};
+
+template <typename T, typename... Ts>
+struct ArenaIndex<T, T, Ts...> {
+  static constexpr uint8_t value = 0;
+};
+
+// ============================================================================
+// StaticArena - one static block holding the long-lived singletons
+//
+// Sized at compile time for one of each listed type. make() constructs them
+// in place, in call order, so they live in .bss instead of the heap: boot
+// lays them out the same way every time, and the large ones (the
+// controller's history) never compete with lwIP for a contiguous heap block.
+// Making a type that is not listed (or is listed as ArenaNone) does not
+// compile; making one a second time returns nullptr.
+// Nothing is freed. destroy() runs the destructor, but the storage is not
+// reused. Each object is recorded by name for the boot RAM map.
+// No Arduino dependencies; not thread-safe (setup() only).
+// ============================================================================
+template <typename... Ts>
+class StaticArena {
+public:
+  static constexpr size_t CAPACITY = ArenaSize<Ts...>::value;
+  static constexpr uint8_t MAX_OBJECTS = ArenaCount<Ts...>::value;
+  static_assert(sizeof...(Ts) <= 32, "Made-types mask holds 32 types");
+
+  struct Entry {
+    const char* name;
+    size_t offset;
+    size_t size;              // sizeof, without alignment padding
+  };
+
+  StaticArena() : _used(0), _count(0), _made(0) {}
+
+  // nullptr if a T was already made (even if since destroyed); the arena
+  // only has room for one of each
+  template <typename T, typename... Args>
+  T* make(const char* name, Args&&... args) {
+    static_assert(!std::is_same<T, ArenaNone>::value, "ArenaNone cannot be made");
+    static_assert(ArenaHas<T, Ts...>::value, "Type is not in this arena's type list");
+    static_assert(alignof(T) <= ARENA_ALIGN, "Type needs more than ARENA_ALIGN");
+    const uint32_t bit = 1u << ArenaIndex<T, Ts...>::value;
+    const size_t size = ArenaSize<T>::value;
+    if (_made & bit) return nullptr;
+    _made |= bit;
+    T* obj = new (_storage + _used) T(std::forward<Args>(args)...);
+    _entries[_count].name = name;
+    _entries[_count].offset = _used;
+    _entries[_count].size = sizeof(T);
+    _count++;
+    _used += size;
+    return obj;
+  }
+
+  template <typename T>
+  static void destroy(T* obj) {
+    if (obj) obj->~T();
+  }
+
+  size_t used() const { return _used; }
+  uint8_t count() const { return _count; }
+  const Entry& entry(uint8_t i) const { return _entries[i]; }
+  const void* base() const { return _storage; }
+
+private:
+  alignas(ARENA_ALIGN) uint8_t _storage[CAPACITY];
+  Entry _entries[MAX_OBJECTS];
+  size_t _used;
+  uint8_t _count;
+  uint32_t _made;             // bit per position in Ts
+};
+
+#endif // STATIC_ARENA_H
@@ -0,0 +1,74 @@
+#ifndef STATUS_CACHE_H
+#define STATUS_CACHE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "seqlock.h"
+#include "temperature_control.h"
+
+// ============================================================================
+// StatusCache - controller status formatted once per control tick
+//
+// refresh() runs on the loop task. When the controller has published a new
+// snapshot it formats every displayed value once into fixed buffers: the text
+// fields MQTT and the TUI print, and the /api/status JSON body (also sent as
+// the /api/events status frame). Front ends on the loop task read fields()
+// and json() in place; the web server's task copies the JSON out through a
+// SeqLock. Nothing here allocates.
+// ============================================================================
+class StatusCache {
+public:
+  struct Fields {
+    char temp[12];              // °F, one decimal
+    char setpoint[12];
+    char tempDelta[12];         // current - setpoint, one decimal
+    char pidOutput[12];         // percent, one decimal
+    char pidP[16];              // four decimals
+    char pidI[16];
+    char pidD[16];
+    char reigniteAttempts[4];
+    const char* state;          // static strings, nothing to format
+    const char* auger;          // "ON" / "OFF"
+    const char* fan;
+    const char* igniter;
+    const char* lidOpen;
+  };
+
+  struct Json {
+    uint32_t seq;               // snapshot sequence it was formatted from
+    uint16_t length;
+    char text[STATUS_JSON_BYTES];
+  };
+
+  StatusCache();
+
+  // Reformat if the controller has published since the last call. Returns
+  // true when the cache changed. `freeHeap` is reported in the JSON.
+  bool refresh(const TemperatureController& controller, uint32_t freeHeap);
+
+  // Loop task only
+  const TemperatureController::Snapshot& snapshot() const { return _snap; }
+  const Fields& fields() const { return _fields; }
+  const Json& json() const { return _json; }
+  uint32_t seq() const { return _json.seq; }
+  bool valid() const { return _formats > 0; }
+
+  // Any task: copy the latest JSON body
+  void readJson(Json& out) const { _published.read(out); }
+
+  // Number of times refresh() actually formatted
+  uint32_t formats() const { return _formats; }
+
+private:
+  TemperatureController::Snapshot _snap;
+  Fields _fields;
+  Json _json;
+  SeqLock<Json> _published;
+  uint32_t _formats;
+
+  void format(uint32_t freeHeap);
+};
+
+extern StatusCache statusCache;
+
+#endif // STATUS_CACHE_H
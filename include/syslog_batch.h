@@ -0,0 +1,54 @@
+#ifndef SYSLOG_BATCH_H
+#define SYSLOG_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// ============================================================================
+// SyslogBatch - RFC 5424 messages packed into one send
+//
+// Each message gets the same header the Syslog library wrote
+// ("<PRI>1 - HOST APP - - - BOM"), with its trailing newline removed and any
+// inner newline turned into a space. Framing depends on the transport:
+//   newline   "<PRI>1 ... msg\n<PRI>1 ... msg\n"    one UDP datagram
+//   octet     "57 <PRI>1 ... msg61 <PRI>1 ... msg"  TCP, RFC 6587 counting
+// The batch is due once its oldest message is SYSLOG_BATCH_FLUSH_MS old, or
+// at once when it holds one at SYSLOG_BATCH_FLUSH_PRIORITY or more severe.
+// No Arduino dependencies; the buffer is supplied by the owner.
+// ============================================================================
+class SyslogBatch {
+public:
+  enum Framing : uint8_t { FRAMING_NEWLINE, FRAMING_OCTET_COUNT };
+
+  SyslogBatch(char* buf, size_t capacity, Framing framing, uint8_t facility,
+              const char* hostname, const char* appName);
+
+  // Add one message (severity 0-7). False, with the batch unchanged, if it
+  // does not fit; a message too large for an empty batch is truncated.
+  bool append(uint8_t severity, const char* message, uint32_t now);
+
+  // Time to send: the oldest message has waited long enough or an urgent one
+  // is waiting
+  bool due(uint32_t now) const;
+
+  const char* data() const { return _buf; }
+  size_t size() const { return _len; }
+  uint16_t count() const { return _count; }
+  bool empty() const { return _count == 0; }
+  void clear();
+
+private:
+  char* _buf;
+  size_t _capacity;
+  size_t _len;
+  Framing _framing;
+  uint8_t _facility;
+  const char* _hostname;
+  const char* _appName;
+  uint16_t _count;
+  bool _urgent;
+  uint32_t _firstTime;    // millis() of the oldest message
+};
+
+#endif // SYSLOG_BATCH_H
@@ -30,13 +30,7 @@ private:
 // Global telnet server instance
 extern TelnetServer telnetServer;
 
-// Unified print macros - output to Serial, Syslog, AND Telnet
-#define UNIFIED_PRINTF(priority, ...) do { \
-  char buffer[LOG_BUFFER_SIZE]; \
-  snprintf(buffer, LOG_BUFFER_SIZE, __VA_ARGS__); \
-  if (ENABLE_SERIAL_DEBUG) Serial.print(buffer); \
-  logger.logf(priority, __VA_ARGS__); \
-  telnetServer.print(buffer); \
-} while(0)
+// Unified print macro - output to Serial, Syslog, AND Telnet (via the logger)
+#define UNIFIED_PRINTF(priority, ...) DUAL_LOGF(priority, __VA_ARGS__)
 
 #endif // TELNET_SERVER_H
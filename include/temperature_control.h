@@ -6,6 +6,16 @@
 #include "config.h"
 #include "max31865.h"
 #include "relay_control.h"
+#include "seqlock.h"
+#include "history_store.h"
+#include "one_shot_timer.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+class HistoryJournal;
 
 // Controller state machine
 enum ControllerState {
@@ -18,28 +28,6 @@ enum ControllerState {
   STATE_REIGNITE = 6
 };
 
-// Temperature history sample (for web graph)
-// 12 bytes/sample with natural alignment (was 16 with floats)
-struct HistorySample {
-  uint32_t time;     // seconds since boot (millis()/1000)
-  int16_t temp;      // current temperature °F × 10 (2253 = 225.3°F)
-  int16_t setpoint;  // target temperature °F × 10
-  uint8_t state;     // ControllerState enum value
-};
-
-// State change event
-struct HistoryEvent {
-  uint32_t time;     // seconds since boot
-  uint8_t state;     // new state entered
-};
-
-// Safety: ESP32-S3 no PSRAM needs ~100KB free heap for WiFi.
-// History buffer must not exceed 40KB to leave headroom.
-static_assert(
-  sizeof(HistorySample) * HISTORY_MAX_SAMPLES + sizeof(HistoryEvent) * HISTORY_MAX_EVENTS <= 40960,
-  "History buffers exceed 40KB — WiFi will fail on ESP32-S3 without PSRAM"
-);
-
 // PID temperature control
 class TemperatureController {
 public:
@@ -52,6 +40,10 @@ public:
   // Main control loop - call this regularly (every TEMP_CONTROL_INTERVAL ms)
   void update();
 
+  // Run one control cycle now, without the interval gate. Used by the
+  // dedicated control task, which does its own fixed-period scheduling.
+  void tick();
+
   // User commands
   void startSmoking(float targetTemp);
   void stop();
@@ -66,6 +58,8 @@ public:
 
   // Sensor access for diagnostics
   MAX31865* getSensor(void) { return _tempSensor; }
+  // Raw register dump, serialized against control-cycle SPI reads
+  MAX31865::DiagData getSensorDiagnostics(void);
 
   // Debug/Testing methods
   void setDebugMode(bool enabled);
@@ -105,6 +99,33 @@ public:
   };
   PIDStatus getPIDStatus(void);
 
+  // Consistent view of one control tick, published at the end of every tick
+  // and after every command. Readers on other tasks (web, MQTT, TUI, display)
+  // should use getSnapshot() instead of the live getters above, so a single
+  // response never mixes two ticks and never blocks the control path.
+  struct Snapshot {
+    uint32_t seq;              // publish sequence (advances every publish)
+    uint32_t publishedAt;      // millis() at publish
+    Status status;
+    PIDStatus pid;
+    bool lidOpen;
+    uint32_t lidOpenDuration;  // seconds
+    uint8_t reigniteAttempts;
+    uint8_t reignitePhase;
+    bool debugMode;
+    uint16_t historyCount;      // raw-tier samples held
+    uint32_t historyLatestTime; // time of newest history sample (0 = none)
+    uint32_t historyEnd;        // absolute index one past the newest sample
+    uint8_t eventCount;
+  };
+  // Lock-free copy of the latest published snapshot
+  Snapshot getSnapshot(void) const;
+  // Cheap change check: sequence of the latest publish
+  uint32_t getSnapshotSeq(void) const { return _snapshot.sequence(); }
+
+  // Display name for a state ("Idle", "Running", ...)
+  static const char* stateName(ControllerState state);
+
   // Reignite status
   uint8_t getReigniteAttempts(void) { return _reigniteAttempts; }
   uint8_t getReignitePhase(void) { return _reignitePhase; }
@@ -113,16 +134,26 @@ public:
   bool isLidOpen(void) { return _lidOpen; }
   uint32_t getLidOpenDuration(void);
 
-  // History access for web graph
-  uint16_t getHistoryCount(void);
-  const HistorySample& getHistorySampleAt(uint16_t index);  // 0 = oldest
-  uint8_t getEventCount(void);
-  const HistoryEvent& getHistoryEventAt(uint8_t index);     // 0 = oldest
+  // History access for web graph (lock-free reads, see HistoryStore)
+  const HistoryStore& getHistory(void) const { return _history; }
   uint32_t getUptime(void);
 
+  // Restore history from `journal` and log new samples/events to it. Call
+  // once after begin(), before the control loop starts.
+  void attachJournal(HistoryJournal* journal);
+
+  // History clock: seconds since boot, continued from the newest restored
+  // record so journal history and new samples share one time axis
+  uint32_t getHistoryTime(void);
+
 private:
   MAX31865* _tempSensor;
   RelayControl* _relayControl;
+
+#ifdef ARDUINO_ARCH_ESP32
+  // Serializes the control task against commands from loop/web/MQTT tasks
+  SemaphoreHandle_t _mutex;
+#endif
   
   float _setpoint;
   float _currentTemp;
@@ -147,22 +178,20 @@ private:
   float _lastD;               // Last derivative term (for getPIDStatus)
   unsigned long _lastPidUpdate;
   unsigned long _augerCycleStart;
+  unsigned long _augerOnTime;    // on-time of the current cycle (ms)
   bool _augerCycleState;
+  bool _augerCycleActive;        // edges are being scheduled (RUNNING only)
+  OneShotTimer _augerTimer;      // fires at the next on/off edge
 
   // Persistent integral storage
   Preferences _prefs;
   unsigned long _lastIntegralSave;
 
-  // Temperature history ring buffer
-  HistorySample _history[HISTORY_MAX_SAMPLES];
-  uint16_t _historyHead;       // next write position
-  uint16_t _historyCount;      // number of valid samples
+  // Temperature history (multi-resolution rings + state change events)
+  HistoryStore _history;
   unsigned long _lastHistorySample;
-
-  // State change event ring buffer
-  HistoryEvent _events[HISTORY_MAX_EVENTS];
-  uint8_t _eventHead;
-  uint8_t _eventCount;
+  HistoryJournal* _journal;      // optional flash log (nullptr = RAM only)
+  uint32_t _historyTimeBase;     // history clock at boot (see getHistoryTime)
 
   // Reignite logic
   uint8_t _reigniteAttempts;     // counter for current cook session
@@ -175,6 +204,9 @@ private:
   uint32_t _lidOpenTime;         // millis when lid was detected open
   uint32_t _lidStableTime;       // millis when temp rate stabilized after lid-open
 
+  // Published per-tick view for readers on other tasks
+  SeqLock<Snapshot> _snapshot;
+
   // Calculated PID gains (from Proportional Band parameters)
   float _Kp;
   float _Ki;
@@ -192,6 +224,9 @@ private:
   // Control logic
   void updatePID();
   void applyPIDOutput();
+  void scheduleAugerEdge();
+  void stopAugerCycle();
+  static void onAugerTimer(void* arg);
   void manageFan();
   void manageAuger();
   void manageIgniter();
@@ -200,11 +235,14 @@ private:
   bool readTemperature();
   void handleSensorError();
   void handleTemperatureError();
+  void reportErrorState();
 
   // Lid detection
   void detectLidOpen();
 
   // Utility
+  void controlCycle();
+  void publishSnapshot();
   unsigned long getStateElapsedTime();
   const char* stateToString(ControllerState state);
 
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <TM1638.h>
 #include "config.h"
+#include "tm1638_shadow.h"
 
 // Button definitions
 #define BTN_START       0x01  // Button 1
@@ -25,8 +26,17 @@
 #define LED_RUNNING     6  // LED 7
 #define LED_8           7  // LED 8
 
+// Setters only update a shadow of the module; update() sends the digits and
+// LEDs that changed. loop() calls it every TM1638_REFRESH_MS.
 class TM1638Display {
 public:
+  // Bus transactions (one STB frame each) sent, and avoided compared with
+  // rewriting every digit and LED on each call
+  struct BusStats {
+    uint32_t sent;
+    uint32_t saved;
+  };
+
   TM1638Display();
   void begin();
   void update();
@@ -45,14 +55,16 @@ public:
   uint8_t readButtons();
   bool isButtonPressed(uint8_t button);
 
+  BusStats getBusStats() const;
+
 private:
   TM1638* _display;
   float _currentTemp;
   float _targetTemp;
   uint8_t _lastButtons;
-  uint8_t _ledState;
+  TM1638Shadow _shadow;
 
-  void displayTemperature(float temp, bool rightDisplay);
+  void flush();
   void formatTemperature(float temp, char* buffer);
 };
 
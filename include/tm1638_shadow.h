@@ -0,0 +1,60 @@
+#ifndef TM1638_SHADOW_H
+#define TM1638_SHADOW_H
+
+#include <stdint.h>
+
+#define TM1638_DIGITS  8
+
+// ============================================================================
+// TM1638Shadow - what the TM1638 shows, so only changes go on the bus
+//
+// Setters record the wanted digits and LEDs; take*() hand the driver what
+// differs from the last transmission and mark it shown. Each digit and each
+// LED position is one bus transaction (one STB frame). For the saved-
+// transactions counter the driver reports through request() what it would
+// have sent without the shadow.
+// LEDs are 16 bits as in TM1638::setLEDs(): low byte red, high byte green.
+// No Arduino dependencies.
+// ============================================================================
+class TM1638Shadow {
+public:
+  TM1638Shadow();
+
+  // The module's contents are unknown (power-up, test pattern): the next
+  // take*() calls send everything
+  void invalidate();
+
+  // `text` is up to TM1638_DIGITS characters, padded with spaces
+  void setDigits(const char* text);
+  void setLed(uint8_t pos, bool on);    // red, as TM1638Display::setLED()
+  void setLeds(uint16_t leds);
+
+  bool dirty() const;
+
+  // Bit per digit / LED position that changed since the last take
+  uint8_t takeDigits();
+  uint8_t takeLeds();
+
+  const char* digits() const { return _digits; }
+  uint16_t leds() const { return _leds; }
+  // TM1638_COLOR_* value for a position (0 off, 1 red, 2 green)
+  uint8_t ledColor(uint8_t pos) const;
+
+  // Charge transactions the unshadowed driver would have sent
+  void request(uint32_t frames) { _requested += frames; }
+  uint32_t sent() const { return _sent; }
+  uint32_t requested() const { return _requested; }
+  uint32_t saved() const { return _requested > _sent ? _requested - _sent : 0; }
+
+private:
+  char _digits[TM1638_DIGITS + 1];
+  char _shownDigits[TM1638_DIGITS];
+  uint16_t _leds;
+  uint16_t _shownLeds;
+  bool _digitsKnown;
+  bool _ledsKnown;
+  uint32_t _sent;
+  uint32_t _requested;
+};
+
+#endif // TM1638_SHADOW_H
@@ -3,10 +3,22 @@
 
 #include <Arduino.h>
 #include <ESPTelnet.h>
+#include "screen_buffer.h"
+#include "status_cache.h"
 #include "temperature_control.h"
 #include "max31865.h"
 
-// TUI Server for real-time status display
+// ESPTelnet's print() does not report short writes. The frame sink needs to
+// know, so it writes the client directly.
+class TUITelnet : public ESPTelnet {
+public:
+  bool send(const char* data, size_t len) {
+    return isConnected() && client.write((const uint8_t*)data, len) == len;
+  }
+};
+
+// TUI Server for real-time status display. Each frame is drawn into a
+// ScreenBuffer and only the cells that changed go out over telnet.
 class TUIServer {
 public:
   // Constructor
@@ -15,23 +27,28 @@ public:
   // Initialize TUI server
   void begin(uint16_t port = 2323);
 
-  // Main loop - call this regularly
-  void update();
+  // Telnet housekeeping (accepts, input); call every SCHED_POLL_INTERVAL
+  void poll();
+
+  // Draw and send a frame if a client is connected; every TUI_UPDATE_INTERVAL
+  void render();
 
   // Check if clients are connected
   bool hasClients();
 
-  // Public methods for callbacks
+  // Public methods for callbacks; clearScreen() makes the next frame a full
+  // repaint
   void clearScreen();
   void renderScreen();
 
 private:
-  ESPTelnet _telnet;
+  TUITelnet _telnet;
   TemperatureController* _controller;
   MAX31865* _sensor;
 
-  unsigned long _lastUpdate;
-  uint16_t _updateInterval;
+  // Controller state for the frame being rendered
+  TemperatureController::Snapshot _snap;
+  ScreenBuffer _screen;
 
   // Rendering functions
   void renderHeader();
@@ -44,14 +61,12 @@ private:
   void renderFooter();
 
   // Helper functions
-  void moveCursor(int row, int col);
-  void print(const String& text);
-  void println(const String& text);
-  String padRight(String text, int width);
-  String padLeft(String text, int width);
-  const char* boolToOnOff(bool value);
-  const char* getStateColor(ControllerState state);
-  String formatUptime(unsigned long ms);
+  void drawBox(uint8_t top, uint8_t lines, const char* title);
+  void printPadded(uint8_t style, const char* text, const char* suffix, int width,
+                   bool alignRight = false);
+  static uint8_t getStateStyle(ControllerState state);
+  static void formatUptime(unsigned long ms, char* buf, size_t size);
+  static bool sendToClient(void* ctx, const char* data, size_t len);
 };
 
 #endif // TUI_SERVER_H
@@ -1,9 +1,11 @@
 #ifndef WEB_SERVER_H
 #define WEB_SERVER_H
 
+#include <atomic>
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
+#include "config.h"
 #include "temperature_control.h"
 
 class WebServer {
@@ -20,18 +22,44 @@ public:
   // Notifies all connected clients of status update
   void notifyClients(const String& message);
 
+  // Push status, history and log frames to /api/events subscribers. Call
+  // from loop(); status frames go out at most once per controller snapshot.
+  void publishEvents();
+
+  struct EventStats {
+    uint32_t frames;      // frames sent (each to every subscriber)
+    uint32_t coalesced;   // ticks skipped while clients drained a backlog
+    uint32_t rejected;    // subscribers refused over EVENT_STREAM_MAX_CLIENTS
+    uint8_t clients;
+  };
+  EventStats getEventStats(void);
+
   // Check if server is running
   bool isRunning(void);
 
 private:
   AsyncWebServer _server;
+  AsyncEventSource _events;
   TemperatureController* _controller;
   uint16_t _port;
   bool _running;
 
+  // Event stream state (loop task only, except _eventStats.rejected)
+  uint32_t _eventSeq;            // snapshot last pushed
+  uint32_t _eventHistoryCursor;  // history time last pushed
+  uint32_t _eventLogSeq;         // log sequence last pushed
+  EventStats _eventStats;
+  char _eventFrame[EVENT_STREAM_FRAME_BYTES];
+
   // Route handlers
   void setupRoutes();
-  void setupWebSocket();
+  void setupEventStream();
+  void handleHistory(AsyncWebServerRequest* request);
+  void publishHistoryDelta(uint32_t latest);
+  void publishLogs();
+#if ENABLE_LOG_RING
+  void handleLogs(AsyncWebServerRequest* request);
+#endif
 
   // API Endpoints (handlers defined in web_server.cpp)
   friend class AsyncCallbackWebHandler;
@@ -0,0 +1,75 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ============================================================================
+// WiFiLink - station connection state machine, without blocking
+//
+// Fed the driver's events (got IP, disconnected) and polled with the time,
+// it returns what the owner should do next: start a connection attempt,
+// open or close the fallback AP. Nothing here waits for the radio.
+//   - A failed or lost connection is retried after WIFI_RETRY_MIN_MS,
+//     doubling per failure up to WIFI_RETRY_MAX_MS; an IP resets the delay.
+//     An attempt with no IP after WIFI_CONNECT_TIMEOUT_MS counts as failed.
+//   - If the station has not had an IP WIFI_AP_FALLBACK_MS after begin(),
+//     the AP opens alongside it (or at once without credentials); the
+//     station keeps retrying and the AP closes once it connects.
+// Times are millis(). No Arduino dependencies; events may come from another
+// task, so the owner serializes calls.
+// ============================================================================
+class WiFiLink {
+public:
+  enum State : uint8_t {
+    LINK_OFF,           // no credentials: AP only
+    LINK_CONNECTING,    // attempt in progress
+    LINK_UP,            // station has an IP
+    LINK_BACKOFF        // waiting to retry
+  };
+
+  enum Action : uint8_t {
+    ACTION_NONE,
+    ACTION_CONNECT,     // (re)start the station connection
+    ACTION_START_AP,
+    ACTION_STOP_AP
+  };
+
+  WiFiLink();
+
+  void begin(uint32_t now, bool haveCredentials);
+  // Next thing to do; call until ACTION_NONE
+  Action update(uint32_t now);
+
+  void onGotIp(uint32_t now);
+  void onDisconnected(uint32_t now);
+
+  State state() const { return _state; }
+  bool apActive() const { return _apActive; }
+  bool everUp() const { return _everUp; }
+  uint32_t firstUpAt() const { return _firstUpAt; }    // millis() of the first IP
+  uint32_t attempts() const { return _attempts; }      // since the last IP
+  uint32_t retryAt() const { return _retryAt; }        // millis() of the next attempt
+  uint32_t retryDelay() const { return _retryDelay; }  // for the next failure
+  uint32_t connects() const { return _connects; }      // IPs obtained since boot
+
+  static const char* stateName(State state);
+
+private:
+  State _state;
+  bool _apWanted;
+  bool _apActive;
+  bool _everUp;
+  bool _connectPending;
+  uint32_t _begunAt;
+  uint32_t _attemptAt;
+  uint32_t _retryAt;
+  uint32_t _retryDelay;
+  uint32_t _firstUpAt;
+  uint32_t _attempts;
+  uint32_t _connects;
+
+  void fail(uint32_t now);
+};
+
+#endif // WIFI_LINK_H
@@ -0,0 +1,117 @@
+#include "control_task.h"
+#include <esp_timer.h>
+#include "profiler.h"
+
+ControlTask::ControlTask(TemperatureController* controller, MAX31865* sensor)
+    : _controller(controller), _sensor(sensor), _handle(nullptr),
+      _statsMux(portMUX_INITIALIZER_UNLOCKED), _stats(), _absJitterSumUs(0),
+      _diagRan(false) {
+  resetStats();
+}
+
+bool ControlTask::begin() {
+  if (_handle) return true;
+
+  BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "control",
+                                          CONTROL_TASK_STACK, this,
+                                          CONTROL_TASK_PRIORITY, &_handle,
+                                          CONTROL_TASK_CORE);
+  if (ok != pdPASS) {
+    _handle = nullptr;
+    Serial.println("[CTRL] ERROR: Failed to create control task");
+    return false;
+  }
+
+  Serial.printf("[CTRL] Control task started on core %d (prio %d, period %dms)\n",
+                CONTROL_TASK_CORE, CONTROL_TASK_PRIORITY, TEMP_CONTROL_INTERVAL);
+  return true;
+}
+
+void ControlTask::taskEntry(void* arg) {
+  static_cast<ControlTask*>(arg)->run();
+}
+
+void ControlTask::run() {
+  const TickType_t period = pdMS_TO_TICKS(TEMP_CONTROL_INTERVAL);
+  const int64_t periodUs = (int64_t)TEMP_CONTROL_INTERVAL * 1000;
+
+  TickType_t lastWake = xTaskGetTickCount();
+  int64_t idealWakeUs = esp_timer_get_time();
+
+  for (;;) {
+    int64_t wakeUs = esp_timer_get_time();
+    int32_t jitterUs = (int32_t)(wakeUs - idealWakeUs);
+
+    runDeferredDiagnostic();
+    _controller->tick();
+
+    int64_t doneUs = esp_timer_get_time();
+    recordCycle(wakeUs, jitterUs, (uint32_t)(doneUs - wakeUs));
+
+    // After an overrun vTaskDelayUntil returns at once and only advances
+    // lastWake by one period, so the task would burst through the missed
+    // periods. Restart both schedules from now instead; the late cycle is
+    // already counted as an overrun and later jitter stays relative to it.
+    if ((TickType_t)(xTaskGetTickCount() - lastWake) >= period) {
+      lastWake = xTaskGetTickCount();
+      idealWakeUs = esp_timer_get_time();
+    }
+
+    vTaskDelayUntil(&lastWake, period);
+    idealWakeUs += periodUs;
+  }
+}
+
+// Run MAX31865 hardware diagnostic once, CONTROL_DIAG_DELAY after boot (USB
+// CDC is connected by then). Done here so it never races a control-cycle
+// sensor read on the SPI bus.
+void ControlTask::runDeferredDiagnostic() {
+  if (_diagRan || !_sensor || millis() < CONTROL_DIAG_DELAY) return;
+  _diagRan = true;
+
+  Serial.println("\n*** RUNNING DEFERRED MAX31865 HARDWARE DIAGNOSTIC ***");
+  _sensor->runHardwareDiagnostic();
+  // Re-initialize sensor for normal operation after diagnostic
+  Serial.println("*** RE-INITIALIZING MAX31865 FOR NORMAL OPERATION ***");
+  _sensor->begin(MAX31865::THREE_WIRE);
+}
+
+void ControlTask::recordCycle(int64_t wakeUs, int32_t jitterUs, uint32_t execUs) {
+  uint32_t stackFree = uxTaskGetStackHighWaterMark(nullptr);
+
+  portENTER_CRITICAL(&_statsMux);
+  if (_stats.firstTickUs == 0) _stats.firstTickUs = (uint32_t)wakeUs;
+  _stats.cycles++;
+  _stats.lastJitterUs = jitterUs;
+  if (jitterUs < _stats.minJitterUs) _stats.minJitterUs = jitterUs;
+  if (jitterUs > _stats.maxJitterUs) _stats.maxJitterUs = jitterUs;
+  _absJitterSumUs += (uint32_t)abs(jitterUs);
+  _stats.meanAbsJitterUs = (uint32_t)(_absJitterSumUs / _stats.cycles);
+  _stats.lastExecUs = execUs;
+  if (execUs > _stats.maxExecUs) _stats.maxExecUs = execUs;
+  if (execUs >= (uint32_t)TEMP_CONTROL_INTERVAL * 1000) _stats.overruns++;
+  _stats.stackHighWater = stackFree;
+  portEXIT_CRITICAL(&_statsMux);
+
+#if ENABLE_PROFILER
+  loopProfiler.recordTick(jitterUs, execUs);
+#endif
+}
+
+ControlTask::Stats ControlTask::getStats(void) {
+  portENTER_CRITICAL(&_statsMux);
+  Stats copy = _stats;
+  portEXIT_CRITICAL(&_statsMux);
+  return copy;
+}
+
+void ControlTask::resetStats(void) {
+  portENTER_CRITICAL(&_statsMux);
+  uint32_t firstTickUs = _stats.firstTickUs;
+  _stats = {};
+  _stats.firstTickUs = firstTickUs;
+  _stats.minJitterUs = INT32_MAX;
+  _stats.maxJitterUs = INT32_MIN;
+  _absJitterSumUs = 0;
+  portEXIT_CRITICAL(&_statsMux);
+}
@@ -0,0 +1,226 @@
+#include "crash_log.h"
+#include "log_filter.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_attr.h>
+// RTC slow memory, left alone by the startup code on every reset but power-on
+static RTC_NOINIT_ATTR CrashRecord crashRecord;
+#else
+static CrashRecord crashRecord;
+#endif
+
+CrashLog crashLog(crashRecord);
+
+// The live record must not be touched here: the constructor runs before
+// begin() has looked at what the previous boot left.
+CrashLog::CrashLog(CrashRecord& live)
+    : _live(live), _resetReason(CRASH_RESET_UNKNOWN), _hasReport(false), _jsonLen(0) {
+  memset(&_report, 0, sizeof(_report));
+  _json[0] = '\0';
+}
+
+void CrashLog::begin(uint8_t resetReason) {
+  _resetReason = resetReason;
+  _hasReport = resetReason != CRASH_RESET_POWERON && isValid(_live);
+
+  uint32_t boots = 0;
+  if (_hasReport) {
+    memcpy(&_report, &_live, sizeof(_report));
+    // A line may have been cut short by the reset
+    for (uint8_t i = 0; i < CRASH_LOG_LINES; i++) {
+      _report.lines[i].text[CRASH_LOG_LINE_LEN - 1] = '\0';
+    }
+    boots = _live.bootCount;
+  }
+  reset(boots + 1);
+  _jsonLen = toJson(_json, sizeof(_json));
+}
+
+void CrashLog::reset(uint32_t bootCount) {
+  memset(&_live, 0, sizeof(_live));
+  _live.magic = CRASH_LOG_MAGIC;
+  _live.version = CRASH_LOG_VERSION;
+  _live.size = sizeof(CrashRecord);
+  _live.bootCount = bootCount;
+}
+
+bool CrashLog::isValid(const CrashRecord& record) {
+  return record.magic == CRASH_LOG_MAGIC && record.version == CRASH_LOG_VERSION &&
+         record.size == sizeof(CrashRecord);
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+void CrashLog::append(uint8_t priority, uint32_t time, const char* text) {
+  while (*text == '\n') text++;
+
+  CrashLogLine& line = _live.lines[_live.lineCount % CRASH_LOG_LINES];
+  line.time = time;
+  line.priority = priority;
+  size_t len = strnlen(text, CRASH_LOG_LINE_LEN - 1);
+  while (len > 0 && (text[len - 1] == '\n' || text[len - 1] == '\r')) len--;
+  memcpy(line.text, text, len);
+  line.text[len] = '\0';
+  _live.lineCount++;
+}
+
+uint32_t CrashLog::snapshotCheck(const CrashSnapshot& snap) {
+  uint32_t h = logHash(&snap, offsetof(CrashSnapshot, check));
+  return h ? h : 1;    // 0 is "never written"
+}
+
+void CrashLog::recordSnapshot(const TemperatureController::Snapshot& snap) {
+  // Built on the stack (padding zeroed) and copied in one go, so the check
+  // only matches a snapshot that was written completely
+  CrashSnapshot cs;
+  memset(&cs, 0, sizeof(cs));
+  cs.uptime = snap.publishedAt;
+  cs.currentTemp = snap.status.currentTemp;
+  cs.setpoint = snap.status.setpoint;
+  cs.pidOutput = snap.pid.output;
+  cs.state = (uint8_t)snap.status.state;
+  cs.relays = (snap.status.auger ? CRASH_RELAY_AUGER : 0) |
+              (snap.status.fan ? CRASH_RELAY_FAN : 0) |
+              (snap.status.igniter ? CRASH_RELAY_IGNITER : 0);
+  cs.errorCount = snap.status.errorCount;
+  cs.reigniteAttempts = snap.reigniteAttempts;
+  cs.lidOpen = snap.lidOpen;
+  cs.check = snapshotCheck(cs);
+  memcpy(&_live.snapshot, &cs, sizeof(cs));
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+uint8_t CrashLog::reportLineCount() const {
+  if (!_hasReport) return 0;
+  return _report.lineCount < CRASH_LOG_LINES ? (uint8_t)_report.lineCount : CRASH_LOG_LINES;
+}
+
+const CrashLogLine& CrashLog::reportLine(uint8_t index) const {
+  uint32_t first = _report.lineCount - reportLineCount();
+  return _report.lines[(first + index) % CRASH_LOG_LINES];
+}
+
+bool CrashLog::reportSnapshotValid() const {
+  return _hasReport && _report.snapshot.check != 0 &&
+         _report.snapshot.check == snapshotCheck(_report.snapshot);
+}
+
+uint32_t CrashLog::reportUptime() const {
+  uint32_t uptime = reportSnapshotValid() ? _report.snapshot.uptime : 0;
+  uint8_t count = reportLineCount();
+  if (count && reportLine(count - 1).time > uptime) uptime = reportLine(count - 1).time;
+  return uptime;
+}
+
+bool CrashLog::isCrash(uint8_t resetReason) {
+  switch (resetReason) {
+    case CRASH_RESET_PANIC:
+    case CRASH_RESET_INT_WDT:
+    case CRASH_RESET_TASK_WDT:
+    case CRASH_RESET_WDT:
+    case CRASH_RESET_BROWNOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static const char* const RESET_NAMES[] = {
+  "UNKNOWN", "POWERON", "EXT", "SW", "PANIC", "INT_WDT",
+  "TASK_WDT", "WDT", "DEEPSLEEP", "BROWNOUT", "SDIO"
+};
+
+const char* CrashLog::resetReasonName(uint8_t resetReason) {
+  return resetReason < sizeof(RESET_NAMES) / sizeof(RESET_NAMES[0]) ? RESET_NAMES[resetReason]
+                                                                      : "OTHER";
+}
+
+// JSON string body (without quotes) of a line; dst may be null to measure
+static size_t escapeLine(const char* text, char* dst) {
+  size_t n = 0;
+  for (const char* p = text; *p; p++) {
+    const char* esc = nullptr;
+    if (*p == '"') esc = "\\\"";
+    else if (*p == '\\') esc = "\\\\";
+    else if (*p == '\n') esc = "\\n";
+    else if ((unsigned char)*p < 0x20) continue;
+    if (esc) {
+      if (dst) memcpy(dst + n, esc, 2);
+      n += 2;
+    } else {
+      if (dst) dst[n] = *p;
+      n++;
+    }
+  }
+  return n;
+}
+
+// "[time,priority,\"text\"]" is at most this much more than the escaped text
+#define LINE_JSON_OVERHEAD 32
+
+size_t CrashLog::toJson(char* buf, size_t size) const {
+  int n = snprintf(buf, size, "{\"available\":%s,\"reset_reason\":\"%s\",\"crash\":%s,\"boot\":%u",
+                   _hasReport ? "true" : "false", resetReasonName(_resetReason),
+                   crashed() ? "true" : "false", (unsigned)bootCount());
+  if (n < 0 || (size_t)n >= size) return 0;
+  size_t len = (size_t)n;
+
+  if (_hasReport) {
+    n = snprintf(buf + len, size - len, ",\"uptime\":%u", (unsigned)reportUptime());
+    if (n < 0 || (size_t)n >= size - len) return 0;
+    len += (size_t)n;
+  }
+
+  if (reportSnapshotValid()) {
+    const CrashSnapshot& s = _report.snapshot;
+    n = snprintf(buf + len, size - len,
+                 ",\"snapshot\":{\"uptime\":%u,\"state\":\"%s\",\"temp\":%.1f,\"setpoint\":%.1f,"
+                 "\"pid_output\":%.1f,\"auger\":%s,\"fan\":%s,\"igniter\":%s,\"lid_open\":%s,"
+                 "\"errors\":%u,\"reignite_attempts\":%u}",
+                 (unsigned)s.uptime, TemperatureController::stateName((ControllerState)s.state),
+                 s.currentTemp, s.setpoint, s.pidOutput * 100.0,
+                 (s.relays & CRASH_RELAY_AUGER) ? "true" : "false",
+                 (s.relays & CRASH_RELAY_FAN) ? "true" : "false",
+                 (s.relays & CRASH_RELAY_IGNITER) ? "true" : "false",
+                 s.lidOpen ? "true" : "false", (unsigned)s.errorCount,
+                 (unsigned)s.reigniteAttempts);
+    if (n < 0 || (size_t)n >= size - len) return 0;
+    len += (size_t)n;
+  }
+
+  // Keep the newest lines that fit, leaving room for the closing brackets
+  const size_t prefix = 32;    // ,"dropped":N,"lines":[
+  uint8_t count = reportLineCount();
+  uint8_t keep = 0;
+  size_t need = len + prefix + 3;    // ]} and null
+  while (keep < count) {
+    size_t lineLen = escapeLine(reportLine(count - 1 - keep).text, nullptr) + LINE_JSON_OVERHEAD;
+    if (need + lineLen > size) break;
+    need += lineLen;
+    keep++;
+  }
+  if (need > size) return 0;
+
+  len += (size_t)snprintf(buf + len, size - len, ",\"dropped\":%u,\"lines\":[",
+                          (unsigned)(count - keep));
+  for (uint8_t i = count - keep; i < count; i++) {
+    const CrashLogLine& line = reportLine(i);
+    len += (size_t)snprintf(buf + len, size - len, "%s[%u,%u,\"", i > count - keep ? "," : "",
+                            (unsigned)line.time, (unsigned)line.priority);
+    len += escapeLine(line.text, buf + len);
+    buf[len++] = '"';
+    buf[len++] = ']';
+  }
+  buf[len++] = ']';
+  buf[len++] = '}';
+  buf[len] = '\0';
+  return len;
+}
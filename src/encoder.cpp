@@ -14,7 +14,6 @@ Encoder::Encoder()
       _buttonState(false),
       _lastButtonState(false),
       _buttonPressed(false),
-      _lastPoll(0),
       _lastButtonTime(0) {}
 
 bool Encoder::begin() {
@@ -86,13 +85,8 @@ bool Encoder::writeRegThenRead(uint8_t reg, uint8_t* buf, uint8_t len) {
   return true;
 }
 
-bool Encoder::update() {
+bool Encoder::poll() {
   if (!_connected) return false;
-
-  unsigned long now = millis();
-  if (now - _lastPoll < ENCODER_POLL_INTERVAL) return false;
-  _lastPoll = now;
-
   return readDevice();
 }
 
@@ -0,0 +1,335 @@
+#include "heap_monitor.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+HeapMonitor heapMonitor;
+#if ENABLE_HEAP_TRACE
+HeapTracer heapTracer;
+#endif
+
+// Held by the malloc wrappers around every table update (see the end of
+// this file). No-op on native builds, which are single-threaded.
+#if ENABLE_HEAP_TRACE && defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+#define TRACE_ENTER() portENTER_CRITICAL(&traceMux)
+#define TRACE_EXIT() portEXIT_CRITICAL(&traceMux)
+#else
+#define TRACE_ENTER() do {} while (0)
+#define TRACE_EXIT() do {} while (0)
+#endif
+
+static_assert((HEAP_TRACE_SLOTS & (HEAP_TRACE_SLOTS - 1)) == 0,
+              "HEAP_TRACE_SLOTS must be a power of two");
+
+// Stop inserting at 3/4 full so probe runs stay short
+static const uint32_t TRACE_MAX_LIVE = HEAP_TRACE_SLOTS / 4 * 3;
+static const uint32_t TRACE_MASK = HEAP_TRACE_SLOTS - 1;
+
+// ============================================================================
+// TRACER
+// ============================================================================
+
+HeapTracer::HeapTracer() : _loopTag(TAG_OTHER), _enabled(false) {
+  memset(_slots, 0, sizeof(_slots));
+  memset(_tags, 0, sizeof(_tags));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+// Fibonacci hash of the pointer, taking the well-mixed upper bits; heap
+// pointers are at least 4-byte aligned
+uint32_t HeapTracer::slotFor(uintptr_t ptr) {
+  return ((uint32_t)(ptr >> 2) * 2654435761u) >> 16 & TRACE_MASK;
+}
+
+void HeapTracer::onAlloc(const void* ptr, uint32_t size, Tag tag) {
+  if (!ptr) return;
+  if (tag >= TAG_COUNT) tag = TAG_OTHER;
+  if (_stats.live >= TRACE_MAX_LIVE || size > 0xFFFFFF) {
+    _stats.dropped++;
+    return;
+  }
+
+  uintptr_t key = (uintptr_t)ptr;
+  uint32_t i = slotFor(key);
+  while (_slots[i].ptr && _slots[i].ptr != key) i = (i + 1) & TRACE_MASK;
+  if (_slots[i].ptr == key) {
+    // Freed behind our back (before start() or by a dropped free): recharge
+    onFree(ptr);
+    onAlloc(ptr, size, tag);
+    return;
+  }
+  _slots[i].ptr = key;
+  _slots[i].sizeTag = size << 8 | tag;
+  _stats.live++;
+
+  TagStats& t = _tags[tag];
+  t.allocs++;
+  t.bytes += size;
+  t.liveBlocks++;
+  t.liveBytes += size;
+  if (t.liveBytes > t.peakBytes) t.peakBytes = t.liveBytes;
+}
+
+bool HeapTracer::onFree(const void* ptr, Tag* tag, uint32_t* size) {
+  if (!ptr) return false;
+  uintptr_t key = (uintptr_t)ptr;
+  uint32_t i = slotFor(key);
+  while (_slots[i].ptr != key) {
+    if (!_slots[i].ptr) {
+      _stats.untrackedFrees++;
+      return false;
+    }
+    i = (i + 1) & TRACE_MASK;
+  }
+
+  uint32_t bytes = _slots[i].sizeTag >> 8;
+  Tag owner = (Tag)(_slots[i].sizeTag & 0xFF);
+  TagStats& t = _tags[owner];
+  t.frees++;
+  t.liveBlocks--;
+  t.liveBytes -= bytes;
+  _stats.live--;
+  if (tag) *tag = owner;
+  if (size) *size = bytes;
+
+  // Backward-shift deletion: pull later entries of the probe run into the
+  // hole so lookups never need tombstones
+  uint32_t hole = i;
+  uint32_t j = i;
+  for (;;) {
+    j = (j + 1) & TRACE_MASK;
+    if (!_slots[j].ptr) break;
+    uint32_t home = slotFor(_slots[j].ptr);
+    // Movable unless its home lies cyclically in (hole, j]
+    if (((j - home) & TRACE_MASK) >= ((j - hole) & TRACE_MASK)) {
+      _slots[hole] = _slots[j];
+      hole = j;
+    }
+  }
+  _slots[hole].ptr = 0;
+  return true;
+}
+
+void HeapTracer::resetCounts() {
+  for (uint8_t t = 0; t < TAG_COUNT; t++) {
+    _tags[t].allocs = 0;
+    _tags[t].frees = 0;
+    _tags[t].bytes = 0;
+    _tags[t].peakBytes = _tags[t].liveBytes;
+  }
+  _stats.dropped = 0;
+  _stats.untrackedFrees = 0;
+}
+
+HeapTracer::Snapshot HeapTracer::snapshot() const {
+  Snapshot snap;
+  TRACE_ENTER();
+  snap.stats = _stats;
+  memcpy(snap.tags, _tags, sizeof(snap.tags));
+  TRACE_EXIT();
+  return snap;
+}
+
+static const char* const TAG_NAMES[HeapTracer::TAG_COUNT] = {
+  "other", "setup", "net", "web", "mqtt", "tui", "telnet", "history", "status",
+  "control", "log", "ota"
+};
+
+const char* HeapTracer::tagName(Tag tag) {
+  return tag < TAG_COUNT ? TAG_NAMES[tag] : "?";
+}
+
+// ============================================================================
+// MONITOR
+// ============================================================================
+
+HeapMonitor::HeapMonitor() {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+uint8_t HeapMonitor::fragmentation(const HeapReading& reading) {
+  if (reading.freeBytes == 0 || reading.largestBlock >= reading.freeBytes) return 0;
+  return (uint8_t)(100 - (uint64_t)reading.largestBlock * 100 / reading.freeBytes);
+}
+
+void HeapMonitor::sample(const HeapReading& reading, uint32_t now) {
+  _stats.last = reading;
+  _stats.fragmentation = fragmentation(reading);
+  if (_stats.samples == 0 || reading.largestBlock < _stats.minLargestBlock) {
+    _stats.minLargestBlock = reading.largestBlock;
+    _stats.minLargestAt = now;
+  }
+  if (_stats.fragmentation > _stats.maxFragmentation) {
+    _stats.maxFragmentation = _stats.fragmentation;
+  }
+  _stats.samples++;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+
+HeapReading HeapMonitor::read() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  HeapReading r;
+  r.freeBytes = info.total_free_bytes;
+  r.minFreeBytes = info.minimum_free_bytes;
+  r.largestBlock = info.largest_free_block;
+  r.totalBytes = info.total_free_bytes + info.total_allocated_bytes;
+  r.allocatedBlocks = info.allocated_blocks;
+  r.freeBlocks = info.free_blocks;
+  return r;
+}
+#endif
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+// snprintf into buf + *len, false once the buffer is full
+static bool append(char* buf, size_t size, size_t* len, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *len) return false;
+  *len += (size_t)n;
+  return true;
+}
+
+size_t HeapTracer::toJson(char* buf, size_t size) const {
+  // Formatting takes far too long to hold the lock, so work from a copy
+  Snapshot snap = snapshot();
+  size_t len = 0;
+  if (!append(buf, size, &len, "{\"live\":%u,\"dropped\":%u,\"untracked_frees\":%u,\"tags\":{",
+              (unsigned)snap.stats.live, (unsigned)snap.stats.dropped,
+              (unsigned)snap.stats.untrackedFrees)) {
+    return 0;
+  }
+  for (uint8_t t = 0; t < TAG_COUNT; t++) {
+    const TagStats& s = snap.tags[t];
+    if (!append(buf, size, &len,
+                "%s\"%s\":{\"allocs\":%u,\"frees\":%u,\"bytes\":%u,\"live_blocks\":%u,"
+                "\"live_bytes\":%u,\"peak_bytes\":%u}",
+                t ? "," : "", TAG_NAMES[t], (unsigned)s.allocs, (unsigned)s.frees,
+                (unsigned)s.bytes, (unsigned)s.liveBlocks, (unsigned)s.liveBytes,
+                (unsigned)s.peakBytes)) {
+      return 0;
+    }
+  }
+  return append(buf, size, &len, "}}") ? len : 0;
+}
+
+size_t HeapMonitor::toJson(char* buf, size_t size, uint32_t uptimeMs,
+                           const HeapTracer* tracer) const {
+  const HeapReading& r = _stats.last;
+  size_t len = 0;
+  if (!append(buf, size, &len,
+              "{\"uptime\":%u,\"samples\":%u,\"free\":%u,\"min_free\":%u,\"total\":%u,"
+              "\"largest_block\":%u,\"min_largest_block\":%u,\"min_largest_at\":%u,"
+              "\"frag_pct\":%u,\"max_frag_pct\":%u,\"alloc_blocks\":%u,\"free_blocks\":%u,"
+              "\"trace\":",
+              (unsigned)uptimeMs, (unsigned)_stats.samples, (unsigned)r.freeBytes,
+              (unsigned)r.minFreeBytes, (unsigned)r.totalBytes, (unsigned)r.largestBlock,
+              (unsigned)_stats.minLargestBlock, (unsigned)_stats.minLargestAt,
+              (unsigned)_stats.fragmentation, (unsigned)_stats.maxFragmentation,
+              (unsigned)r.allocatedBlocks, (unsigned)r.freeBlocks)) {
+    return 0;
+  }
+  if (tracer) {
+    size_t n = tracer->toJson(buf + len, size - len);
+    if (!n) return 0;
+    len += n;
+  } else if (!append(buf, size, &len, "null")) {
+    return 0;
+  }
+  return append(buf, size, &len, "}") ? len : 0;
+}
+
+// ============================================================================
+// MALLOC WRAPPERS (heap-trace build, -Wl,--wrap=malloc etc.)
+//
+// Each allocation is charged to the task that makes it: the loop task to
+// its current HEAP_TAG, known tasks by name, anything else to "other". Frees
+// are recorded before the memory goes back, so another task cannot be handed
+// the same pointer while it is still in the table.
+// ============================================================================
+#if ENABLE_HEAP_TRACE && defined(ARDUINO_ARCH_ESP32)
+static HeapTracer::Tag currentTag() {
+  const char* name = pcTaskGetTaskName(nullptr);
+  if (!name) return HeapTracer::TAG_OTHER;
+  if (!strcmp(name, "loopTask")) return heapTracer.loopTag();
+  if (!strcmp(name, "async_tcp")) return HeapTracer::TAG_WEB;
+  if (!strcmp(name, "control")) return HeapTracer::TAG_CONTROL;
+  if (!strcmp(name, "log_drain")) return HeapTracer::TAG_LOG;
+  if (!strcmp(name, "tiT") || !strcmp(name, "wifi") || !strcmp(name, "sys_evt") ||
+      !strcmp(name, "arduino_events")) {
+    return HeapTracer::TAG_NET;
+  }
+  return HeapTracer::TAG_OTHER;
+}
+
+static void traceAlloc(void* ptr, size_t size) {
+  // Not before the scheduler runs: there is no current task to ask
+  if (!ptr || !heapTracer.enabled() ||
+      xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+    return;
+  }
+  HeapTracer::Tag tag = currentTag();
+  TRACE_ENTER();
+  heapTracer.onAlloc(ptr, (uint32_t)size, tag);
+  TRACE_EXIT();
+}
+
+static bool traceFree(void* ptr, HeapTracer::Tag* tag, uint32_t* size) {
+  if (!ptr || !heapTracer.enabled()) return false;
+  TRACE_ENTER();
+  bool tracked = heapTracer.onFree(ptr, tag, size);
+  TRACE_EXIT();
+  return tracked;
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+  void* ptr = __real_malloc(size);
+  traceAlloc(ptr, size);
+  return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  void* ptr = __real_calloc(count, size);
+  traceAlloc(ptr, count * size);
+  return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  HeapTracer::Tag tag;
+  uint32_t oldSize;
+  bool tracked = traceFree(ptr, &tag, &oldSize);
+  void* moved = __real_realloc(ptr, size);
+  if (moved) {
+    traceAlloc(moved, size);
+  } else if (tracked && size) {
+    // Failed: the old block is still live and still its old owner's
+    TRACE_ENTER();
+    heapTracer.onAlloc(ptr, oldSize, tag);
+    TRACE_EXIT();
+  }
+  return moved;
+}
+
+void __wrap_free(void* ptr) {
+  traceFree(ptr, nullptr, nullptr);
+  __real_free(ptr);
+}
+}
+#endif // ENABLE_HEAP_TRACE && ARDUINO_ARCH_ESP32
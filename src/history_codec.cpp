@@ -0,0 +1,121 @@
+#include "history_codec.h"
+
+static const uint32_t NOMINAL_DT = HISTORY_SAMPLE_INTERVAL / 1000;
+
+void HistoryCodec::start(HistoryBlock& block, const HistorySample& sample, uint32_t index) {
+  block.first = index;
+  block.time = sample.time;
+  block.temp = sample.temp;
+  block.setpoint = sample.setpoint;
+  block.state = sample.state;
+  block.count = 1;
+  block.used = 0;
+}
+
+bool HistoryCodec::append(HistoryBlock& block, const HistorySample& prev, const HistorySample& sample) {
+  if (block.count == 0 || block.count == UINT8_MAX) return false;
+
+  int32_t dt = (int32_t)(sample.time - prev.time) - (int32_t)NOMINAL_DT;
+  int32_t dTemp = (int32_t)sample.temp - prev.temp;
+  int32_t dSetpoint = (int32_t)sample.setpoint - prev.setpoint;
+  uint32_t zTemp = zigzag(dTemp);
+
+  uint8_t buf[MAX_SAMPLE_BYTES];
+  uint8_t len = 0;
+
+  if (dt == 0 && dSetpoint == 0 && sample.state == prev.state && zTemp < 0x80) {
+    buf[len++] = FAST | (uint8_t)zTemp;
+  } else {
+    uint8_t flags = 0;
+    if (dt != 0) flags |= HAS_DT;
+    if (dTemp != 0) flags |= HAS_TEMP;
+    if (dSetpoint != 0) flags |= HAS_SETPOINT;
+    if (sample.state != prev.state) flags |= HAS_STATE;
+
+    buf[len++] = flags;
+    if (flags & HAS_DT) len += putVarint(buf + len, zigzag(dt));
+    if (flags & HAS_TEMP) len += putVarint(buf + len, zTemp);
+    if (flags & HAS_SETPOINT) len += putVarint(buf + len, zigzag(dSetpoint));
+    if (flags & HAS_STATE) buf[len++] = sample.state;
+  }
+
+  if (block.used + len > sizeof(block.data)) return false;
+  memcpy(block.data + block.used, buf, len);
+  block.used += len;
+  block.count++;
+  return true;
+}
+
+uint8_t HistoryCodec::putVarint(uint8_t* out, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+bool HistoryCodec::getVarint(const HistoryBlock& block, uint16_t& pos, uint32_t& v) {
+  v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (pos >= block.used) return false;
+    uint8_t b = block.data[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+void HistoryCodec::Decoder::reset(const HistoryBlock& block) {
+  _block = &block;
+  _pos = 0;
+  _index = 0;
+}
+
+bool HistoryCodec::Decoder::next(HistorySample& out) {
+  const HistoryBlock& b = *_block;
+  if (_index >= b.count) return false;
+
+  if (_index == 0) {
+    memset(&_prev, 0, sizeof(_prev));
+    _prev.time = b.time;
+    _prev.temp = b.temp;
+    _prev.setpoint = b.setpoint;
+    _prev.state = b.state;
+  } else {
+    if (_pos >= b.used) return false;
+    uint8_t head = b.data[_pos++];
+    _prev.time += NOMINAL_DT;
+
+    if (head & FAST) {
+      _prev.temp += (int16_t)unzigzag(head & 0x7F);
+    } else {
+      uint32_t v;
+      if (head & HAS_DT) {
+        if (!getVarint(b, _pos, v)) return false;
+        _prev.time += unzigzag(v);
+      }
+      if (head & HAS_TEMP) {
+        if (!getVarint(b, _pos, v)) return false;
+        _prev.temp += (int16_t)unzigzag(v);
+      }
+      if (head & HAS_SETPOINT) {
+        if (!getVarint(b, _pos, v)) return false;
+        _prev.setpoint += (int16_t)unzigzag(v);
+      }
+      if (head & HAS_STATE) {
+        if (_pos >= b.used) return false;
+        _prev.state = b.data[_pos++];
+      }
+    }
+  }
+
+  _index++;
+  out = _prev;
+  return true;
+}
@@ -0,0 +1,183 @@
+#include "history_downsample.h"
+
+// ============================================================================
+// HISTORY SERIES
+// ============================================================================
+
+HistorySeries::HistorySeries(const HistoryStore& store, uint32_t since, uint32_t latest)
+    : _store(store), _reader(store), _latest(latest), _lastTime(since),
+      _index(store.tier2().begin()), _tier(2), _hasPeeked(false), _started(since > 0) {
+  memset(&_peeked, 0, sizeof(_peeked));
+  if (since > 0) _reader.skipThrough(since);
+}
+
+static void fromBucket(const HistoryBucket& b, HistorySample& out) {
+  out.time = b.time;
+  out.temp = b.meanTemp;
+  out.setpoint = b.setpoint;
+  out.state = b.state;
+}
+
+bool HistorySeries::fetch(HistorySample& out) {
+  HistoryBucket b;
+  while (_tier == 2) {
+    if (_index < _store.tier2().begin()) _index = _store.tier2().begin();
+    if (_index >= _store.tier2().end()) {
+      _tier = 1;
+      _index = _store.tier1().begin();
+    } else if (_store.tier2().read(_index++, b)) {
+      fromBucket(b, out);
+      return true;
+    }
+  }
+  while (_tier == 1) {
+    if (_index < _store.tier1().begin()) _index = _store.tier1().begin();
+    if (_index >= _store.tier1().end()) {
+      _tier = 0;
+    } else if (_store.tier1().read(_index++, b)) {
+      fromBucket(b, out);
+      return true;
+    }
+  }
+  return _reader.next(out);
+}
+
+bool HistorySeries::peek(HistorySample& out) {
+  if (!_hasPeeked) {
+    for (;;) {
+      if (!fetch(_peeked) || _peeked.time > _latest) return false;
+      // Strictly increasing: drops anything at or before `since`, and the
+      // overlap when a fold moves data between tiers mid-read
+      if (!_started || _peeked.time > _lastTime) break;
+    }
+    _hasPeeked = true;
+  }
+  out = _peeked;
+  return true;
+}
+
+bool HistorySeries::next(HistorySample& out) {
+  if (!peek(out)) return false;
+  _hasPeeked = false;
+  _lastTime = out.time;
+  _started = true;
+  return true;
+}
+
+// ============================================================================
+// DOWNSAMPLER
+// ============================================================================
+
+HistoryDownsampler::HistoryDownsampler(const HistoryStore& store, uint32_t since,
+                                       uint32_t latest, uint16_t points)
+    : _main(store, since, latest), _lead(store, since, latest), _start(0), _end(latest),
+      _buckets((points < MIN_POINTS ? MIN_POINTS : points) - 2), _started(false),
+      _bucket(0), _prevState(0), _candidateArea(0), _hasCandidate(false),
+      _avgBucket(0), _avgTime(0), _avgTemp(0), _hasAvg(false), _queued(0), _queueHead(0) {
+  memset(&_kept, 0, sizeof(_kept));
+  memset(&_candidate, 0, sizeof(_candidate));
+  HistorySample first;
+  if (_main.peek(first)) _start = first.time;
+}
+
+// 0 = first point, 1.._buckets = interior slices, _buckets + 1 = last point
+uint32_t HistoryDownsampler::bucketOf(uint32_t time) const {
+  if (time >= _end) return (uint32_t)_buckets + 1;
+  if (time <= _start) return 0;
+  return 1 + (uint32_t)((uint64_t)(time - _start - 1) * _buckets / (_end - _start - 1));
+}
+
+// Mean of the first non-empty bucket after `bucket`, read by the lead cursor
+void HistoryDownsampler::meanAfter(uint32_t bucket) {
+  HistorySample s;
+  while (_lead.peek(s) && bucketOf(s.time) <= bucket) {
+    _lead.next(s);
+  }
+  if (!_lead.peek(s)) {
+    // Nothing further (the series shrank under us): aim at the kept point
+    _avgBucket = UINT32_MAX;
+    _avgTime = _kept.time;
+    _avgTemp = _kept.temp;
+    _hasAvg = true;
+    return;
+  }
+
+  _avgBucket = bucketOf(s.time);
+  int64_t sumTime = 0;
+  int32_t sumTemp = 0;
+  uint32_t n = 0;
+  while (_lead.peek(s) && bucketOf(s.time) == _avgBucket) {
+    _lead.next(s);
+    sumTime += s.time - _start;
+    sumTemp += s.temp;
+    n++;
+  }
+  _avgTime = _start + (uint32_t)(sumTime / n);
+  _avgTemp = sumTemp / (int32_t)n;
+  _hasAvg = true;
+}
+
+void HistoryDownsampler::push(const HistorySample& s) {
+  _queue[_queued++] = s;
+  _kept = s;
+}
+
+// Emit the current bucket's winner
+void HistoryDownsampler::endBucket() {
+  push(_candidate);
+  _hasCandidate = false;
+}
+
+bool HistoryDownsampler::next(HistorySample& out) {
+  HistorySample p;
+  for (;;) {
+    if (_queueHead < _queued) {
+      out = _queue[_queueHead++];
+      return true;
+    }
+    _queued = 0;
+    _queueHead = 0;
+
+    if (!_started) {
+      _started = true;
+      if (!_main.next(p)) return false;
+      _prevState = p.state;
+      push(p);
+      continue;
+    }
+
+    if (!_main.peek(p)) {
+      if (!_hasCandidate) return false;
+      endBucket();
+      continue;
+    }
+
+    uint32_t bucket = bucketOf(p.time);
+    if (bucket != _bucket) {
+      if (_hasCandidate) endBucket();
+      _bucket = bucket;
+      continue;
+    }
+    _main.next(p);
+
+    if (p.state != _prevState || bucket > _buckets) {
+      // State boundary or the last point: always kept, after the best point
+      // found before it
+      if (_hasCandidate) endBucket();
+      push(p);
+    } else {
+      if (!_hasAvg || _avgBucket <= bucket) meanAfter(bucket);
+      // Twice the area of triangle (kept, p, next-bucket mean)
+      int64_t ax = _kept.time;
+      int64_t ay = _kept.temp;
+      int64_t area = (ax - _avgTime) * (p.temp - ay) - (ax - p.time) * (_avgTemp - ay);
+      if (area < 0) area = -area;
+      if (!_hasCandidate || area > _candidateArea) {
+        _candidate = p;
+        _candidateArea = area;
+        _hasCandidate = true;
+      }
+    }
+    _prevState = p.state;
+  }
+}
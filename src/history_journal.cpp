@@ -0,0 +1,328 @@
+#include "history_journal.h"
+
+// Critical section around the pending batch: the control task appends while
+// the loop task flushes. No-op on native builds, which are single-threaded.
+#ifdef ARDUINO_ARCH_ESP32
+#define JOURNAL_ENTER() portENTER_CRITICAL(&_mux)
+#define JOURNAL_EXIT() portEXIT_CRITICAL(&_mux)
+#else
+#define JOURNAL_ENTER() do {} while (0)
+#define JOURNAL_EXIT() do {} while (0)
+#endif
+
+static const uint8_t EVENT_PAYLOAD_BYTES = 5;
+static const uint8_t BLOCK_HEADER_BYTES = sizeof(HistoryBlock) - sizeof(HistoryBlock::data);
+static const uint8_t MAX_LISTED_SEGMENTS = 32;
+
+HistoryJournal::HistoryJournal(fs::FS& fs)
+    : _fs(fs), _segment(0), _oldestSegment(1), _segmentBytes(0),
+      _needNewSegment(true), _lastFlush(0), _pendingBlocks(0),
+      _pendingEventCount(0), _sampleIndex(0) {
+#ifdef ARDUINO_ARCH_ESP32
+  _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+  memset(&_stats, 0, sizeof(_stats));
+  memset(&_pendingLast, 0, sizeof(_pendingLast));
+}
+
+void HistoryJournal::segmentPath(uint32_t seq, char* out, size_t len) {
+  snprintf(out, len, "%s/%08X.seg", HISTORY_JOURNAL_DIR, (unsigned)seq);
+}
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+
+void HistoryJournal::begin(HistoryStore& store) {
+  if (!_fs.exists(HISTORY_JOURNAL_DIR)) {
+    _fs.mkdir(HISTORY_JOURNAL_DIR);
+  }
+
+  // Collect segment sequence numbers, sorted ascending
+  uint32_t seqs[MAX_LISTED_SEGMENTS];
+  uint8_t count = 0;
+  File dir = _fs.open(HISTORY_JOURNAL_DIR);
+  if (dir && dir.isDirectory()) {
+    File f = dir.openNextFile();
+    while (f) {
+      const char* name = f.name();
+      char* end = nullptr;
+      unsigned long seq = strtoul(name, &end, 16);
+      if (end == name + 8 && strcmp(end, ".seg") == 0 && count < MAX_LISTED_SEGMENTS) {
+        uint8_t i = count++;
+        while (i > 0 && seqs[i - 1] > seq) {
+          seqs[i] = seqs[i - 1];
+          i--;
+        }
+        seqs[i] = (uint32_t)seq;
+      }
+      f.close();
+      f = dir.openNextFile();
+    }
+    dir.close();
+  }
+
+  // Drop segments beyond the retention count (e.g. after a config change)
+  uint8_t first = 0;
+  char path[40];
+  while (count - first > HISTORY_JOURNAL_SEGMENTS) {
+    segmentPath(seqs[first++], path, sizeof(path));
+    _fs.remove(path);
+  }
+
+  bool tailOk = false;
+  for (uint8_t i = first; i < count; i++) {
+    tailOk = replaySegment(seqs[i], store);
+  }
+
+  if (count > first) {
+    _oldestSegment = seqs[first];
+    _segment = seqs[count - 1];
+    segmentPath(_segment, path, sizeof(path));
+    File tail = _fs.open(path, FILE_READ);
+    if (tail) {
+      _segmentBytes = tail.size();
+      tail.close();
+    }
+    // Keep appending to an intact tail; never after a torn one
+    _needNewSegment = !tailOk;
+  }
+
+  _lastFlush = millis();
+  Serial.printf("[HIST] Journal: recovered %u samples, %u events from %u segments (%u corrupt)\n",
+                _stats.recoveredSamples, _stats.recoveredEvents, count - first,
+                _stats.corruptRecords);
+}
+
+// Replay one segment. Returns false if it ended in a bad or torn record.
+bool HistoryJournal::replaySegment(uint32_t seq, HistoryStore& store) {
+  char path[40];
+  segmentPath(seq, path, sizeof(path));
+  File f = _fs.open(path, FILE_READ);
+  if (!f) return false;
+
+  uint8_t header[RECORD_HEADER_BYTES];
+  HistoryBlock block;
+  bool ok = true;
+
+  while (f.available() > 0) {
+    if (f.read(header, sizeof(header)) != (int)sizeof(header)) {
+      ok = false;
+      break;
+    }
+    uint8_t type = header[1];
+    uint16_t len = (uint16_t)(header[2] | (header[3] << 8));
+    uint32_t crc = (uint32_t)header[4] | ((uint32_t)header[5] << 8) |
+                   ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+    if (header[0] != RECORD_MAGIC || len > sizeof(block)) {
+      ok = false;
+      break;
+    }
+
+    memset(&block, 0, sizeof(block));
+    if (f.read((uint8_t*)&block, len) != (int)len ||
+        crc32((uint8_t*)&block, len, crc32(header + 1, 3)) != crc) {
+      ok = false;
+      break;
+    }
+
+    if (type == RECORD_SAMPLES) {
+      if (len < BLOCK_HEADER_BYTES || block.count == 0 ||
+          BLOCK_HEADER_BYTES + block.used != len) {
+        ok = false;
+        break;
+      }
+      HistoryCodec::Decoder decoder(block);
+      HistorySample s;
+      while (decoder.next(s)) {
+        store.recordSample(s);
+        _stats.recoveredSamples++;
+      }
+    } else if (type == RECORD_EVENT && len == EVENT_PAYLOAD_BYTES) {
+      const uint8_t* p = (const uint8_t*)&block;
+      uint32_t time = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                      ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+      store.recordEvent(time, p[4]);
+      _stats.recoveredEvents++;
+    } else {
+      ok = false;
+      break;
+    }
+  }
+  f.close();
+
+  if (!ok) {
+    _stats.corruptRecords++;
+    Serial.printf("[HIST] Journal: segment %08X ends in a bad record, rest ignored\n",
+                  (unsigned)seq);
+  }
+  return ok;
+}
+
+// ============================================================================
+// APPEND (control task)
+// ============================================================================
+
+void HistoryJournal::appendSample(const HistorySample& sample) {
+  JOURNAL_ENTER();
+  bool stored = false;
+  if (_pendingBlocks > 0 &&
+      HistoryCodec::append(_pending[_pendingBlocks - 1], _pendingLast, sample)) {
+    stored = true;
+  } else if (_pendingBlocks < HISTORY_JOURNAL_PENDING_BLOCKS) {
+    HistoryCodec::start(_pending[_pendingBlocks++], sample, _sampleIndex);
+    stored = true;
+  }
+  if (stored) {
+    _pendingLast = sample;
+    _sampleIndex++;
+  } else {
+    _stats.dropped++;
+  }
+  JOURNAL_EXIT();
+}
+
+void HistoryJournal::appendEvent(uint32_t time, uint8_t state) {
+  JOURNAL_ENTER();
+  if (_pendingEventCount < HISTORY_JOURNAL_PENDING_EVENTS) {
+    _pendingEvents[_pendingEventCount].time = time;
+    _pendingEvents[_pendingEventCount].state = state;
+    _pendingEventCount++;
+  } else {
+    _stats.dropped++;
+  }
+  JOURNAL_EXIT();
+}
+
+// ============================================================================
+// FLUSH (loop task)
+// ============================================================================
+
+void HistoryJournal::service() {
+  JOURNAL_ENTER();
+  bool filling = _pendingBlocks >= HISTORY_JOURNAL_PENDING_BLOCKS ||
+                 _pendingEventCount >= HISTORY_JOURNAL_PENDING_EVENTS / 2;
+  JOURNAL_EXIT();
+
+  if (filling || millis() - _lastFlush >= HISTORY_JOURNAL_FLUSH_INTERVAL) {
+    flush();
+  }
+}
+
+void HistoryJournal::flush() {
+  _lastFlush = millis();
+
+  // Serialize the batch under the lock, CRCs are filled in after
+  size_t len = 0;
+  JOURNAL_ENTER();
+  for (uint8_t i = 0; i < _pendingEventCount; i++) {
+    uint8_t payload[EVENT_PAYLOAD_BYTES];
+    uint32_t t = _pendingEvents[i].time;
+    payload[0] = (uint8_t)t;
+    payload[1] = (uint8_t)(t >> 8);
+    payload[2] = (uint8_t)(t >> 16);
+    payload[3] = (uint8_t)(t >> 24);
+    payload[4] = _pendingEvents[i].state;
+    len += putRecord(_writeBuf + len, RECORD_EVENT, payload, EVENT_PAYLOAD_BYTES);
+  }
+  for (uint8_t i = 0; i < _pendingBlocks; i++) {
+    len += putRecord(_writeBuf + len, RECORD_SAMPLES, (const uint8_t*)&_pending[i],
+                     BLOCK_HEADER_BYTES + _pending[i].used);
+  }
+  _pendingEventCount = 0;
+  _pendingBlocks = 0;
+  JOURNAL_EXIT();
+
+  if (len == 0) return;
+
+  for (size_t pos = 0; pos < len;) {
+    uint8_t* rec = _writeBuf + pos;
+    uint16_t payloadLen = (uint16_t)(rec[2] | (rec[3] << 8));
+    uint32_t crc = crc32(rec + RECORD_HEADER_BYTES, payloadLen, crc32(rec + 1, 3));
+    rec[4] = (uint8_t)crc;
+    rec[5] = (uint8_t)(crc >> 8);
+    rec[6] = (uint8_t)(crc >> 16);
+    rec[7] = (uint8_t)(crc >> 24);
+    pos += RECORD_HEADER_BYTES + payloadLen;
+  }
+
+  if (_needNewSegment || _segmentBytes + len > HISTORY_JOURNAL_SEGMENT_BYTES) {
+    if (!startSegment()) return;
+  }
+
+  char path[40];
+  segmentPath(_segment, path, sizeof(path));
+  File f = _fs.open(path, FILE_APPEND);
+  if (!f) {
+    _stats.writeErrors++;
+    _needNewSegment = true;
+    return;
+  }
+  // One write per batch: a single cluster program plus FAT/dir updates
+  size_t written = f.write(_writeBuf, len);
+  f.flush();
+  f.close();
+
+  _segmentBytes += written;
+  _stats.bytesWritten += written;
+  _stats.flushes++;
+  if (written != len) {
+    _stats.writeErrors++;
+    _needNewSegment = true;
+    Serial.printf("[HIST] Journal: short write (%u of %u bytes)\n",
+                  (unsigned)written, (unsigned)len);
+  }
+}
+
+size_t HistoryJournal::putRecord(uint8_t* out, uint8_t type, const uint8_t* payload, uint16_t len) {
+  out[0] = RECORD_MAGIC;
+  out[1] = type;
+  out[2] = (uint8_t)len;
+  out[3] = (uint8_t)(len >> 8);
+  memset(out + 4, 0, 4);
+  memcpy(out + RECORD_HEADER_BYTES, payload, len);
+  return RECORD_HEADER_BYTES + len;
+}
+
+bool HistoryJournal::startSegment() {
+  char path[40];
+  uint32_t next = _segment + 1;
+  segmentPath(next, path, sizeof(path));
+  File f = _fs.open(path, FILE_WRITE, true);
+  if (!f) {
+    _stats.writeErrors++;
+    return false;
+  }
+  f.close();
+
+  _segment = next;
+  _segmentBytes = 0;
+  _needNewSegment = false;
+  _stats.segmentsCreated++;
+
+  while (_segment - _oldestSegment + 1 > HISTORY_JOURNAL_SEGMENTS) {
+    segmentPath(_oldestSegment++, path, sizeof(path));
+    _fs.remove(path);
+  }
+  return true;
+}
+
+HistoryJournal::Stats HistoryJournal::getStats(void) {
+  JOURNAL_ENTER();
+  Stats copy = _stats;
+  JOURNAL_EXIT();
+  return copy;
+}
+
+// CRC-32 (IEEE 802.3, reflected), bitwise: runs once per flush, so the table
+// is not worth the RAM
+uint32_t HistoryJournal::crc32(const uint8_t* data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
@@ -0,0 +1,232 @@
+#include "history_store.h"
+
+HistoryStore::HistoryStore() {
+  clear();
+}
+
+void HistoryStore::clear() {
+  _blocks.clear();
+  _tier1.clear();
+  _tier2.clear();
+  _events.clear();
+  _sampleBegin.store(0, std::memory_order_relaxed);
+  _sampleEnd.store(0, std::memory_order_relaxed);
+  _latestTime.store(0, std::memory_order_relaxed);
+
+  memset(&_current, 0, sizeof(_current));
+  memset(&_last, 0, sizeof(_last));
+  _groupLen = 0;
+  _groupCount = 0;
+  _groupUsed = 0;
+  _open.write(_current);
+}
+
+void HistoryStore::recordSample(const HistorySample& sample) {
+  uint32_t index = _sampleEnd.load(std::memory_order_relaxed);
+
+  if (index % HISTORY_TIER1_FOLD == 0) {
+    _groupLen = 0;
+    _groupCount = _current.count;
+    _groupUsed = _current.used;
+  }
+
+  if (_current.count == 0) {
+    HistoryCodec::start(_current, sample, index);
+  } else if (!HistoryCodec::append(_current, _last, sample)) {
+    // Close the block where the current group began and carry the group's
+    // samples into a fresh block, so closed blocks hold whole groups
+    HistoryBlock closed = _current;
+    closed.count = _groupCount;
+    closed.used = _groupUsed;
+    closeBlock(closed);
+
+    if (_groupLen > 0) {
+      HistoryCodec::start(_current, _group[0], index - _groupLen);
+      for (uint8_t i = 1; i < _groupLen; i++) {
+        HistoryCodec::append(_current, _group[i - 1], _group[i]);
+      }
+      HistoryCodec::append(_current, _last, sample);
+    } else {
+      HistoryCodec::start(_current, sample, index);
+    }
+    _groupCount = 0;
+    _groupUsed = 0;
+  }
+
+  _group[_groupLen++] = sample;
+  _last = sample;
+
+  _open.write(_current);
+  _sampleEnd.store(index + 1, std::memory_order_release);
+  _latestTime.store(sample.time, std::memory_order_release);
+}
+
+void HistoryStore::recordEvent(uint32_t time, uint8_t state) {
+  if (_events.full()) {
+    _events.evict(1);
+  }
+  HistoryEvent e;
+  memset(&e, 0, sizeof(e));
+  e.time = time;
+  e.state = state;
+  _events.push(e);
+}
+
+// Move a finished block into the raw ring, folding the oldest block out first
+void HistoryStore::closeBlock(const HistoryBlock& block) {
+  if (_blocks.full()) {
+    HistoryBlock oldest;
+    if (_blocks.read(_blocks.begin(), oldest)) {
+      foldBlockToTier1(oldest);
+      _sampleBegin.store(oldest.first + oldest.count, std::memory_order_release);
+    }
+    _blocks.evict(1);
+  }
+  _blocks.push(block);
+}
+
+// Fold a block's samples, HISTORY_TIER1_FOLD at a time, into tier 1 buckets
+void HistoryStore::foldBlockToTier1(const HistoryBlock& block) {
+  HistoryCodec::Decoder decoder(block);
+  HistorySample s;
+  HistoryBucket b;
+  int32_t sum = 0;
+  uint8_t n = 0;
+
+  while (decoder.next(s)) {
+    if (n == 0) {
+      memset(&b, 0, sizeof(b));
+      b.time = s.time;
+      b.minTemp = s.temp;
+      b.maxTemp = s.temp;
+      sum = 0;
+    }
+    if (s.temp < b.minTemp) b.minTemp = s.temp;
+    if (s.temp > b.maxTemp) b.maxTemp = s.temp;
+    sum += s.temp;
+    b.setpoint = s.setpoint;
+    b.state = s.state;
+    if (++n == HISTORY_TIER1_FOLD) {
+      b.meanTemp = (int16_t)(sum / n);
+      pushTier1(b);
+      n = 0;
+    }
+  }
+  // Blocks hold whole groups; a short tail only follows a corrupt block
+  if (n > 0) {
+    b.meanTemp = (int16_t)(sum / n);
+    pushTier1(b);
+  }
+}
+
+void HistoryStore::pushTier1(const HistoryBucket& bucket) {
+  if (_tier1.full()) {
+    foldTier1ToTier2();
+  }
+  _tier1.push(bucket);
+}
+
+// Fold the oldest HISTORY_TIER2_FOLD tier 1 buckets into one tier 2 bucket
+void HistoryStore::foldTier1ToTier2() {
+  HistoryBucket out;
+  memset(&out, 0, sizeof(out));
+  int32_t sum = 0;
+  uint8_t n = 0;
+
+  uint32_t first = _tier1.begin();
+  for (uint32_t i = first; i < first + HISTORY_TIER2_FOLD; i++) {
+    HistoryBucket b;
+    if (!_tier1.read(i, b)) break;
+    if (n == 0) {
+      out.time = b.time;
+      out.minTemp = b.minTemp;
+      out.maxTemp = b.maxTemp;
+    }
+    if (b.minTemp < out.minTemp) out.minTemp = b.minTemp;
+    if (b.maxTemp > out.maxTemp) out.maxTemp = b.maxTemp;
+    sum += b.meanTemp;
+    out.setpoint = b.setpoint;
+    out.state = b.state;
+    n++;
+  }
+  if (n == 0) return;
+  out.meanTemp = (int16_t)(sum / n);
+
+  // Oldest tier: drop the oldest bucket outright
+  if (_tier2.full()) {
+    _tier2.evict(1);
+  }
+  _tier2.push(out);
+  _tier1.evict(n);
+}
+
+// ============================================================================
+// SAMPLE READER
+// ============================================================================
+
+HistoryStore::SampleReader::SampleReader(const HistoryStore& store)
+    : _store(store), _blockIndex(0), _next(0), _after(0), _skipping(false),
+      _active(false), _onOpen(false) {
+  memset(&_block, 0, sizeof(_block));
+}
+
+void HistoryStore::SampleReader::skipThrough(uint32_t time) {
+  _after = time;
+  _skipping = true;
+
+  // Binary search for the first closed block whose keyframe is newer than
+  // `time`; evicted blocks count as older
+  const BlockRing& ring = _store._blocks;
+  uint32_t lo = ring.begin();
+  uint32_t hi = ring.end();
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (!ring.read(mid, _block) || _block.time <= time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  // The block before it may still end with newer samples
+  _blockIndex = (lo > ring.begin()) ? lo - 1 : lo;
+}
+
+bool HistoryStore::SampleReader::next(HistorySample& out) {
+  for (;;) {
+    if (_active) {
+      while (_decoder.next(out)) {
+        uint32_t index = _decoder.index();
+        if (index < _next) continue;    // already returned from an older copy
+        _next = index + 1;
+        if (_skipping) {
+          if (out.time <= _after) continue;
+          _skipping = false;
+        }
+        return true;
+      }
+      _active = false;
+      if (_onOpen) return false;
+    }
+
+    // Closed blocks first, skipping any evicted since the last one
+    const BlockRing& ring = _store._blocks;
+    uint32_t begin = ring.begin();
+    if (_blockIndex < begin) _blockIndex = begin;
+    if (_blockIndex < ring.end()) {
+      if (ring.read(_blockIndex++, _block)) {
+        _decoder.reset(_block);
+        _active = true;
+      }
+      continue;
+    }
+
+    // Then the open block. If it starts past what we have read, a block was
+    // closed after we looked at the ring: go back for it.
+    _store._open.read(_block);
+    if (_block.count == 0) return false;
+    if (_block.first > _next && _blockIndex < ring.end()) continue;
+    _decoder.reset(_block);
+    _active = true;
+    _onOpen = true;
+  }
+}
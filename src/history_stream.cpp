@@ -0,0 +1,199 @@
+#include "history_stream.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+HistoryStream::HistoryStream(const HistoryStore& store, uint32_t now, uint32_t since,
+                             uint16_t points, bool binary)
+    : _store(store), _now(now), _since(since), _latest(store.latestTime()),
+      _points(points), _binary(binary), _reader(store),
+      _reduced(store, since, _latest, points), _phase(PHASE_HEADER), _index(0),
+      _lastBucket(0), _anyBucket(false), _first(true), _recordLen(0), _recordPos(0) {
+  // Cursor read before any record: anything recorded while streaming is newer
+  // and will be picked up by the next ?since= request
+  if (since > 0) _reader.skipThrough(since);
+}
+
+size_t HistoryStream::read(uint8_t* buf, size_t maxLen) {
+  size_t n = 0;
+  while (n < maxLen) {
+    if (_recordPos == _recordLen && !nextRecord()) break;
+    size_t take = (size_t)(_recordLen - _recordPos);
+    if (take > maxLen - n) take = maxLen - n;
+    memcpy(buf + n, _record + _recordPos, take);
+    _recordPos += (uint8_t)take;
+    n += take;
+  }
+  return n;
+}
+
+// Buckets still held in `ring` from _index on. A folded bucket is returned
+// when it ends after `since`, so a ?since= poll also gets the buckets that
+// absorbed samples around its cursor. Start times must increase, which drops
+// the overlap when a fold moves buckets from tier 1 to tier 2 mid-read.
+template <typename Ring>
+bool HistoryStream::nextBucket(const Ring& ring, uint32_t span, HistoryBucket& out) {
+  if (_index < ring.begin()) _index = ring.begin();
+  while (_index < ring.end()) {
+    if (!ring.read(_index++, out)) continue;
+    if (_since && out.time + span <= _since) continue;
+    if (_anyBucket && out.time <= _lastBucket) continue;
+    _lastBucket = out.time;
+    _anyBucket = true;
+    return true;
+  }
+  return false;
+}
+
+// Format the next record (or JSON punctuation between arrays) into _record.
+// Returns false once the body is complete.
+bool HistoryStream::nextRecord() {
+  _recordLen = 0;
+  _recordPos = 0;
+  HistoryBucket b;
+  HistorySample s;
+  HistoryEvent e;
+
+  for (;;) {
+    switch (_phase) {
+      case PHASE_HEADER:
+        if (_binary) {
+          u8('S');
+          u8('H');
+          u8(1);
+          u8(0);
+          u32(_now);
+          u32(_latest);
+        } else {
+          text("{\"now\":%u,\"latest\":%u,\"buckets\":[", (unsigned)_now, (unsigned)_latest);
+        }
+        _phase = PHASE_TIER2;
+        _index = _store.tier2().begin();
+        _first = true;
+        return true;
+
+      case PHASE_TIER2:
+        if (!_points && nextBucket(_store.tier2(), HistoryStore::tier2Interval(), b)) {
+          bucket(b, HistoryStore::tier2Interval());
+          return true;
+        }
+        _phase = PHASE_TIER1;
+        _index = _store.tier1().begin();
+        break;
+
+      case PHASE_TIER1:
+        if (!_points && nextBucket(_store.tier1(), HistoryStore::tier1Interval(), b)) {
+          bucket(b, HistoryStore::tier1Interval());
+          return true;
+        }
+        _phase = PHASE_SAMPLES;
+        _first = true;
+        if (!_binary) {
+          text("],\"samples\":[");
+          return true;
+        }
+        break;
+
+      case PHASE_SAMPLES:
+        if (_points ? _reduced.next(s) : (_reader.next(s) && s.time <= _latest)) {
+          sample(s);
+          return true;
+        }
+        _phase = PHASE_EVENTS;
+        _index = _store.events().begin();
+        _first = true;
+        if (!_binary) {
+          text("],\"events\":[");
+          return true;
+        }
+        break;
+
+      case PHASE_EVENTS:
+        if (_index < _store.events().begin()) _index = _store.events().begin();
+        while (_index < _store.events().end()) {
+          if (!_store.events().read(_index++, e)) continue;
+          if ((_since && e.time <= _since) || e.time > _latest) continue;
+          event(e);
+          return true;
+        }
+        _phase = PHASE_END;
+        break;
+
+      case PHASE_END:
+        _phase = PHASE_DONE;
+        if (!_binary) {
+          text("]}");
+          return true;
+        }
+        break;
+
+      default:
+        return false;
+    }
+  }
+}
+
+void HistoryStream::text(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(_record + _recordLen, sizeof(_record) - _recordLen, fmt, args);
+  va_end(args);
+  if (n > 0) {
+    size_t room = sizeof(_record) - 1 - _recordLen;
+    _recordLen += (uint8_t)((size_t)n < room ? (size_t)n : room);
+  }
+}
+
+void HistoryStream::u8(uint8_t v) {
+  _record[_recordLen++] = (char)v;
+}
+
+void HistoryStream::u16(uint16_t v) {
+  u8((uint8_t)v);
+  u8((uint8_t)(v >> 8));
+}
+
+void HistoryStream::u32(uint32_t v) {
+  for (uint8_t i = 0; i < 4; i++) u8((uint8_t)(v >> (8 * i)));
+}
+
+void HistoryStream::bucket(const HistoryBucket& b, uint32_t span) {
+  if (_binary) {
+    u8('B');
+    u32(b.time);
+    u16((uint16_t)span);
+    u16((uint16_t)b.minTemp);
+    u16((uint16_t)b.maxTemp);
+    u16((uint16_t)b.meanTemp);
+    u16((uint16_t)b.setpoint);
+    u8(b.state);
+    return;
+  }
+  text("%s[%u,%u,%d,%d,%d,%d,%d]", _first ? "" : ",", (unsigned)b.time, (unsigned)span,
+       b.minTemp, b.maxTemp, b.meanTemp, b.setpoint, b.state);
+  _first = false;
+}
+
+void HistoryStream::sample(const HistorySample& s) {
+  if (_binary) {
+    u8('S');
+    u32(s.time);
+    u16((uint16_t)s.temp);
+    u16((uint16_t)s.setpoint);
+    u8(s.state);
+    return;
+  }
+  text("%s[%u,%d,%d,%d]", _first ? "" : ",", (unsigned)s.time, s.temp, s.setpoint, s.state);
+  _first = false;
+}
+
+void HistoryStream::event(const HistoryEvent& e) {
+  if (_binary) {
+    u8('E');
+    u32(e.time);
+    u8(e.state);
+    return;
+  }
+  text("%s[%u,%d]", _first ? "" : ",", (unsigned)e.time, e.state);
+  _first = false;
+}
@@ -0,0 +1,316 @@
+#include "log_codec.h"
+#include <stdio.h>
+
+static const LogMessageInfo LOG_MESSAGES[LOG_MSG_COUNT] = {
+#define LOG_CATALOG_INFO(name, priority, tag, format, fields) \
+  {#name, priority, tag, format, fields},
+  LOG_CATALOG(LOG_CATALOG_INFO)
+#undef LOG_CATALOG_INFO
+};
+
+const LogMessageInfo* logMessageInfo(uint16_t id) {
+  return id < LOG_MSG_COUNT ? &LOG_MESSAGES[id] : nullptr;
+}
+
+// ============================================================================
+// ARGUMENT DECODING
+// ============================================================================
+
+static uint32_t readU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+namespace {
+
+struct Arg {
+  char code;          // 'i', 'u', 'f', 's'
+  uint32_t word;
+  const char* str;    // not terminated
+  uint8_t strLen;
+};
+
+class ArgReader {
+public:
+  ArgReader(const uint8_t* payload, size_t len) : _p(payload), _len(len), _pos(0) {}
+
+  bool next(Arg& arg) {
+    if (_pos >= _len) return false;
+    arg.code = (char)_p[_pos];
+    arg.word = 0;
+    arg.str = nullptr;
+    arg.strLen = 0;
+    if (arg.code == 's') {
+      if (_pos + 2 > _len || _pos + 2 + _p[_pos + 1] > _len) return false;
+      arg.strLen = _p[_pos + 1];
+      arg.str = (const char*)_p + _pos + 2;
+      _pos += 2 + arg.strLen;
+      return true;
+    }
+    if ((arg.code != 'i' && arg.code != 'u' && arg.code != 'f') || _pos + 5 > _len) return false;
+    arg.word = readU32(_p + _pos + 1);
+    _pos += 5;
+    return true;
+  }
+
+private:
+  const uint8_t* _p;
+  size_t _len;
+  size_t _pos;
+};
+
+// Bounded append that keeps `out` terminated
+class Out {
+public:
+  Out(char* buf, size_t size) : _buf(buf), _size(size), _len(0) {
+    if (_size) _buf[0] = '\0';
+  }
+
+  void put(const char* s, size_t n) {
+    if (_len + 1 >= _size) return;
+    if (n > _size - 1 - _len) n = _size - 1 - _len;
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+  }
+  void put(const char* s) { put(s, strlen(s)); }
+
+  // One printf conversion; `spec` is the "%...X" text with length modifiers removed
+  void convert(const char* spec, const Arg& arg) {
+    if (_len + 1 >= _size) return;
+    char conv = spec[strlen(spec) - 1];
+    int n;
+    if (arg.code == 's') {
+      char s[LOG_EVENT_MAX_STRING + 1];
+      memcpy(s, arg.str, arg.strLen);
+      s[arg.strLen] = '\0';
+      n = (conv == 's') ? snprintf(_buf + _len, _size - _len, spec, s)
+                        : snprintf(_buf + _len, _size - _len, "%s", s);
+    } else if (conv == 'f' || conv == 'e' || conv == 'g' || conv == 'E' || conv == 'G') {
+      double v;
+      if (arg.code == 'f') {
+        float f;
+        memcpy(&f, &arg.word, sizeof(f));
+        v = f;
+      } else {
+        v = (arg.code == 'i') ? (double)(int32_t)arg.word : (double)arg.word;
+      }
+      n = snprintf(_buf + _len, _size - _len, spec, v);
+    } else if (conv == 's') {
+      n = snprintf(_buf + _len, _size - _len, "?");
+    } else {
+      int32_t v = (int32_t)arg.word;
+      if (arg.code == 'f') {
+        float f;
+        memcpy(&f, &arg.word, sizeof(f));
+        v = (int32_t)f;
+      }
+      if (conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o') {
+        n = snprintf(_buf + _len, _size - _len, spec, (unsigned)v);
+      } else {
+        n = snprintf(_buf + _len, _size - _len, spec, (int)v);
+      }
+    }
+    if (n < 0) return;
+    _len += ((size_t)n < _size - _len) ? (size_t)n : _size - 1 - _len;
+  }
+
+  size_t length() const { return _len; }
+
+private:
+  char* _buf;
+  size_t _size;
+  size_t _len;
+};
+
+}  // namespace
+
+// ============================================================================
+// EXPANSION
+// ============================================================================
+
+size_t logExpand(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size) {
+  Out o(out, size);
+  const LogMessageInfo* info = logMessageInfo(id);
+  if (!info) {
+    char unknown[32];
+    snprintf(unknown, sizeof(unknown), "<unknown event %u>", (unsigned)id);
+    o.put(unknown);
+    return o.length();
+  }
+
+  ArgReader args(payload, len);
+  const char* f = info->format;
+  while (*f) {
+    const char* pct = strchr(f, '%');
+    if (!pct) {
+      o.put(f);
+      break;
+    }
+    o.put(f, (size_t)(pct - f));
+    f = pct + 1;
+    if (*f == '%') {
+      o.put("%", 1);
+      f++;
+      continue;
+    }
+
+    // Copy flags, width and precision; drop length modifiers, since every
+    // argument arrives as a 32-bit value or a double
+    char spec[16];
+    size_t n = 0;
+    spec[n++] = '%';
+    while (*f && logFormatModifier(*f)) {
+      if (*f != 'h' && *f != 'l' && *f != 'z' && *f != 'j' && *f != 't' && n < sizeof(spec) - 2) {
+        spec[n++] = *f;
+      }
+      f++;
+    }
+    if (!*f) break;
+    spec[n++] = *f++;
+    spec[n] = '\0';
+
+    Arg arg;
+    if (args.next(arg)) {
+      o.convert(spec, arg);
+    } else {
+      o.put("?", 1);    // truncated record
+    }
+  }
+  return o.length();
+}
+
+size_t logExpandLine(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size) {
+  const LogMessageInfo* info = logMessageInfo(id);
+  int n = snprintf(out, size, "[%s] ", info ? info->tag : "LOG");
+  if (n < 0 || (size_t)n + 2 >= size) return 0;
+  size_t total = (size_t)n + logExpand(id, payload, len, out + n, size - n - 1);
+  out[total++] = '\n';
+  out[total] = '\0';
+  return total;
+}
+
+static void putJsonString(Out& o, const char* s, size_t n) {
+  o.put("\"", 1);
+  for (size_t i = 0; i < n; i++) {
+    char c = s[i];
+    if (c == '"' || c == '\\') {
+      char esc[2] = {'\\', c};
+      o.put(esc, 2);
+    } else if ((uint8_t)c < 0x20) {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)(uint8_t)c);
+      o.put(esc);
+    } else {
+      o.put(&c, 1);
+    }
+  }
+  o.put("\"", 1);
+}
+
+size_t logFieldsJson(uint16_t id, const uint8_t* payload, size_t len, char* out, size_t size) {
+  Out o(out, size);
+  o.put("{", 1);
+  const LogMessageInfo* info = logMessageInfo(id);
+  const char* field = info ? info->fields : "";
+  ArgReader args(payload, len);
+  Arg arg;
+  for (unsigned i = 0; args.next(arg); i++) {
+    if (i) o.put(",", 1);
+
+    // Catalog field name, or argN past the end of the list
+    const char* end = strchr(field, ',');
+    size_t nameLen = end ? (size_t)(end - field) : strlen(field);
+    if (nameLen) {
+      putJsonString(o, field, nameLen);
+    } else {
+      char name[12];
+      snprintf(name, sizeof(name), "\"arg%u\"", i);
+      o.put(name);
+    }
+    field = end ? end + 1 : field + nameLen;
+    o.put(":", 1);
+
+    char num[24];
+    if (arg.code == 's') {
+      putJsonString(o, arg.str, arg.strLen);
+      continue;
+    } else if (arg.code == 'f') {
+      float f;
+      memcpy(&f, &arg.word, sizeof(f));
+      if (f != f || f > 3.4e38f || f < -3.4e38f) {
+        o.put("null");    // NaN / inf are not JSON
+        continue;
+      }
+      snprintf(num, sizeof(num), "%.7g", (double)f);
+    } else if (arg.code == 'i') {
+      snprintf(num, sizeof(num), "%d", (int)(int32_t)arg.word);
+    } else {
+      snprintf(num, sizeof(num), "%u", (unsigned)arg.word);
+    }
+    o.put(num);
+  }
+  o.put("}", 1);
+  return o.length();
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+static void writeU32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+LogFrameWriter::LogFrameWriter(uint8_t* buf, size_t capacity)
+    : _buf(buf), _capacity(capacity), _len(0) {
+  begin(0);
+}
+
+void LogFrameWriter::begin(uint32_t sequence) {
+  _buf[0] = 'S';
+  _buf[1] = 'L';
+  _buf[2] = LOG_FRAME_VERSION;
+  _buf[3] = 0;
+  static constexpr uint32_t CATALOG_HASH = logCatalogHash();
+  writeU32(_buf + 4, CATALOG_HASH);
+  writeU32(_buf + 8, sequence);
+  _len = LOG_FRAME_HEADER_BYTES;
+}
+
+bool LogFrameWriter::append(uint16_t id, uint32_t time, const uint8_t* payload, uint8_t len) {
+  if (_buf[3] == 0xFF || _len + LOG_FRAME_RECORD_BYTES + len > _capacity) return false;
+  uint8_t* p = _buf + _len;
+  p[0] = (uint8_t)id;
+  p[1] = (uint8_t)(id >> 8);
+  writeU32(p + 2, time);
+  p[6] = len;
+  memcpy(p + LOG_FRAME_RECORD_BYTES, payload, len);
+  _len += LOG_FRAME_RECORD_BYTES + len;
+  _buf[3]++;
+  return true;
+}
+
+LogFrameReader::LogFrameReader(const uint8_t* buf, size_t len)
+    : _buf(buf), _len(len), _pos(LOG_FRAME_HEADER_BYTES), _valid(false), _hash(0),
+      _sequence(0), _count(0) {
+  if (len < LOG_FRAME_HEADER_BYTES || buf[0] != 'S' || buf[1] != 'L' ||
+      buf[2] != LOG_FRAME_VERSION) {
+    return;
+  }
+  _count = buf[3];
+  _hash = readU32(buf + 4);
+  _sequence = readU32(buf + 8);
+  _valid = true;
+}
+
+bool LogFrameReader::next(uint16_t& id, uint32_t& time, const uint8_t*& payload, uint8_t& len) {
+  if (!_valid || _pos + LOG_FRAME_RECORD_BYTES > _len) return false;
+  const uint8_t* p = _buf + _pos;
+  if (_pos + LOG_FRAME_RECORD_BYTES + p[6] > _len) return false;
+  id = (uint16_t)(p[0] | (p[1] << 8));
+  time = readU32(p + 2);
+  len = p[6];
+  payload = p + LOG_FRAME_RECORD_BYTES;
+  _pos += LOG_FRAME_RECORD_BYTES + len;
+  return true;
+}
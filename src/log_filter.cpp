@@ -0,0 +1,205 @@
+#include "log_filter.h"
+#include <ctype.h>
+#include <stdlib.h>
+
+LogFilter::LogFilter() : _count(1) {
+#ifdef ARDUINO_ARCH_ESP32
+  _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+  memset(_names, 0, sizeof(_names));
+  memset(_custom, 0, sizeof(_custom));
+  _names[LOG_TAG_DEFAULT][0] = '*';
+  for (uint8_t t = 0; t < LOG_FILTER_MAX_TAGS; t++) {
+    for (uint8_t s = 0; s < LOG_SINK_COUNT; s++) {
+      _levels[t][s] = LOG_LEVEL_DEFAULT;
+    }
+    rebuild(t);
+  }
+}
+
+// Registration and level changes are a few table writes; a critical section
+// (not a spinlock) so a preempted holder cannot livelock a higher-priority
+// task on the same core. No-op on native builds.
+void LogFilter::lock() {
+#ifdef ARDUINO_ARCH_ESP32
+  portENTER_CRITICAL(&_mux);
+#endif
+}
+
+void LogFilter::unlock() {
+#ifdef ARDUINO_ARCH_ESP32
+  portEXIT_CRITICAL(&_mux);
+#endif
+}
+
+// ============================================================================
+// TAGS
+// ============================================================================
+
+uint8_t LogFilter::find(const char* tag, size_t len) const {
+  uint8_t count = _count.load(std::memory_order_acquire);
+  for (uint8_t t = 1; t < count; t++) {
+    if (strncmp(_names[t], tag, len) == 0 && _names[t][len] == '\0') return t;
+  }
+  return LOG_TAG_DEFAULT;
+}
+
+uint8_t LogFilter::tagIndex(const char* tag, size_t len) {
+  if (len == 0 || len >= LOG_RING_TAG_LEN) return LOG_TAG_DEFAULT;
+  if (len == 1 && tag[0] == '*') return LOG_TAG_DEFAULT;
+
+  uint8_t t = find(tag, len);
+  if (t != LOG_TAG_DEFAULT) return t;
+
+  lock();
+  t = find(tag, len);    // another task may have added it meanwhile
+  uint8_t count = _count.load(std::memory_order_relaxed);
+  if (t == LOG_TAG_DEFAULT && count < LOG_FILTER_MAX_TAGS) {
+    t = count;
+    memcpy(_names[t], tag, len);
+    _names[t][len] = '\0';
+    memcpy(_levels[t], _levels[LOG_TAG_DEFAULT], sizeof(_levels[t]));
+    rebuild(t);
+    _count.store(count + 1, std::memory_order_release);
+  }
+  unlock();
+  return t;
+}
+
+// Same parsing as the web log ring: optional leading newlines, then "[TAG]".
+// nullptr if the text has no tag.
+const char* LogFilter::parseTag(const char* text, size_t& len) {
+  while (*text == '\n') text++;
+  if (*text != '[') return nullptr;
+  text++;
+  const char* end = strchr(text, ']');
+  if (!end) return nullptr;
+  len = (size_t)(end - text);
+  if (memchr(text, '%', len)) return nullptr;    // "[%s] ..." is not a tag
+  return text;
+}
+
+uint8_t LogFilter::tagOf(const char* text) {
+  size_t len;
+  const char* tag = parseTag(text, len);
+  return tag ? tagIndex(tag, len) : LOG_TAG_DEFAULT;
+}
+
+uint8_t LogFilter::lookupTag(const char* text) const {
+  size_t len;
+  const char* tag = parseTag(text, len);
+  if (!tag || len >= LOG_RING_TAG_LEN) return LOG_TAG_DEFAULT;
+  return find(tag, len);
+}
+
+// ============================================================================
+// LEVELS
+// ============================================================================
+
+// Sink mask per priority from the per-sink levels
+void LogFilter::rebuild(uint8_t tag) {
+  for (uint8_t p = 0; p < 8; p++) {
+    uint8_t mask = 0;
+    for (uint8_t s = 0; s < LOG_SINK_COUNT; s++) {
+      if ((int8_t)p <= _levels[tag][s]) mask |= (uint8_t)(1 << s);
+    }
+    _masks[tag][p].store(mask, std::memory_order_relaxed);
+  }
+}
+
+bool LogFilter::setLevel(const char* tag, uint8_t sinkMask, int8_t level) {
+  for (const char* c = tag; *c; c++) {
+    if (!isalnum((unsigned char)*c) && *c != '_' && *c != '-' && *c != '*') return false;
+  }
+  uint8_t t = tagIndex(tag, strlen(tag));
+  bool isDefault = strcmp(tag, "*") == 0;
+  if (t == LOG_TAG_DEFAULT && !isDefault) return false;    // table full or bad name
+
+  lock();
+  for (uint8_t s = 0; s < LOG_SINK_COUNT; s++) {
+    if (sinkMask & (1 << s)) _levels[t][s] = level;
+  }
+  rebuild(t);
+  if (isDefault) {
+    uint8_t count = _count.load(std::memory_order_relaxed);
+    for (uint8_t i = 1; i < count; i++) {
+      if (_custom[i]) continue;
+      memcpy(_levels[i], _levels[LOG_TAG_DEFAULT], sizeof(_levels[i]));
+      rebuild(i);
+    }
+  } else {
+    _custom[t] = true;
+  }
+  unlock();
+  return true;
+}
+
+bool LogFilter::clearLevel(const char* tag) {
+  uint8_t t = find(tag, strlen(tag));
+  if (t == LOG_TAG_DEFAULT) return false;
+
+  lock();
+  _custom[t] = false;
+  memcpy(_levels[t], _levels[LOG_TAG_DEFAULT], sizeof(_levels[t]));
+  rebuild(t);
+  unlock();
+  return true;
+}
+
+// ============================================================================
+// NAMES
+// ============================================================================
+
+static const char* const SINK_NAMES[LOG_SINK_COUNT] = {"serial", "telnet", "syslog", "ring"};
+static const char* const LEVEL_NAMES[8] = {"emerg", "alert", "crit", "err",
+                                           "warning", "notice", "info", "debug"};
+
+const char* LogFilter::sinkName(uint8_t sink) {
+  return sink < LOG_SINK_COUNT ? SINK_NAMES[sink] : "";
+}
+
+const char* LogFilter::levelName(int8_t level) {
+  return (level >= 0 && level < 8) ? LEVEL_NAMES[level] : "off";
+}
+
+bool LogFilter::parseLevel(const char* text, int8_t& level) {
+  if (strcmp(text, "off") == 0) {
+    level = LOG_LEVEL_OFF;
+    return true;
+  }
+  if (strcmp(text, "error") == 0) text = "err";
+  if (strcmp(text, "warn") == 0) text = "warning";
+  for (int8_t i = 0; i < 8; i++) {
+    if (strcmp(text, LEVEL_NAMES[i]) == 0) {
+      level = i;
+      return true;
+    }
+  }
+  char* end;
+  long n = strtol(text, &end, 10);
+  if (end == text || *end != '\0' || n < LOG_LEVEL_OFF || n > LOG_DEBUG) return false;
+  level = (int8_t)n;
+  return true;
+}
+
+uint8_t LogFilter::parseSinks(const char* text) {
+  if (strcmp(text, "all") == 0) return LOG_SINK_ALL;
+  uint8_t mask = 0;
+  while (*text) {
+    const char* end = strchr(text, ',');
+    size_t len = end ? (size_t)(end - text) : strlen(text);
+    uint8_t s = 0;
+    while (s < LOG_SINK_COUNT &&
+           !(strncmp(text, SINK_NAMES[s], len) == 0 && SINK_NAMES[s][len] == '\0')) {
+      s++;
+    }
+    if (s == LOG_SINK_COUNT) return 0;
+    mask |= (uint8_t)(1 << s);
+    text += len;
+    if (*text == ',') text++;
+  }
+  return mask;
+}
+
+// Global filter instance
+LogFilter logFilter;
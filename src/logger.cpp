@@ -1,52 +1,119 @@
 #include "logger.h"
 #include "telnet_server.h"
+#include "crash_log.h"
 #include <WiFi.h>
 
-Logger::Logger() : _udpClient(nullptr), _syslog(nullptr), _initialized(false)
+Logger::Logger() : _udpClient(nullptr), _syslog(nullptr), _initialized(false),
+                   _folded(0), _rateLimited(0)
+#if ENABLE_LOG_QUEUE
+  , _queued(0), _written(0), _droppedReported(0), _watchedCount(0)
+#endif
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  , _syslogBatch(_syslogBuf, sizeof(_syslogBuf),
+                 SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP ? SyslogBatch::FRAMING_OCTET_COUNT
+                                                          : SyslogBatch::FRAMING_NEWLINE,
+                 SYSLOG_FACILITY, SYSLOG_DEVICE_NAME, SYSLOG_APP_NAME)
+  , _syslogSends(0), _syslogLost(0)
+#if SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP
+  , _tcpClient(nullptr), _tcpLastAttempt(0)
+#endif
+#endif
+#if ENABLE_BINARY_LOG
+  , _eventFrame(_eventBuf, sizeof(_eventBuf)), _eventFrameSeq(0)
+#endif
 #if ENABLE_LOG_RING
   , _logHead(0), _logCount(0), _logSequence(0)
 #endif
-{}
+{
+#ifdef ARDUINO_ARCH_ESP32
+  _mutex = xSemaphoreCreateRecursiveMutex();
+  _drainTask = nullptr;
+#endif
+#if ENABLE_LOG_QUEUE
+  _draining.clear();
+#endif
+#if ENABLE_LOG_RING
+  for (uint8_t i = 0; i < LOG_RING_SIZE; i++) {
+    _logSlotSeq[i].store(LOG_SLOT_WRITING, std::memory_order_relaxed);
+  }
+#endif
+}
 
 void Logger::begin() {
 #if ENABLE_SYSLOG
   // Initialize UDP client for syslog
   _udpClient = new WiFiUDP();
 
+#if ENABLE_SYSLOG_BATCH
+  // Batches are framed here and sent by flushSyslog()
+#if SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP
+  _tcpClient = new WiFiClient();
+#endif
+#else
   // Initialize syslog with server, port, device hostname, app name, and default priority
   _syslog = new Syslog(*_udpClient, SYSLOG_SERVER, SYSLOG_PORT,
                        SYSLOG_DEVICE_NAME, SYSLOG_APP_NAME, LOG_INFO);
+#endif
 
   _initialized = true;
 
   if (ENABLE_SERIAL_DEBUG) {
-    Serial.printf("[SYSLOG] Initialized - Server: %s:%d, Device: %s\n",
-                  SYSLOG_SERVER, SYSLOG_PORT, SYSLOG_DEVICE_NAME);
+    Serial.printf("[SYSLOG] Initialized - Server: %s:%d (%s), Device: %s\n", SYSLOG_SERVER,
+                  (SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP && ENABLE_SYSLOG_BATCH)
+                      ? SYSLOG_TCP_PORT : SYSLOG_PORT,
+                  (SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP && ENABLE_SYSLOG_BATCH) ? "tcp" : "udp",
+                  SYSLOG_DEVICE_NAME);
+  }
+#endif
+
+#if ENABLE_LOG_QUEUE && defined(ARDUINO_ARCH_ESP32)
+  // Until now entries were written out by whoever queued them; from here on
+  // Telnet and Syslog are live, so only the drain task touches the sinks
+  if (!_drainTask) {
+    BaseType_t ok = xTaskCreatePinnedToCore(drainTaskEntry, "log_drain",
+                                            LOG_DRAIN_TASK_STACK, this,
+                                            LOG_DRAIN_TASK_PRIORITY, &_drainTask,
+                                            LOG_DRAIN_TASK_CORE);
+    if (ok != pdPASS) {
+      _drainTask = nullptr;
+      Serial.println("[LOG] ERROR: Failed to create drain task, logging synchronously");
+    } else {
+      Serial.printf("[LOG] Drain task started on core %d (queue depth %d)\n",
+                    LOG_DRAIN_TASK_CORE, LOG_QUEUE_DEPTH);
+      xTaskNotifyGive(_drainTask);
+    }
   }
 #endif
 }
 
 void Logger::log(uint16_t priority, const char* message) {
 #if ENABLE_SYSLOG
-  if (_initialized && _syslog && WiFi.status() == WL_CONNECTED) {
-    _syslog->log(priority, message);
+  if (!(logFilter.sinks(logFilter.tagOf(message), priority) & LOG_SINK_SYSLOG)) {
+    return;
+  }
+  if (isConnected()) {
+#if ENABLE_LOG_QUEUE
+    enqueue(priority, LOG_SINK_SYSLOG, message);
+#else
+    dualLogTo(nullptr, LOG_SINK_SYSLOG, priority, "%s", message);
+#endif
   }
 #endif
 }
 
 void Logger::logf(uint16_t priority, const char* format, ...) {
 #if ENABLE_SYSLOG
-  if (!_initialized || !_syslog || WiFi.status() != WL_CONNECTED) {
+  if (!isConnected()) {
+    return;
+  }
+  if (!(logFilter.sinks(logFilter.tagOf(format), priority) & LOG_SINK_SYSLOG)) {
     return;
   }
 
-  char buffer[LOG_BUFFER_SIZE];
   va_list args;
   va_start(args, format);
-  vsnprintf(buffer, LOG_BUFFER_SIZE, format, args);
+  formatTo(nullptr, LOG_SINK_SYSLOG, priority, format, args);
   va_end(args);
-
-  _syslog->log(priority, buffer);
 #endif
 }
 
@@ -59,42 +126,489 @@ bool Logger::isConnected() {
 }
 
 void Logger::dualLog(uint16_t priority, const char* format, ...) {
-  char buffer[LOG_BUFFER_SIZE];
+  uint8_t sinks = logFilter.sinks(logFilter.tagOf(format), priority);
+  if (!sinks) return;
+
   va_list args;
+  va_start(args, format);
+  formatTo(nullptr, sinks, priority, format, args);
+  va_end(args);
+}
 
-  // Format the message once
+void Logger::dualLogTo(LogSite* site, uint8_t sinks, uint16_t priority, const char* format, ...) {
+  va_list args;
   va_start(args, format);
-  vsnprintf(buffer, LOG_BUFFER_SIZE, format, args);
+  formatTo(site, sinks, priority, format, args);
   va_end(args);
+}
 
+void Logger::formatTo(LogSite* site, uint8_t sinks, uint16_t priority, const char* format,
+                      va_list args) {
+#if ENABLE_LOG_QUEUE
+  // Format straight into a queue slot; nothing here waits on a sink
+  enqueuef(site, priority, sinks, format, args);
+#else
+  LogRecord record;
+
+  // Format the message once
+  int n = vsnprintf(record.text, sizeof(record.text), format, args);
+  if (n < 0) {
+    record.text[0] = '\0';
+    n = 0;
+  } else if ((size_t)n >= sizeof(record.text)) {
+    n = sizeof(record.text) - 1;
+  }
+  record.length = (uint16_t)n;
+  record.site = site;
+  record.event = LOG_RECORD_TEXT;
+  record.time = millis();
+  record.priority = (uint8_t)priority;
+  record.sinks = sinks;
+
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+#endif
+  writeRecord(record);
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  serviceSyslog(true);    // no drain task to send it later
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGiveRecursive(_mutex);
+#endif
+#endif
+}
+
+bool Logger::post(uint16_t priority, const char* message) {
+  // Lookup only: registering a tag takes the filter lock, which an ISR must
+  // not. A tag no call site or level change has registered follows "*".
+  uint8_t sinks = logFilter.sinks(logFilter.lookupTag(message), priority);
+  if (!sinks) return true;    // filtered, not lost
+#if ENABLE_LOG_QUEUE
+  return enqueue(priority, sinks, message);
+#else
+  dualLogTo(nullptr, sinks, priority, "%s", message);
+  return true;
+#endif
+}
+
+static_assert(LOG_EVENT_MAX_PAYLOAD <= LOG_BUFFER_SIZE, "LOG_EVENT payload must fit a LogRecord");
+
+bool Logger::postEvent(uint16_t id, LogSite* site, uint8_t sinks, const uint8_t* payload,
+                       uint8_t len) {
+  const LogMessageInfo* info = logMessageInfo(id);
+  if (!info) return false;
+
+#if ENABLE_LOG_QUEUE
+  uint32_t ticket;
+  if (!_queue.claim(ticket)) return false;    // counted by the queue
+
+  LogRecord& record = _queue.item(ticket);
+  memcpy(record.text, payload, len);
+  record.length = len;
+  record.site = site;
+  record.event = id;
+  record.time = millis();
+  record.priority = info->priority;
+  record.sinks = sinks;
+  _queue.commit(ticket);
+
+  _queued.fetch_add(1, std::memory_order_relaxed);
+  wakeDrain();
+#else
+  LogRecord record;
+  memcpy(record.text, payload, len);
+  record.length = len;
+  record.site = site;
+  record.event = id;
+  record.time = millis();
+  record.priority = info->priority;
+  record.sinks = sinks;
+
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+#endif
+  writeRecord(record);
+#if ENABLE_BINARY_LOG
+  flushEvents();
+#endif
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  serviceSyslog(true);
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGiveRecursive(_mutex);
+#endif
+#endif
+  return true;
+}
+
+// Fold repeats and report rate-limited messages for the record's call site,
+// then write the record out. Drain task (or mutex holder) only.
+void Logger::writeRecord(const LogRecord& record) {
+  if (record.site) {
+    LogSite& site = *record.site;
+    uint32_t hash = logHash(record.text, record.length,
+                            logHash(&record.event, sizeof(record.event)) ^ record.priority);
+    site.priority = record.priority;
+    site.sinks = record.sinks;
+#if ENABLE_LOG_QUEUE
+    watchSite(site);
+#endif
+    uint32_t folded;
+    if (!site.fold(hash, record.time, folded)) {
+      _folded++;
+      return;
+    }
+
+    uint32_t limited = site.limit.takeSuppressed();
+    if (folded || limited) reportSite(site, folded, limited, record.time);
+  }
+
+  if (record.event == LOG_RECORD_TEXT) {
+    writeSinks(record.priority, record.sinks, record.time, record.text);
+  } else {
+    writeEvent(record);
+  }
+}
+
+// "repeated N times" / "N suppressed" lines for a site, at its last
+// message's priority and sinks
+void Logger::reportSite(const LogSite& site, uint32_t folded, uint32_t limited, uint32_t time) {
+  uint8_t tag = site.tag.load(std::memory_order_relaxed);
+  const char* name = (tag == LOG_TAG_DEFAULT) ? "LOG" : logFilter.tagName(tag);
+  char note[80];
+  if (folded) {
+    snprintf(note, sizeof(note), "[%s] Previous message repeated %u times\n", name,
+             (unsigned)folded);
+    writeSinks(site.priority, site.sinks, time, note);
+  }
+  if (limited) {
+    _rateLimited += limited;
+    snprintf(note, sizeof(note), "[%s] %u messages suppressed by rate limit\n", name,
+             (unsigned)limited);
+    writeSinks(site.priority, site.sinks, time, note);
+  }
+}
+
+void Logger::writeSinks(uint8_t priority, uint8_t sinks, uint32_t time, const char* text) {
   // Output to Serial if enabled
-  if (ENABLE_SERIAL_DEBUG) {
-    Serial.print(buffer);
+  if (ENABLE_SERIAL_DEBUG && (sinks & LOG_SINK_SERIAL)) {
+    Serial.print(text);
   }
 
   // Output to Telnet if connected
 #if ENABLE_TELNET
-  extern TelnetServer telnetServer;
-  telnetServer.print(buffer);
+  if (sinks & LOG_SINK_TELNET) {
+    extern TelnetServer telnetServer;
+    telnetServer.print(text);
+  }
 #endif
 
   // Output to Syslog if connected
 #if ENABLE_SYSLOG
-  if (_initialized && _syslog && WiFi.status() == WL_CONNECTED) {
-    _syslog->log(priority, buffer);
+  if ((sinks & LOG_SINK_SYSLOG) && isConnected()) {
+#if ENABLE_SYSLOG_BATCH
+    writeSyslog(priority, time, text);
+#else
+    _syslog->log(priority, text);
+#endif
   }
 #endif
 
   // Append to ring buffer for web UI
 #if ENABLE_LOG_RING
-  appendToRing(priority, buffer);
+  if (sinks & LOG_SINK_RING) {
+    appendToRing(priority, time, text);
+  }
 #endif
+
+  // Same lines into the RTC crash record (no flash writes)
+#if ENABLE_CRASH_LOG
+  if (sinks & LOG_SINK_RING) {
+    crashLog.append(priority, time, text);
+  }
+#endif
+  (void)time;
 }
 
+// Expand a LOG_EVENT record for the text sinks; with ENABLE_BINARY_LOG the
+// Syslog copy goes out as a binary record instead
+void Logger::writeEvent(const LogRecord& record) {
+  uint8_t sinks = record.sinks;
+#if ENABLE_BINARY_LOG
+  if (sinks & LOG_SINK_SYSLOG) {
+    sinks &= ~LOG_SINK_SYSLOG;
+    const uint8_t* payload = (const uint8_t*)record.text;
+    uint8_t len = (uint8_t)record.length;
+    if (!_eventFrame.append(record.event, record.time, payload, len)) {
+      flushEvents();
+      _eventFrame.append(record.event, record.time, payload, len);
+    }
+  }
+#endif
+  if (!sinks) return;
+
+  char text[LOG_BUFFER_SIZE];
+  logExpandLine(record.event, (const uint8_t*)record.text, record.length, text, sizeof(text));
+  writeSinks(record.priority, sinks, record.time, text);
+}
+
+#if ENABLE_BINARY_LOG
+void Logger::flushEvents() {
+  if (_eventFrame.count() == 0) return;
+  if (_initialized && _udpClient && WiFi.status() == WL_CONNECTED) {
+    _udpClient->beginPacket(SYSLOG_SERVER, BINARY_LOG_PORT);
+    _udpClient->write(_eventFrame.data(), _eventFrame.size());
+    _udpClient->endPacket();
+  }
+  // Sequence advances even when offline so the decoder sees the gap
+  _eventFrame.begin(++_eventFrameSeq);
+}
+#endif
+
+Logger::QueueStats Logger::getQueueStats() {
+  QueueStats stats;
+  memset(&stats, 0, sizeof(stats));
+#if ENABLE_LOG_QUEUE
+  stats.queued = _queued.load(std::memory_order_relaxed);
+  stats.written = _written;
+  stats.dropped = _queue.dropped();
+  stats.highWater = _queue.highWater();
+  stats.capacity = LOG_QUEUE_DEPTH;
+#endif
+#if ENABLE_BINARY_LOG
+  stats.eventFrames = _eventFrameSeq;
+#endif
+  stats.folded = _folded;
+  stats.rateLimited = _rateLimited;
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  stats.syslogSends = _syslogSends;
+  stats.syslogLost = _syslogLost;
+#endif
+  return stats;
+}
+
+// ============================================================================
+// LOG QUEUE
+// ============================================================================
+
+#if ENABLE_LOG_QUEUE
+bool Logger::enqueue(uint16_t priority, uint8_t sinks, const char* text) {
+  uint32_t ticket;
+  if (!_queue.claim(ticket)) return false;    // counted by the queue
+
+  LogRecord& record = _queue.item(ticket);
+  size_t len = strnlen(text, sizeof(record.text) - 1);
+  memcpy(record.text, text, len);
+  record.text[len] = '\0';
+  record.length = (uint16_t)len;
+  record.site = nullptr;
+  record.event = LOG_RECORD_TEXT;
+  record.time = millis();
+  record.priority = (uint8_t)priority;
+  record.sinks = sinks;
+  _queue.commit(ticket);
+
+  _queued.fetch_add(1, std::memory_order_relaxed);
+  wakeDrain();
+  return true;
+}
+
+bool Logger::enqueuef(LogSite* site, uint16_t priority, uint8_t sinks, const char* format,
+                      va_list args) {
+  uint32_t ticket;
+  if (!_queue.claim(ticket)) return false;    // dropped before paying for vsnprintf
+
+  LogRecord& record = _queue.item(ticket);
+  int n = vsnprintf(record.text, sizeof(record.text), format, args);
+  if (n < 0) {
+    record.text[0] = '\0';
+    n = 0;
+  } else if ((size_t)n >= sizeof(record.text)) {
+    n = sizeof(record.text) - 1;
+  }
+  record.length = (uint16_t)n;
+  record.site = site;
+  record.event = LOG_RECORD_TEXT;
+  record.time = millis();
+  record.priority = (uint8_t)priority;
+  record.sinks = sinks;
+  _queue.commit(ticket);
+
+  _queued.fetch_add(1, std::memory_order_relaxed);
+  wakeDrain();
+  return true;
+}
+
+void Logger::wakeDrain() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (xPortInIsrContext()) {
+    // Never write sinks from an ISR; before begin() the entry waits for the
+    // next task-context log
+    if (_drainTask) {
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveFromISR(_drainTask, &woken);
+      if (woken) portYIELD_FROM_ISR();
+    }
+    return;
+  }
+  if (_drainTask) {
+    xTaskNotifyGive(_drainTask);
+    return;
+  }
+#endif
+  // No drain task (early boot, before Telnet/Syslog exist): write out inline
+  drainPending();
+}
+
+void Logger::drainPending() {
+  while (!_draining.test_and_set(std::memory_order_acquire)) {
+    LogRecord* record;
+    while ((record = _queue.front()) != nullptr) {
+      writeRecord(*record);
+      _queue.pop();
+      _written++;
+    }
+#if ENABLE_BINARY_LOG
+    flushEvents();
+#endif
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+    // The drain task comes back for a batch that is not due yet
+#ifdef ARDUINO_ARCH_ESP32
+    serviceSyslog(_drainTask == nullptr);
+#else
+    serviceSyslog(true);
+#endif
+#endif
+
+    flushSites(millis());
+
+    uint32_t dropped = _queue.dropped();
+    if (dropped != _droppedReported) {
+      char note[64];
+      snprintf(note, sizeof(note), "[LOG] Queue full: %u messages dropped\n",
+               (unsigned)(dropped - _droppedReported));
+      _droppedReported = dropped;
+      writeSinks(LOG_WARNING, LOG_SINK_ALL, millis(), note);
+    }
+    _draining.clear(std::memory_order_release);
+
+    // A producer that committed while we held the flag could not drain it
+    if (!_queue.ready()) break;
+  }
+}
+
+// Remember a site whose repeat or suppressed counts may need reporting after
+// its messages stop. A full list only loses the after-storm report; counts are
+// still reported ahead of the site's next message.
+void Logger::watchSite(LogSite& site) {
+  if (site.watched || _watchedCount >= LOG_SITE_WATCH) return;
+  site.watched = true;
+  _watched[_watchedCount++] = &site;
+}
+
+// Report counts of watched sites that have gone quiet, and stop watching the
+// ones that can have nothing more pending
+void Logger::flushSites(uint32_t now) {
+  uint8_t i = 0;
+  while (i < _watchedCount) {
+    LogSite& site = *_watched[i];
+    uint32_t folded, limited;
+    if (site.flush(now, folded, limited)) reportSite(site, folded, limited, now);
+    if (site.settled(now)) {
+      site.watched = false;
+      _watched[i] = _watched[--_watchedCount];
+      continue;
+    }
+    i++;
+  }
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void Logger::drainTaskEntry(void* arg) {
+  Logger* self = static_cast<Logger*>(arg);
+  for (;;) {
+    TickType_t wait = portMAX_DELAY;
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+    if (!self->_syslogBatch.empty()) wait = pdMS_TO_TICKS(SYSLOG_BATCH_FLUSH_MS);
+#endif
+    // Wake for quiet call sites even when nothing else is logged
+    if (self->_watchedCount && wait > pdMS_TO_TICKS(LOG_SITE_FLUSH_MS)) {
+      wait = pdMS_TO_TICKS(LOG_SITE_FLUSH_MS);
+    }
+    ulTaskNotifyTake(pdTRUE, wait);
+    self->drainPending();
+  }
+}
+#endif
+#endif
+
+// ============================================================================
+// SYSLOG BATCHING
+// ============================================================================
+
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+void Logger::writeSyslog(uint8_t priority, uint32_t time, const char* text) {
+  if (_syslogBatch.append(priority, text, time)) return;
+  flushSyslog();
+  if (!_syslogBatch.empty()) {
+    // Could not be sent (TCP down): make room rather than block the drain task
+    _syslogLost += _syslogBatch.count();
+    _syslogBatch.clear();
+  }
+  _syslogBatch.append(priority, text, time);
+}
+
+void Logger::serviceSyslog(bool force) {
+  if (_syslogBatch.empty()) return;
+  if (force || _syslogBatch.due(millis())) flushSyslog();
+}
+
+void Logger::flushSyslog() {
+  if (_syslogBatch.empty()) return;
+  if (sendSyslog(_syslogBatch.data(), _syslogBatch.size())) {
+    _syslogSends++;
+    _syslogBatch.clear();
+    return;
+  }
+#if SYSLOG_TRANSPORT != SYSLOG_TRANSPORT_TCP
+  // A datagram that did not go out is gone
+  _syslogLost += _syslogBatch.count();
+  _syslogBatch.clear();
+#endif
+}
+
+bool Logger::sendSyslog(const char* data, size_t len) {
+  if (WiFi.status() != WL_CONNECTED) return false;
+#if SYSLOG_TRANSPORT == SYSLOG_TRANSPORT_TCP
+  if (!_tcpClient->connected()) {
+    uint32_t now = millis();
+    if (_tcpLastAttempt && now - _tcpLastAttempt < SYSLOG_TCP_RECONNECT_MS) return false;
+    _tcpLastAttempt = now;
+    if (!_tcpClient->connect(SYSLOG_SERVER, SYSLOG_TCP_PORT, SYSLOG_TCP_CONNECT_TIMEOUT)) {
+      return false;
+    }
+    _tcpClient->setNoDelay(true);
+  }
+  // A short write leaves the receiver mid-frame: start over on a new connection
+  if (_tcpClient->write((const uint8_t*)data, len) != len) {
+    _tcpClient->stop();
+    return false;
+  }
+  return true;
+#else
+  if (!_udpClient->beginPacket(SYSLOG_SERVER, SYSLOG_PORT)) return false;
+  _udpClient->write((const uint8_t*)data, len);
+  return _udpClient->endPacket() == 1;
+#endif
+}
+#endif
+
 #if ENABLE_LOG_RING
-void Logger::appendToRing(uint8_t priority, const char* formatted) {
+void Logger::appendToRing(uint8_t priority, uint32_t time, const char* formatted) {
   LogEntry& entry = _logRing[_logHead];
-  entry.timestamp = millis() / 1000;
+  _logSlotSeq[_logHead].store(LOG_SLOT_WRITING, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.timestamp = time / 1000;
   entry.priority = priority;
   entry.sequence = _logSequence++;
 
@@ -122,13 +636,31 @@ void Logger::appendToRing(uint8_t priority, const char* formatted) {
     entry.tag[LOG_RING_TAG_LEN - 1] = '\0';
   }
 
-  // Copy message, strip trailing newlines
-  strncpy(entry.message, p, LOG_RING_MSG_LEN - 1);
-  entry.message[LOG_RING_MSG_LEN - 1] = '\0';
-  size_t mlen = strlen(entry.message);
-  while (mlen > 0 && (entry.message[mlen - 1] == '\n' || entry.message[mlen - 1] == '\r')) {
-    entry.message[--mlen] = '\0';
+  // Copy the message JSON-escaped, so readers write it out in one piece.
+  // Trailing newlines are dropped and an escape is never cut in half.
+  size_t end = strlen(p);
+  while (end > 0 && (p[end - 1] == '\n' || p[end - 1] == '\r')) end--;
+  size_t mlen = 0;
+  for (size_t i = 0; i < end; i++) {
+    char c = p[i];
+    const char* esc = nullptr;
+    if (c == '"') esc = "\\\"";
+    else if (c == '\\') esc = "\\\\";
+    else if (c == '\n') esc = "\\n";
+    else if ((unsigned char)c < 0x20) continue;
+    size_t n = esc ? 2 : 1;
+    if (mlen + n > LOG_RING_MSG_LEN - 1) break;
+    if (esc) {
+      entry.message[mlen] = esc[0];
+      entry.message[mlen + 1] = esc[1];
+    } else {
+      entry.message[mlen] = c;
+    }
+    mlen += n;
   }
+  entry.message[mlen] = '\0';
+  entry.messageLen = (uint8_t)mlen;
+  _logSlotSeq[_logHead].store(entry.sequence, std::memory_order_release);
 
   _logHead = (_logHead + 1) % LOG_RING_SIZE;
   if (_logCount < LOG_RING_SIZE) _logCount++;
@@ -149,6 +681,28 @@ const LogEntry& Logger::getLogAt(uint8_t index) {
   return _logRing[pos];
 }
 
+bool Logger::copyLogAt(uint8_t index, LogEntry& out) {
+  uint8_t pos = (uint8_t)(&getLogAt(index) - _logRing);
+  uint32_t seq = _logSlotSeq[pos].load(std::memory_order_acquire);
+  if (seq == LOG_SLOT_WRITING) return false;
+  memcpy(&out, &_logRing[pos], sizeof(out));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (_logSlotSeq[pos].load(std::memory_order_relaxed) != seq || out.sequence != seq) {
+    return false;
+  }
+  out.tag[LOG_RING_TAG_LEN - 1] = '\0';
+  if (out.messageLen >= LOG_RING_MSG_LEN) out.messageLen = LOG_RING_MSG_LEN - 1;
+  return true;
+}
+
+uint8_t Logger::firstLogAfter(uint32_t since) {
+  // Sequences in the ring are consecutive, oldest = _logSequence - _logCount
+  uint32_t oldest = _logSequence - _logCount;
+  if (since < oldest) return 0;
+  uint32_t skip = since - oldest + 1;
+  return skip < _logCount ? (uint8_t)skip : _logCount;
+}
+
 uint32_t Logger::getLatestSequence() {
   return _logSequence > 0 ? _logSequence - 1 : 0;
 }
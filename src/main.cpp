@@ -3,10 +3,15 @@
 #include <ArduinoOTA.h>
 #include <FFat.h>
 #include <ArduinoJson.h>
+#include <esp_system.h>
 #include "config.h"
 #include "max31865.h"
 #include "relay_control.h"
 #include "temperature_control.h"
+#include "control_task.h"
+#include "history_journal.h"
+#include "status_cache.h"
+#include "crash_log.h"
 #include "web_server.h"
 #include "mqtt_client.h"
 #include "tm1638_display.h"
@@ -15,29 +20,62 @@
 #include "tui_server.h"
 #include "encoder.h"
 #include "http_ota.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "wifi_link.h"
+#include "heap_monitor.h"
+#include "static_arena.h"
 
 // Global objects
 MAX31865* tempSensor = nullptr;
 RelayControl* relayControl = nullptr;
 TemperatureController* controller = nullptr;
+ControlTask* controlTask = nullptr;
+HistoryJournal* historyJournal = nullptr;
 WebServer* webServer = nullptr;
 MQTTClient* mqttClient = nullptr;
 TM1638Display* display = nullptr;
 TUIServer* tuiServer = nullptr;
 Encoder* encoder = nullptr;
 
+// The objects above live in one static block rather than on the heap, built
+// by setup() in a fixed order before WiFi starts; only their own internal
+// buffers come from the heap. A compiled-out TUI takes no room. The journal
+// is not in the block: whether it exists depends on FFat mounting, so it is
+// allocated at boot only when it does.
+static StaticArena<MAX31865, RelayControl, TemperatureController, ControlTask, TM1638Display,
+                   Encoder, ArenaOptional<ENABLE_TUI, TUIServer>, WebServer, MQTTClient> arena;
+
 // Helper function to log to Serial, Syslog, Telnet, and web ring buffer
-void logMessage(uint16_t priority, const char* tag, const char* format, ...) {
+static void vlogMessage(uint8_t sinks, uint16_t priority, const char* tag, const char* format,
+                        va_list args) {
+  // Filter by tag before paying for the format
+  sinks &= logFilter.sinks(logFilter.tagIndex(tag, strlen(tag)), priority);
+  if (!sinks) return;
+
   char buffer[LOG_BUFFER_SIZE];
-  va_list args;
+  vsnprintf(buffer, LOG_BUFFER_SIZE, format, args);
 
-  // Format the message
+  // Use dualLog which handles Serial + Syslog + Telnet + Ring Buffer
+  logger.dualLogTo(nullptr, sinks, priority, "[%s] %s\n", tag, buffer);
+}
+
+void logMessage(uint16_t priority, const char* tag, const char* format, ...) {
+  va_list args;
   va_start(args, format);
-  vsnprintf(buffer, LOG_BUFFER_SIZE, format, args);
+  vlogMessage(LOG_SINK_ALL, priority, tag, format, args);
   va_end(args);
+}
 
-  // Use dualLog which handles Serial + Syslog + Telnet + Ring Buffer
-  logger.dualLog(priority, "[%s] %s\n", tag, buffer);
+// Periodic status lines stay out of the web log ring: at one batch every 10 s
+// they would push out the events worth keeping within minutes
+#define LOG_SINK_PERIODIC (LOG_SINK_ALL & ~LOG_SINK_RING)
+
+static void logPeriodic(const char* tag, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vlogMessage(LOG_SINK_PERIODIC, LOG_INFO, tag, format, args);
+  va_end(args);
 }
 
 // Network configuration
@@ -46,66 +84,99 @@ String wifiPassword = WIFI_PASS;
 String mqttBroker = MQTT_BROKER_HOST;
 uint16_t mqttPort = MQTT_BROKER_PORT;
 
-// Timing variables
-unsigned long lastStatusPrint = 0;
-unsigned long lastWiFiCheck = 0;
+bool fileSystemMounted = false;
 
 // ============================================================================
 // WIFI FUNCTIONS
 // ============================================================================
 
-void initializeWiFi() {
-  // Try to load saved WiFi credentials
-  // For now, fall back to AP mode
-
-  Serial.println("\n[WIFI] Starting WiFi...");
-
-  if (wifiSSID.length() > 0 && wifiPassword.length() > 0) {
-    // Connect to saved network
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-
-    Serial.printf("[WIFI] Connecting to %s...\n", wifiSSID.c_str());
+// Station/AP state machine. The WiFi event task feeds it events and loop()
+// polls it for actions, so every call is made under wifiMux.
+static WiFiLink wifiLink;
+static portMUX_TYPE wifiMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Runs in the WiFi event task; the actions it leads to are taken in loop()
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  uint32_t now = millis();
+  portENTER_CRITICAL(&wifiMux);
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    wifiLink.onGotIp(now);
+  } else if (event == ARDUINO_EVENT_WIFI_STA_LOST_IP ||
+             (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+              info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE)) {
+    // ASSOC_LEAVE is our own disconnect, not a failed attempt
+    wifiLink.onDisconnected(now);
+  }
+  portEXIT_CRITICAL(&wifiMux);
+}
 
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-      delay(500);
-      Serial.print(".");
-      attempts++;
+// Takes the link's pending actions and logs state changes. Returns true
+// once the network is usable: the station has an IP or the AP is open.
+bool serviceWiFi() {
+  WiFiLink::Action action;
+  WiFiLink::State state;
+  bool apActive;
+  uint32_t attempts;
+  uint32_t retryAt;
+  do {
+    portENTER_CRITICAL(&wifiMux);
+    action = wifiLink.update(millis());
+    state = wifiLink.state();
+    apActive = wifiLink.apActive();
+    attempts = wifiLink.attempts();
+    retryAt = wifiLink.retryAt();
+    portEXIT_CRITICAL(&wifiMux);
+
+    switch (action) {
+      case WiFiLink::ACTION_CONNECT:
+        Serial.printf("[WIFI] Connecting to %s (attempt %u)...\n", wifiSSID.c_str(), attempts);
+        WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
+        break;
+      case WiFiLink::ACTION_START_AP:
+        // With credentials the station keeps retrying alongside the AP
+        WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASS);
+        logMessage(LOG_WARNING, "WIFI", "AP Mode - SSID: %s, IP: %s", WIFI_AP_SSID,
+                   WiFi.softAPIP().toString().c_str());
+        break;
+      case WiFiLink::ACTION_STOP_AP:
+        WiFi.softAPdisconnect(true);
+        logMessage(LOG_INFO, "WIFI", "Station connected, AP closed");
+        break;
+      case WiFiLink::ACTION_NONE:
+        break;
     }
-
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.printf("\n[WIFI] Connected! IP: %s\n", WiFi.localIP().toString().c_str());
-    } else {
-      Serial.println("\n[WIFI] Connection failed, starting AP mode");
-      WiFi.mode(WIFI_AP);
-      WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASS);
-      Serial.printf("[WIFI] AP Mode - SSID: %s, IP: %s\n", WIFI_AP_SSID,
-                    WiFi.softAPIP().toString().c_str());
+  } while (action != WiFiLink::ACTION_NONE);
+
+  static WiFiLink::State lastState = WiFiLink::LINK_OFF;
+  if (state != lastState) {
+    if (state == WiFiLink::LINK_UP) {
+      logMessage(LOG_INFO, "WIFI", "Connected! IP: %s, %lu ms after boot",
+                 WiFi.localIP().toString().c_str(), millis());
+    } else if (state == WiFiLink::LINK_BACKOFF) {
+      logMessage(LOG_WARNING, "WIFI", "%s, retrying in %u ms",
+                 lastState == WiFiLink::LINK_UP ? "Connection lost" : "Connection failed",
+                 (unsigned)(retryAt - millis()));
     }
-  } else {
-    // Start in AP mode
-    WiFi.mode(WIFI_AP);
-    WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASS);
-    Serial.printf("[WIFI] AP Mode - SSID: %s, Pass: %s, IP: %s\n",
-                  WIFI_AP_SSID, WIFI_AP_PASS,
-                  WiFi.softAPIP().toString().c_str());
+    lastState = state;
   }
+
+  return state == WiFiLink::LINK_UP || apActive;
 }
 
-void checkWiFiConnection() {
-  static unsigned long lastCheck = 0;
-  unsigned long now = millis();
+// Starts the radio and returns at once; serviceWiFi() does the rest
+void initializeWiFi() {
+  bool haveCredentials = wifiSSID.length() > 0 && wifiPassword.length() > 0;
 
-  if (now - lastCheck < 10000)
-    return; // Check every 10 seconds
+  WiFi.onEvent(onWiFiEvent);
+  WiFi.setAutoReconnect(false);    // WiFiLink decides when to retry
+  WiFi.mode(haveCredentials ? WIFI_STA : WIFI_AP);
 
-  lastCheck = now;
+  portENTER_CRITICAL(&wifiMux);
+  wifiLink.begin(millis(), haveCredentials);
+  portEXIT_CRITICAL(&wifiMux);
 
-  if (WiFi.getMode() == WIFI_STA && WiFi.status() != WL_CONNECTED) {
-    Serial.println("[WIFI] Connection lost, reconnecting...");
-    WiFi.reconnect();
-  }
+  Serial.println("\n[WIFI] Starting WiFi in the background...");
+  serviceWiFi();
 }
 
 // ============================================================================
@@ -116,6 +187,7 @@ void initializeFileSystem() {
   if (!FFat.begin(true)) {  // true = format on fail
     Serial.println("[FS] Failed to initialize FFat file system");
   } else {
+    fileSystemMounted = true;
     Serial.printf("[FS] FFat initialized - %u KB used / %u KB total\n",
                   FFat.usedBytes() / 1024, FFat.totalBytes() / 1024);
     // List files for debugging
@@ -200,7 +272,7 @@ void handleEncoder() {
   if (!encoder || !controller) return;
   if (!encoder->isConnected()) return;
 
-  if (!encoder->update()) return;
+  if (!encoder->poll()) return;
 
   // Handle rotation: adjust setpoint
   int8_t clicks = encoder->getIncrement();
@@ -270,6 +342,9 @@ void initializeOTA() {
     if (controller) {
       controller->shutdown();
     }
+    if (historyJournal) {
+      historyJournal->flush();
+    }
   });
 
   ArduinoOTA.onEnd([]() {
@@ -300,26 +375,427 @@ bool isOtaUpdateSafe() {
   return (state == STATE_IDLE || state == STATE_SHUTDOWN || state == STATE_ERROR);
 }
 
+// ============================================================================
+// SCHEDULED JOBS
+// ============================================================================
+
+static uint32_t schedulerClock() { return micros(); }
+static Scheduler scheduler(schedulerClock);
+
+// Job priorities, most urgent first. They only order jobs that are due in
+// the same pass; deadlines decide everything else.
+enum : uint8_t {
+  PRIO_CONTROL,       // control tick without the control task
+  PRIO_INPUT,         // encoder, display buttons
+  PRIO_NETWORK,       // WiFi link, OTA, telnet, MQTT client housekeeping
+  PRIO_STATUS,        // status cache, history flush, event stream
+  PRIO_PUBLISH,       // MQTT publishes, TUI frames
+  PRIO_BACKGROUND     // HTTP OTA, heartbeat, heap samples, reports
+};
+
+// Run MAX31865 hardware diagnostic once, CONTROL_DIAG_DELAY after boot (USB
+// CDC is connected by then). The control task does this itself when running.
+static void jobDiagnostic() {
+  if (!tempSensor) return;
+  Serial.println("\n*** RUNNING DEFERRED MAX31865 HARDWARE DIAGNOSTIC ***");
+  tempSensor->runHardwareDiagnostic();
+  // Re-initialize sensor for normal operation after diagnostic
+  Serial.println("*** RE-INITIALIZING MAX31865 FOR NORMAL OPERATION ***");
+  tempSensor->begin(MAX31865::THREE_WIRE);
+}
+
+// Temperature control loop (only when not running in its own task)
+static uint32_t loopFirstTickUs = 0;
+static uint32_t setupDoneMs = 0;
+
+static void jobControl() {
+  PROFILE_STAGE(LoopProfiler::STAGE_CONTROL);
+  HEAP_TAG(HeapTracer::TAG_CONTROL);
+  if (!loopFirstTickUs) loopFirstTickUs = micros();
+  controller->tick();
+}
+
+// Network housekeeping that must run often: OTA, telnet and MQTT clients
+static void jobNetwork() {
+  {
+    PROFILE_STAGE(LoopProfiler::STAGE_OTA);
+    HEAP_TAG(HeapTracer::TAG_OTA);
+    ArduinoOTA.handle();
+  }
+  {
+    PROFILE_STAGE(LoopProfiler::STAGE_TELNET);
+    HEAP_TAG(HeapTracer::TAG_TELNET);
+    telnetServer.loop();
+  }
+  if (tuiServer) {
+    PROFILE_STAGE(LoopProfiler::STAGE_TUI);
+    HEAP_TAG(HeapTracer::TAG_TUI);
+    tuiServer->poll();
+  }
+  {
+    PROFILE_STAGE(LoopProfiler::STAGE_MQTT);
+    HEAP_TAG(HeapTracer::TAG_MQTT);
+    mqttClient->poll();
+  }
+}
+
+static void jobStatus() {
+  // Format the latest status once for the web UI, event stream, MQTT and TUI
+  {
+    PROFILE_STAGE(LoopProfiler::STAGE_STATUS);
+    HEAP_TAG(HeapTracer::TAG_STATUS);
+    statusCache.refresh(*controller, ESP.getFreeHeap());
+  }
+
+  // Write batched history to flash (at most once per flush interval)
+  if (historyJournal) {
+    PROFILE_STAGE(LoopProfiler::STAGE_HISTORY);
+    HEAP_TAG(HeapTracer::TAG_HISTORY);
+    historyJournal->service();
+  }
+
+  // Push status/history/log frames to /api/events subscribers
+  if (webServer) {
+    PROFILE_STAGE(LoopProfiler::STAGE_EVENTS);
+    HEAP_TAG(HeapTracer::TAG_WEB);
+    webServer->publishEvents();
+  }
+}
+
+static void jobMqttStatus() {
+  PROFILE_STAGE(LoopProfiler::STAGE_MQTT);
+  HEAP_TAG(HeapTracer::TAG_MQTT);
+  mqttClient->publishStatus();
+}
+
+static void jobMqttTelemetry() {
+  PROFILE_STAGE(LoopProfiler::STAGE_MQTT);
+  HEAP_TAG(HeapTracer::TAG_MQTT);
+  mqttClient->publishTelemetry();
+}
+
+static void jobTui() {
+  PROFILE_STAGE(LoopProfiler::STAGE_TUI);
+  HEAP_TAG(HeapTracer::TAG_TUI);
+  tuiServer->render();
+}
+
+static void jobDisplay() {
+  PROFILE_STAGE(LoopProfiler::STAGE_DISPLAY);
+  auto snap = controller->getSnapshot();
+  const auto& status = snap.status;
+
+  // Update temperature displays
+  display->setCurrentTemp(status.currentTemp);
+  display->setTargetTemp(status.setpoint);
+
+  // Update relay status LEDs
+  display->setRelayLEDs(status.auger, status.fan, status.igniter);
+
+  // Update status LEDs
+  bool wifiConnected = (WiFi.status() == WL_CONNECTED);
+  bool mqttConnected = mqttClient && mqttClient->isConnected();
+  bool isError = (status.state == STATE_ERROR);
+  bool isRunning = (status.state == STATE_RUNNING ||
+                    status.state == STATE_STARTUP);
+  display->setStatusLEDs(wifiConnected, mqttConnected, isError, isRunning);
+  display->update();
+
+  // Handle button presses
+  handleDisplayButtons();
+}
+
+static void jobEncoder() {
+  PROFILE_STAGE(LoopProfiler::STAGE_ENCODER);
+  handleEncoder();
+}
+
+
+// HTTP OTA update checks (pull-based from GitHub) on its own timers
+static void jobHttpOta() {
+  PROFILE_STAGE(LoopProfiler::STAGE_HTTP_OTA);
+  HEAP_TAG(HeapTracer::TAG_OTA);
+  httpOTA.update();
+  if (httpOTA.isUpdateRequested()) {
+    httpOTA.clearUpdateRequest();
+    if (historyJournal) historyJournal->flush();
+    httpOTA.performUpdate();
+  }
+}
+
+// Built-in LED and TM1638 LED 8 blink once a second
+static void jobHeartbeat() {
+  static bool heartbeatState = false;
+  heartbeatState = !heartbeatState;
+  digitalWrite(PIN_LED_STATUS, heartbeatState);
+  if (display) display->setLED(LED_8, heartbeatState);
+}
+
+// Heap low-water marks for telemetry, /api/perf/heap and the report
+static void jobHeap() {
+  heapMonitor.sample(HeapMonitor::read(), millis());
+}
+
+// Periodic status print (debugging)
+static void jobReport() {
+  auto snap = controller->getSnapshot();
+  const auto& status = snap.status;
+  const char* stateName = TemperatureController::stateName(status.state);
+  Serial.printf(
+      "[STATUS] Temp: %.1f°F | Setpoint: %.1f°F | State: %s | "
+      "Auger: %s | Fan: %s | MQTT: %s | Heap: %u/%u\n",
+      status.currentTemp, status.setpoint,
+      stateName, status.auger ? "ON" : "OFF",
+      status.fan ? "ON" : "OFF",
+      mqttClient && mqttClient->isConnected() ? "Connected" : "Offline",
+      ESP.getFreeHeap(), ESP.getMinFreeHeap());
+
+  // Also send to syslog
+  LOG_EVENT_TO(LOG_SINK_PERIODIC, STATUS, status.currentTemp, status.setpoint, stateName,
+               status.auger ? "ON" : "OFF", status.fan ? "ON" : "OFF");
+
+  if (controlTask) {
+    auto ct = controlTask->getStats();
+    logPeriodic("CTRL",
+                "Cycles: %u | Jitter: last %dus, min %dus, max %dus, mean |%u|us | "
+                "Exec: last %uus, max %uus | Overruns: %u | Stack free: %u",
+                ct.cycles, ct.lastJitterUs, ct.minJitterUs, ct.maxJitterUs,
+                ct.meanAbsJitterUs, ct.lastExecUs, ct.maxExecUs, ct.overruns,
+                ct.stackHighWater);
+  }
+
+#if ENABLE_PROFILER
+  const ProfileHistogram& lp = loopProfiler.stage(LoopProfiler::STAGE_LOOP);
+  logPeriodic("PERF", "Loop: p50 %uus, p99 %uus, max %uus | Tick jitter: min %dus, max %dus",
+              lp.percentile(50), lp.percentile(99), lp.maxUs, loopProfiler.minJitterUs(),
+              loopProfiler.maxJitterUs());
+#endif
+
+  const HeapMonitor::Stats& hs = heapMonitor.getStats();
+  logPeriodic("HEAP", "Free: %u, min %u | Largest block: %u, min %u at %u s | "
+              "Fragmentation: %u%%, max %u%% | Blocks: %u used, %u free",
+              hs.last.freeBytes, hs.last.minFreeBytes, hs.last.largestBlock,
+              hs.minLargestBlock, hs.minLargestAt / 1000, hs.fragmentation,
+              hs.maxFragmentation, hs.last.allocatedBlocks, hs.last.freeBlocks);
+#if ENABLE_HEAP_TRACE
+  {
+    // Live bytes per subsystem, the ones holding any
+    HeapTracer::Snapshot tr = heapTracer.snapshot();
+    char line[LOG_BUFFER_SIZE];
+    size_t len = 0;
+    for (uint8_t t = 0; t < HeapTracer::TAG_COUNT && len < sizeof(line); t++) {
+      const HeapTracer::TagStats& ts = tr.tags[t];
+      if (!ts.liveBlocks) continue;
+      len += snprintf(line + len, sizeof(line) - len, "%s%s %u/%u", len ? ", " : "",
+                      HeapTracer::tagName((HeapTracer::Tag)t), ts.liveBytes, ts.liveBlocks);
+    }
+    logPeriodic("HEAP", "Live bytes/blocks: %s | %u dropped, %u untracked frees",
+                len ? line : "none", tr.stats.dropped, tr.stats.untrackedFrees);
+  }
+#endif
+
+  if (historyJournal) {
+    auto js = historyJournal->getStats();
+    logPeriodic("HIST",
+                "Journal: %u flushes, %u bytes, %u segments | Errors: %u | Dropped: %u",
+                js.flushes, js.bytesWritten, js.segmentsCreated, js.writeErrors,
+                js.dropped);
+  }
+
+  if (ENABLE_EVENT_STREAM && webServer) {
+    auto es = webServer->getEventStats();
+    logPeriodic("WEB", "Events: %u clients | %u frames | %u coalesced | %u refused",
+                es.clients, es.frames, es.coalesced, es.rejected);
+  }
+
+  if (display) {
+    auto ds = display->getBusStats();
+    logPeriodic("TM1638", "Bus: %u transactions sent | %u saved", ds.sent, ds.saved);
+  }
+
+  if (ENABLE_LOG_QUEUE) {
+    auto lq = logger.getQueueStats();
+    logPeriodic("LOG", "Queue: %u queued | %u written | %u dropped | peak %u/%u | "
+                "%u folded | %u rate-limited | syslog %u sends, %u lost",
+                lq.queued, lq.written, lq.dropped, lq.highWater, lq.capacity,
+                lq.folded, lq.rateLimited, lq.syslogSends, lq.syslogLost);
+  }
+
+  // Scheduler load over the last report interval, and any job that fell a
+  // period behind since the previous report
+  static uint64_t lastBusyUs = 0;
+  static uint32_t lastReportUs = micros();
+  static uint32_t reportedOverruns[SCHED_MAX_JOBS] = {};
+  auto ss = scheduler.getStats();
+  uint32_t now = micros();
+  uint32_t windowUs = now - lastReportUs;
+  float load = windowUs ? 100.0f * (float)(ss.busyUs - lastBusyUs) / windowUs : 0.0f;
+  lastBusyUs = ss.busyUs;
+  lastReportUs = now;
+  logPeriodic("SCHED", "Load: %.1f%% | %u passes, %u idle | %u runs | %u overruns",
+              load, ss.passes, ss.idlePasses, ss.runs, ss.overruns);
+  for (uint8_t id = 0; id < scheduler.jobCount(); id++) {
+    const Scheduler::JobStats& js = scheduler.jobStats(id);
+    if (js.overruns == reportedOverruns[id]) continue;
+    logPeriodic("SCHED", "%s: %u overruns (+%u) | Late: max %uus | Exec: last %uus, max %uus",
+                js.name, js.overruns, js.overruns - reportedOverruns[id], js.maxLateUs,
+                js.lastExecUs, js.maxExecUs);
+    reportedOverruns[id] = js.overruns;
+  }
+}
+
+// Time from boot to the first control tick, how long setup() took and when
+// the network came up. Runs once, in the first loop() pass.
+static void jobBootReport() {
+  uint32_t firstTickUs = controlTask ? controlTask->getStats().firstTickUs : loopFirstTickUs;
+  logMessage(LOG_INFO, "BOOT", "First control tick %u ms after boot | setup() done at %u ms | "
+             "network %s", firstTickUs / 1000, setupDoneMs,
+             wifiLink.state() == WiFiLink::LINK_UP ? "up" : "still connecting");
+}
+
+// Jobs that need the network; added once it is up
+static void scheduleNetworkJobs() {
+  scheduler.addJob("network", jobNetwork, SCHED_POLL_INTERVAL, PRIO_NETWORK);
+  scheduler.addJob("mqtt_status", jobMqttStatus, MQTT_STATUS_INTERVAL, PRIO_PUBLISH,
+                   MQTT_STATUS_INTERVAL);
+  scheduler.addJob("mqtt_telemetry", jobMqttTelemetry, MQTT_TELEMETRY_INTERVAL, PRIO_PUBLISH,
+                   MQTT_TELEMETRY_INTERVAL);
+  if (tuiServer) scheduler.addJob("tui", jobTui, TUI_UPDATE_INTERVAL, PRIO_PUBLISH);
+  scheduler.addJob("http_ota", jobHttpOta, HTTP_OTA_POLL_INTERVAL, PRIO_BACKGROUND);
+}
+
+// Everything that listens on or connects to the network, started on the
+// first IP (or when the AP opens) rather than waited for in setup()
+static void startNetworkServices() {
+  HEAP_TAG(HeapTracer::TAG_SETUP);
+
+  // Initialize Telnet Server
+  telnetServer.begin();
+
+  // Initialize TUI Server
+  if (tuiServer) {
+    tuiServer->begin(TUI_PORT);
+    Serial.printf("[SETUP] TUI server started on port %d\n", TUI_PORT);
+  }
+
+  // Initialize OTA updates
+  initializeOTA();
+
+  // Initialize HTTP OTA (pull-based updates from GitHub Releases)
+  httpOTA.setSafetyCheck(isOtaUpdateSafe);
+  httpOTA.begin();
+
+  // Web Server
+  webServer->begin();
+  Serial.printf("[SETUP] Web server started on port %d\n", WEB_SERVER_PORT);
+
+  // MQTT Client
+  mqttClient->begin(MQTT_CLIENT_ID);
+  Serial.printf("[SETUP] MQTT client initialized\n");
+
+  scheduleNetworkJobs();
+  logMessage(LOG_INFO, "SETUP", "Network services started %lu ms after boot", millis());
+}
+
+// Link management; network services start the first time it is usable
+static void jobWiFi() {
+  PROFILE_STAGE(LoopProfiler::STAGE_WIFI);
+  HEAP_TAG(HeapTracer::TAG_NET);
+  static bool servicesStarted = false;
+  if (serviceWiFi() && !servicesStarted) {
+    servicesStarted = true;
+    startNetworkServices();
+  }
+}
+
+// Periods come from the modules' own intervals; each job runs on its
+// deadline and loop() sleeps until the next one
+static void scheduleJobs() {
+  if (!controlTask) {
+    scheduler.addJob("control", jobControl, TEMP_CONTROL_INTERVAL, PRIO_CONTROL);
+    uint32_t sinceBoot = millis();
+    scheduler.addJob("diagnostic", jobDiagnostic, 0, PRIO_BACKGROUND,
+                     sinceBoot < CONTROL_DIAG_DELAY ? CONTROL_DIAG_DELAY - sinceBoot : 0);
+  }
+  scheduler.addJob("boot_report", jobBootReport, 0, PRIO_BACKGROUND);
+  scheduler.addJob("status", jobStatus, SCHED_STATUS_INTERVAL, PRIO_STATUS);
+  if (display) scheduler.addJob("display", jobDisplay, TM1638_REFRESH_MS, PRIO_INPUT);
+  if (encoder && encoder->isConnected()) {
+    scheduler.addJob("encoder", jobEncoder, ENCODER_POLL_INTERVAL, PRIO_INPUT);
+  }
+  scheduler.addJob("wifi", jobWiFi, WIFI_POLL_INTERVAL, PRIO_NETWORK);
+  scheduler.addJob("heartbeat", jobHeartbeat, SCHED_HEARTBEAT_INTERVAL, PRIO_BACKGROUND);
+  scheduler.addJob("heap", jobHeap, HEAP_SAMPLE_INTERVAL, PRIO_BACKGROUND);
+  if (ENABLE_SERIAL_DEBUG) {
+    scheduler.addJob("report", jobReport, SCHED_REPORT_INTERVAL, PRIO_BACKGROUND,
+                     SCHED_REPORT_INTERVAL);
+  }
+  scheduler.resetStats();
+}
+
+// ============================================================================
+// RAM MAP
+// ============================================================================
+
+// Section bounds from the ESP-IDF linker script
+extern "C" uint8_t _data_start, _data_end, _bss_start, _bss_end;
+
+// Where internal RAM went once the singletons are built and before WiFi
+// takes its share: static sections, the arena object by object, and the heap
+static void reportRamMap() {
+  HeapReading heap = HeapMonitor::read();
+  Serial.printf("[RAM] .data %u B | .bss %u B | heap %u B free of %u, largest block %u B\n",
+                (unsigned)(&_data_end - &_data_start), (unsigned)(&_bss_end - &_bss_start),
+                heap.freeBytes, heap.totalBytes, heap.largestBlock);
+  Serial.printf("[RAM] Arena at %p: %u of %u B, in .bss\n", arena.base(),
+                (unsigned)arena.used(), (unsigned)decltype(arena)::CAPACITY);
+  for (uint8_t i = 0; i < arena.count(); i++) {
+    const auto& e = arena.entry(i);
+    Serial.printf("[RAM]   +%-6u %-22s %6u B\n", (unsigned)e.offset, e.name, (unsigned)e.size);
+  }
+  if (historyJournal) {
+    Serial.printf("[RAM] HistoryJournal %u B, on the heap\n", (unsigned)sizeof(HistoryJournal));
+  }
+}
+
 // ============================================================================
 // SETUP
 // ============================================================================
 
 void setup() {
+  // Take over what the previous boot left in RTC memory before anything logs
+#if ENABLE_CRASH_LOG
+  crashLog.begin((uint8_t)esp_reset_reason());
+#endif
+#if ENABLE_PROFILER
+  loopProfiler.setCpuMHz(ESP.getCpuFreqMHz());
+#endif
+#if ENABLE_HEAP_TRACE
+  // Charge what setup() allocates to "setup"; loop() scopes tag the rest
+  heapTracer.setLoopTag(HeapTracer::TAG_SETUP);
+  heapTracer.start();
+#endif
+
   // Initialize Serial
   Serial.begin(SERIAL_BAUD_RATE);
   // ESP32-S3 native USB CDC: prevent indefinite blocking on full TX buffer.
   // 100ms is safe (WDT is 5s) and avoids silent data loss from timeout=0.
   Serial.setTxTimeoutMs(100);
-  // Wait for USB CDC connection (up to 5 seconds) so boot messages are captured
+  // Optionally wait for a USB CDC host so boot messages are captured; by
+  // default boot goes straight on and the control task starts at once
   unsigned long serialWait = millis();
-  while (!Serial && millis() - serialWait < 5000) delay(10);
-  delay(500); // Extra settle time after USB enumerates
+  while (SERIAL_BOOT_WAIT_MS && !Serial && millis() - serialWait < SERIAL_BOOT_WAIT_MS) delay(10);
 
   Serial.println("\n\n========================================");
   Serial.println("  ESP32 Wood Pellet Smoker Controller");
   Serial.printf("  Version: %s\n", FIRMWARE_VERSION);
   Serial.printf("  Build: %s\n", FIRMWARE_BUILD);
   Serial.println("========================================\n");
+#if ENABLE_CRASH_LOG
+  Serial.printf("[SETUP] Reset reason: %s (boot %u)%s\n",
+                CrashLog::resetReasonName(crashLog.resetReason()), crashLog.bootCount(),
+                crashLog.hasReport() ? ", previous boot at /api/crashlog" : "");
+#endif
 
   // Initialize file system
   initializeFileSystem();
@@ -328,8 +804,8 @@ void setup() {
   Serial.println("[SETUP] Initializing hardware...");
 
   // Temperature Sensor (MAX31865)
-  tempSensor = new MAX31865(PIN_MAX31865_CS, MAX31865_REFERENCE_RESISTANCE,
-                            MAX31865_RTD_RESISTANCE_AT_0);
+  tempSensor = arena.make<MAX31865>("MAX31865", PIN_MAX31865_CS,
+                                   MAX31865_REFERENCE_RESISTANCE, MAX31865_RTD_RESISTANCE_AT_0);
   if (!tempSensor->begin(MAX31865::THREE_WIRE)) {
     Serial.println("[SETUP] WARNING: MAX31865 initialization failed!");
   } else {
@@ -337,65 +813,81 @@ void setup() {
   }
 
   // Relay Control
-  relayControl = new RelayControl();
+  relayControl = arena.make<RelayControl>("RelayControl");
   relayControl->begin();
   Serial.println("[SETUP] Relay control initialized");
 
   // Temperature Controller
-  controller = new TemperatureController(tempSensor, relayControl);
+  controller = arena.make<TemperatureController>("TemperatureController", tempSensor,
+                                                 relayControl);
   controller->begin();
   Serial.println("[SETUP] Temperature controller initialized");
 
+  // Restore history from flash before anything records new samples
+  if (ENABLE_HISTORY_JOURNAL && fileSystemMounted) {
+    historyJournal = new HistoryJournal(FFat);
+    controller->attachJournal(historyJournal);
+  }
+
+  // Control loop runs in its own task from here on; loop() keeps network/UI
+  if (ENABLE_CONTROL_TASK) {
+    controlTask = arena.make<ControlTask>("ControlTask", controller, tempSensor);
+    if (!controlTask->begin()) {
+      Serial.println("[SETUP] WARNING: Control task failed, falling back to loop()");
+      arena.destroy(controlTask);
+      controlTask = nullptr;
+    }
+  }
+  statusCache.refresh(*controller, ESP.getFreeHeap());
+
   // TM1638 Display
-  display = new TM1638Display();
+  display = arena.make<TM1638Display>("TM1638Display");
   display->begin();
   Serial.println("[SETUP] TM1638 display initialized");
 
   // Rotary Encoder (M5Stack Unit Encoder U135)
-  encoder = new Encoder();
+  encoder = arena.make<Encoder>("Encoder");
   if (!encoder->begin()) {
     Serial.println("[SETUP] WARNING: Encoder not found on I2C bus");
   }
 
-  // Initialize WiFi
+  // Network services are built now, next to the rest, and started from
+  // loop() once the network is up (see startNetworkServices)
+#if ENABLE_TUI
+  tuiServer = arena.make<TUIServer>("TUIServer", controller, tempSensor);
+#endif
+  webServer = arena.make<WebServer>("WebServer", controller, WEB_SERVER_PORT);
+  mqttClient = arena.make<MQTTClient>("MQTTClient", controller, MQTT_BROKER_HOST,
+                                      MQTT_BROKER_PORT);
+  reportRamMap();
+
+  // Start WiFi without waiting for it; network services start from loop()
+  // once it is up (see jobWiFi)
   initializeWiFi();
 
-  // Initialize Syslog (after WiFi)
+  // Initialize Syslog (sends once WiFi is connected)
   logger.begin();
 
-  // Initialize Telnet Server (after WiFi)
-  telnetServer.begin();
-
-  // Initialize TUI Server (after WiFi)
-  if (ENABLE_TUI) {
-    tuiServer = new TUIServer(controller, tempSensor);
-    tuiServer->begin(TUI_PORT);
-    Serial.printf("[SETUP] TUI server started on port %d\n", TUI_PORT);
-  }
-
-  // Initialize OTA updates
-  initializeOTA();
-
-  // Initialize HTTP OTA (pull-based updates from GitHub Releases)
-  httpOTA.setSafetyCheck(isOtaUpdateSafe);
-  httpOTA.begin();
-
-  // Web Server
-  webServer = new WebServer(controller, WEB_SERVER_PORT);
-  webServer->begin();
-  Serial.printf("[SETUP] Web server started on port %d\n", WEB_SERVER_PORT);
-
-  // MQTT Client
-  mqttClient = new MQTTClient(controller, MQTT_BROKER_HOST, MQTT_BROKER_PORT);
-  mqttClient->begin(MQTT_CLIENT_ID);
-  Serial.printf("[SETUP] MQTT client initialized\n");
-
   // Status LED
   pinMode(PIN_LED_STATUS, OUTPUT);
   digitalWrite(PIN_LED_STATUS, LOW);
 
+  // Everything periodic in loop() runs from here on
+  scheduleJobs();
+  setupDoneMs = millis();
+#if ENABLE_HEAP_TRACE
+  heapTracer.setLoopTag(HeapTracer::TAG_OTHER);
+#endif
+
   Serial.println("\n[SETUP] Initialization complete!\n");
   logMessage(LOG_INFO, "SETUP", "ESP32 Smoker Controller v%s initialized successfully", FIRMWARE_VERSION);
+#if ENABLE_CRASH_LOG
+  if (crashLog.crashed()) {
+    logMessage(LOG_WARNING, "CRASH", "Previous boot ended by %s after %u s, see /api/crashlog",
+               CrashLog::resetReasonName(crashLog.resetReason()),
+               crashLog.reportUptime() / 1000);
+  }
+#endif
 }
 
 // ============================================================================
@@ -403,114 +895,12 @@ void setup() {
 // ============================================================================
 
 void loop() {
-  // Run MAX31865 hardware diagnostic once, 10 seconds after boot (USB CDC is connected by then)
-  static bool diagRan = false;
-  if (!diagRan && millis() > 10000 && tempSensor) {
-    diagRan = true;
-    Serial.println("\n*** RUNNING DEFERRED MAX31865 HARDWARE DIAGNOSTIC ***");
-    tempSensor->runHardwareDiagnostic();
-    // Re-initialize sensor for normal operation after diagnostic
-    Serial.println("*** RE-INITIALIZING MAX31865 FOR NORMAL OPERATION ***");
-    tempSensor->begin(MAX31865::THREE_WIRE);
-  }
-
-  // Handle OTA updates
-  ArduinoOTA.handle();
-
-  // Handle HTTP OTA update checks (pull-based from GitHub)
-  httpOTA.update();
-  if (httpOTA.isUpdateRequested()) {
-    httpOTA.clearUpdateRequest();
-    httpOTA.performUpdate();
-  }
-
-  // Handle telnet server
-  telnetServer.loop();
-
-  // Handle TUI server
-  if (tuiServer) {
-    tuiServer->update();
-  }
-
-  // Update temperature control loop
-  controller->update();
-
-  // Update MQTT connection and publish
-  mqttClient->update();
-
-  // Check WiFi connection
-  checkWiFiConnection();
-
-  // Update TM1638 display
-  if (display) {
-    auto status = controller->getStatus();
-
-    // Update temperature displays
-    display->setCurrentTemp(status.currentTemp);
-    display->setTargetTemp(status.setpoint);
-    display->update();
-
-    // Update relay status LEDs
-    display->setRelayLEDs(status.auger, status.fan, status.igniter);
-
-    // Update status LEDs
-    bool wifiConnected = (WiFi.status() == WL_CONNECTED);
-    bool mqttConnected = mqttClient->isConnected();
-    bool isError = (controller->getState() == STATE_ERROR);
-    bool isRunning = (controller->getState() == STATE_RUNNING ||
-                      controller->getState() == STATE_STARTUP);
-    display->setStatusLEDs(wifiConnected, mqttConnected, isError, isRunning);
-
-    // Heartbeat LED (blink LED 8 every second)
-    static unsigned long lastBlink = 0;
-    static bool heartbeatState = false;
-    if (millis() - lastBlink > 1000) {
-      lastBlink = millis();
-      heartbeatState = !heartbeatState;
-      display->setLED(LED_8, heartbeatState);
-    }
-
-    // Handle button presses
-    handleDisplayButtons();
-  }
-
-  // Handle rotary encoder input
-  handleEncoder();
-
-  // Built-in LED heartbeat
-  static unsigned long lastBuiltinBlink = 0;
-  static bool builtinState = false;
-  if (millis() - lastBuiltinBlink > 1000) {
-    lastBuiltinBlink = millis();
-    builtinState = !builtinState;
-    digitalWrite(PIN_LED_STATUS, builtinState);
-  }
-
-  // Periodic status print (debugging)
-  if (ENABLE_SERIAL_DEBUG) {
-    if (millis() - lastStatusPrint > 10000) {
-      lastStatusPrint = millis();
-
-      auto status = controller->getStatus();
-      Serial.printf(
-          "[STATUS] Temp: %.1f°F | Setpoint: %.1f°F | State: %s | "
-          "Auger: %s | Fan: %s | MQTT: %s | Heap: %u/%u\n",
-          status.currentTemp, status.setpoint,
-          controller->getStateName(), status.auger ? "ON" : "OFF",
-          status.fan ? "ON" : "OFF",
-          mqttClient->isConnected() ? "Connected" : "Offline",
-          ESP.getFreeHeap(), ESP.getMinFreeHeap());
-
-      // Also send to syslog
-      logMessage(LOG_INFO, "STATUS",
-                 "Temp: %.1f°F | Setpoint: %.1f°F | State: %s | Auger: %s | Fan: %s",
-                 status.currentTemp, status.setpoint,
-                 controller->getStateName(),
-                 status.auger ? "ON" : "OFF",
-                 status.fan ? "ON" : "OFF");
-    }
-  }
-
-  // Small delay to prevent watchdog timeout
-  delay(10);
+  PROFILE_START(pass);
+  uint32_t waitUs = scheduler.runDue();
+  PROFILE_STOP(pass, LoopProfiler::STAGE_LOOP);
+
+  // Sleep until the next deadline, always yielding at least a tick
+  uint32_t waitMs = (waitUs + 999) / 1000;
+  if (waitMs > SCHED_MAX_SLEEP_MS) waitMs = SCHED_MAX_SLEEP_MS;
+  delay(waitMs ? waitMs : 1);
 }
@@ -187,25 +187,24 @@ float MAX31865::readTemperatureC(void) {
   // Check for faults first
   uint8_t fault = getFaultStatus();
   if (fault != 0) {
-    DUAL_LOGF(LOG_ERR, "[MAX31865] Fault 0x%02X detected, clearing and retrying...\n", fault);
+    LOG_EVENT(RTD_FAULT, fault);
     printFaultStatus(fault);
 
     // Dump RTD and threshold registers for diagnosis
     uint16_t rtdRaw = readRegister16(MAX31865_RTD_MSB);
     uint16_t highThresh = readRegister16(0x03);
     uint16_t lowThresh = readRegister16(0x05);
-    DUAL_LOGF(LOG_ERR, "[MAX31865] RTD=0x%04X, HighTh=0x%04X, LowTh=0x%04X\n",
-              rtdRaw, highThresh, lowThresh);
+    LOG_EVENT(RTD_REGISTERS, rtdRaw, highThresh, lowThresh);
 
     // Clear fault and retry once
     clearFaults();
     delay(10);
     fault = getFaultStatus();
     if (fault != 0) {
-      DUAL_LOGF(LOG_ERR, "[MAX31865] Fault persists after clear: 0x%02X\n", fault);
+      LOG_EVENT(RTD_FAULT_PERSISTS, fault);
       return -999.0;
     }
-    DUAL_LOGF(LOG_INFO, "[MAX31865] Fault cleared successfully, reading temp\n");
+    LOG_EVENT(RTD_FAULT_CLEARED);
   }
 
   // In auto-conversion mode, the register always has a fresh value.
@@ -233,8 +232,7 @@ float MAX31865::readTemperatureC(void) {
   static unsigned long lastDetailedLog = 0;
   if (millis() - lastDetailedLog > 10000) {
     lastDetailedLog = millis();
-    DUAL_LOGF(LOG_DEBUG, "[MAX31865] Raw ADC: %u, Resistance: %.2f Ω, Temp: %.2f°C (%.2f°F)\n",
-              rawRTD, resistance, tempC, tempC * 9.0 / 5.0 + 32.0);
+    LOG_EVENT(RTD_READING, rawRTD, resistance, tempC, tempC * 9.0 / 5.0 + 32.0);
   }
 #endif
 
@@ -245,7 +243,7 @@ uint16_t MAX31865::readRawRTD(void) {
   uint16_t raw = readRegister16(MAX31865_RTD_MSB);
   if (raw & 0x01) {
     // Fault bit is set in RTD register — reading is unreliable
-    DUAL_LOGF(LOG_WARNING, "[MAX31865] RTD fault bit set (raw=0x%04X)\n", raw);
+    LOG_EVENT(RTD_FAULT_BIT, raw);
     return 0; // Triggers error path in caller
   }
   return raw >> 1;
@@ -1,4 +1,7 @@
 #include "mqtt_client.h"
+#include "crash_log.h"
+#include "profiler.h"
+#include "heap_monitor.h"
 #include "config.h"
 #include <ArduinoJson.h>
 
@@ -18,8 +21,11 @@ MQTTClient::MQTTClient(TemperatureController* controller,
     : _mqttClient(_wifiClient), _controller(controller),
       _brokerHost(brokerHost), _brokerPort(brokerPort),
       _clientId(MQTT_CLIENT_ID), _rootTopic(MQTT_ROOT_TOPIC),
-      _lastPublish(0), _lastTelemetry(0),
-      _subscribed(false), _discoveryPublished(false), _subscribeTime(0) {}
+      _lastReconnectAttempt(0),
+      _subscribed(false), _discoveryPublished(false), _crashLogPublished(false),
+      _subscribeTime(0) {
+  setupTopics();
+}
 
 // ============================================================================
 // LIFECYCLE
@@ -55,31 +61,16 @@ bool MQTTClient::isConnected(void) {
   return _mqttClient.connected();
 }
 
-void MQTTClient::update() {
-  if (!_mqttClient.connected()) {
-    unsigned long now = millis();
-    static unsigned long lastReconnectAttempt = 0;
-
-    if (now - lastReconnectAttempt > MQTT_RECONNECT_INTERVAL) {
-      lastReconnectAttempt = now;
-      reconnect();
-    }
-  } else {
+void MQTTClient::poll() {
+  if (_mqttClient.connected()) {
     _mqttClient.loop();
+    return;
+  }
 
-    unsigned long now = millis();
-
-    // Publish core status periodically
-    if (now - _lastPublish > MQTT_STATUS_INTERVAL) {
-      _lastPublish = now;
-      publishStatus();
-    }
-
-    // Publish extended telemetry less frequently
-    if (now - _lastTelemetry > MQTT_TELEMETRY_INTERVAL) {
-      _lastTelemetry = now;
-      publishTelemetry();
-    }
+  unsigned long now = millis();
+  if (now - _lastReconnectAttempt > MQTT_RECONNECT_INTERVAL) {
+    _lastReconnectAttempt = now;
+    reconnect();
   }
 }
 
@@ -106,6 +97,11 @@ bool MQTTClient::reconnect() {
       _discoveryPublished = true;
     }
 
+    // Previous boot's crash log (retained, once per boot)
+    if (!_crashLogPublished) {
+      _crashLogPublished = publishCrashLog();
+    }
+
     subscribe();
     return true;
   } else {
@@ -144,7 +140,17 @@ void MQTTClient::subscribe() {
 }
 
 void MQTTClient::setupTopics() {
-  // Topic structure defined in config.h and subscribe()
+  // Status topics are published every interval; build them once.
+  // Command topics are built in subscribe().
+  static const char* const names[STATUS_TOPIC_COUNT] = {
+    "temperature", "setpoint", "state",
+    "auger", "fan", "igniter",
+    "pid_output", "pid_p", "pid_i", "pid_d",
+    "lid_open", "reignite_attempts",
+  };
+  for (uint8_t i = 0; i < STATUS_TOPIC_COUNT; i++) {
+    snprintf(_statusTopics[i], sizeof(_statusTopics[i]), "%s/sensor/%s", _rootTopic, names[i]);
+  }
 }
 
 void MQTTClient::staticCallback(char* topic, byte* payload,
@@ -219,64 +225,42 @@ void MQTTClient::handleMessage(char* topic, byte* payload,
 // ============================================================================
 
 void MQTTClient::publishStatus(void) {
-  if (!_mqttClient.connected())
+  if (!_mqttClient.connected() || !statusCache.valid())
     return;
 
-  auto status = _controller->getStatus();
+  // Values were formatted once this tick by the status cache
+  const StatusCache::Fields& f = statusCache.fields();
 
-  // Build topic prefix once to avoid repeated String allocations
-  String prefix = String(_rootTopic) + "/sensor/";
-  char buf[16];
-
-  // Temperature
-  snprintf(buf, sizeof(buf), "%.1f", status.currentTemp);
-  _mqttClient.publish((prefix + "temperature").c_str(), buf);
-
-  // Setpoint
-  snprintf(buf, sizeof(buf), "%.1f", status.setpoint);
-  _mqttClient.publish((prefix + "setpoint").c_str(), buf);
-
-  // State
-  _mqttClient.publish((prefix + "state").c_str(),
-                      _controller->getStateName());
+  _mqttClient.publish(_statusTopics[TOPIC_TEMPERATURE], f.temp);
+  _mqttClient.publish(_statusTopics[TOPIC_SETPOINT], f.setpoint);
+  _mqttClient.publish(_statusTopics[TOPIC_STATE], f.state);
 
   // Flush TCP buffer so remaining publishes don't get dropped
   _mqttClient.loop();
 
   // Relay states
-  _mqttClient.publish((prefix + "auger").c_str(),
-                      status.auger ? "ON" : "OFF");
-  _mqttClient.publish((prefix + "fan").c_str(),
-                      status.fan ? "ON" : "OFF");
-  _mqttClient.publish((prefix + "igniter").c_str(),
-                      status.igniter ? "ON" : "OFF");
+  _mqttClient.publish(_statusTopics[TOPIC_AUGER], f.auger);
+  _mqttClient.publish(_statusTopics[TOPIC_FAN], f.fan);
+  _mqttClient.publish(_statusTopics[TOPIC_IGNITER], f.igniter);
 
   // Flush again before PID batch
   _mqttClient.loop();
 
   // PID data (only meaningful in RUNNING state, but always publish for graphs)
-  auto pid = _controller->getPIDStatus();
-  snprintf(buf, sizeof(buf), "%.1f", pid.output * 100.0);
-  _mqttClient.publish((prefix + "pid_output").c_str(), buf);
-  snprintf(buf, sizeof(buf), "%.4f", pid.proportionalTerm);
-  _mqttClient.publish((prefix + "pid_p").c_str(), buf);
-  snprintf(buf, sizeof(buf), "%.4f", pid.integralTerm);
-  _mqttClient.publish((prefix + "pid_i").c_str(), buf);
-  snprintf(buf, sizeof(buf), "%.4f", pid.derivativeTerm);
-  _mqttClient.publish((prefix + "pid_d").c_str(), buf);
+  _mqttClient.publish(_statusTopics[TOPIC_PID_OUTPUT], f.pidOutput);
+  _mqttClient.publish(_statusTopics[TOPIC_PID_P], f.pidP);
+  _mqttClient.publish(_statusTopics[TOPIC_PID_I], f.pidI);
+  _mqttClient.publish(_statusTopics[TOPIC_PID_D], f.pidD);
 
   // Flush before lid/reignite batch
   _mqttClient.loop();
 
   // Lid-open and reignite status
-  _mqttClient.publish((prefix + "lid_open").c_str(),
-                      _controller->isLidOpen() ? "ON" : "OFF");
-  snprintf(buf, sizeof(buf), "%d", _controller->getReigniteAttempts());
-  _mqttClient.publish((prefix + "reignite_attempts").c_str(), buf);
+  _mqttClient.publish(_statusTopics[TOPIC_LID_OPEN], f.lidOpen);
+  _mqttClient.publish(_statusTopics[TOPIC_REIGNITE_ATTEMPTS], f.reigniteAttempts);
 
   if (ENABLE_SERIAL_DEBUG) {
-    Serial.printf("[MQTT] Published status - Temp: %.1f°F, State: %s\n",
-                  status.currentTemp, _controller->getStateName());
+    Serial.printf("[MQTT] Published status - Temp: %s°F, State: %s\n", f.temp, f.state);
   }
 }
 
@@ -301,6 +285,62 @@ void MQTTClient::publishTelemetry() {
   // Free heap
   snprintf(buf, sizeof(buf), "%u", ESP.getFreeHeap());
   _mqttClient.publish((String(_rootTopic) + "/sensor/free_heap").c_str(), buf);
+
+  // Heap health, from the last HeapMonitor sample: the largest block shrinks
+  // long before free_heap shows fragmentation
+  const HeapMonitor::Stats& hs = heapMonitor.getStats();
+  snprintf(buf, sizeof(buf), "%u", ESP.getMinFreeHeap());
+  _mqttClient.publish((String(_rootTopic) + "/sensor/heap_min_free").c_str(), buf);
+  snprintf(buf, sizeof(buf), "%u", (unsigned)hs.last.largestBlock);
+  _mqttClient.publish((String(_rootTopic) + "/sensor/heap_largest_block").c_str(), buf);
+  snprintf(buf, sizeof(buf), "%u", (unsigned)hs.fragmentation);
+  _mqttClient.publish((String(_rootTopic) + "/sensor/heap_fragmentation").c_str(), buf);
+  snprintf(buf, sizeof(buf), "%u", (unsigned)hs.last.allocatedBlocks);
+  _mqttClient.publish((String(_rootTopic) + "/sensor/heap_blocks").c_str(), buf);
+
+  publishPerf();
+}
+
+// Loop profiler report at <root>/perf, the /api/perf body. Streamed like the
+// crash log; not retained, it is only meaningful while the device runs.
+void MQTTClient::publishPerf() {
+#if ENABLE_PROFILER
+  char* body = (char*)malloc(PROFILER_JSON_BYTES);
+  if (!body) return;
+  size_t len = loopProfiler.toJson(body, PROFILER_JSON_BYTES, millis());
+  String topic = String(_rootTopic) + "/perf";
+  if (len) {
+    _mqttClient.beginPublish(topic.c_str(), len, false);
+    _mqttClient.write((const uint8_t*)body, len);
+    _mqttClient.endPublish();
+  }
+  free(body);
+#endif
+}
+
+// ============================================================================
+// CRASH LOG (once per boot)
+// ============================================================================
+
+// Streamed with beginPublish() since the report is larger than the client
+// buffer. Retained, so <root>/crashlog always describes the latest boot.
+bool MQTTClient::publishCrashLog() {
+#if ENABLE_CRASH_LOG
+  // Too large to format: nothing to publish, and retrying will not help
+  size_t len = crashLog.jsonLength();
+  if (!len) return true;
+  String topic = String(_rootTopic) + "/crashlog";
+  bool ok = _mqttClient.beginPublish(topic.c_str(), len, true) &&
+            _mqttClient.write((const uint8_t*)crashLog.json(), len) == len &&
+            _mqttClient.endPublish();
+  if (ENABLE_SERIAL_DEBUG) {
+    Serial.printf("[MQTT] Crash log %s (%u bytes)\n", ok ? "published" : "publish failed",
+                  (unsigned)len);
+  }
+  return ok;
+#else
+  return true;
+#endif
 }
 
 // ============================================================================
@@ -459,6 +499,53 @@ void MQTTClient::publishDiscovery() {
       "%s,%s}", _rootTopic, device, avail);
   publishDiscoveryEntity("sensor", "free_heap", payload);
 
+  // Minimum Free Heap since boot
+  snprintf(payload, sizeof(payload),
+      "{\"name\":\"Minimum Free Memory\","
+      "\"stat_t\":\"%s/sensor/heap_min_free\","
+      "\"unit_of_meas\":\"B\","
+      "\"stat_cla\":\"measurement\","
+      "\"uniq_id\":\"gundergrill_heap_min_free\","
+      "\"ent_cat\":\"diagnostic\","
+      "\"ic\":\"mdi:memory\","
+      "%s,%s}", _rootTopic, device, avail);
+  publishDiscoveryEntity("sensor", "heap_min_free", payload);
+
+  // Largest Free Block
+  snprintf(payload, sizeof(payload),
+      "{\"name\":\"Largest Free Block\","
+      "\"stat_t\":\"%s/sensor/heap_largest_block\","
+      "\"unit_of_meas\":\"B\","
+      "\"stat_cla\":\"measurement\","
+      "\"uniq_id\":\"gundergrill_heap_largest_block\","
+      "\"ent_cat\":\"diagnostic\","
+      "\"ic\":\"mdi:memory\","
+      "%s,%s}", _rootTopic, device, avail);
+  publishDiscoveryEntity("sensor", "heap_largest_block", payload);
+
+  // Heap Fragmentation
+  snprintf(payload, sizeof(payload),
+      "{\"name\":\"Heap Fragmentation\","
+      "\"stat_t\":\"%s/sensor/heap_fragmentation\","
+      "\"unit_of_meas\":\"%%\","
+      "\"stat_cla\":\"measurement\","
+      "\"uniq_id\":\"gundergrill_heap_fragmentation\","
+      "\"ent_cat\":\"diagnostic\","
+      "\"ic\":\"mdi:puzzle-outline\","
+      "%s,%s}", _rootTopic, device, avail);
+  publishDiscoveryEntity("sensor", "heap_fragmentation", payload);
+
+  // Allocated Heap Blocks
+  snprintf(payload, sizeof(payload),
+      "{\"name\":\"Heap Blocks\","
+      "\"stat_t\":\"%s/sensor/heap_blocks\","
+      "\"stat_cla\":\"measurement\","
+      "\"uniq_id\":\"gundergrill_heap_blocks\","
+      "\"ent_cat\":\"diagnostic\","
+      "\"ic\":\"mdi:memory\","
+      "%s,%s}", _rootTopic, device, avail);
+  publishDiscoveryEntity("sensor", "heap_blocks", payload);
+
   _mqttClient.loop();
 
   // --- BINARY SENSORS ---
@@ -0,0 +1,36 @@
+#include "one_shot_timer.h"
+#include <Arduino.h>
+
+OneShotTimer::OneShotTimer(const char* name, Callback callback, void* arg)
+    : _handle(nullptr) {
+  esp_timer_create_args_t args = {};
+  args.callback = callback;
+  args.arg = arg;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = name;
+  if (esp_timer_create(&args, &_handle) != ESP_OK) {
+    _handle = nullptr;
+    Serial.printf("[TIMER] ERROR: Failed to create timer '%s'\n", name);
+  }
+}
+
+OneShotTimer::~OneShotTimer() {
+  if (!_handle) return;
+  esp_timer_stop(_handle);
+  esp_timer_delete(_handle);
+}
+
+void OneShotTimer::start(uint32_t delayMs) {
+  if (!_handle) return;
+  // start_once fails on a running timer
+  esp_timer_stop(_handle);
+  esp_timer_start_once(_handle, (uint64_t)delayMs * 1000);
+}
+
+void OneShotTimer::stop() {
+  if (_handle) esp_timer_stop(_handle);
+}
+
+bool OneShotTimer::isArmed() const {
+  return _handle && esp_timer_is_active(_handle);
+}
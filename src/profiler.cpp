@@ -0,0 +1,139 @@
+#include "profiler.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if ENABLE_PROFILER
+LoopProfiler loopProfiler;
+#endif
+
+// ============================================================================
+// HISTOGRAM
+// ============================================================================
+
+uint8_t LoopProfiler::bucketFor(uint32_t us) {
+  if (us < 16) return 0;
+  uint8_t log2 = 31 - (uint8_t)__builtin_clz(us);    // us >= 16, so log2 >= 4
+  uint8_t bucket = log2 - 3;
+  return bucket < PROFILER_BUCKETS ? bucket : PROFILER_BUCKETS - 1;
+}
+
+uint32_t LoopProfiler::bucketLimitUs(uint8_t bucket) {
+  return bucket < PROFILER_BUCKETS - 1 ? (uint32_t)16 << bucket : 0;
+}
+
+void ProfileHistogram::add(uint32_t us) {
+  count++;
+  totalUs += us;
+  lastUs = us;
+  if (us > maxUs) maxUs = us;
+  buckets[LoopProfiler::bucketFor(us)]++;
+}
+
+uint32_t ProfileHistogram::percentile(uint8_t pct) const {
+  if (count == 0) return 0;
+  // Smallest number of samples that covers pct percent, at least one
+  uint64_t target = ((uint64_t)count * pct + 99) / 100;
+  if (target == 0) target = 1;
+  uint64_t seen = 0;
+  for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+    seen += buckets[b];
+    if (seen >= target) {
+      uint32_t limit = LoopProfiler::bucketLimitUs(b);
+      return limit && limit < maxUs ? limit : maxUs;
+    }
+  }
+  return maxUs;
+}
+
+// ============================================================================
+// PROFILER
+// ============================================================================
+
+LoopProfiler::LoopProfiler() : _cyclesPerUs(1) {
+  reset();
+}
+
+void LoopProfiler::reset() {
+  memset(_stages, 0, sizeof(_stages));
+  memset(&_jitter, 0, sizeof(_jitter));
+  _minJitterUs = 0;
+  _maxJitterUs = 0;
+}
+
+void LoopProfiler::record(Stage stage, uint32_t us) {
+  if (stage < STAGE_COUNT) _stages[stage].add(us);
+}
+
+void LoopProfiler::recordTick(int32_t jitterUs, uint32_t execUs) {
+  if (_jitter.count == 0 || jitterUs < _minJitterUs) _minJitterUs = jitterUs;
+  if (_jitter.count == 0 || jitterUs > _maxJitterUs) _maxJitterUs = jitterUs;
+  _jitter.add(jitterUs < 0 ? (uint32_t)-jitterUs : (uint32_t)jitterUs);
+  _stages[STAGE_TICK].add(execUs);
+}
+
+static const char* const STAGE_NAMES[LoopProfiler::STAGE_COUNT] = {
+  "ota", "http_ota", "telnet", "tui", "control", "status", "history",
+  "events", "mqtt", "wifi", "display", "encoder", "loop", "tick"
+};
+
+const char* LoopProfiler::stageName(Stage stage) {
+  return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "?";
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+// snprintf into buf + *len, false once the buffer is full
+static bool append(char* buf, size_t size, size_t* len, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + *len, size - *len, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *len) return false;
+  *len += (size_t)n;
+  return true;
+}
+
+static bool appendBuckets(char* buf, size_t size, size_t* len, const ProfileHistogram& h) {
+  for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+    if (!append(buf, size, len, "%s%u", b ? "," : "[", (unsigned)h.buckets[b])) return false;
+  }
+  return append(buf, size, len, "]");
+}
+
+size_t LoopProfiler::toJson(char* buf, size_t size, uint32_t uptimeMs) const {
+  size_t len = 0;
+  if (!append(buf, size, &len, "{\"uptime\":%u,\"bucket_us\":", (unsigned)uptimeMs)) return 0;
+  for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+    uint32_t limit = bucketLimitUs(b);
+    bool ok = limit ? append(buf, size, &len, "%s%u", b ? "," : "[", (unsigned)limit)
+                    : append(buf, size, &len, "%snull", b ? "," : "[");
+    if (!ok) return 0;
+  }
+
+  if (!append(buf, size, &len, "],\"stages\":{")) return 0;
+  for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+    const ProfileHistogram& h = _stages[s];
+    if (!append(buf, size, &len,
+                "%s\"%s\":{\"count\":%u,\"mean_us\":%u,\"max_us\":%u,\"last_us\":%u,"
+                "\"p50_us\":%u,\"p99_us\":%u,\"hist\":",
+                s ? "," : "", STAGE_NAMES[s], (unsigned)h.count,
+                (unsigned)(h.count ? h.totalUs / h.count : 0), (unsigned)h.maxUs,
+                (unsigned)h.lastUs, (unsigned)h.percentile(50), (unsigned)h.percentile(99)) ||
+        !appendBuckets(buf, size, &len, h) || !append(buf, size, &len, "}")) {
+      return 0;
+    }
+  }
+
+  if (!append(buf, size, &len,
+              "},\"tick\":{\"interval_ms\":%u,\"count\":%u,\"jitter_min_us\":%d,"
+              "\"jitter_max_us\":%d,\"jitter_p99_us\":%u,\"jitter_hist\":",
+              (unsigned)TEMP_CONTROL_INTERVAL, (unsigned)_jitter.count, (int)_minJitterUs,
+              (int)_maxJitterUs, (unsigned)_jitter.percentile(99)) ||
+      !appendBuckets(buf, size, &len, _jitter) || !append(buf, size, &len, "}}")) {
+    return 0;
+  }
+  return len;
+}
@@ -18,12 +18,16 @@ void RelayControl::begin() {
   }
 }
 
+void RelayControl::writeRelay(RelayID relay, RelayState state) {
+  _states[relay] = state;
+  digitalWrite(_pins[relay], state ? LOW : HIGH); // Active LOW: LOW = on
+}
+
 void RelayControl::setRelay(RelayID relay, RelayState state) {
   if (relay >= RELAY_COUNT)
     return;
 
-  _states[relay] = state;
-  digitalWrite(_pins[relay], state ? LOW : HIGH); // Active LOW: LOW = on
+  writeRelay(relay, state);
 
   if (ENABLE_SERIAL_DEBUG) {
     const char* relayName[] = {"AUGER", "FAN", "IGNITER"};
@@ -88,6 +92,12 @@ void RelayControl::setSafeAuger(RelayState state) {
   setRelay(RELAY_AUGER, state);
 }
 
+bool RelayControl::setSafeAugerQuiet(RelayState state) {
+  if (state == RELAY_ON && _states[RELAY_FAN] == RELAY_OFF) return false;
+  writeRelay(RELAY_AUGER, state);
+  return true;
+}
+
 RelayControl::RelayStates RelayControl::getStates(void) {
   return {_states[RELAY_AUGER] == RELAY_ON, _states[RELAY_FAN] == RELAY_ON,
           _states[RELAY_IGNITER] == RELAY_ON};
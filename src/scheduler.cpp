@@ -0,0 +1,144 @@
+#include "scheduler.h"
+#include <string.h>
+
+// a is earlier than b, wrap-safe
+static inline bool earlier(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+Scheduler::Scheduler(Clock clock) : _clock(clock), _jobCount(0), _heapSize(0) {
+  memset(_jobs, 0, sizeof(_jobs));
+  resetStats();
+}
+
+void Scheduler::resetStats() {
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.sinceUs = _clock();
+  for (uint8_t i = 0; i < _jobCount; i++) {
+    JobStats& s = _jobs[i].stats;
+    s.runs = 0;
+    s.overruns = 0;
+    s.lastLateUs = 0;
+    s.maxLateUs = 0;
+    s.lastExecUs = 0;
+    s.maxExecUs = 0;
+    s.totalExecUs = 0;
+  }
+}
+
+uint8_t Scheduler::addJob(const char* name, Task task, uint32_t periodMs, uint8_t priority,
+                          uint32_t firstDelayMs) {
+  if (_jobCount >= SCHED_MAX_JOBS || !task) return INVALID_JOB;
+
+  uint8_t id = _jobCount++;
+  Job& job = _jobs[id];
+  job.task = task;
+  job.deadline = _clock() + firstDelayMs * 1000;
+  job.stats.name = name;
+  job.stats.periodUs = periodMs * 1000;
+  job.stats.priority = priority;
+  push(id);
+  return id;
+}
+
+// ============================================================================
+// TIMER HEAP
+// ============================================================================
+
+// Heap order: earlier deadline, then higher priority (lower number)
+bool Scheduler::before(uint8_t a, uint8_t b) const {
+  const Job& ja = _jobs[a];
+  const Job& jb = _jobs[b];
+  if (ja.deadline != jb.deadline) return earlier(ja.deadline, jb.deadline);
+  return ja.stats.priority < jb.stats.priority;
+}
+
+void Scheduler::push(uint8_t id) {
+  uint8_t i = _heapSize++;
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (!before(id, _heap[parent])) break;
+    _heap[i] = _heap[parent];
+    i = parent;
+  }
+  _heap[i] = id;
+}
+
+uint8_t Scheduler::pop() {
+  uint8_t top = _heap[0];
+  uint8_t last = _heap[--_heapSize];
+  uint8_t i = 0;
+  for (;;) {
+    uint8_t child = 2 * i + 1;
+    if (child >= _heapSize) break;
+    if (child + 1 < _heapSize && before(_heap[child + 1], _heap[child])) child++;
+    if (!before(_heap[child], last)) break;
+    _heap[i] = _heap[child];
+    i = child;
+  }
+  if (_heapSize > 0) _heap[i] = last;
+  return top;
+}
+
+// ============================================================================
+// RUNNING
+// ============================================================================
+
+uint32_t Scheduler::untilNextUs() const {
+  if (_heapSize == 0) return (uint32_t)SCHED_MAX_SLEEP_MS * 1000;
+  int32_t wait = (int32_t)(_jobs[_heap[0]].deadline - _clock());
+  return wait > 0 ? (uint32_t)wait : 0;
+}
+
+uint32_t Scheduler::runDue() {
+  _stats.passes++;
+
+  // Take every job due at the start of the pass; one that comes due while
+  // these run waits for the next pass rather than starving the rest
+  uint8_t ready[SCHED_MAX_JOBS];
+  uint8_t count = 0;
+  uint32_t now = _clock();
+  while (_heapSize > 0 && !earlier(now, _jobs[_heap[0]].deadline)) {
+    uint8_t id = pop();
+    // Insertion sort by priority; pops arrive in deadline order already
+    uint8_t i = count++;
+    while (i > 0 && _jobs[ready[i - 1]].stats.priority > _jobs[id].stats.priority) {
+      ready[i] = ready[i - 1];
+      i--;
+    }
+    ready[i] = id;
+  }
+
+  if (count == 0) _stats.idlePasses++;
+  for (uint8_t i = 0; i < count; i++) run(ready[i]);
+  return untilNextUs();
+}
+
+void Scheduler::run(uint8_t id) {
+  Job& job = _jobs[id];
+  JobStats& s = job.stats;
+
+  uint32_t start = _clock();
+  job.task();
+  uint32_t end = _clock();
+
+  uint32_t late = start - job.deadline;
+  uint32_t exec = end - start;
+  s.runs++;
+  s.lastLateUs = late;
+  if (late > s.maxLateUs) s.maxLateUs = late;
+  s.lastExecUs = exec;
+  if (exec > s.maxExecUs) s.maxExecUs = exec;
+  s.totalExecUs += exec;
+  _stats.runs++;
+  _stats.busyUs += exec;
+
+  if (s.periodUs == 0) return;    // One-shot: done
+
+  // Next deadline on the original grid, past every period already missed
+  uint32_t missed = (end - job.deadline) / s.periodUs;
+  job.deadline += (missed + 1) * s.periodUs;
+  s.overruns += missed;
+  _stats.overruns += missed;
+  push(id);
+}
@@ -0,0 +1,256 @@
+#include "screen_buffer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Never drawn, so a cell holding it always differs from the next frame
+#define GLYPH_UNKNOWN 0xFFFF
+
+// Next code point of a UTF-8 string, advancing `p`. Anything outside the
+// BMP or malformed becomes '?'.
+static uint16_t nextGlyph(const char*& p) {
+  uint8_t c = (uint8_t)*p++;
+  if (c < 0x80) return c < 0x20 ? ' ' : c;
+
+  uint8_t extra;
+  uint16_t cp;
+  if ((c & 0xE0) == 0xC0) {
+    extra = 1;
+    cp = c & 0x1F;
+  } else if ((c & 0xF0) == 0xE0) {
+    extra = 2;
+    cp = c & 0x0F;
+  } else {
+    // Lead byte of a 4-byte sequence, or a stray continuation byte
+    while (((uint8_t)*p & 0xC0) == 0x80) p++;
+    return '?';
+  }
+  for (uint8_t i = 0; i < extra; i++) {
+    if (((uint8_t)*p & 0xC0) != 0x80) return '?';
+    cp = (uint16_t)((cp << 6) | ((uint8_t)*p++ & 0x3F));
+  }
+  return cp;
+}
+
+static size_t glyphCount(const char* text) {
+  size_t n = 0;
+  while (*text) {
+    nextGlyph(text);
+    n++;
+  }
+  return n;
+}
+
+ScreenBuffer::ScreenBuffer()
+    : _row(0), _col(0), _style(STYLE_DEFAULT), _fullRepaint(true), _changedCells(0),
+      _outLen(0), _sent(0), _sinkFailed(false), _sink(nullptr), _ctx(nullptr) {
+  clear();
+  for (uint8_t r = 0; r < TUI_ROWS; r++) {
+    for (uint8_t c = 0; c < TUI_COLS; c++) {
+      _shownChars[r][c] = GLYPH_UNKNOWN;
+      _shownStyles[r][c] = STYLE_DEFAULT;
+    }
+  }
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+
+void ScreenBuffer::clear() {
+  for (uint8_t r = 0; r < TUI_ROWS; r++) {
+    for (uint8_t c = 0; c < TUI_COLS; c++) {
+      _chars[r][c] = ' ';
+    }
+  }
+  memset(_styles, STYLE_DEFAULT, sizeof(_styles));
+  _row = 0;
+  _col = 0;
+  _style = STYLE_DEFAULT;
+}
+
+void ScreenBuffer::moveTo(uint8_t row, uint8_t col) {
+  _row = row;
+  _col = col;
+}
+
+void ScreenBuffer::putGlyph(uint16_t glyph) {
+  if (_row < TUI_ROWS && _col < TUI_COLS) {
+    _chars[_row][_col] = glyph;
+    _styles[_row][_col] = _style;
+  }
+  if (_col < TUI_COLS) _col++;
+}
+
+void ScreenBuffer::print(const char* text) {
+  while (*text && _col < TUI_COLS) putGlyph(nextGlyph(text));
+}
+
+void ScreenBuffer::print(uint8_t style, const char* text) {
+  _style = style;
+  print(text);
+}
+
+void ScreenBuffer::printf(const char* fmt, ...) {
+  char line[TUI_COLS * 3 + 1];    // a full row of 3-byte glyphs
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  print(line);
+}
+
+void ScreenBuffer::printPadded(const char* text, uint8_t width, bool alignRight) {
+  size_t len = glyphCount(text);
+  uint8_t pad = len < width ? (uint8_t)(width - len) : 0;
+  if (alignRight) {
+    for (uint8_t i = 0; i < pad; i++) putGlyph(' ');
+  }
+  for (uint8_t i = pad; i < width && *text; i++) putGlyph(nextGlyph(text));
+  if (!alignRight) {
+    for (uint8_t i = 0; i < pad; i++) putGlyph(' ');
+  }
+}
+
+void ScreenBuffer::repeat(const char* glyph, uint8_t count) {
+  const char* p = glyph;
+  uint16_t g = nextGlyph(p);
+  for (uint8_t i = 0; i < count && _col < TUI_COLS; i++) putGlyph(g);
+}
+
+// ============================================================================
+// PRESENTING
+// ============================================================================
+
+bool ScreenBuffer::changed(uint8_t row, uint8_t col) const {
+  return _fullRepaint || _chars[row][col] != _shownChars[row][col] ||
+         _styles[row][col] != _shownStyles[row][col];
+}
+
+size_t ScreenBuffer::present(Sink sink, void* ctx) {
+  _sink = sink;
+  _ctx = ctx;
+  _outLen = 0;
+  _sent = 0;
+  _sinkFailed = false;
+  _changedCells = 0;
+
+  // Terminal cursor as of the last byte emitted, unknown at first. Every
+  // frame ends in the default style, so that is where the next one starts.
+  int cursorRow = -1;
+  int cursorCol = -1;
+  uint8_t style = STYLE_DEFAULT;
+
+  if (_fullRepaint) {
+    static const char CLEAR[] = "\033[0m\033[2J\033[?25l";
+    emit(CLEAR, sizeof(CLEAR) - 1);
+  }
+
+  for (uint8_t r = 0; r < TUI_ROWS; r++) {
+    uint8_t c = 0;
+    while (c < TUI_COLS) {
+      if (!changed(r, c)) {
+        c++;
+        continue;
+      }
+
+      // Extend the run over short gaps of unchanged cells
+      uint8_t last = c;
+      for (uint8_t i = c + 1; i < TUI_COLS && i - last <= TUI_MERGE_GAP; i++) {
+        if (changed(r, i)) last = i;
+      }
+
+      if (cursorRow != r || cursorCol != c) {
+        char move[12];
+        int n = snprintf(move, sizeof(move), "\033[%u;%uH", (unsigned)(r + 1), (unsigned)(c + 1));
+        emit(move, (size_t)n);
+      }
+      for (; c <= last; c++) {
+        if (changed(r, c)) _changedCells++;
+        if (style != _styles[r][c]) {
+          style = _styles[r][c];
+          emitStyle(style);
+        }
+        emitGlyph(_chars[r][c]);
+        _shownChars[r][c] = _chars[r][c];
+        _shownStyles[r][c] = _styles[r][c];
+      }
+      cursorRow = r;
+      cursorCol = c;
+    }
+  }
+
+  // Leave the terminal in the default style between frames
+  if (style != STYLE_DEFAULT) emitStyle(STYLE_DEFAULT);
+  flush();
+  // A dropped or short write leaves the terminal out of step
+  _fullRepaint = _sinkFailed;
+  return _sent;
+}
+
+void ScreenBuffer::emit(const char* data, size_t len) {
+  while (len > 0) {
+    size_t n = TUI_CHUNK_BYTES - _outLen;
+    if (n > len) n = len;
+    memcpy(_out + _outLen, data, n);
+    _outLen += n;
+    data += n;
+    len -= n;
+    if (_outLen == TUI_CHUNK_BYTES) flush();
+  }
+}
+
+void ScreenBuffer::emitGlyph(uint16_t glyph) {
+  char utf8[3];
+  size_t n;
+  if (glyph < 0x80) {
+    utf8[0] = (char)glyph;
+    n = 1;
+  } else if (glyph < 0x800) {
+    utf8[0] = (char)(0xC0 | (glyph >> 6));
+    utf8[1] = (char)(0x80 | (glyph & 0x3F));
+    n = 2;
+  } else {
+    utf8[0] = (char)(0xE0 | (glyph >> 12));
+    utf8[1] = (char)(0x80 | ((glyph >> 6) & 0x3F));
+    utf8[2] = (char)(0x80 | (glyph & 0x3F));
+    n = 3;
+  }
+  emit(utf8, n);
+}
+
+// One SGR sequence that sets the whole style, starting from a reset
+void ScreenBuffer::emitStyle(uint8_t style) {
+  char sgr[12];
+  size_t n = 0;
+  sgr[n++] = '\033';
+  sgr[n++] = '[';
+  sgr[n++] = '0';
+  if (style & BOLD) {
+    sgr[n++] = ';';
+    sgr[n++] = '1';
+  }
+  uint8_t fg = style & FG_MASK;
+  if (fg >= FG_BLACK && fg <= FG_BRIGHT_WHITE) {
+    sgr[n++] = ';';
+    sgr[n++] = fg < FG_BRIGHT_BLACK ? '3' : '9';
+    sgr[n++] = (char)('0' + (fg - FG_BLACK) % 8);
+  }
+  sgr[n++] = 'm';
+  emit(sgr, n);
+}
+
+void ScreenBuffer::flush() {
+  if (_outLen == 0) return;
+  _out[_outLen] = '\0';
+  // After a failed chunk the rest of the frame is dropped; the next one is a
+  // full repaint
+  if (!_sinkFailed && _sink) {
+    if (_sink(_ctx, _out, _outLen)) {
+      _sent += _outLen;
+    } else {
+      _sinkFailed = true;
+    }
+  }
+  _outLen = 0;
+}
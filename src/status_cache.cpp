@@ -0,0 +1,60 @@
+#include "status_cache.h"
+#include <stdio.h>
+#include <string.h>
+
+StatusCache statusCache;
+
+StatusCache::StatusCache() : _formats(0) {
+  memset(&_snap, 0, sizeof(_snap));
+  memset(&_fields, 0, sizeof(_fields));
+  memset(&_json, 0, sizeof(_json));
+}
+
+bool StatusCache::refresh(const TemperatureController& controller, uint32_t freeHeap) {
+  if (_formats > 0 && controller.getSnapshotSeq() == _json.seq) return false;
+  _snap = controller.getSnapshot();
+  format(freeHeap);
+  _formats++;
+  return true;
+}
+
+static const char* onOff(bool on) { return on ? "ON" : "OFF"; }
+static const char* jsonBool(bool on) { return on ? "true" : "false"; }
+
+void StatusCache::format(uint32_t freeHeap) {
+  const auto& status = _snap.status;
+  const auto& pid = _snap.pid;
+
+  snprintf(_fields.temp, sizeof(_fields.temp), "%.1f", status.currentTemp);
+  snprintf(_fields.setpoint, sizeof(_fields.setpoint), "%.1f", status.setpoint);
+  snprintf(_fields.tempDelta, sizeof(_fields.tempDelta), "%.1f",
+           status.currentTemp - status.setpoint);
+  snprintf(_fields.pidOutput, sizeof(_fields.pidOutput), "%.1f", pid.output * 100.0);
+  snprintf(_fields.pidP, sizeof(_fields.pidP), "%.4f", pid.proportionalTerm);
+  snprintf(_fields.pidI, sizeof(_fields.pidI), "%.4f", pid.integralTerm);
+  snprintf(_fields.pidD, sizeof(_fields.pidD), "%.4f", pid.derivativeTerm);
+  snprintf(_fields.reigniteAttempts, sizeof(_fields.reigniteAttempts), "%u",
+           (unsigned)_snap.reigniteAttempts);
+  _fields.state = TemperatureController::stateName(status.state);
+  _fields.auger = onOff(status.auger);
+  _fields.fan = onOff(status.fan);
+  _fields.igniter = onOff(status.igniter);
+  _fields.lidOpen = onOff(_snap.lidOpen);
+
+  // /api/status body, reusing the text fields where the precision matches
+  int n = snprintf(_json.text, sizeof(_json.text),
+                   "{\"temp\":%.2f,\"setpoint\":%s,\"state\":\"%s\",\"auger\":%s,\"fan\":%s,"
+                   "\"igniter\":%s,\"runtime\":%u,\"errors\":%u,\"version\":\"%s\",\"heap\":%u,"
+                   "\"pid\":{\"p\":%s,\"i\":%s,\"d\":%s,\"output\":%s,\"error\":%.1f,"
+                   "\"cycleRemaining\":%u,\"augerOn\":%s,\"lidOpen\":%s,\"reigniteAttempts\":%s}}",
+                   status.currentTemp, _fields.setpoint, _fields.state, jsonBool(status.auger),
+                   jsonBool(status.fan), jsonBool(status.igniter), (unsigned)status.runtime,
+                   (unsigned)status.errorCount, FIRMWARE_VERSION, (unsigned)freeHeap,
+                   _fields.pidP, _fields.pidI, _fields.pidD, _fields.pidOutput, pid.error,
+                   (unsigned)pid.cycleTimeRemaining, jsonBool(pid.augerCycleState),
+                   jsonBool(_snap.lidOpen), _fields.reigniteAttempts);
+  if (n < 0 || (size_t)n >= sizeof(_json.text)) n = 0;    // STATUS_JSON_BYTES too small
+  _json.length = (uint16_t)n;
+  _json.seq = _snap.seq;
+  _published.write(_json);
+}
@@ -0,0 +1,72 @@
+#include "syslog_batch.h"
+#include <stdio.h>
+#include <string.h>
+
+SyslogBatch::SyslogBatch(char* buf, size_t capacity, Framing framing, uint8_t facility,
+                         const char* hostname, const char* appName)
+    : _buf(buf), _capacity(capacity), _len(0), _framing(framing), _facility(facility),
+      _hostname(hostname), _appName(appName), _count(0), _urgent(false), _firstTime(0) {}
+
+void SyslogBatch::clear() {
+  _len = 0;
+  _count = 0;
+  _urgent = false;
+}
+
+bool SyslogBatch::due(uint32_t now) const {
+  if (_count == 0) return false;
+  return _urgent || now - _firstTime >= SYSLOG_BATCH_FLUSH_MS;
+}
+
+bool SyslogBatch::append(uint8_t severity, const char* message, uint32_t now) {
+  char header[64];
+  int hlen = snprintf(header, sizeof(header), "<%u>1 - %s %s - - - \xEF\xBB\xBF",
+                      (unsigned)(_facility | (severity & 7)), _hostname, _appName);
+  if (hlen < 0 || (size_t)hlen >= sizeof(header)) return false;
+
+  // Message body without leading/trailing line breaks
+  while (*message == '\n') message++;
+  size_t mlen = strlen(message);
+  while (mlen > 0 && (message[mlen - 1] == '\n' || message[mlen - 1] == '\r')) mlen--;
+
+  // Room needed around the body: the octet count and its space, or the newline
+  size_t body = (size_t)hlen + mlen;
+  char prefix[8];
+  size_t plen = 0;
+  size_t frame;
+  if (_framing == FRAMING_OCTET_COUNT) {
+    plen = (size_t)snprintf(prefix, sizeof(prefix), "%u ", (unsigned)body);
+    frame = plen + body;
+  } else {
+    frame = body + 1;
+  }
+
+  if (_len + frame > _capacity) {
+    if (_count > 0) return false;
+    // Alone in the batch and still too big: cut the message
+    size_t over = _len + frame - _capacity;
+    if (over > mlen) return false;
+    mlen -= over;
+    if (_framing == FRAMING_OCTET_COUNT) {
+      body = (size_t)hlen + mlen;
+      plen = (size_t)snprintf(prefix, sizeof(prefix), "%u ", (unsigned)body);
+    }
+  }
+
+  char* p = _buf + _len;
+  memcpy(p, prefix, plen);
+  p += plen;
+  memcpy(p, header, (size_t)hlen);
+  p += hlen;
+  for (size_t i = 0; i < mlen; i++) {
+    char c = message[i];
+    *p++ = (c == '\n' || c == '\r') ? ' ' : c;
+  }
+  if (_framing == FRAMING_NEWLINE) *p++ = '\n';
+  _len = (size_t)(p - _buf);
+
+  if (_count == 0) _firstTime = now;
+  _count++;
+  if (severity <= SYSLOG_BATCH_FLUSH_PRIORITY) _urgent = true;
+  return true;
+}
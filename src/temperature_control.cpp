@@ -1,6 +1,26 @@
 #include "temperature_control.h"
 #include "config.h"
 #include "logger.h"
+#include "history_journal.h"
+#include "crash_log.h"
+
+// Scoped lock on the controller mutex. The control task holds it for a full
+// tick; commands and status reads from other tasks hold it briefly. No-op on
+// native builds, which are single-threaded.
+#ifdef ARDUINO_ARCH_ESP32
+class ControlLock {
+public:
+  explicit ControlLock(SemaphoreHandle_t mutex) : _mutex(mutex) {
+    xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+  }
+  ~ControlLock() { xSemaphoreGiveRecursive(_mutex); }
+private:
+  SemaphoreHandle_t _mutex;
+};
+#define CONTROL_LOCK() ControlLock _lock(_mutex)
+#else
+#define CONTROL_LOCK() do {} while (0)
+#endif
 
 TemperatureController::TemperatureController(MAX31865* tempSensor,
                                              RelayControl* relayControl)
@@ -10,10 +30,11 @@ TemperatureController::TemperatureController(MAX31865* tempSensor,
       _debugMode(false), _tempOverrideEnabled(false), _tempOverrideValue(70.0),
       _pidOutput(0.0), _integral(0.0), _previousError(0.0), _previousTemp(70.0),
       _lastP(0.0), _lastI(0.0), _lastD(0.0),
-      _lastPidUpdate(0), _augerCycleStart(0), _augerCycleState(false),
+      _lastPidUpdate(0), _augerCycleStart(0), _augerOnTime(0),
+      _augerCycleState(false), _augerCycleActive(false),
+      _augerTimer("auger", onAugerTimer, this),
       _lastIntegralSave(0),
-      _historyHead(0), _historyCount(0), _lastHistorySample(0),
-      _eventHead(0), _eventCount(0),
+      _lastHistorySample(0), _journal(nullptr), _historyTimeBase(0),
       _reigniteAttempts(0), _reignitePhase(0), _reignitePhaseStart(0),
       _pidMaxedSince(0),
       _lidOpen(false), _lidOpenTime(0), _lidStableTime(0) {
@@ -22,6 +43,10 @@ TemperatureController::TemperatureController(MAX31865* tempSensor,
   _Kp = -1.0 / PID_PROPORTIONAL_BAND;              // = -0.0167
   _Ki = _Kp / PID_INTEGRAL_TIME;                   // = -0.0000926
   _Kd = _Kp * PID_DERIVATIVE_TIME;                 // = -0.75
+
+#ifdef ARDUINO_ARCH_ESP32
+  _mutex = xSemaphoreCreateRecursiveMutex();
+#endif
 }
 
 void TemperatureController::begin() {
@@ -38,6 +63,8 @@ void TemperatureController::begin() {
     }
   }
 
+  publishSnapshot();
+
   if (ENABLE_SERIAL_DEBUG) {
     Serial.println("[TEMP] Temperature controller initialized");
   }
@@ -49,7 +76,16 @@ void TemperatureController::update() {
     return;
 
   _lastUpdate = now;
+  tick();
+}
 
+void TemperatureController::tick() {
+  CONTROL_LOCK();
+  controlCycle();
+  publishSnapshot();
+}
+
+void TemperatureController::controlCycle() {
   // Skip automatic control if in debug mode
   if (_debugMode) {
     // Still read temperature for display
@@ -88,13 +124,15 @@ void TemperatureController::update() {
     if (_previousState == STATE_RUNNING || _previousState == STATE_REIGNITE) {
       saveIntegralToNVS();
     }
+    // Auger edges only run in RUNNING; the new state drives the auger itself
+    if (_previousState == STATE_RUNNING) {
+      stopAugerCycle();
+    }
 
     // Record state change event for history graph
     recordHistoryEvent(_state);
 
-    DUAL_LOGF(LOG_INFO, "\n[STATE] Transition: %s -> %s (Temp: %.1f°F)\n\n",
-              stateToString(_previousState),
-              stateToString(_state),
+    LOG_EVENT(STATE_TRANSITION, stateToString(_previousState), stateToString(_state),
               _currentTemp);
     _previousState = _state;
   }
@@ -129,6 +167,7 @@ void TemperatureController::update() {
 }
 
 void TemperatureController::startSmoking(float targetTemp) {
+  CONTROL_LOCK();
   // Safety: ignore start commands during boot grace period to prevent auto-start
   // from stale encoder button state, MQTT retained messages, or I2C noise
   if (millis() < BOOT_GRACE_PERIOD_MS) {
@@ -166,18 +205,24 @@ void TemperatureController::startSmoking(float targetTemp) {
   if (ENABLE_SERIAL_DEBUG) {
     Serial.printf("[TEMP] Starting up - target: %.1f°F\n", _setpoint);
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::stop() {
+  CONTROL_LOCK();
   _state = STATE_COOLDOWN;
   _stateStartTime = millis();
 
   if (ENABLE_SERIAL_DEBUG) {
     Serial.println("[TEMP] Initiating cooldown");
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::shutdown() {
+  CONTROL_LOCK();
   _state = STATE_SHUTDOWN;
   _stateStartTime = millis();
   _relayControl->allOff();
@@ -185,13 +230,18 @@ void TemperatureController::shutdown() {
   if (ENABLE_SERIAL_DEBUG) {
     Serial.println("[TEMP] Emergency stop commanded");
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::setSetpoint(float targetTemp) {
+  CONTROL_LOCK();
   if (targetTemp < TEMP_MIN_SETPOINT || targetTemp > TEMP_MAX_SETPOINT) {
     return;
   }
   _setpoint = targetTemp;
+
+  publishSnapshot();
 }
 
 float TemperatureController::getCurrentTemp(void) {
@@ -207,7 +257,11 @@ ControllerState TemperatureController::getState(void) {
 }
 
 const char* TemperatureController::getStateName(void) {
-  switch (_state) {
+  return stateName(_state);
+}
+
+const char* TemperatureController::stateName(ControllerState state) {
+  switch (state) {
   case STATE_IDLE:
     return "Idle";
   case STATE_STARTUP:
@@ -228,6 +282,7 @@ const char* TemperatureController::getStateName(void) {
 }
 
 TemperatureController::Status TemperatureController::getStatus(void) {
+  CONTROL_LOCK();
   return {_currentTemp, _setpoint, _state,
           _relayControl->getAuger() == RELAY_ON,
           _relayControl->getFan() == RELAY_ON,
@@ -236,6 +291,7 @@ TemperatureController::Status TemperatureController::getStatus(void) {
 }
 
 TemperatureController::PIDStatus TemperatureController::getPIDStatus(void) {
+  CONTROL_LOCK();
   unsigned long cyclePos = (millis() - _augerCycleStart) % AUGER_CYCLE_TIME;
   unsigned long onTime = (unsigned long)(AUGER_CYCLE_TIME * _pidOutput);
   uint32_t remaining = (_state == STATE_RUNNING)
@@ -258,10 +314,38 @@ TemperatureController::PIDStatus TemperatureController::getPIDStatus(void) {
   };
 }
 
+TemperatureController::Snapshot TemperatureController::getSnapshot(void) const {
+  Snapshot snap;
+  _snapshot.read(snap);
+  return snap;
+}
+
 // ============================================================================
 // PRIVATE METHODS
 // ============================================================================
 
+// Called with the controller mutex held, so there is only ever one writer
+void TemperatureController::publishSnapshot() {
+  Snapshot snap;
+  snap.seq = _snapshot.sequence() + 2;
+  snap.publishedAt = millis();
+  snap.status = getStatus();
+  snap.pid = getPIDStatus();
+  snap.lidOpen = _lidOpen;
+  snap.lidOpenDuration = getLidOpenDuration();
+  snap.reigniteAttempts = _reigniteAttempts;
+  snap.reignitePhase = _reignitePhase;
+  snap.debugMode = _debugMode;
+  snap.historyCount = _history.sampleCount();
+  snap.historyLatestTime = _history.latestTime();
+  snap.historyEnd = _history.sampleEnd();
+  snap.eventCount = (uint8_t)_history.events().count();
+  _snapshot.write(snap);
+#if ENABLE_CRASH_LOG
+  crashLog.recordSnapshot(snap);
+#endif
+}
+
 void TemperatureController::handleIdleState() {
   _relayControl->allOff();
   // Wait for startSmoking() command
@@ -338,11 +422,9 @@ void TemperatureController::handleRunningState() {
         (now - _pidMaxedSince) >= REIGNITE_TRIGGER_TIME) {
 
       if (_reigniteAttempts < REIGNITE_MAX_ATTEMPTS) {
-        DUAL_LOGF(LOG_WARNING,
-          "[REIGNITE] Fire may be out! Temp=%.1f°F < %.0f°F, PID maxed for %lus. Attempt %d/%d\n",
-          _currentTemp, REIGNITE_TEMP_THRESHOLD,
-          (now - _pidMaxedSince) / 1000,
-          _reigniteAttempts + 1, REIGNITE_MAX_ATTEMPTS);
+        LOG_EVENT(REIGNITE_START, _currentTemp, REIGNITE_TEMP_THRESHOLD,
+                  (uint32_t)((now - _pidMaxedSince) / 1000),
+                  _reigniteAttempts + 1, REIGNITE_MAX_ATTEMPTS);
 
         _state = STATE_REIGNITE;
         _stateStartTime = now;
@@ -350,9 +432,7 @@ void TemperatureController::handleRunningState() {
         _reignitePhaseStart = now;
         _pidMaxedSince = 0;
       } else {
-        DUAL_LOGF(LOG_CRIT,
-          "[REIGNITE] Max attempts (%d) exhausted. Entering ERROR state.\n",
-          REIGNITE_MAX_ATTEMPTS);
+        LOG_EVENT(REIGNITE_EXHAUSTED, REIGNITE_MAX_ATTEMPTS);
         _state = STATE_ERROR;
         _relayControl->emergencyStop();
       }
@@ -388,10 +468,18 @@ void TemperatureController::handleShutdownState() {
 
 void TemperatureController::handleErrorState() {
   _relayControl->emergencyStop();
+  reportErrorState();
+}
 
-  // Log error state details periodically
+// Full diagnostics once per error episode, then a one-line reminder every
+// 5 s. The reminder only changes with the fault byte, so the logger folds it
+// into "repeated N times" and the events that led here stay in the log ring.
+void TemperatureController::reportErrorState() {
   static unsigned long lastErrorLog = 0;
-  if (millis() - lastErrorLog > 5000) {
+  static unsigned long reportedEpisode = ~0UL;
+
+  if (reportedEpisode != _stateStartTime) {
+    reportedEpisode = _stateStartTime;
     lastErrorLog = millis();
 
     DUAL_LOGF(LOG_ERR, "========================================\n");
@@ -416,6 +504,10 @@ void TemperatureController::handleErrorState() {
     DUAL_LOGF(LOG_ERR, "  2. Use web interface to restart\n");
     DUAL_LOGF(LOG_ERR, "  3. Or power cycle the ESP32\n");
     DUAL_LOGF(LOG_ERR, "========================================\n");
+  } else if (millis() - lastErrorLog > 5000) {
+    lastErrorLog = millis();
+    DUAL_LOGF(LOG_ERR, "[TEMP] Still in ERROR state (sensor fault 0x%02X), restart to recover\n",
+              _tempSensor->getFaultStatus());
   }
 }
 
@@ -494,31 +586,80 @@ void TemperatureController::updatePID() {
 
 void TemperatureController::applyPIDOutput() {
   // Time-proportioning control: auger cycles on/off within AUGER_CYCLE_TIME window
-  // based on PID output (0.0 to 1.0)
-
-  unsigned long now = millis();
-  unsigned long cyclePosition = (now - _augerCycleStart) % AUGER_CYCLE_TIME;
+  // based on PID output (0.0 to 1.0). The edges are timed by _augerTimer, so
+  // on-time resolution is 1ms rather than TEMP_CONTROL_INTERVAL.
 
   // Calculate on-time from PID output (already enforces minimum via PID_OUTPUT_MIN)
-  unsigned long onTime = (unsigned long)(AUGER_CYCLE_TIME * _pidOutput);
+  _augerOnTime = (unsigned long)(AUGER_CYCLE_TIME * _pidOutput);
 
-  // Reset cycle if it wrapped
-  if (cyclePosition < 100 && (now - _augerCycleStart) > AUGER_CYCLE_TIME) {
-    _augerCycleStart = now;
+  // First output in RUNNING starts a cycle now
+  if (!_augerCycleActive) {
+    _augerCycleActive = true;
+    _augerCycleStart = millis();
+    _augerCycleState = (_relayControl->getAuger() == RELAY_ON);
+  }
+
+  // A new output re-times the cycle in progress
+  scheduleAugerEdge();
+}
+
+// Set the auger for the current position in the cycle, then arm the timer
+// for the next edge: the end of the on-time, or the end of the cycle.
+// Called with the controller mutex held, from the tick or the esp_timer
+// task, so the relay is switched without Serial output.
+void TemperatureController::scheduleAugerEdge() {
+  unsigned long now = millis();
+  unsigned long cyclePosition = now - _augerCycleStart;
+
+  // Next cycle starts where the last one ended, so timer latency doesn't
+  // stretch cycles; if a whole cycle was missed, start afresh
+  if (cyclePosition >= AUGER_CYCLE_TIME) {
+    _augerCycleStart = (cyclePosition < 2 * AUGER_CYCLE_TIME)
+                         ? _augerCycleStart + AUGER_CYCLE_TIME
+                         : now;
+    cyclePosition = now - _augerCycleStart;
   }
 
   // Determine auger state based on position in cycle
-  bool shouldBeOn = (cyclePosition < onTime);
+  bool shouldBeOn = (cyclePosition < _augerOnTime);
 
-  // Only change state if needed (reduces relay wear)
-  if (shouldBeOn != _augerCycleState) {
+  // Only change state if needed (reduces relay wear). An ON edge refused by
+  // the fan interlock leaves the auger recorded as off.
+  if (shouldBeOn != _augerCycleState &&
+      _relayControl->setSafeAugerQuiet(shouldBeOn ? RELAY_ON : RELAY_OFF)) {
     _augerCycleState = shouldBeOn;
-    if (shouldBeOn) {
-      _relayControl->setSafeAuger(RELAY_ON);
-    } else {
-      _relayControl->setAuger(RELAY_OFF);
-    }
   }
+
+  unsigned long nextEdge = shouldBeOn ? _augerOnTime : AUGER_CYCLE_TIME;
+  _augerTimer.start(nextEdge - cyclePosition);
+}
+
+void TemperatureController::stopAugerCycle() {
+  _augerTimer.stop();
+  _augerCycleActive = false;
+}
+
+// Runs on the esp_timer task. A control tick may hold the mutex for a few ms
+// (SPI read, NVS save); rather than block that task, retry the edge after
+// AUGER_EDGE_RETRY_MS. A tick that reaches applyPIDOutput re-arms the timer
+// itself, replacing the retry.
+void TemperatureController::onAugerTimer(void* arg) {
+  TemperatureController* self = static_cast<TemperatureController*>(arg);
+#ifdef ARDUINO_ARCH_ESP32
+  if (xSemaphoreTakeRecursive(self->_mutex, 0) != pdTRUE) {
+    self->_augerTimer.start(AUGER_EDGE_RETRY_MS);
+    return;
+  }
+#endif
+
+  // Left RUNNING since the timer was armed: leave the auger to the new state
+  if (self->_augerCycleActive && self->_state == STATE_RUNNING && !self->_debugMode) {
+    self->scheduleAugerEdge();
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGiveRecursive(self->_mutex);
+#endif
 }
 
 void TemperatureController::manageFan() {
@@ -577,9 +718,14 @@ bool TemperatureController::readTemperature() {
 void TemperatureController::handleSensorError() {
   _consecutiveErrors++;
 
+  // Already stopped: the failure details were logged on the way in
+  if (_state == STATE_ERROR) {
+    reportErrorState();
+    return;
+  }
+
   DUAL_LOGF(LOG_WARNING, "----------------------------------------\n");
-  DUAL_LOGF(LOG_WARNING, "[TEMP] SENSOR READ FAILURE #%d of %d\n",
-            _consecutiveErrors, SENSOR_ERROR_THRESHOLD);
+  LOG_EVENT(SENSOR_FAILURE, _consecutiveErrors, SENSOR_ERROR_THRESHOLD);
 
   // Get detailed fault information from sensor
   uint8_t fault = _tempSensor->getFaultStatus();
@@ -596,6 +742,7 @@ void TemperatureController::handleSensorError() {
 
   if (_consecutiveErrors >= SENSOR_ERROR_THRESHOLD) {
     _state = STATE_ERROR;
+    _stateStartTime = millis();
     _relayControl->emergencyStop();
 
     DUAL_LOGF(LOG_CRIT, "\n!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
@@ -631,6 +778,7 @@ void TemperatureController::handleTemperatureError() {
   DUAL_LOGF(LOG_CRIT, "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
 
   _state = STATE_ERROR;
+  _stateStartTime = millis();
   _relayControl->emergencyStop();
 }
 
@@ -719,9 +867,7 @@ void TemperatureController::handleReigniteState() {
       // Success: temp rose above threshold
       if (_currentTemp >= REIGNITE_TEMP_THRESHOLD) {
         _reigniteAttempts++;
-        DUAL_LOGF(LOG_INFO,
-          "[REIGNITE] Success! Temp=%.1f°F. Returning to RUNNING. (Attempt %d)\n",
-          _currentTemp, _reigniteAttempts);
+        LOG_EVENT(REIGNITE_SUCCESS, _currentTemp, _reigniteAttempts);
         _state = STATE_RUNNING;
         _stateStartTime = millis();
         _pidMaxedSince = 0;
@@ -737,15 +883,11 @@ void TemperatureController::handleReigniteState() {
       if (phaseElapsed >= REIGNITE_RECOVERY_TIME) {
         _reigniteAttempts++;
         if (_reigniteAttempts >= REIGNITE_MAX_ATTEMPTS) {
-          DUAL_LOGF(LOG_CRIT,
-            "[REIGNITE] Recovery failed after %d attempts. Entering ERROR state.\n",
-            _reigniteAttempts);
+          LOG_EVENT(REIGNITE_FAILED, _reigniteAttempts);
           _state = STATE_ERROR;
           _relayControl->emergencyStop();
         } else {
-          DUAL_LOGF(LOG_WARNING,
-            "[REIGNITE] Recovery failed (attempt %d/%d). Retrying...\n",
-            _reigniteAttempts, REIGNITE_MAX_ATTEMPTS);
+          LOG_EVENT(REIGNITE_RETRY, _reigniteAttempts, REIGNITE_MAX_ATTEMPTS);
           _reignitePhase = 0;
           _reignitePhaseStart = millis();
         }
@@ -773,9 +915,7 @@ void TemperatureController::detectLidOpen() {
       _lidOpen = true;
       _lidOpenTime = now;
       _lidStableTime = 0;
-      DUAL_LOGF(LOG_INFO,
-        "[LID] Lid opened detected! dT/dt=%.2f°F/s (threshold=%.1f)\n",
-        dTdt, LID_OPEN_DERIVATIVE_THRESHOLD);
+      LOG_EVENT(LID_OPEN, dTdt, LID_OPEN_DERIVATIVE_THRESHOLD);
     }
   } else {
     // Detect lid closing: temperature stabilizing
@@ -786,9 +926,7 @@ void TemperatureController::detectLidOpen() {
       } else if ((now - _lidStableTime) >= (uint32_t)LID_CLOSE_RECOVERY_TIME) {
         // Stable for long enough — declare lid closed
         uint32_t openDuration = (now - _lidOpenTime) / 1000;
-        DUAL_LOGF(LOG_INFO,
-          "[LID] Lid closed. Open for %lus. Integral preserved at %.2f\n",
-          openDuration, _integral);
+        LOG_EVENT(LID_CLOSED, openDuration, _integral);
         _lidOpen = false;
         _lidOpenTime = 0;
         _lidStableTime = 0;
@@ -810,12 +948,19 @@ uint32_t TemperatureController::getLidOpenDuration(void) {
   return (millis() - _lidOpenTime) / 1000;
 }
 
+MAX31865::DiagData TemperatureController::getSensorDiagnostics(void) {
+  CONTROL_LOCK();
+  return _tempSensor->getDiagnostics();
+}
+
 // Debug/Testing Methods
 void TemperatureController::setDebugMode(bool enabled) {
+  CONTROL_LOCK();
   _debugMode = enabled;
 
   if (enabled) {
     // When entering debug mode, turn off all relays
+    stopAugerCycle();
     _relayControl->allOff();
     if (ENABLE_SERIAL_DEBUG) {
       Serial.println("[TEMP] Debug mode ENABLED - manual control active");
@@ -828,6 +973,8 @@ void TemperatureController::setDebugMode(bool enabled) {
       Serial.println("[TEMP] Debug mode DISABLED - automatic control active");
     }
   }
+
+  publishSnapshot();
 }
 
 bool TemperatureController::isDebugMode(void) {
@@ -835,6 +982,7 @@ bool TemperatureController::isDebugMode(void) {
 }
 
 void TemperatureController::setManualRelay(const char* relay, bool state) {
+  CONTROL_LOCK();
   if (!_debugMode) {
     if (ENABLE_SERIAL_DEBUG) {
       Serial.println("[TEMP] Manual relay control requires debug mode");
@@ -858,24 +1006,33 @@ void TemperatureController::setManualRelay(const char* relay, bool state) {
       Serial.printf("[TEMP] Manual: Igniter %s\n", state ? "ON" : "OFF");
     }
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::setTempOverride(float temp) {
+  CONTROL_LOCK();
   _tempOverrideEnabled = true;
   _tempOverrideValue = temp;
   if (ENABLE_SERIAL_DEBUG) {
     Serial.printf("[TEMP] Temperature override set to %.1f°F\n", temp);
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::clearTempOverride(void) {
+  CONTROL_LOCK();
   _tempOverrideEnabled = false;
   if (ENABLE_SERIAL_DEBUG) {
     Serial.println("[TEMP] Temperature override cleared");
   }
+
+  publishSnapshot();
 }
 
 void TemperatureController::resetError(void) {
+  CONTROL_LOCK();
   if (_state == STATE_ERROR) {
     _state = STATE_IDLE;
     _consecutiveErrors = 0;
@@ -884,6 +1041,8 @@ void TemperatureController::resetError(void) {
       Serial.println("[TEMP] Error state cleared - returned to IDLE");
     }
   }
+
+  publishSnapshot();
 }
 
 // ============================================================================
@@ -912,49 +1071,41 @@ void TemperatureController::recordHistorySample() {
   if (now - _lastHistorySample < HISTORY_SAMPLE_INTERVAL) return;
   _lastHistorySample = now;
 
-  HistorySample& s = _history[_historyHead];
-  s.time = now / 1000;
+  HistorySample s;
+  memset(&s, 0, sizeof(s));
+  s.time = _historyTimeBase + now / 1000;
   float clampedTemp = constrain(_currentTemp, -3276.0f, 3276.0f);
   s.temp = (int16_t)(clampedTemp * 10.0f);
   s.setpoint = (int16_t)(_setpoint * 10.0f);
   s.state = (uint8_t)_state;
 
-  _historyHead = (_historyHead + 1) % HISTORY_MAX_SAMPLES;
-  if (_historyCount < HISTORY_MAX_SAMPLES) _historyCount++;
+  _history.recordSample(s);
+  if (_journal) _journal->appendSample(s);
 }
 
 void TemperatureController::recordHistoryEvent(ControllerState newState) {
-  HistoryEvent& e = _events[_eventHead];
-  e.time = millis() / 1000;
-  e.state = (uint8_t)newState;
-
-  _eventHead = (_eventHead + 1) % HISTORY_MAX_EVENTS;
-  if (_eventCount < HISTORY_MAX_EVENTS) _eventCount++;
+  uint32_t t = getHistoryTime();
+  _history.recordEvent(t, (uint8_t)newState);
+  if (_journal) _journal->appendEvent(t, (uint8_t)newState);
 }
 
-uint16_t TemperatureController::getHistoryCount(void) {
-  return _historyCount;
-}
+void TemperatureController::attachJournal(HistoryJournal* journal) {
+  CONTROL_LOCK();
+  journal->begin(_history);
 
-const HistorySample& TemperatureController::getHistorySampleAt(uint16_t index) {
-  // index 0 = oldest sample
-  uint16_t start = (_historyCount < HISTORY_MAX_SAMPLES)
-                       ? 0
-                       : _historyHead;
-  uint16_t pos = (start + index) % HISTORY_MAX_SAMPLES;
-  return _history[pos];
-}
-
-uint8_t TemperatureController::getEventCount(void) {
-  return _eventCount;
+  // Continue the history clock after the newest restored record
+  uint32_t latest = _history.latestTime();
+  HistoryEvent e;
+  if (_history.events().read(_history.events().end() - 1, e) && e.time > latest) {
+    latest = e.time;
+  }
+  _historyTimeBase = latest;
+  _journal = journal;
+  publishSnapshot();
 }
 
-const HistoryEvent& TemperatureController::getHistoryEventAt(uint8_t index) {
-  uint8_t start = (_eventCount < HISTORY_MAX_EVENTS)
-                      ? 0
-                      : _eventHead;
-  uint8_t pos = (start + index) % HISTORY_MAX_EVENTS;
-  return _events[pos];
+uint32_t TemperatureController::getHistoryTime(void) {
+  return _historyTimeBase + millis() / 1000;
 }
 
 uint32_t TemperatureController::getUptime(void) {
@@ -972,14 +1123,10 @@ void TemperatureController::loadIntegralFromNVS() {
 
   if (savedSetpoint > 0.0f && setpointDiff <= PID_SETPOINT_TOLERANCE) {
     _integral = savedIntegral;
-    DUAL_LOGF(LOG_INFO,
-      "[PID] Restored integral=%.1f from NVS (saved@%.0f, current@%.0f, diff=%.0f)\n",
-      savedIntegral, savedSetpoint, _setpoint, setpointDiff);
+    LOG_EVENT(PID_RESTORED, savedIntegral, savedSetpoint, _setpoint, setpointDiff);
   } else if (savedSetpoint > 0.0f) {
     _integral = 0.0f;
-    DUAL_LOGF(LOG_INFO,
-      "[PID] Discarding saved integral (setpoint diff=%.0f > tolerance=%.0f)\n",
-      setpointDiff, PID_SETPOINT_TOLERANCE);
+    LOG_EVENT(PID_DISCARDED, setpointDiff, PID_SETPOINT_TOLERANCE);
   } else {
     _integral = 0.0f;
     if (ENABLE_SERIAL_DEBUG) {
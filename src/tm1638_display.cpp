@@ -4,8 +4,7 @@ TM1638Display::TM1638Display()
     : _display(nullptr),
       _currentTemp(0.0),
       _targetTemp(0.0),
-      _lastButtons(0),
-      _ledState(0) {}
+      _lastButtons(0) {}
 
 void TM1638Display::begin() {
   if (ENABLE_SERIAL_DEBUG) {
@@ -38,6 +37,9 @@ void TM1638Display::begin() {
 void TM1638Display::update() {
   if (!_display) return;
 
+  // Unshadowed, every call rewrote all 8 digits
+  _shadow.request(TM1638_DIGITS);
+
   // Format and display current temperature (left 4 digits)
   char leftBuffer[5];
   formatTemperature(_currentTemp, leftBuffer);
@@ -58,15 +60,36 @@ void TM1638Display::update() {
                   displayBuffer, _currentTemp, _targetTemp);
   }
 
-  // Display the string
-  _display->setDisplayToString(displayBuffer);
+  _shadow.setDigits(displayBuffer);
+  flush();
+}
+
+// Send the digits and LEDs that differ from what the module shows, one
+// position (one bus transaction) at a time
+void TM1638Display::flush() {
+  uint8_t digits = _shadow.takeDigits();
+  for (uint8_t pos = 0; pos < TM1638_DIGITS; pos++) {
+    if (digits & (1 << pos)) {
+      char digit[2] = {_shadow.digits()[pos], '\0'};
+      _display->setDisplayToString(digit, 0, pos);
+    }
+  }
+
+  uint8_t leds = _shadow.takeLeds();
+  for (uint8_t pos = 0; pos < TM1638_DIGITS; pos++) {
+    if (leds & (1 << pos)) {
+      _display->setLED(_shadow.ledColor(pos), pos);
+    }
+  }
 }
 
 void TM1638Display::clear() {
   if (_display) {
-    _display->clearDisplay();
-    _ledState = 0;
-    _display->setLEDs(_ledState);
+    // Contents are unknown after the test pattern: send every position
+    _shadow.invalidate();
+    _shadow.setDigits("");
+    _shadow.setLeds(0);
+    flush();
   }
 }
 
@@ -104,13 +127,9 @@ void TM1638Display::formatTemperature(float temp, char* buffer) {
 void TM1638Display::setLED(uint8_t ledNum, bool state) {
   if (!_display || ledNum > 7) return;
 
-  if (state) {
-    _ledState |= (1 << ledNum);
-  } else {
-    _ledState &= ~(1 << ledNum);
-  }
-
-  _display->setLEDs(_ledState);
+  // Unshadowed, every call rewrote all 8 LEDs
+  _shadow.request(TM1638_DIGITS);
+  _shadow.setLed(ledNum, state);
 }
 
 void TM1638Display::setRelayLEDs(bool auger, bool fan, bool igniter) {
@@ -136,3 +155,10 @@ uint8_t TM1638Display::readButtons() {
 bool TM1638Display::isButtonPressed(uint8_t button) {
   return (_lastButtons & button) != 0;
 }
+
+TM1638Display::BusStats TM1638Display::getBusStats() const {
+  BusStats stats;
+  stats.sent = _shadow.sent();
+  stats.saved = _shadow.saved();
+  return stats;
+}
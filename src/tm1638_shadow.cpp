@@ -0,0 +1,65 @@
+#include "tm1638_shadow.h"
+#include <string.h>
+
+TM1638Shadow::TM1638Shadow()
+    : _leds(0), _shownLeds(0), _digitsKnown(false), _ledsKnown(false), _sent(0),
+      _requested(0) {
+  memset(_digits, ' ', TM1638_DIGITS);
+  _digits[TM1638_DIGITS] = '\0';
+  memset(_shownDigits, ' ', TM1638_DIGITS);
+}
+
+void TM1638Shadow::invalidate() {
+  _digitsKnown = false;
+  _ledsKnown = false;
+}
+
+void TM1638Shadow::setDigits(const char* text) {
+  size_t len = strnlen(text, TM1638_DIGITS);
+  memcpy(_digits, text, len);
+  memset(_digits + len, ' ', TM1638_DIGITS - len);
+}
+
+void TM1638Shadow::setLed(uint8_t pos, bool on) {
+  if (pos >= TM1638_DIGITS) return;
+  if (on) {
+    _leds |= (uint16_t)(1 << pos);
+  } else {
+    _leds &= (uint16_t)~(1 << pos);
+  }
+}
+
+void TM1638Shadow::setLeds(uint16_t leds) {
+  _leds = leds;
+}
+
+bool TM1638Shadow::dirty() const {
+  return !_digitsKnown || !_ledsKnown || _leds != _shownLeds ||
+         memcmp(_digits, _shownDigits, TM1638_DIGITS) != 0;
+}
+
+uint8_t TM1638Shadow::takeDigits() {
+  uint8_t changed = 0;
+  for (uint8_t i = 0; i < TM1638_DIGITS; i++) {
+    if (!_digitsKnown || _digits[i] != _shownDigits[i]) {
+      changed |= (uint8_t)(1 << i);
+      _shownDigits[i] = _digits[i];
+      _sent++;
+    }
+  }
+  _digitsKnown = true;
+  return changed;
+}
+
+uint8_t TM1638Shadow::takeLeds() {
+  uint16_t diff = _ledsKnown ? (uint16_t)(_leds ^ _shownLeds) : 0xFFFF;
+  uint8_t changed = (uint8_t)(diff | (diff >> 8));
+  _shownLeds = _leds;
+  _ledsKnown = true;
+  for (uint8_t m = changed; m; m &= (uint8_t)(m - 1)) _sent++;
+  return changed;
+}
+
+uint8_t TM1638Shadow::ledColor(uint8_t pos) const {
+  return (uint8_t)(((_leds >> pos) & 1) | (((_leds >> (pos + 8)) & 1) << 1));
+}
@@ -1,7 +1,7 @@
 #include "tui_server.h"
-#include "ansi_utils.h"
 #include "config.h"
 #include <WiFi.h>
+#include <esp_wifi.h>
 
 // Static instance pointer for callbacks
 static TUIServer* _instance = nullptr;
@@ -32,7 +32,7 @@ void onTUIDisconnect(String ip) {
 }
 
 TUIServer::TUIServer(TemperatureController* controller, MAX31865* sensor)
-  : _controller(controller), _sensor(sensor), _lastUpdate(0), _updateInterval(1000) {
+  : _controller(controller), _sensor(sensor) {
   _instance = this;
 }
 
@@ -51,40 +51,78 @@ void TUIServer::begin(uint16_t port) {
   }
 }
 
-void TUIServer::update() {
+void TUIServer::poll() {
   _telnet.loop();
+}
 
-  // Update display at specified interval if clients are connected
-  if (_telnet.isConnected() && (millis() - _lastUpdate >= _updateInterval)) {
-    _lastUpdate = millis();
-    renderScreen();
-  }
+void TUIServer::render() {
+  if (_telnet.isConnected()) renderScreen();
 }
 
 bool TUIServer::hasClients() {
   return _telnet.isConnected();
 }
 
+// Full repaint on the next frame, for a client that has just connected
 void TUIServer::clearScreen() {
-  _telnet.print(ANSI::CLEAR_SCREEN);
-  _telnet.print(ANSI::CURSOR_HOME);
-  _telnet.print(ANSI::HIDE_CURSOR);
+  _screen.invalidate();
 }
 
-void TUIServer::moveCursor(int row, int col) {
-  _telnet.print(ANSI::cursorTo(row, col));
+// One ScreenBuffer chunk to the client. A failed or short write makes the
+// next frame a full repaint.
+bool TUIServer::sendToClient(void* ctx, const char* data, size_t len) {
+  return static_cast<TUITelnet*>(ctx)->send(data, len);
 }
 
-void TUIServer::print(const String& text) {
-  _telnet.print(text);
+// padRight/padLeft for preformatted text plus a unit suffix
+void TUIServer::printPadded(uint8_t style, const char* text, const char* suffix, int width,
+                            bool alignRight) {
+  char value[40];
+  snprintf(value, sizeof(value), "%s%s", text, suffix);
+  _screen.setStyle(style);
+  _screen.printPadded(value, (uint8_t)width, alignRight);
 }
 
-void TUIServer::println(const String& text) {
-  _telnet.println(text);
+// Panel frame with `lines` rows of content below the title. Drawn after the
+// content so an overlong line cannot overwrite the right border.
+void TUIServer::drawBox(uint8_t top, uint8_t lines, const char* title) {
+  _screen.moveTo(top, 0);
+  _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_WHITE, "┌─ ");
+  _screen.print(title);
+  _screen.print(" ");
+  _screen.setStyle(ScreenBuffer::STYLE_DEFAULT);
+  _screen.repeat("─", TUI_COLS - 1 - _screen.col());
+  _screen.print("┐");
+
+  for (uint8_t i = 1; i <= lines; i++) {
+    _screen.moveTo(top + i, 0);
+    _screen.print(ScreenBuffer::STYLE_DEFAULT, "│");
+    _screen.moveTo(top + i, TUI_COLS - 1);
+    _screen.print("│");
+  }
+
+  _screen.moveTo(top + lines + 1, 0);
+  _screen.print("└");
+  _screen.repeat("─", TUI_COLS - 2);
+  _screen.print("┘");
 }
 
+// Screen layout: top row of each panel
+#define ROW_HEADER        0
+#define ROW_TEMPERATURE   4
+#define ROW_PID           8
+#define ROW_STATE         14
+#define ROW_RELAYS        18
+#define ROW_SENSOR        22
+#define ROW_NETWORK       28
+#define ROW_FOOTER        33
+
 void TUIServer::renderScreen() {
-  moveCursor(1, 1);
+  // Render every panel from one consistent controller snapshot; values
+  // shared with the web UI and MQTT come preformatted from the status cache
+  _snap = statusCache.valid() ? statusCache.snapshot() : _controller->getSnapshot();
+
+  _screen.clear();
   renderHeader();
   renderTemperature();
   renderPIDStatus();
@@ -93,442 +131,279 @@ void TUIServer::renderScreen() {
   renderMAX31865Diagnostics();
   renderNetworkStatus();
   renderFooter();
+
+  _screen.present(sendToClient, &_telnet);
 }
 
 void TUIServer::renderHeader() {
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_CYAN);
-  println("╔════════════════════════════════════════════════════════════════════════════╗");
-  println("║              ESP32 WOOD PELLET SMOKER CONTROLLER - TUI                    ║");
-  println("╚════════════════════════════════════════════════════════════════════════════╝");
-  print(ANSI::RESET);
-  println("");
+  const uint8_t style = ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_CYAN;
+  _screen.moveTo(ROW_HEADER, 0);
+  _screen.print(style, "╔");
+  _screen.repeat("═", TUI_COLS - 2);
+  _screen.print("╗");
+  _screen.moveTo(ROW_HEADER + 1, 0);
+  _screen.print("║              ESP32 WOOD PELLET SMOKER CONTROLLER - TUI");
+  _screen.moveTo(ROW_HEADER + 1, TUI_COLS - 1);
+  _screen.print("║");
+  _screen.moveTo(ROW_HEADER + 2, 0);
+  _screen.print("╚");
+  _screen.repeat("═", TUI_COLS - 2);
+  _screen.print("╝");
 }
 
 void TUIServer::renderTemperature() {
-  auto status = _controller->getStatus();
-
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ TEMPERATURE ");
-  print(ANSI::RESET);
-  println("─────────────────────────────────────────────────────────────────┐");
-
-  // Current temperature
-  print("│ ");
-  print(ANSI::BOLD);
-  print(ANSI::FG_YELLOW);
-  print("Current Temp: ");
-  print(ANSI::FG_BRIGHT_YELLOW);
-  print(padRight(String(status.currentTemp, 1) + "°F", 15));
-  print(ANSI::RESET);
-
-  // Setpoint
-  print("  ");
-  print(ANSI::BOLD);
-  print(ANSI::FG_CYAN);
-  print("Setpoint: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(String(status.setpoint, 1) + "°F", 15));
-  print(ANSI::RESET);
-
-  // Error
-  print("  ");
-  print(ANSI::BOLD);
-  print(ANSI::FG_MAGENTA);
-  print("Error: ");
+  const auto& status = _snap.status;
+  const StatusCache::Fields& f = statusCache.fields();
+
+  _screen.moveTo(ROW_TEMPERATURE + 1, 2);
+  _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_YELLOW, "Current Temp: ");
+  printPadded(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_YELLOW, f.temp, "°F", 15);
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_CYAN, "Setpoint: ");
+  printPadded(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_CYAN, f.setpoint, "°F", 15);
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_MAGENTA, "Error: ");
   float error = status.currentTemp - status.setpoint;
-  if (error > 0) {
-    print(ANSI::FG_BRIGHT_RED);
-    print("+");
-  } else {
-    print(ANSI::FG_BRIGHT_GREEN);
-  }
-  print(padLeft(String(error, 1) + "°F", 10));
-  print(ANSI::RESET);
-  println(" │");
+  char delta[16];
+  snprintf(delta, sizeof(delta), "%s%s", error > 0 ? "+" : "", f.tempDelta);
+  printPadded(ScreenBuffer::BOLD |
+                  (error > 0 ? ScreenBuffer::FG_BRIGHT_RED : ScreenBuffer::FG_BRIGHT_GREEN),
+              delta, "°F", 10, true);
 
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
+  drawBox(ROW_TEMPERATURE, 1, "TEMPERATURE");
 }
 
 void TUIServer::renderPIDStatus() {
-  auto pidStatus = _controller->getPIDStatus();
-
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ PID CONTROLLER ");
-  print(ANSI::RESET);
-  println("──────────────────────────────────────────────────────────────┐");
+  const auto& pidStatus = _snap.pid;
+  const StatusCache::Fields& f = statusCache.fields();
+  char value[24];
 
   // First row: P, I, D terms
-  print("│ ");
-  print(ANSI::FG_GREEN);
-  print("P: ");
-  print(ANSI::FG_BRIGHT_GREEN);
-  print(padRight(String(pidStatus.proportionalTerm, 4), 10));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_BLUE);
-  print("I: ");
-  print(ANSI::FG_BRIGHT_BLUE);
-  print(padRight(String(pidStatus.integralTerm, 4), 10));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_MAGENTA);
-  print("D: ");
-  print(ANSI::FG_BRIGHT_MAGENTA);
-  print(padRight(String(pidStatus.derivativeTerm, 4), 10));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::BOLD);
-  print(ANSI::FG_YELLOW);
-  print("Output: ");
-  print(ANSI::FG_BRIGHT_YELLOW);
-  print(padRight(String(pidStatus.output * 100.0, 1) + "%", 10));
-  print(ANSI::RESET);
-  println(" │");
+  _screen.moveTo(ROW_PID + 1, 2);
+  _screen.print(ScreenBuffer::FG_GREEN, "P: ");
+  printPadded(ScreenBuffer::FG_BRIGHT_GREEN, f.pidP, "", 10);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_BLUE, "I: ");
+  printPadded(ScreenBuffer::FG_BRIGHT_BLUE, f.pidI, "", 10);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_MAGENTA, "D: ");
+  printPadded(ScreenBuffer::FG_BRIGHT_MAGENTA, f.pidD, "", 10);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_YELLOW, "Output: ");
+  printPadded(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_YELLOW, f.pidOutput, "%", 10);
 
   // Second row: Gains
-  print("│ ");
-  print(ANSI::FG_GREEN);
-  print("Kp: ");
-  print(ANSI::FG_BRIGHT_GREEN);
-  print(padRight(String(pidStatus.Kp, 6), 9));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_BLUE);
-  print("Ki: ");
-  print(ANSI::FG_BRIGHT_BLUE);
-  print(padRight(String(pidStatus.Ki, 8), 9));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_MAGENTA);
-  print("Kd: ");
-  print(ANSI::FG_BRIGHT_MAGENTA);
-  print(padRight(String(pidStatus.Kd, 6), 9));
-  print(ANSI::RESET);
-
-  println("                    │");
+  _screen.moveTo(ROW_PID + 2, 2);
+  _screen.print(ScreenBuffer::FG_GREEN, "Kp: ");
+  snprintf(value, sizeof(value), "%.6f", pidStatus.Kp);
+  printPadded(ScreenBuffer::FG_BRIGHT_GREEN, value, "", 9);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_BLUE, "Ki: ");
+  snprintf(value, sizeof(value), "%.8f", pidStatus.Ki);
+  printPadded(ScreenBuffer::FG_BRIGHT_BLUE, value, "", 9);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_MAGENTA, "Kd: ");
+  snprintf(value, sizeof(value), "%.6f", pidStatus.Kd);
+  printPadded(ScreenBuffer::FG_BRIGHT_MAGENTA, value, "", 9);
 
   // Third row: Auger cycle info
-  print("│ ");
-  print(ANSI::FG_CYAN);
-  print("Auger Cycle: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(pidStatus.augerCycleState ? "ON " : "OFF");
-  print(ANSI::RESET);
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("Time Remaining: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(String(pidStatus.cycleTimeRemaining / 1000.0, 1) + "s", 10));
-  print(ANSI::RESET);
-  println("                │");
-
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
+  _screen.moveTo(ROW_PID + 3, 2);
+  _screen.print(ScreenBuffer::FG_CYAN, "Auger Cycle: ");
+  _screen.print(ScreenBuffer::FG_BRIGHT_CYAN, pidStatus.augerCycleState ? "ON " : "OFF");
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "Time Remaining: ");
+  snprintf(value, sizeof(value), "%.1f", pidStatus.cycleTimeRemaining / 1000.0);
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, value, "s", 10);
+
+  drawBox(ROW_PID, 3, "PID CONTROLLER");
 }
 
 void TUIServer::renderStateMachine() {
-  auto status = _controller->getStatus();
+  const auto& status = _snap.status;
   ControllerState state = status.state;
+  char value[24];
 
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ STATE MACHINE ");
-  print(ANSI::RESET);
-  println("────────────────────────────────────────────────────────────────┐");
-
-  print("│ ");
-  print(ANSI::BOLD);
-  print("State: ");
-  print(getStateColor(state));
-  print(padRight(_controller->getStateName(), 15));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::BOLD);
-  print("Runtime: ");
-  print(ANSI::FG_BRIGHT_WHITE);
-  print(padRight(formatUptime(status.runtime), 20));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::BOLD);
-  print("Errors: ");
-  if (status.errorCount > 0) {
-    print(ANSI::FG_BRIGHT_RED);
-  } else {
-    print(ANSI::FG_BRIGHT_GREEN);
-  }
-  print(String(status.errorCount));
-  print(ANSI::RESET);
-  println("    │");
+  _screen.moveTo(ROW_STATE + 1, 2);
+  _screen.print(ScreenBuffer::BOLD, "State: ");
+  printPadded(ScreenBuffer::BOLD | getStateStyle(state), TemperatureController::stateName(state),
+              "", 15);
 
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::BOLD, "Runtime: ");
+  formatUptime(status.runtime, value, sizeof(value));
+  printPadded(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_WHITE, value, "", 20);
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::BOLD, "Errors: ");
+  _screen.setStyle(ScreenBuffer::BOLD | (status.errorCount > 0 ? ScreenBuffer::FG_BRIGHT_RED
+                                                                : ScreenBuffer::FG_BRIGHT_GREEN));
+  _screen.printf("%u", (unsigned)status.errorCount);
+
+  drawBox(ROW_STATE, 1, "STATE MACHINE");
 }
 
 void TUIServer::renderRelayStatus() {
-  auto relayStates = _controller->getStatus();
-
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ RELAY STATUS ");
-  print(ANSI::RESET);
-  println("───────────────────────────────────────────────────────────────┐");
-
-  print("│ ");
-
-  // Auger
-  print(ANSI::BOLD);
-  print("Auger: ");
-  if (relayStates.auger) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("ON ");
-  } else {
-    print(ANSI::FG_BRIGHT_BLACK);
-    print("OFF");
+  const auto& relayStates = _snap.status;
+  struct {
+    const char* label;
+    bool on;
+  } relays[] = {
+    {"Auger: ", relayStates.auger},
+    {"Fan: ", relayStates.fan},
+    {"Igniter: ", relayStates.igniter},
+  };
+
+  _screen.moveTo(ROW_RELAYS + 1, 2);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (i > 0) _screen.print(ScreenBuffer::STYLE_DEFAULT, "     ");
+    _screen.print(ScreenBuffer::BOLD, relays[i].label);
+    if (relays[i].on) {
+      _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_GREEN, "ON ");
+    } else {
+      _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_BLACK, "OFF");
+    }
   }
-  print(ANSI::RESET);
 
-  print("     ");
+  drawBox(ROW_RELAYS, 1, "RELAY STATUS");
+}
 
-  // Fan
-  print(ANSI::BOLD);
-  print("Fan: ");
-  if (relayStates.fan) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("ON ");
-  } else {
-    print(ANSI::FG_BRIGHT_BLACK);
-    print("OFF");
-  }
-  print(ANSI::RESET);
+void TUIServer::renderMAX31865Diagnostics() {
+  // Register dump via the controller so it is serialized with control-cycle reads
+  auto diag = _controller->getSensorDiagnostics();
+  char value[24];
 
-  print("     ");
+  _screen.moveTo(ROW_SENSOR + 1, 2);
+  _screen.print(ScreenBuffer::FG_CYAN, "Raw ADC: ");
+  snprintf(value, sizeof(value), "%u", (unsigned)diag.adcValue);
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, value, "", 10);
 
-  // Igniter
-  print(ANSI::BOLD);
-  print("Igniter: ");
-  if (relayStates.igniter) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("ON ");
-  } else {
-    print(ANSI::FG_BRIGHT_BLACK);
-    print("OFF");
-  }
-  print(ANSI::RESET);
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "Resistance: ");
+  snprintf(value, sizeof(value), "%.2f", diag.resistance);
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, value, "Ω", 15);
 
-  println("                                │");
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
-}
-
-void TUIServer::renderMAX31865Diagnostics() {
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ MAX31865 RTD SENSOR ");
-  print(ANSI::RESET);
-  println("───────────────────────────────────────────────────────┐");
-
-  // Read raw RTD value
-  uint16_t rawRTD = _sensor->readRawRTD();
-  float resistance = (rawRTD * MAX31865_REFERENCE_RESISTANCE) / 32768.0;
-
-  print("│ ");
-  print(ANSI::FG_CYAN);
-  print("Raw ADC: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(String(rawRTD), 10));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("Resistance: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(String(resistance, 2) + "Ω", 15));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("Ref: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(String(MAX31865_REFERENCE_RESISTANCE, 0) + "Ω", 10));
-  print(ANSI::RESET);
-  println(" │");
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "Ref: ");
+  snprintf(value, sizeof(value), "%.0f", (double)MAX31865_REFERENCE_RESISTANCE);
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, value, "Ω", 10);
 
   // Fault status
-  uint8_t faultStatus = _sensor->getFaultStatus();
-  print("│ ");
-  print(ANSI::BOLD);
-  print("Fault Status: ");
+  uint8_t faultStatus = diag.faultStatus;
+  _screen.moveTo(ROW_SENSOR + 2, 2);
+  _screen.print(ScreenBuffer::BOLD, "Fault Status: ");
   if (faultStatus == 0) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("OK (0x00)");
+    _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_GREEN, "OK (0x00)");
   } else {
-    print(ANSI::FG_BRIGHT_RED);
-    print("FAULT (0x");
-    print(String(faultStatus, HEX));
-    print(")");
+    _screen.setStyle(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_RED);
+    _screen.printf("FAULT (0x%X)", faultStatus);
+
+    // Decode faults
+    _screen.print(ScreenBuffer::STYLE_DEFAULT, "  [");
+    if (faultStatus & MAX31865_FAULT_HIGHTEMP) _screen.print("HIGH_TEMP ");
+    if (faultStatus & MAX31865_FAULT_LOWTEMP) _screen.print("LOW_TEMP ");
+    if (faultStatus & MAX31865_FAULT_RTDIN) _screen.print("RTDIN_HIGH ");
+    if (faultStatus & MAX31865_FAULT_REFIN) _screen.print("REFIN_HIGH ");
+    if (faultStatus & MAX31865_FAULT_REFIN_LO) _screen.print("REFIN_LOW ");
+    if (faultStatus & MAX31865_FAULT_RTDIN_LO) _screen.print("RTDIN_LOW ");
+    _screen.print("]");
   }
-  print(ANSI::RESET);
-
-  // Decode faults
-  if (faultStatus != 0) {
-    print("  [");
-    if (faultStatus & MAX31865_FAULT_HIGHTEMP) print("HIGH_TEMP ");
-    if (faultStatus & MAX31865_FAULT_LOWTEMP) print("LOW_TEMP ");
-    if (faultStatus & MAX31865_FAULT_RTDIN) print("RTDIN_HIGH ");
-    if (faultStatus & MAX31865_FAULT_REFIN) print("REFIN_HIGH ");
-    if (faultStatus & MAX31865_FAULT_REFIN_LO) print("REFIN_LOW ");
-    if (faultStatus & MAX31865_FAULT_RTDIN_LO) print("RTDIN_LOW ");
-    print("]");
-  }
-
-  println("          │");
 
   // Health status
-  print("│ ");
-  print(ANSI::BOLD);
-  print("Health: ");
-  if (_sensor->isHealthy()) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("HEALTHY");
+  _screen.moveTo(ROW_SENSOR + 3, 2);
+  _screen.print(ScreenBuffer::BOLD, "Health: ");
+  if (faultStatus == 0) {
+    _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_GREEN, "HEALTHY");
   } else {
-    print(ANSI::FG_BRIGHT_RED);
-    print("UNHEALTHY");
+    _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_RED, "UNHEALTHY");
   }
-  print(ANSI::RESET);
-  println("                                                              │");
 
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
+  drawBox(ROW_SENSOR, 3, "MAX31865 RTD SENSOR");
 }
 
 void TUIServer::renderNetworkStatus() {
-  print(ANSI::BOLD);
-  print(ANSI::FG_BRIGHT_WHITE);
-  print("┌─ NETWORK STATUS ");
-  print(ANSI::RESET);
-  println("──────────────────────────────────────────────────────────────┐");
+  char value[24];
+
+  // SSID and RSSI straight from the driver; WiFi.SSID() builds a String
+  wifi_ap_record_t ap;
+  bool connected = WiFi.status() == WL_CONNECTED;
+  if (!connected || esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+    memset(&ap, 0, sizeof(ap));
+  }
 
   // WiFi status
-  print("│ ");
-  print(ANSI::BOLD);
-  print("WiFi: ");
-  if (WiFi.status() == WL_CONNECTED) {
-    print(ANSI::FG_BRIGHT_GREEN);
-    print("CONNECTED");
+  _screen.moveTo(ROW_NETWORK + 1, 2);
+  _screen.print(ScreenBuffer::BOLD, "WiFi: ");
+  if (connected) {
+    _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_GREEN, "CONNECTED");
   } else {
-    print(ANSI::FG_BRIGHT_RED);
-    print("DISCONNECTED");
+    _screen.print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_RED, "DISCONNECTED");
   }
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("SSID: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(WiFi.SSID(), 20));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("RSSI: ");
-  int rssi = WiFi.RSSI();
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "SSID: ");
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, (const char*)ap.ssid, "", 20);
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "RSSI: ");
+  int rssi = ap.rssi;
+  uint8_t rssiStyle;
   if (rssi > -50) {
-    print(ANSI::FG_BRIGHT_GREEN);
+    rssiStyle = ScreenBuffer::FG_BRIGHT_GREEN;
   } else if (rssi > -70) {
-    print(ANSI::FG_BRIGHT_YELLOW);
+    rssiStyle = ScreenBuffer::FG_BRIGHT_YELLOW;
   } else {
-    print(ANSI::FG_BRIGHT_RED);
+    rssiStyle = ScreenBuffer::FG_BRIGHT_RED;
   }
-  print(padRight(String(rssi) + "dBm", 10));
-  print(ANSI::RESET);
-  println(" │");
+  snprintf(value, sizeof(value), "%d", rssi);
+  printPadded(rssiStyle, value, "dBm", 10);
 
   // IP address
-  print("│ ");
-  print(ANSI::FG_CYAN);
-  print("IP Address: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(WiFi.localIP().toString(), 20));
-  print(ANSI::RESET);
-
-  print("  ");
-  print(ANSI::FG_CYAN);
-  print("Hostname: ");
-  print(ANSI::FG_BRIGHT_CYAN);
-  print(padRight(WiFi.getHostname(), 25));
-  print(ANSI::RESET);
-  println(" │");
-
-  println("└────────────────────────────────────────────────────────────────────────────┘");
-  println("");
+  IPAddress ip = WiFi.localIP();
+  _screen.moveTo(ROW_NETWORK + 2, 2);
+  _screen.print(ScreenBuffer::FG_CYAN, "IP Address: ");
+  snprintf(value, sizeof(value), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, value, "", 20);
+
+  _screen.print(ScreenBuffer::STYLE_DEFAULT, "  ");
+  _screen.print(ScreenBuffer::FG_CYAN, "Hostname: ");
+  const char* hostname = WiFi.getHostname();
+  printPadded(ScreenBuffer::FG_BRIGHT_CYAN, hostname ? hostname : "", "", 25);
+
+  drawBox(ROW_NETWORK, 2, "NETWORK STATUS");
 }
 
 void TUIServer::renderFooter() {
-  print(ANSI::FG_BRIGHT_BLACK);
-  print("Firmware: ");
-  print(FIRMWARE_VERSION);
-  print("  │  Uptime: ");
-  print(formatUptime(millis()));
-  print("  │  Press Ctrl+] then 'quit' to disconnect");
-  print(ANSI::RESET);
-  println("");
-}
+  char uptime[24];
+  formatUptime(millis(), uptime, sizeof(uptime));
 
-String TUIServer::padRight(String text, int width) {
-  while (text.length() < width) {
-    text += " ";
-  }
-  if (text.length() > width) {
-    text = text.substring(0, width);
-  }
-  return text;
-}
-
-String TUIServer::padLeft(String text, int width) {
-  while (text.length() < width) {
-    text = " " + text;
-  }
-  if (text.length() > width) {
-    text = text.substring(0, width);
-  }
-  return text;
+  _screen.moveTo(ROW_FOOTER, 0);
+  _screen.setStyle(ScreenBuffer::FG_BRIGHT_BLACK);
+  _screen.printf("Firmware: %s  │  Uptime: %s  │  Ctrl+] then 'quit' to disconnect",
+                 FIRMWARE_VERSION, uptime);
 }
 
-const char* TUIServer::boolToOnOff(bool value) {
-  return value ? "ON" : "OFF";
-}
-
-const char* TUIServer::getStateColor(ControllerState state) {
+uint8_t TUIServer::getStateStyle(ControllerState state) {
   switch (state) {
     case STATE_IDLE:
-      return ANSI::FG_BRIGHT_BLACK;
+      return ScreenBuffer::FG_BRIGHT_BLACK;
     case STATE_STARTUP:
-      return ANSI::FG_BRIGHT_YELLOW;
+      return ScreenBuffer::FG_BRIGHT_YELLOW;
     case STATE_RUNNING:
-      return ANSI::FG_BRIGHT_GREEN;
+      return ScreenBuffer::FG_BRIGHT_GREEN;
     case STATE_COOLDOWN:
-      return ANSI::FG_BRIGHT_BLUE;
+      return ScreenBuffer::FG_BRIGHT_BLUE;
     case STATE_SHUTDOWN:
-      return ANSI::FG_BRIGHT_MAGENTA;
+      return ScreenBuffer::FG_BRIGHT_MAGENTA;
     case STATE_ERROR:
-      return ANSI::FG_BRIGHT_RED;
+      return ScreenBuffer::FG_BRIGHT_RED;
     default:
-      return ANSI::FG_WHITE;
+      return ScreenBuffer::FG_WHITE;
   }
 }
 
-String TUIServer::formatUptime(unsigned long ms) {
+void TUIServer::formatUptime(unsigned long ms, char* buf, size_t size) {
   unsigned long seconds = ms / 1000;
   unsigned long minutes = seconds / 60;
   unsigned long hours = minutes / 60;
@@ -538,17 +413,13 @@ String TUIServer::formatUptime(unsigned long ms) {
   minutes %= 60;
   hours %= 24;
 
-  String uptime = "";
   if (days > 0) {
-    uptime += String(days) + "d ";
-  }
-  if (hours > 0 || days > 0) {
-    uptime += String(hours) + "h ";
-  }
-  if (minutes > 0 || hours > 0 || days > 0) {
-    uptime += String(minutes) + "m ";
+    snprintf(buf, size, "%lud %luh %lum %lus", days, hours, minutes, seconds);
+  } else if (hours > 0) {
+    snprintf(buf, size, "%luh %lum %lus", hours, minutes, seconds);
+  } else if (minutes > 0) {
+    snprintf(buf, size, "%lum %lus", minutes, seconds);
+  } else {
+    snprintf(buf, size, "%lus", seconds);
   }
-  uptime += String(seconds) + "s";
-
-  return uptime;
 }
@@ -1,15 +1,25 @@
 #include "web_server.h"
+#include <memory>
 #include "config.h"
+#include "history_stream.h"
+#include "status_cache.h"
+#include "crash_log.h"
 #include "web_content.h"
 #include "http_ota.h"
 #include "logger.h"
+#include "profiler.h"
+#include "heap_monitor.h"
 
 WebServer::WebServer(TemperatureController* controller, uint16_t port)
-    : _server(port), _controller(controller), _port(port), _running(false) {}
+    : _server(port), _events("/api/events"), _controller(controller), _port(port),
+      _running(false), _eventSeq(0), _eventHistoryCursor(0), _eventLogSeq(0) {
+  memset(&_eventStats, 0, sizeof(_eventStats));
+  _eventFrame[0] = '\0';
+}
 
 void WebServer::begin() {
   setupRoutes();
-  setupWebSocket();
+  setupEventStream();
 
   // Start server
   _server.begin();
@@ -34,7 +44,59 @@ bool WebServer::isRunning(void) {
 }
 
 void WebServer::notifyClients(const String& message) {
-  // WebSocket broadcast would go here
+#if ENABLE_EVENT_STREAM
+  _events.send(message.c_str(), "message");
+#endif
+}
+
+// ============================================================================
+// HISTORY
+// ============================================================================
+
+// GET /api/history[?since=<time>][&points=<n>][&format=bin]
+//
+// since:  only samples and events in (since, latest] and buckets ending
+//         after since (history clock seconds). Pass the previous response's
+//         "latest" to fetch just what was added.
+// points: reduce buckets and samples to about n samples (see
+//         HistoryDownsampler), all returned as samples; events are never
+//         reduced.
+//
+// JSON (default), temps as int °F×10:
+//   {"now":T,"latest":T,"buckets":[[time, seconds, min, max, mean, setpoint, state],...],
+//    "samples":[[time, temp, setpoint, state],...],"events":[[time, state],...]}
+// Buckets hold older, folded history (oldest first) and end where samples
+// begin. With since, a bucket is returned when it ends after since, so buckets
+// folded around the cursor come back; its start may be at or before since.
+//
+// Binary (application/octet-stream, little-endian, packed):
+//   header  'S' 'H' version:u8=1 flags:u8=0 now:u32 latest:u32
+//   records, each led by a type byte, in the JSON order:
+//   'B' time:u32 seconds:u16 min:i16 max:i16 mean:i16 setpoint:i16 state:u8
+//   'S' time:u32 temp:i16 setpoint:i16 state:u8
+//   'E' time:u32 state:u8
+void WebServer::handleHistory(AsyncWebServerRequest* request) {
+  uint32_t since = 0;
+  if (request->hasParam("since")) {
+    since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+  }
+  uint16_t points = 0;
+  if (request->hasParam("points")) {
+    unsigned long n = strtoul(request->getParam("points")->value().c_str(), nullptr, 10);
+    points = (uint16_t)(n > 65535 ? 65535 : n);
+  }
+  bool binary = request->hasParam("format") && request->getParam("format")->value() == "bin";
+
+  // Chunked so the body is formatted one TCP window at a time on async_tcp;
+  // the stream is freed with the response, including on disconnect
+  std::shared_ptr<HistoryStream> stream = std::make_shared<HistoryStream>(
+      _controller->getHistory(), _controller->getHistoryTime(), since, points, binary);
+  AsyncWebServerResponse* response = request->beginChunkedResponse(
+      binary ? "application/octet-stream" : "application/json",
+      [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return stream->read(buffer, maxLen);
+      });
+  request->send(response);
 }
 
 void WebServer::setupRoutes() {
@@ -57,37 +119,17 @@ void WebServer::setupRoutes() {
   });
 
   // API: Get current status
-  _server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
-    auto status = _controller->getStatus();
-    auto pid = _controller->getPIDStatus();
-
-    StaticJsonDocument<512> doc;
-    doc["temp"] = status.currentTemp;
-    doc["setpoint"] = status.setpoint;
-    doc["state"] = _controller->getStateName();
-    doc["auger"] = status.auger;
-    doc["fan"] = status.fan;
-    doc["igniter"] = status.igniter;
-    doc["runtime"] = status.runtime;
-    doc["errors"] = status.errorCount;
-    doc["version"] = FIRMWARE_VERSION;
-    doc["heap"] = ESP.getFreeHeap();
-
-    // PID data for web UI visualization
-    JsonObject pidObj = doc.createNestedObject("pid");
-    pidObj["p"] = serialized(String(pid.proportionalTerm, 4));
-    pidObj["i"] = serialized(String(pid.integralTerm, 4));
-    pidObj["d"] = serialized(String(pid.derivativeTerm, 4));
-    pidObj["output"] = serialized(String(pid.output * 100.0, 1));
-    pidObj["error"] = serialized(String(pid.error, 1));
-    pidObj["cycleRemaining"] = pid.cycleTimeRemaining;
-    pidObj["augerOn"] = pid.augerCycleState;
-    pidObj["lidOpen"] = _controller->isLidOpen();
-    pidObj["reigniteAttempts"] = _controller->getReigniteAttempts();
-
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+  // Body is formatted once per control tick by the loop task (StatusCache)
+  _server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest* request) {
+    StatusCache::Json status;
+    statusCache.readJson(status);
+    if (status.length == 0) {
+      request->send(503, "application/json", "{\"error\":\"Starting\"}");
+      return;
+    }
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    response->write((const uint8_t*)status.text, status.length);
+    request->send(response);
   });
 
   // API: Set setpoint temperature
@@ -139,29 +181,9 @@ void WebServer::setupRoutes() {
                }
              });
 
-  // API: Temperature history for graph
-  // Compact format: arrays instead of objects, temps as int (°F×10)
-  // Sample: [time, temp×10, setpoint×10, state]  Event: [time, state]
+  // API: Temperature history for graph (see handleHistory)
   _server.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest* request) {
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
-    response->print("{\"now\":");
-    response->print(_controller->getUptime());
-    response->print(",\"samples\":[");
-    uint16_t count = _controller->getHistoryCount();
-    for (uint16_t i = 0; i < count; i++) {
-      const HistorySample& s = _controller->getHistorySampleAt(i);
-      if (i > 0) response->print(',');
-      response->printf("[%u,%d,%d,%d]", s.time, s.temp, s.setpoint, s.state);
-    }
-    response->print("],\"events\":[");
-    uint8_t ecount = _controller->getEventCount();
-    for (uint8_t i = 0; i < ecount; i++) {
-      const HistoryEvent& e = _controller->getHistoryEventAt(i);
-      if (i > 0) response->print(',');
-      response->printf("[%u,%d]", e.time, e.state);
-    }
-    response->print("]}");
-    request->send(response);
+    handleHistory(request);
   });
 
   // Debug API: Enable/disable debug mode
@@ -181,7 +203,7 @@ void WebServer::setupRoutes() {
   _server.on("/api/debug/status", HTTP_GET,
              [this](AsyncWebServerRequest* request) {
                StaticJsonDocument<128> doc;
-               doc["debugMode"] = _controller->isDebugMode();
+               doc["debugMode"] = _controller->getSnapshot().debugMode;
                String response;
                serializeJson(doc, response);
                request->send(200, "application/json", response);
@@ -225,7 +247,7 @@ void WebServer::setupRoutes() {
   // Debug API: Raw sensor diagnostics
   _server.on("/api/debug/sensor", HTTP_GET,
              [this](AsyncWebServerRequest* request) {
-               auto d = _controller->getSensor()->getDiagnostics();
+               auto d = _controller->getSensorDiagnostics();
                StaticJsonDocument<384> doc;
                doc["configReg"] = String("0x") + String(d.configReg, HEX);
                doc["rtdRaw"] = String("0x") + String(d.rtdRaw, HEX);
@@ -309,7 +331,7 @@ void WebServer::setupRoutes() {
       request->send(400, "application/json", "{\"error\":\"No update available\"}");
       return;
     }
-    ControllerState state = _controller->getState();
+    ControllerState state = _controller->getSnapshot().status.state;
     if (state != STATE_IDLE && state != STATE_SHUTDOWN && state != STATE_ERROR) {
       request->send(409, "application/json",
                     "{\"error\":\"Cannot update while smoker is active\"}");
@@ -321,44 +343,149 @@ void WebServer::setupRoutes() {
   });
 
   // API: System log entries (ring buffer)
-  // GET /api/logs          - All entries
-  // GET /api/logs?since=42 - Only entries with sequence > 42
+  // GET /api/logs                    - All entries
+  // GET /api/logs?since=42           - Only entries with sequence > 42
+  // GET /api/logs?since=42&wait=20000 - Long poll: held until an entry newer
+  //                                    than 42 arrives or `wait` ms pass
 #if ENABLE_LOG_RING
-  _server.on("/api/logs", HTTP_GET, [](AsyncWebServerRequest* request) {
-    uint32_t since = 0;
-    if (request->hasParam("since")) {
-      since = request->getParam("since")->value().toInt();
-    }
+  _server.on("/api/logs", HTTP_GET, [this](AsyncWebServerRequest* request) {
+    handleLogs(request);
+  });
+#endif
 
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
-    response->print("{\"logs\":[");
+  // API: What the previous boot left in RTC memory (see CrashLog)
+  // GET /api/crashlog
+  //   {"available":true,"reset_reason":"TASK_WDT","crash":true,"boot":7,"uptime":5023411,
+  //    "snapshot":{"state":"Running","temp":224.6,...},"dropped":0,
+  //    "lines":[[millis,priority,"[TAG] message"],...]}
+#if ENABLE_CRASH_LOG
+  _server.on("/api/crashlog", HTTP_GET, [](AsyncWebServerRequest* request) {
+    if (!crashLog.jsonLength()) {
+      request->send(500, "application/json", "{\"error\":\"Report too large\"}");
+      return;
+    }
+    request->send(200, "application/json", crashLog.json());
+  });
+#endif
 
-    uint8_t count = logger.getLogCount();
-    bool first = true;
-    for (uint8_t i = 0; i < count; i++) {
-      const LogEntry& entry = logger.getLogAt(i);
-      if (entry.sequence <= since) continue;
+  // API: Heap health and, in the heap-trace build, live allocations per
+  // subsystem (see HeapMonitor, HeapTracer). Registered before /api/perf,
+  // which would otherwise match it as a prefix.
+  // GET /api/perf/heap
+  //   {"uptime":61000,"samples":61,"free":141232,"min_free":118904,"total":290816,
+  //    "largest_block":110580,"min_largest_block":98292,"min_largest_at":40210,
+  //    "frag_pct":21,"max_frag_pct":30,"alloc_blocks":812,"free_blocks":23,
+  //    "trace":null | {"live":..,"dropped":..,"untracked_frees":..,
+  //                    "tags":{"mqtt":{"allocs":..,"frees":..,"bytes":..,"live_blocks":..,
+  //                                    "live_bytes":..,"peak_bytes":..},...}}}
+  _server.on("/api/perf/heap", HTTP_GET, [](AsyncWebServerRequest* request) {
+    // Static: the report should not itself churn the heap it describes, and
+    // handlers all run on async_tcp, one at a time
+    static char body[HEAP_JSON_BYTES];
+#if ENABLE_HEAP_TRACE
+    size_t len = heapMonitor.toJson(body, sizeof(body), millis(), &heapTracer);
+#else
+    size_t len = heapMonitor.toJson(body, sizeof(body), millis(), nullptr);
+#endif
+    if (!len) {
+      request->send(500, "application/json", "{\"error\":\"Report too large\"}");
+      return;
+    }
+    request->send(200, "application/json", body);
+  });
 
-      if (!first) response->print(',');
-      first = false;
+  // API: Loop and control tick timing (see LoopProfiler)
+  // GET /api/perf
+  //   {"uptime":61000,"bucket_us":[16,32,...,262144,null],
+  //    "stages":{"ota":{"count":..,"mean_us":..,"max_us":..,"last_us":..,"p50_us":..,
+  //                     "p99_us":..,"hist":[...]},...,"loop":{...},"tick":{...}},
+  //    "tick":{"interval_ms":2000,"count":..,"jitter_min_us":..,"jitter_max_us":..,
+  //            "jitter_p99_us":..,"jitter_hist":[...]}}
+#if ENABLE_PROFILER
+  _server.on("/api/perf", HTTP_GET, [](AsyncWebServerRequest* request) {
+    // Static, like /api/perf/heap: handlers all run on async_tcp
+    static char body[PROFILER_JSON_BYTES];
+    if (!loopProfiler.toJson(body, sizeof(body), millis())) {
+      request->send(500, "application/json", "{\"error\":\"Report too large\"}");
+      return;
+    }
+    request->send(200, "application/json", body);
+  });
+#endif
 
-      // Compact: [sequence, timestamp, priority, "tag", "message"]
-      response->printf("[%u,%u,%u,\"%s\",\"",
-                       entry.sequence, entry.timestamp, entry.priority, entry.tag);
-      // Escape message for JSON
-      for (const char* p = entry.message; *p; p++) {
-        if (*p == '"') response->print("\\\"");
-        else if (*p == '\\') response->print("\\\\");
-        else if (*p == '\n') response->print("\\n");
-        else if (*p == '\r') { /* skip */ }
-        else response->write(*p);
+  // API: Runtime log levels per tag and sink (see LogFilter)
+  // GET  /api/log/levels
+  //   {"compile":"debug","sinks":["serial","telnet","syslog","ring"],
+  //    "tags":{"*":["debug","debug","debug","debug"],"PID":[...],...}}
+  //   Levels are listed in "sinks" order; "own" names the tags with their own levels.
+  // POST /api/log/levels  tag=<TAG|*>  level=<debug..emerg|off|0-7|default>
+  //                       [sinks=all|serial,telnet,syslog,ring]
+  //   e.g. tag=PID&level=debug&sinks=syslog; level=default drops a tag's own levels
+  _server.on("/api/log/levels", HTTP_GET, [](AsyncWebServerRequest* request) {
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    response->printf("{\"compile\":\"%s\",\"sinks\":[", LogFilter::levelName(LOG_LEVEL_COMPILE));
+    for (uint8_t s = 0; s < LOG_SINK_COUNT; s++) {
+      response->printf("%s\"%s\"", s ? "," : "", LogFilter::sinkName(s));
+    }
+    response->print("],\"tags\":{");
+    uint8_t count = logFilter.tagCount();
+    for (uint8_t t = 0; t < count; t++) {
+      response->printf("%s\"%s\":[", t ? "," : "", logFilter.tagName(t));
+      for (uint8_t s = 0; s < LOG_SINK_COUNT; s++) {
+        response->printf("%s\"%s\"", s ? "," : "", LogFilter::levelName(logFilter.level(t, s)));
       }
-      response->print("\"]");
+      response->print(']');
+    }
+    response->print("},\"own\":[");
+    bool first = true;
+    for (uint8_t t = 1; t < count; t++) {
+      if (!logFilter.hasOwnLevels(t)) continue;
+      response->printf("%s\"%s\"", first ? "" : ",", logFilter.tagName(t));
+      first = false;
     }
     response->print("]}");
     request->send(response);
   });
-#endif
+
+  _server.on("/api/log/levels", HTTP_POST, [](AsyncWebServerRequest* request) {
+    if (!request->hasParam("tag", true) || !request->hasParam("level", true)) {
+      request->send(400, "application/json", "{\"error\":\"Missing tag or level parameter\"}");
+      return;
+    }
+    String tag = request->getParam("tag", true)->value();
+    String level = request->getParam("level", true)->value();
+
+    if (level == "default") {
+      if (!logFilter.clearLevel(tag.c_str())) {
+        request->send(404, "application/json", "{\"error\":\"Unknown tag\"}");
+        return;
+      }
+    } else {
+      int8_t value;
+      uint8_t sinks = LOG_SINK_ALL;
+      if (request->hasParam("sinks", true)) {
+        sinks = LogFilter::parseSinks(request->getParam("sinks", true)->value().c_str());
+      }
+      if (!LogFilter::parseLevel(level.c_str(), value) || sinks == 0) {
+        request->send(400, "application/json", "{\"error\":\"Invalid level or sinks\"}");
+        return;
+      }
+      if (value > LOG_LEVEL_COMPILE) {
+        request->send(400, "application/json",
+                      "{\"error\":\"Level not compiled in (LOG_LEVEL_COMPILE)\"}");
+        return;
+      }
+      if (!logFilter.setLevel(tag.c_str(), sinks, value)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid tag or tag table full\"}");
+        return;
+      }
+    }
+    request->send(200, "application/json", "{\"ok\":true}");
+
+    if (ENABLE_SERIAL_DEBUG) {
+      Serial.printf("[WEB] Log level %s set to %s\n", tag.c_str(), level.c_str());
+    }
+  });
 
   // 404 handler
   _server.onNotFound([](AsyncWebServerRequest* request) {
@@ -366,7 +493,317 @@ void WebServer::setupRoutes() {
   });
 }
 
-void WebServer::setupWebSocket() {
-  // WebSocket setup would go here for real-time updates
-  // This is a simplified implementation
+// ============================================================================
+// LOGS
+// ============================================================================
+
+#if ENABLE_LOG_RING
+// {"logs":[[sequence, uptime s, priority, "tag", "message"],...]} for the
+// entries after `since` (all of them with `all`). Messages are stored
+// escaped, so each goes out in one write; entries are copied out first
+// (copyLogAt), as a half-rewritten one would break the JSON.
+static void sendLogs(AsyncWebServerRequest* request, uint32_t since, bool all) {
+  AsyncResponseStream* response = request->beginResponseStream("application/json");
+  response->print("{\"logs\":[");
+  uint8_t count = logger.getLogCount();
+  uint8_t first = all ? 0 : logger.firstLogAfter(since);
+  LogEntry entry;
+  for (uint8_t i = first; i < count; i++) {
+    if (!logger.copyLogAt(i, entry)) break;    // rewritten: left for the next ?since=
+    response->printf("%s[%u,%u,%u,\"%s\",\"", i == first ? "" : ",",
+                     entry.sequence, entry.timestamp, entry.priority, entry.tag);
+    response->write((const uint8_t*)entry.message, entry.messageLen);
+    response->print("\"]");
+  }
+  response->print("]}");
+  request->send(response);
+}
+
+// A long-polled /api/logs, answered entirely on async_tcp by its chunked
+// response. Until an entry newer than `since` arrives or the deadline passes
+// the callback returns RESPONSE_TRY_AGAIN, and AsyncTCP asks again on its
+// poll timer; then the sendLogs() body is written one entry at a time.
+// Lives as long as the response, so a disconnect just frees it.
+class LogPoll {
+public:
+  LogPoll(uint32_t since, uint32_t deadline)
+      : _since(since), _until(0), _deadline(deadline), _phase(PHASE_WAIT), _first(true),
+        _len(0), _pos(0) {
+    active++;
+  }
+  ~LogPoll() { active--; }
+
+  size_t read(uint8_t* buf, size_t maxLen) {
+    if (_phase == PHASE_WAIT) {
+      if (logger.firstLogAfter(_since) >= logger.getLogCount() &&
+          (int32_t)(millis() - _deadline) < 0) {
+        return RESPONSE_TRY_AGAIN;
+      }
+      _until = logger.getLatestSequence();
+      _phase = PHASE_ENTRIES;
+      append("{\"logs\":[", 9);
+    }
+    size_t n = 0;
+    while (n < maxLen) {
+      if (_pos == _len && !next()) break;
+      size_t take = _len - _pos;
+      if (take > maxLen - n) take = maxLen - n;
+      memcpy(buf + n, _buf + _pos, take);
+      _pos += take;
+      n += take;
+    }
+    return n;
+  }
+
+  static std::atomic<uint8_t> active;    // polls held open
+
+private:
+  enum Phase : uint8_t { PHASE_WAIT, PHASE_ENTRIES, PHASE_DONE };
+
+  uint32_t _since;                // last sequence written
+  uint32_t _until;                // newest sequence when the poll was answered
+  uint32_t _deadline;             // millis()
+  Phase _phase;
+  bool _first;
+  char _buf[48 + LOG_RING_TAG_LEN + LOG_RING_MSG_LEN];    // one entry not yet sent
+  size_t _len;
+  size_t _pos;
+
+  void append(const char* text, size_t len) {
+    memcpy(_buf + _len, text, len);
+    _len += len;
+  }
+
+  bool next() {
+    _len = 0;
+    _pos = 0;
+    if (_phase != PHASE_ENTRIES) return false;
+    uint8_t i = logger.firstLogAfter(_since);
+    LogEntry entry;
+    if (i < logger.getLogCount() && logger.copyLogAt(i, entry)) {
+      if (entry.sequence <= _until) {
+        _len = (size_t)snprintf(_buf, sizeof(_buf), "%s[%u,%u,%u,\"%s\",\"", _first ? "" : ",",
+                                entry.sequence, entry.timestamp, entry.priority, entry.tag);
+        append(entry.message, entry.messageLen);
+        append("\"]", 2);
+        _since = entry.sequence;
+        _first = false;
+        return true;
+      }
+    }
+    append("]}", 2);
+    _phase = PHASE_DONE;
+    return true;
+  }
+};
+
+std::atomic<uint8_t> LogPoll::active(0);
+
+void WebServer::handleLogs(AsyncWebServerRequest* request) {
+  bool all = !request->hasParam("since");
+  uint32_t since = all ? 0 : request->getParam("since")->value().toInt();
+  uint32_t wait = 0;
+  if (request->hasParam("wait")) {
+    wait = request->getParam("wait")->value().toInt();
+    if (wait > LOG_POLL_MAX_WAIT_MS) wait = LOG_POLL_MAX_WAIT_MS;
+  }
+
+  // Answer now when there is something newer, or when the long polls
+  // already held open use up LOG_POLL_MAX_WAITERS (plain poll)
+  if (all || wait == 0 || logger.firstLogAfter(since) < logger.getLogCount() ||
+      LogPoll::active.load() >= LOG_POLL_MAX_WAITERS) {
+    sendLogs(request, since, all);
+    return;
+  }
+
+  std::shared_ptr<LogPoll> poll = std::make_shared<LogPoll>(since, millis() + wait);
+  AsyncWebServerResponse* response = request->beginChunkedResponse(
+      "application/json", [poll](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return poll->read(buffer, maxLen);
+      });
+  request->send(response);
+}
+#endif
+
+// ============================================================================
+// EVENT STREAM
+// ============================================================================
+
+// Bounded JSON frame built in a fixed buffer. A record that does not fit is
+// rolled back whole, so the frame always ends on a complete record; the last
+// `reserve` bytes are kept for closing brackets until release().
+class FrameWriter {
+public:
+  FrameWriter(char* buf, size_t size, size_t reserve)
+      : _buf(buf), _size(size), _limit(size - reserve), _len(0) {
+    _buf[0] = '\0';
+  }
+
+  bool printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(_buf + _len, _limit - _len, format, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= _limit - _len) {
+      _buf[_len] = '\0';
+      return false;
+    }
+    _len += n;
+    return true;
+  }
+
+  // Bytes already in JSON form (a pre-escaped log message)
+  bool raw(const char* data, size_t len) {
+    if (len >= _limit - _len) return false;
+    memcpy(_buf + _len, data, len);
+    _len += len;
+    _buf[_len] = '\0';
+    return true;
+  }
+
+  size_t mark() const { return _len; }
+  void rollback(size_t mark) {
+    _len = mark;
+    _buf[_len] = '\0';
+  }
+  void release() { _limit = _size; }
+  size_t length() const { return _len; }
+
+private:
+  char* _buf;
+  size_t _size;
+  size_t _limit;
+  size_t _len;
+};
+
+void WebServer::setupEventStream() {
+#if ENABLE_EVENT_STREAM
+  // Runs on the async_tcp task once the client is registered
+  _events.onConnect([this](AsyncEventSourceClient* client) {
+    if (_events.count() > EVENT_STREAM_MAX_CLIENTS) {
+      _eventStats.rejected++;
+      client->close();
+      return;
+    }
+    client->send("{}", "hello", millis(), EVENT_STREAM_RETRY_MS);
+  });
+  _server.addHandler(&_events);
+#endif
+}
+
+WebServer::EventStats WebServer::getEventStats(void) {
+  EventStats stats = _eventStats;
+#if ENABLE_EVENT_STREAM
+  stats.clients = (uint8_t)_events.count();
+#endif
+  return stats;
+}
+
+void WebServer::publishEvents() {
+#if ENABLE_EVENT_STREAM
+  if (_events.count() == 0) {
+    // Nobody listening: keep the cursors current so the first subscriber
+    // gets deltas from now rather than a backlog it fetched already
+    _eventHistoryCursor = _controller->getHistory().latestTime();
+#if ENABLE_LOG_RING
+    _eventLogSeq = logger.getLatestSequence();
+#endif
+    return;
+  }
+
+  if (!statusCache.valid() || statusCache.seq() == _eventSeq) return;
+
+  // Clients are still draining earlier frames: skip this tick rather than
+  // queue more. Status frames are whole snapshots and history/log frames
+  // resume from their cursors, so the next frame sent covers the gap.
+  if (_events.avgPacketsWaiting() >= EVENT_STREAM_BACKLOG) {
+    _eventStats.coalesced++;
+    return;
+  }
+  _eventSeq = statusCache.seq();
+
+  // The /api/status body, already formatted this tick
+  const auto& snap = statusCache.snapshot();
+  _events.send(statusCache.json().text, "status", _eventSeq);
+  _eventStats.frames++;
+
+  if (snap.historyLatestTime > _eventHistoryCursor) {
+    publishHistoryDelta(snap.historyLatestTime);
+  }
+  publishLogs();
+#endif
+}
+
+// Samples and events in (_eventHistoryCursor, latest], in the /api/history
+// JSON layout plus "since" so clients can tell whether they missed a frame.
+// A frame holds what fits; the rest follows on the next tick.
+void WebServer::publishHistoryDelta(uint32_t latest) {
+  const HistoryStore& history = _controller->getHistory();
+  const uint32_t since = _eventHistoryCursor;
+  FrameWriter out(_eventFrame, sizeof(_eventFrame), 256);
+  out.printf("{\"since\":%u,\"samples\":[", since);
+
+  HistoryStore::SampleReader reader(history);
+  reader.skipThrough(since);
+  HistorySample s;
+  uint32_t sent = since;
+  bool first = true;
+  while (reader.next(s) && s.time <= latest) {
+    if (!out.printf("%s[%u,%d,%d,%d]", first ? "" : ",", s.time, s.temp, s.setpoint, s.state)) break;
+    first = false;
+    sent = s.time;
+  }
+  if (sent == since) {
+    _eventHistoryCursor = latest;    // evicted before we got to it
+    return;
+  }
+
+  out.release();
+  out.printf("],\"events\":[");
+  first = true;
+  HistoryEvent e;
+  for (uint32_t i = history.events().begin(); i < history.events().end(); i++) {
+    if (!history.events().read(i, e) || e.time <= since || e.time > sent) continue;
+    if (!out.printf("%s[%u,%d]", first ? "" : ",", e.time, e.state)) break;
+    first = false;
+  }
+  out.printf("],\"latest\":%u}", sent);
+
+  _events.send(_eventFrame, "history", sent);
+  _eventStats.frames++;
+  _eventHistoryCursor = sent;
+}
+
+// New log lines in the /api/logs layout, a few frames' worth per tick
+void WebServer::publishLogs() {
+#if ENABLE_LOG_RING
+  for (uint8_t frame = 0; frame < 4 && logger.getLatestSequence() > _eventLogSeq; frame++) {
+    FrameWriter out(_eventFrame, sizeof(_eventFrame), 4);
+    out.printf("{\"logs\":[");
+    uint32_t sent = _eventLogSeq;
+    uint8_t count = logger.getLogCount();
+    LogEntry entry;
+    for (uint8_t i = logger.firstLogAfter(_eventLogSeq); i < count; i++) {
+      if (!logger.copyLogAt(i, entry)) break;
+      size_t mark = out.mark();
+      if (!out.printf("%s[%u,%u,%u,\"%s\",\"", sent == _eventLogSeq ? "" : ",", entry.sequence,
+                      entry.timestamp, entry.priority, entry.tag) ||
+          !out.raw(entry.message, entry.messageLen) || !out.printf("\"]")) {
+        out.rollback(mark);
+        break;
+      }
+      sent = entry.sequence;
+    }
+    if (sent == _eventLogSeq) {
+      // Ring moved on under us or an entry can never fit: skip ahead
+      _eventLogSeq = logger.getLatestSequence();
+      return;
+    }
+    out.release();
+    out.printf("]}");
+    _events.send(_eventFrame, "log", sent);
+    _eventStats.frames++;
+    _eventLogSeq = sent;
+  }
+#endif
 }
@@ -0,0 +1,85 @@
+#include "wifi_link.h"
+
+WiFiLink::WiFiLink()
+    : _state(LINK_OFF), _apWanted(false), _apActive(false), _everUp(false),
+      _connectPending(false), _begunAt(0), _attemptAt(0), _retryAt(0),
+      _retryDelay(WIFI_RETRY_MIN_MS), _firstUpAt(0), _attempts(0), _connects(0) {}
+
+void WiFiLink::begin(uint32_t now, bool haveCredentials) {
+  _begunAt = now;
+  if (haveCredentials) {
+    _state = LINK_CONNECTING;
+    _connectPending = true;
+  } else {
+    _state = LINK_OFF;
+    _apWanted = true;
+  }
+}
+
+WiFiLink::Action WiFiLink::update(uint32_t now) {
+  switch (_state) {
+    case LINK_CONNECTING:
+      if (!_connectPending && now - _attemptAt >= WIFI_CONNECT_TIMEOUT_MS) fail(now);
+      break;
+    case LINK_BACKOFF:
+      if ((int32_t)(now - _retryAt) >= 0) {
+        _state = LINK_CONNECTING;
+        _connectPending = true;
+      }
+      break;
+    default:
+      break;
+  }
+
+  // Open the AP if the station never came up in time; close it once it has
+  if (!_everUp && _state != LINK_OFF && now - _begunAt >= WIFI_AP_FALLBACK_MS) {
+    _apWanted = true;
+  }
+  if (_apWanted != _apActive) {
+    _apActive = _apWanted;
+    return _apActive ? ACTION_START_AP : ACTION_STOP_AP;
+  }
+
+  if (_connectPending) {
+    _connectPending = false;
+    _attemptAt = now;
+    _attempts++;
+    return ACTION_CONNECT;
+  }
+  return ACTION_NONE;
+}
+
+void WiFiLink::onGotIp(uint32_t now) {
+  if (_state == LINK_OFF) return;
+  if (!_everUp) {
+    _everUp = true;
+    _firstUpAt = now;
+  }
+  _state = LINK_UP;
+  _connectPending = false;
+  _apWanted = false;
+  _retryDelay = WIFI_RETRY_MIN_MS;
+  _attempts = 0;
+  _connects++;
+}
+
+void WiFiLink::onDisconnected(uint32_t now) {
+  // Repeated events while already waiting change nothing
+  if (_state == LINK_UP || (_state == LINK_CONNECTING && !_connectPending)) fail(now);
+}
+
+void WiFiLink::fail(uint32_t now) {
+  _state = LINK_BACKOFF;
+  _retryAt = now + _retryDelay;
+  _retryDelay = _retryDelay * 2 < WIFI_RETRY_MAX_MS ? _retryDelay * 2 : WIFI_RETRY_MAX_MS;
+}
+
+const char* WiFiLink::stateName(State state) {
+  switch (state) {
+    case LINK_OFF:        return "off";
+    case LINK_CONNECTING: return "connecting";
+    case LINK_UP:         return "up";
+    case LINK_BACKOFF:    return "backoff";
+  }
+  return "?";
+}
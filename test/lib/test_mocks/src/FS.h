@@ -0,0 +1,80 @@
+#ifndef MOCK_FS_H
+#define MOCK_FS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// In-memory stand-in for the Arduino-ESP32 fs::FS / fs::File API (the subset
+// used by the firmware). Files live in a global map keyed by full path, so a
+// new FS object sees what an earlier one wrote, like flash across a reboot.
+// No STL in this header: it is included after the mock Arduino.h macros.
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File {
+public:
+    File() : _pos(0), _dir(false), _write(false), _listPos(0) { _path[0] = '\0'; }
+
+    explicit operator bool() const { return _path[0] != '\0'; }
+
+    size_t write(const uint8_t* buf, size_t size);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    int read(uint8_t* buf, size_t size);
+    int read();
+    int available();
+    bool seek(uint32_t pos);
+    size_t position() const { return _pos; }
+    size_t size() const;
+    void flush() {}
+    void close() { _path[0] = '\0'; }
+
+    bool isDirectory() const { return _dir; }
+    File openNextFile(const char* mode = FILE_READ);
+    const char* path() const { return _path; }
+    const char* name() const;
+
+private:
+    friend class FS;
+    char _path[96];
+    size_t _pos;
+    bool _dir;
+    bool _write;
+    size_t _listPos;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+// Mock control ---------------------------------------------------------------
+
+// Erase every file and directory
+void mock_fs_reset(void);
+
+// Simulate power loss: after `bytes` more bytes reach "flash", every further
+// write is dropped (a torn write). Pass -1 to disable.
+void mock_fs_fail_after(long bytes);
+
+// Total bytes written and write() calls since reset
+size_t mock_fs_bytes_written(void);
+size_t mock_fs_write_calls(void);
+
+// Direct access to a file's contents (nullptr if missing)
+uint8_t* mock_fs_data(const char* path, size_t* size);
+
+#endif // MOCK_FS_H
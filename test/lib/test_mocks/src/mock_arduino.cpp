@@ -1,5 +1,6 @@
 #include "Arduino.h"
 #include "SPI.h"
+#include "mock_helpers.h"
 
 // Global mock state
 unsigned long _mock_millis = 0;
@@ -11,12 +12,14 @@ unsigned long millis(void) {
     return _mock_millis;
 }
 
+// Moving the clock forward runs any timer callbacks that fall due on the way
 void mock_set_millis(unsigned long ms) {
+    if (ms > _mock_millis) mock_fire_timers(ms);
     _mock_millis = ms;
 }
 
 void mock_advance_millis(unsigned long ms) {
-    _mock_millis += ms;
+    mock_set_millis(_mock_millis + ms);
 }
 
 void pinMode(uint8_t pin, uint8_t mode) {
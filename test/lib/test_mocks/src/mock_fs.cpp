@@ -0,0 +1,146 @@
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "FS.h"
+
+static std::map<std::string, std::vector<uint8_t>> _files;
+static std::set<std::string> _dirs;
+static long _failAfter = -1;
+static size_t _bytesWritten = 0;
+static size_t _writeCalls = 0;
+
+void mock_fs_reset(void) {
+    _files.clear();
+    _dirs.clear();
+    _failAfter = -1;
+    _bytesWritten = 0;
+    _writeCalls = 0;
+}
+
+void mock_fs_fail_after(long bytes) { _failAfter = bytes; }
+size_t mock_fs_bytes_written(void) { return _bytesWritten; }
+size_t mock_fs_write_calls(void) { return _writeCalls; }
+
+uint8_t* mock_fs_data(const char* path, size_t* size) {
+    auto it = _files.find(path);
+    if (it == _files.end()) return nullptr;
+    *size = it->second.size();
+    return it->second.data();
+}
+
+namespace fs {
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    auto it = _files.find(_path);
+    if (!_write || it == _files.end()) return 0;
+    _writeCalls++;
+    size_t n = size;
+    if (_failAfter >= 0) {
+        if ((long)n > _failAfter) n = (size_t)_failAfter;
+        _failAfter -= (long)n;
+    }
+    std::vector<uint8_t>& data = it->second;
+    if (_pos + n > data.size()) data.resize(_pos + n);
+    memcpy(data.data() + _pos, buf, n);
+    _pos += n;
+    _bytesWritten += n;
+    return n;
+}
+
+int File::read(uint8_t* buf, size_t size) {
+    auto it = _files.find(_path);
+    if (it == _files.end() || _pos >= it->second.size()) return 0;
+    size_t n = it->second.size() - _pos;
+    if (n > size) n = size;
+    memcpy(buf, it->second.data() + _pos, n);
+    _pos += n;
+    return (int)n;
+}
+
+int File::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::available() {
+    return (int)(size() - (_pos < size() ? _pos : size()));
+}
+
+bool File::seek(uint32_t pos) {
+    if (pos > size()) return false;
+    _pos = pos;
+    return true;
+}
+
+size_t File::size() const {
+    auto it = _files.find(_path);
+    return it == _files.end() ? 0 : it->second.size();
+}
+
+const char* File::name() const {
+    size_t slash = std::string(_path).rfind('/');
+    return _path + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File File::openNextFile(const char* mode) {
+    File f;
+    if (!_dir) return f;
+    std::string prefix = strcmp(_path, "/") == 0 ? "/" : std::string(_path) + "/";
+    size_t i = 0;
+    for (auto& entry : _files) {
+        const std::string& p = entry.first;
+        if (p.compare(0, prefix.size(), prefix) != 0) continue;
+        if (p.find('/', prefix.size()) != std::string::npos) continue;
+        if (i++ < _listPos) continue;
+        _listPos++;
+        FS fs;
+        return fs.open(p.c_str(), mode);
+    }
+    return f;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    File f;
+    std::string p(path);
+    if (_dirs.count(p) || p == "/") {
+        strncpy(f._path, path, sizeof(f._path) - 1);
+        f._path[sizeof(f._path) - 1] = '\0';
+        f._dir = true;
+        return f;
+    }
+    bool exists = _files.count(p) > 0;
+    if (strcmp(mode, FILE_READ) == 0) {
+        if (!exists) return f;
+    } else if (strcmp(mode, FILE_WRITE) == 0) {
+        _files[p].clear();
+        f._write = true;
+    } else if (strcmp(mode, FILE_APPEND) == 0) {
+        if (!exists) _files[p];
+        f._write = true;
+        f._pos = _files[p].size();
+    }
+    strncpy(f._path, path, sizeof(f._path) - 1);
+    f._path[sizeof(f._path) - 1] = '\0';
+    return f;
+}
+
+bool FS::exists(const char* path) {
+    return _files.count(path) > 0 || _dirs.count(path) > 0;
+}
+
+bool FS::remove(const char* path) {
+    return _files.erase(path) > 0;
+}
+
+bool FS::mkdir(const char* path) {
+    _dirs.insert(path);
+    return true;
+}
+
+bool FS::rmdir(const char* path) {
+    return _dirs.erase(path) > 0;
+}
+
+}  // namespace fs
@@ -9,4 +9,7 @@ void mock_set_sensor_temp_c(float tempC);
 void mock_set_sensor_fault(uint8_t fault);
 void mock_reset_sensor(void);
 
+// OneShotTimer mock: fire callbacks due by `until` (called as millis() advances)
+void mock_fire_timers(unsigned long until);
+
 #endif // MOCK_HELPERS_H
@@ -3,9 +3,16 @@
 // Global logger instance (required by logger.h extern declaration)
 Logger logger;
 
-Logger::Logger() : _udpClient(nullptr), _syslog(nullptr), _initialized(false) {}
+Logger::Logger() : _udpClient(nullptr), _syslog(nullptr), _initialized(false)
+#if ENABLE_SYSLOG && ENABLE_SYSLOG_BATCH
+  , _syslogBatch(_syslogBuf, sizeof(_syslogBuf), SyslogBatch::FRAMING_NEWLINE, SYSLOG_FACILITY,
+                 SYSLOG_DEVICE_NAME, SYSLOG_APP_NAME)
+#endif
+{}
 void Logger::begin() { _initialized = true; }
 void Logger::log(uint16_t priority, const char* message) { (void)priority; (void)message; }
 void Logger::logf(uint16_t priority, const char* format, ...) { (void)priority; (void)format; }
 bool Logger::isConnected() { return false; }
 void Logger::dualLog(uint16_t priority, const char* format, ...) { (void)priority; (void)format; }
+void Logger::dualLogTo(LogSite* site, uint8_t sinks, uint16_t priority, const char* format, ...) { (void)site; (void)sinks; (void)priority; (void)format; }
+bool Logger::postEvent(uint16_t id, LogSite* site, uint8_t sinks, const uint8_t* payload, uint8_t len) { (void)id; (void)site; (void)sinks; (void)payload; (void)len; return true; }
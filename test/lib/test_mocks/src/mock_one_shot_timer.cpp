@@ -0,0 +1,53 @@
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "one_shot_timer.h"
+
+// All live timers; callbacks fire as the virtual clock passes their deadline
+static OneShotTimer* _mock_timers = nullptr;
+
+OneShotTimer::OneShotTimer(const char* name, Callback callback, void* arg)
+    : _callback(callback), _arg(arg), _deadline(0), _armed(false),
+      _next(_mock_timers) {
+    (void)name;
+    _mock_timers = this;
+}
+
+OneShotTimer::~OneShotTimer() {
+    for (OneShotTimer** t = &_mock_timers; *t; t = &(*t)->_next) {
+        if (*t == this) {
+            *t = _next;
+            break;
+        }
+    }
+}
+
+void OneShotTimer::start(uint32_t delayMs) {
+    _deadline = millis() + delayMs;
+    _armed = true;
+}
+
+void OneShotTimer::stop() {
+    _armed = false;
+}
+
+bool OneShotTimer::isArmed() const {
+    return _armed;
+}
+
+// Fire every deadline up to `until` in time order, with millis() reading the
+// deadline inside the callback. Callbacks may re-arm (or arm other timers).
+void mock_fire_timers(unsigned long until) {
+    for (;;) {
+        OneShotTimer* due = nullptr;
+        for (OneShotTimer* t = _mock_timers; t; t = t->_next) {
+            if (t->_armed && (long)(until - t->_deadline) >= 0 &&
+                (!due || (long)(t->_deadline - due->_deadline) < 0)) {
+                due = t;
+            }
+        }
+        if (!due) break;
+        if ((long)(due->_deadline - _mock_millis) > 0) _mock_millis = due->_deadline;
+        due->_armed = false;
+        due->_callback(due->_arg);
+    }
+}
@@ -0,0 +1,126 @@
+#include "smoker_sim.h"
+#include "mock_helpers.h"
+#include "config.h"
+
+// Defaults approximate a mid-size pellet cooker: ~0.35 lb/hr of pellets holds
+// 225°F on a mild day, full auger reaches roughly 480°F, and a cold start
+// crosses STARTUP_TEMP_THRESHOLD in about five minutes.
+SmokerSimParams::SmokerSimParams()
+    : ambientC(21.0f),
+      augerFeedGps(0.40f),
+      pelletEnergyJpg(10500.0f),   // ~19 MJ/kg × ~55% into the cabinet
+      burnTauFanS(60.0f),
+      burnTauNoFanS(300.0f),
+      fireOutGrams(0.3f),
+      fireLagS(20.0f),
+      igniterW(250.0f),
+      igniterHeatTauS(40.0f),
+      ignitionDelayS(30.0f),
+      airCapJpK(4000.0f),
+      bodyCapJpK(30000.0f),
+      airBodyWpK(120.0f),
+      bodyLossWpK(12.0f),
+      exhaustFanWpK(6.0f),
+      exhaustIdleWpK(2.0f),
+      lidOpenWpK(500.0f),
+      probeTauS(6.0f) {}
+
+SmokerSim::SmokerSim(const SmokerSimParams& params) : _params(params) {
+  reset();
+}
+
+void SmokerSim::reset() {
+  _airC = _params.ambientC;
+  _bodyC = _params.ambientC;
+  _probeC = _params.ambientC;
+  _potGrams = 0.0f;
+  _fireW = 0.0f;
+  _igniterHeat = 0.0f;
+  _ignitionS = 0.0f;
+  _lit = false;
+  _lidOpen = false;
+  _hopperEmpty = false;
+  _fedGrams = 0.0f;
+  _augerOnMs = 0;
+  _ignitions = 0;
+  _flameouts = 0;
+  publishProbe();
+}
+
+// Relays are active LOW; a pin that was never configured is treated as off
+static bool relayOn(uint8_t pin) {
+  return _mock_gpio[pin].mode == OUTPUT && _mock_gpio[pin].value == LOW;
+}
+
+void SmokerSim::step(unsigned long ms) {
+  const float dt = ms / 1000.0f;
+  const SmokerSimParams& p = _params;
+
+  bool auger = relayOn(PIN_RELAY_AUGER);
+  bool fan = relayOn(PIN_RELAY_FAN);
+  bool igniter = relayOn(PIN_RELAY_IGNITER);
+
+  // Pellet delivery
+  if (auger) {
+    _augerOnMs += ms;
+    if (!_hopperEmpty) {
+      float fed = p.augerFeedGps * dt;
+      _potGrams += fed;
+      _fedGrams += fed;
+    }
+  }
+
+  // Hot rod warms toward 1.0 while powered, cools when off
+  float rodTarget = igniter ? 1.0f : 0.0f;
+  _igniterHeat += (rodTarget - _igniterHeat) * dt / p.igniterHeatTauS;
+
+  // Ignition: pellets need to sit on a hot rod for a while
+  if (!_lit) {
+    if (_igniterHeat > 0.7f && _potGrams >= 1.0f) {
+      _ignitionS += dt;
+      if (_ignitionS >= p.ignitionDelayS) {
+        _lit = true;
+        _ignitions++;
+        _ignitionS = 0.0f;
+      }
+    } else {
+      _ignitionS = 0.0f;
+    }
+  }
+
+  // Combustion: burn rate proportional to fuel in the pot, starved without fan
+  float burnGps = 0.0f;
+  if (_lit) {
+    burnGps = _potGrams / (fan ? p.burnTauFanS : p.burnTauNoFanS);
+    _potGrams -= burnGps * dt;
+    if (_potGrams < p.fireOutGrams) {
+      _lit = false;
+      _flameouts++;
+    }
+  }
+  if (_potGrams < 0.0f) _potGrams = 0.0f;
+
+  float releaseW = burnGps * p.pelletEnergyJpg;
+  _fireW += (releaseW - _fireW) * dt / p.fireLagS;
+
+  // Two-node cabinet: fast air node (what the probe sees), slow body node
+  float exhaustWpK = fan ? p.exhaustFanWpK : p.exhaustIdleWpK;
+  if (_lidOpen) exhaustWpK += p.lidOpenWpK;
+
+  float airToBodyW = p.airBodyWpK * (_airC - _bodyC);
+  float airLossW = exhaustWpK * (_airC - p.ambientC);
+  float bodyLossW = p.bodyLossWpK * (_bodyC - p.ambientC);
+  float heatInW = _fireW + (igniter ? p.igniterW : 0.0f);
+
+  _airC += (heatInW - airToBodyW - airLossW) * dt / p.airCapJpK;
+  _bodyC += (airToBodyW - bodyLossW) * dt / p.bodyCapJpK;
+
+  // Probe lag
+  _probeC += (_airC - _probeC) * dt / p.probeTauS;
+
+  publishProbe();
+}
+
+void SmokerSim::publishProbe() {
+  mock_set_sensor_temp_c(_probeC);
+}
@@ -0,0 +1,123 @@
+#ifndef SMOKER_SIM_H
+#define SMOKER_SIM_H
+
+#include "Arduino.h"
+
+// ============================================================================
+// Pellet smoker thermal plant model for native tests
+//
+// Lumped-parameter physics driven by the relay GPIO outputs recorded in the
+// mock Arduino layer. The simulated probe temperature is written into the mock
+// MAX31865, so the real TemperatureController runs unmodified against it on
+// the virtual millis() clock.
+//
+//   auger ──► firepot pellets ──burn──► fire heat ──► cabinet air ◄──► body
+//                  ▲                        ▲             │            │
+//   igniter ───────┘ (ignition)   fan ──────┘ (O2)   exhaust/lid     walls
+//                                                         ▼            ▼
+//                                                      ambient      ambient
+// ============================================================================
+
+struct SmokerSimParams {
+  float ambientC;           // Outside air temperature (°C)
+
+  // Fuel
+  float augerFeedGps;       // Pellet feed rate with auger running (g/s)
+  float pelletEnergyJpg;    // Usable heat per gram delivered to cabinet (J/g)
+  float burnTauFanS;        // Pot burn-down time constant with fan (s)
+  float burnTauNoFanS;      // Smoulder time constant without fan (s)
+  float fireOutGrams;       // Fire dies when pot holds less than this (g)
+  float fireLagS;           // Flame/firepot heat release lag (s)
+
+  // Ignition
+  float igniterW;           // Hot rod heat into cabinet air (W)
+  float igniterHeatTauS;    // Hot rod warm-up time constant (s)
+  float ignitionDelayS;     // Pellets on a hot rod for this long ignite (s)
+
+  // Thermal masses and couplings
+  float airCapJpK;          // Cabinet air + grates (J/K)
+  float bodyCapJpK;         // Steel body, firepot, drip tray (J/K)
+  float airBodyWpK;         // Air <-> body convection (W/K)
+  float bodyLossWpK;        // Body -> ambient through walls (W/K)
+  float exhaustFanWpK;      // Air -> ambient through chimney, fan on (W/K)
+  float exhaustIdleWpK;     // Air -> ambient through chimney, fan off (W/K)
+  float lidOpenWpK;         // Air -> ambient with the lid open (W/K)
+
+  // Sensor
+  float probeTauS;          // RTD probe time constant (s)
+
+  SmokerSimParams();
+};
+
+class SmokerSim {
+public:
+  // Integration step used by run() (ms)
+  static const unsigned long STEP_MS = 250;
+
+  explicit SmokerSim(const SmokerSimParams& params = SmokerSimParams());
+
+  // Cold smoker at ambient, empty firepot, full hopper
+  void reset();
+
+  // Integrate the plant forward by `ms` and publish the probe reading
+  void step(unsigned long ms);
+
+  // Advance the virtual clock by `ms`, integrating the plant in STEP_MS
+  // increments and calling `tick()` after each one (e.g. controller update)
+  template <typename F>
+  void run(unsigned long ms, F tick);
+
+  // Disturbances
+  void setLidOpen(bool open) { _lidOpen = open; }
+  void setHopperEmpty(bool empty) { _hopperEmpty = empty; }
+  void setAmbientC(float c) { _params.ambientC = c; }
+
+  // Plant state
+  float airTempF() const { return cToF(_airC); }
+  float bodyTempF() const { return cToF(_bodyC); }
+  float probeTempF() const { return cToF(_probeC); }
+  float potGrams() const { return _potGrams; }
+  bool isFireLit() const { return _lit; }
+
+  // Accumulated counters since reset()
+  float pelletsFedGrams() const { return _fedGrams; }
+  unsigned long augerOnMs() const { return _augerOnMs; }
+  uint16_t ignitions() const { return _ignitions; }
+  uint16_t flameouts() const { return _flameouts; }
+
+  static float cToF(float c) { return c * 9.0f / 5.0f + 32.0f; }
+
+private:
+  SmokerSimParams _params;
+
+  float _airC;
+  float _bodyC;
+  float _probeC;
+  float _potGrams;
+  float _fireW;            // lagged heat release
+  float _igniterHeat;      // 0 = cold rod, 1 = fully hot
+  float _ignitionS;        // seconds pellets have sat on a hot rod
+  bool _lit;
+  bool _lidOpen;
+  bool _hopperEmpty;
+
+  float _fedGrams;
+  unsigned long _augerOnMs;
+  uint16_t _ignitions;
+  uint16_t _flameouts;
+
+  void publishProbe();
+};
+
+template <typename F>
+void SmokerSim::run(unsigned long ms, F tick) {
+  while (ms > 0) {
+    unsigned long dt = ms < STEP_MS ? ms : STEP_MS;
+    step(dt);
+    mock_advance_millis(dt);
+    tick();
+    ms -= dt;
+  }
+}
+
+#endif // SMOKER_SIM_H
@@ -0,0 +1,224 @@
+// Auger time-proportioning: edges from OneShotTimer, independent of the tick
+
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "one_shot_timer.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+
+static MAX31865* sensor;
+static RelayControl* relay;
+static TemperatureController* ctrl;
+
+static int fired;
+static unsigned long firedAt;
+
+static void countFire(void* arg) {
+    (void)arg;
+    fired++;
+    firedAt = millis();
+}
+
+static bool augerOn(void) {
+    return _mock_gpio[PIN_RELAY_AUGER].value == LOW;  // active LOW
+}
+
+// Same entry as test_pid: temperature override, past the 65s startup
+static void advance_to_running(float setpointF, float currentTempF) {
+    ctrl->setTempOverride(currentTempF);
+    ctrl->startSmoking(setpointF);
+    mock_set_millis(70000);
+    ctrl->update();
+    TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+}
+
+// The first RUNNING tick computes an output and starts the first cycle
+static void start_dosing(float setpointF, float currentTempF) {
+    advance_to_running(setpointF, currentTempF);
+    mock_advance_millis(TEMP_CONTROL_INTERVAL);
+    ctrl->update();
+}
+
+// Step the clock 1ms at a time, running the controller as the loop would,
+// and return how long the auger was on
+static unsigned long augerOnMsOver(unsigned long ms) {
+    unsigned long on = 0;
+    for (unsigned long t = 0; t < ms; t++) {
+        if (augerOn()) on++;
+        mock_advance_millis(1);
+        ctrl->update();
+    }
+    return on;
+}
+
+void setUp(void) {
+    mock_reset_all();
+    mock_reset_sensor();
+    fired = 0;
+    firedAt = 0;
+    sensor = new MAX31865(5, 4300.0, 1000.0);
+    relay = new RelayControl();
+    relay->begin();
+    ctrl = new TemperatureController(sensor, relay);
+    ctrl->begin();
+}
+
+void tearDown(void) {
+    delete ctrl;
+    delete relay;
+    delete sensor;
+}
+
+// ============================================================================
+// MOCK TIMER
+// ============================================================================
+
+void test_timer_fires_at_its_deadline(void) {
+    OneShotTimer timer("test", countFire, nullptr);
+    mock_set_millis(1000);
+    timer.start(250);
+    TEST_ASSERT_TRUE(timer.isArmed());
+
+    mock_advance_millis(249);
+    TEST_ASSERT_EQUAL_INT(0, fired);
+    mock_advance_millis(1000);
+    TEST_ASSERT_EQUAL_INT(1, fired);
+    TEST_ASSERT_EQUAL_UINT32(1250, firedAt);
+    TEST_ASSERT_EQUAL_UINT32(2249, millis());
+    TEST_ASSERT_FALSE(timer.isArmed());
+}
+
+void test_timer_restart_and_stop(void) {
+    OneShotTimer timer("test", countFire, nullptr);
+    timer.start(100);
+    timer.start(300);          // replaces the deadline
+    mock_advance_millis(200);
+    TEST_ASSERT_EQUAL_INT(0, fired);
+    mock_advance_millis(100);
+    TEST_ASSERT_EQUAL_INT(1, fired);
+
+    timer.start(100);
+    timer.stop();
+    mock_advance_millis(500);
+    TEST_ASSERT_EQUAL_INT(1, fired);
+}
+
+// ============================================================================
+// DOSING
+// ============================================================================
+
+void test_edges_do_not_wait_for_the_tick(void) {
+    // Fixed 15% output, well above setpoint: on for 3000ms of each cycle
+    start_dosing(225.0, 300.0);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, PID_OUTPUT_MIN, ctrl->getPIDStatus().output);
+    unsigned long onTime = (unsigned long)(AUGER_CYCLE_TIME * PID_OUTPUT_MIN);
+    TEST_ASSERT_TRUE(augerOn());
+
+    // No update() at all: the timer alone switches the auger
+    mock_advance_millis(onTime - 1);
+    TEST_ASSERT_TRUE(augerOn());
+    mock_advance_millis(1);
+    TEST_ASSERT_FALSE(augerOn());
+    mock_advance_millis(AUGER_CYCLE_TIME - onTime - 1);
+    TEST_ASSERT_FALSE(augerOn());
+    mock_advance_millis(1);
+    TEST_ASSERT_TRUE(augerOn());
+}
+
+void test_cycles_do_not_drift(void) {
+    start_dosing(225.0, 300.0);
+    unsigned long onTime = (unsigned long)(AUGER_CYCLE_TIME * PID_OUTPUT_MIN);
+
+    // Ten cycles with a control tick every 2s: exactly ten 3000ms doses
+    // (sampled on the tick, each would have run to the 4000ms tick)
+    unsigned long on = augerOnMsOver(10UL * AUGER_CYCLE_TIME);
+    TEST_ASSERT_EQUAL_UINT32(10 * onTime, on);
+    TEST_ASSERT_TRUE(augerOn());
+}
+
+void test_new_output_retimes_the_cycle(void) {
+    // Far below setpoint: full output, on for the whole cycle
+    start_dosing(225.0, 120.0);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, PID_OUTPUT_MAX, ctrl->getPIDStatus().output);
+    TEST_ASSERT_TRUE(augerOn());
+
+    // Two seconds in, the output drops to 15%: the dose now ends at 3000ms
+    // into the cycle, between ticks, not at the 4000ms tick
+    mock_advance_millis(TEMP_CONTROL_INTERVAL);
+    ctrl->setTempOverride(300.0);
+    ctrl->update();
+    TEST_ASSERT_FLOAT_WITHIN(0.001, PID_OUTPUT_MIN, ctrl->getPIDStatus().output);
+    TEST_ASSERT_TRUE(augerOn());
+    mock_advance_millis(999);
+    TEST_ASSERT_TRUE(augerOn());
+    mock_advance_millis(1);
+    TEST_ASSERT_FALSE(augerOn());
+
+    // The next cycle starts on time
+    mock_advance_millis(AUGER_CYCLE_TIME - 3000 - 1);
+    TEST_ASSERT_FALSE(augerOn());
+    mock_advance_millis(1);
+    TEST_ASSERT_TRUE(augerOn());
+}
+
+void test_refused_edge_is_not_recorded(void) {
+    start_dosing(225.0, 300.0);
+    unsigned long onTime = (unsigned long)(AUGER_CYCLE_TIME * PID_OUTPUT_MIN);
+    mock_advance_millis(onTime);
+    TEST_ASSERT_FALSE(augerOn());
+
+    // Fan lost before the next cycle: the interlock refuses the ON edge
+    relay->setFan(RELAY_OFF);
+    mock_advance_millis(AUGER_CYCLE_TIME - onTime);
+    TEST_ASSERT_FALSE(augerOn());
+
+    // The next tick restores the fan and the dose resumes in this cycle,
+    // rather than the controller believing the auger is already on
+    mock_advance_millis(1000);
+    ctrl->update();
+    TEST_ASSERT_EQUAL(RELAY_ON, relay->getFan());
+    TEST_ASSERT_TRUE(augerOn());
+    mock_advance_millis(onTime - 1000);
+    TEST_ASSERT_FALSE(augerOn());
+}
+
+void test_leaving_running_stops_the_edges(void) {
+    start_dosing(225.0, 300.0);
+    TEST_ASSERT_TRUE(augerOn());
+
+    ctrl->stop();
+    mock_advance_millis(TEMP_CONTROL_INTERVAL);
+    ctrl->update();
+    TEST_ASSERT_EQUAL(STATE_COOLDOWN, ctrl->getState());
+    TEST_ASSERT_FALSE(augerOn());
+
+    // No stray edge turns it back on
+    int writes = _mock_gpio[PIN_RELAY_AUGER].write_count;
+    mock_advance_millis(3 * AUGER_CYCLE_TIME);
+    TEST_ASSERT_FALSE(augerOn());
+    TEST_ASSERT_EQUAL_INT(writes, _mock_gpio[PIN_RELAY_AUGER].write_count);
+}
+
+void test_debug_mode_stops_the_edges(void) {
+    start_dosing(225.0, 300.0);
+    ctrl->setDebugMode(true);
+    TEST_ASSERT_FALSE(augerOn());
+    mock_advance_millis(2 * AUGER_CYCLE_TIME);
+    TEST_ASSERT_FALSE(augerOn());
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_timer_fires_at_its_deadline);
+    RUN_TEST(test_timer_restart_and_stop);
+    RUN_TEST(test_edges_do_not_wait_for_the_tick);
+    RUN_TEST(test_cycles_do_not_drift);
+    RUN_TEST(test_new_output_retimes_the_cycle);
+    RUN_TEST(test_refused_edge_is_not_recorded);
+    RUN_TEST(test_leaving_running_stops_the_edges);
+    RUN_TEST(test_debug_mode_stops_the_edges);
+    return UNITY_END();
+}
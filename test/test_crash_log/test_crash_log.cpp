@@ -0,0 +1,286 @@
+// CrashLog: the previous boot's log lines and controller snapshot, carried
+// across a reset in no-init memory
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "crash_log.h"
+#include "logger.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+// Stands in for the RTC_NOINIT record; each test "resets" by constructing a
+// new CrashLog over it, as the next boot would
+static CrashRecord rtc;
+static CrashLog* crash;
+
+static void reboot(uint8_t reason) {
+    delete crash;
+    crash = new CrashLog(rtc);
+    crash->begin(reason);
+}
+
+void setUp(void) {
+    mock_reset_all();
+    memset(&rtc, 0xA5, sizeof(rtc));    // power-on garbage
+    crash = nullptr;
+    reboot(CRASH_RESET_POWERON);
+}
+
+void tearDown(void) {
+    delete crash;
+    crash = nullptr;
+}
+
+static TemperatureController::Snapshot makeSnapshot() {
+    TemperatureController::Snapshot snap;
+    memset(&snap, 0, sizeof(snap));
+    snap.publishedAt = 123456;
+    snap.status.currentTemp = 224.6f;
+    snap.status.setpoint = 225.0f;
+    snap.status.state = STATE_RUNNING;
+    snap.status.auger = true;
+    snap.status.fan = true;
+    snap.status.igniter = false;
+    snap.status.errorCount = 2;
+    snap.pid.output = 0.432f;
+    snap.reigniteAttempts = 1;
+    snap.lidOpen = false;
+    return snap;
+}
+
+// ============================================================================
+// BOOT
+// ============================================================================
+
+void test_power_on_has_no_report(void) {
+    TEST_ASSERT_FALSE(crash->hasReport());
+    TEST_ASSERT_EQUAL_UINT8(0, crash->reportLineCount());
+    TEST_ASSERT_EQUAL_UINT32(1, crash->bootCount());
+    TEST_ASSERT_TRUE(CrashLog::isValid(rtc));
+    TEST_ASSERT_EQUAL_UINT32(0, rtc.lineCount);
+}
+
+void test_garbage_record_is_rejected(void) {
+    memset(&rtc, 0xA5, sizeof(rtc));
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_FALSE(crash->hasReport());
+    TEST_ASSERT_EQUAL_UINT32(1, crash->bootCount());
+
+    // Layout from another firmware version
+    rtc.version = CRASH_LOG_VERSION + 1;
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_FALSE(crash->hasReport());
+}
+
+void test_soft_reset_keeps_previous_boot(void) {
+    crash->append(LOG_INFO, 1000, "[STATE] Starting\n");
+    crash->append(LOG_WARNING, 2000, "\n[TEMP] Sensor glitch\n");
+    reboot(CRASH_RESET_TASK_WDT);
+
+    TEST_ASSERT_TRUE(crash->hasReport());
+    TEST_ASSERT_TRUE(crash->crashed());
+    TEST_ASSERT_EQUAL_STRING("TASK_WDT", CrashLog::resetReasonName(crash->resetReason()));
+    TEST_ASSERT_EQUAL_UINT32(2, crash->bootCount());
+    TEST_ASSERT_EQUAL_UINT8(2, crash->reportLineCount());
+    TEST_ASSERT_EQUAL_STRING("[STATE] Starting", crash->reportLine(0).text);
+    TEST_ASSERT_EQUAL_STRING("[TEMP] Sensor glitch", crash->reportLine(1).text);
+    TEST_ASSERT_EQUAL_UINT8(LOG_WARNING, crash->reportLine(1).priority);
+    TEST_ASSERT_EQUAL_UINT32(2000, crash->reportUptime());
+
+    // The live record starts over
+    TEST_ASSERT_EQUAL_UINT32(0, rtc.lineCount);
+}
+
+void test_power_on_discards_valid_record(void) {
+    crash->append(LOG_INFO, 1000, "[STATE] Starting");
+    reboot(CRASH_RESET_SW);
+    TEST_ASSERT_TRUE(crash->hasReport());
+    TEST_ASSERT_FALSE(crash->crashed());
+
+    reboot(CRASH_RESET_POWERON);
+    TEST_ASSERT_FALSE(crash->hasReport());
+    TEST_ASSERT_EQUAL_UINT32(1, crash->bootCount());
+}
+
+// ============================================================================
+// LINES
+// ============================================================================
+
+void test_ring_keeps_newest_lines(void) {
+    char text[32];
+    for (int i = 0; i < CRASH_LOG_LINES + 5; i++) {
+        snprintf(text, sizeof(text), "[T] line %d", i);
+        crash->append(LOG_INFO, (uint32_t)i, text);
+    }
+    reboot(CRASH_RESET_PANIC);
+
+    TEST_ASSERT_EQUAL_UINT8(CRASH_LOG_LINES, crash->reportLineCount());
+    TEST_ASSERT_EQUAL_STRING("[T] line 5", crash->reportLine(0).text);
+    snprintf(text, sizeof(text), "[T] line %d", CRASH_LOG_LINES + 4);
+    TEST_ASSERT_EQUAL_STRING(text, crash->reportLine(CRASH_LOG_LINES - 1).text);
+}
+
+void test_long_line_is_truncated(void) {
+    char text[CRASH_LOG_LINE_LEN * 2];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    crash->append(LOG_INFO, 0, text);
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_EQUAL_UINT32(CRASH_LOG_LINE_LEN - 1, (uint32_t)strlen(crash->reportLine(0).text));
+}
+
+void test_torn_line_is_terminated(void) {
+    crash->append(LOG_INFO, 0, "[T] ok");
+    memset(rtc.lines[0].text, 'x', CRASH_LOG_LINE_LEN);    // reset mid-copy
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_EQUAL_UINT32(CRASH_LOG_LINE_LEN - 1, (uint32_t)strlen(crash->reportLine(0).text));
+}
+
+// ============================================================================
+// SNAPSHOT
+// ============================================================================
+
+void test_snapshot_round_trip(void) {
+    crash->recordSnapshot(makeSnapshot());
+    reboot(CRASH_RESET_BROWNOUT);
+
+    TEST_ASSERT_TRUE(crash->reportSnapshotValid());
+    const CrashSnapshot& s = crash->report().snapshot;
+    TEST_ASSERT_EQUAL_UINT32(123456, s.uptime);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 224.6, s.currentTemp);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 225.0, s.setpoint);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.432, s.pidOutput);
+    TEST_ASSERT_EQUAL_UINT8(STATE_RUNNING, s.state);
+    TEST_ASSERT_EQUAL_UINT8(CRASH_RELAY_AUGER | CRASH_RELAY_FAN, s.relays);
+    TEST_ASSERT_EQUAL_UINT8(2, s.errorCount);
+    TEST_ASSERT_EQUAL_UINT8(1, s.reigniteAttempts);
+    TEST_ASSERT_EQUAL_UINT32(123456, crash->reportUptime());
+}
+
+void test_torn_or_missing_snapshot_is_invalid(void) {
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_FALSE(crash->reportSnapshotValid());    // never written
+
+    crash->recordSnapshot(makeSnapshot());
+    rtc.snapshot.currentTemp = 100.0f;                  // reset mid-copy
+    reboot(CRASH_RESET_PANIC);
+    TEST_ASSERT_FALSE(crash->reportSnapshotValid());
+}
+
+void test_controller_tick_records_snapshot(void) {
+    // The global instance is fed by every published controller snapshot
+    mock_reset_sensor();
+    MAX31865 sensor(5, 4300.0, 1000.0);
+    RelayControl relay;
+    relay.begin();
+    TemperatureController ctrl(&sensor, &relay);
+    ctrl.begin();
+    crashLog.begin(CRASH_RESET_SW);
+
+    ctrl.setTempOverride(180.0f);
+    mock_set_millis(66000);
+    ctrl.update();
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 180.0, ctrl.getSnapshot().status.currentTemp);
+
+    crashLog.begin(CRASH_RESET_PANIC);
+    TEST_ASSERT_TRUE(crashLog.reportSnapshotValid());
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 180.0, crashLog.report().snapshot.currentTemp);
+    TEST_ASSERT_EQUAL_UINT32(66000, crashLog.report().snapshot.uptime);
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+void test_json_report(void) {
+    crash->recordSnapshot(makeSnapshot());
+    crash->append(LOG_ERR, 5000, "[TEMP] Said \"hot\" \\ twice");
+    reboot(CRASH_RESET_TASK_WDT);
+
+    char buf[CRASH_LOG_JSON_BYTES];
+    size_t len = crash->toJson(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)strlen(buf), (uint32_t)len);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"available\":true"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"reset_reason\":\"TASK_WDT\""));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"crash\":true"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"state\":\"Running\""));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"pid_output\":43.2"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"auger\":true,\"fan\":true,\"igniter\":false"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"dropped\":0"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "[5000,3,\"[TEMP] Said \\\"hot\\\" \\\\ twice\"]"));
+    TEST_ASSERT_EQUAL_STRING("]}", buf + len - 2);
+}
+
+void test_json_is_formatted_once_at_boot(void) {
+    crash->append(LOG_ERR, 5000, "[TEMP] before the reset");
+    reboot(CRASH_RESET_PANIC);
+
+    char buf[CRASH_LOG_JSON_BYTES];
+    size_t len = crash->toJson(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)len, (uint32_t)crash->jsonLength());
+    TEST_ASSERT_EQUAL_STRING(buf, crash->json());
+
+    // Lines of this boot go to the live record, not the report
+    crash->append(LOG_ERR, 6000, "[TEMP] after the reset");
+    TEST_ASSERT_NULL(strstr(crash->json(), "after the reset"));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)len, (uint32_t)crash->toJson(buf, sizeof(buf)));
+}
+
+void test_json_without_report(void) {
+    char buf[256];
+    crash->toJson(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"available\":false,\"reset_reason\":\"POWERON\",\"crash\":false,\"boot\":1,"
+        "\"dropped\":0,\"lines\":[]}", buf);
+}
+
+void test_json_drops_oldest_lines_to_fit(void) {
+    char text[CRASH_LOG_LINE_LEN];
+    memset(text, 'y', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    for (int i = 0; i < CRASH_LOG_LINES; i++) {
+        text[0] = (char)('a' + i);
+        crash->append(LOG_INFO, (uint32_t)i, text);
+    }
+    reboot(CRASH_RESET_PANIC);
+
+    char buf[600];
+    size_t len = crash->toJson(buf, sizeof(buf));
+    TEST_ASSERT_TRUE(len > 0 && len < sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("]}", buf + len - 2);
+    TEST_ASSERT_NULL(strstr(buf, "\"dropped\":0,"));
+    // Newest line kept
+    char newest[8];
+    snprintf(newest, sizeof(newest), "\"%cyyy", 'a' + CRASH_LOG_LINES - 1);
+    TEST_ASSERT_NOT_NULL(strstr(buf, newest));
+
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)crash->toJson(buf, 16));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_power_on_has_no_report);
+    RUN_TEST(test_garbage_record_is_rejected);
+    RUN_TEST(test_soft_reset_keeps_previous_boot);
+    RUN_TEST(test_power_on_discards_valid_record);
+    RUN_TEST(test_ring_keeps_newest_lines);
+    RUN_TEST(test_long_line_is_truncated);
+    RUN_TEST(test_torn_line_is_terminated);
+    RUN_TEST(test_snapshot_round_trip);
+    RUN_TEST(test_torn_or_missing_snapshot_is_invalid);
+    RUN_TEST(test_controller_tick_records_snapshot);
+    RUN_TEST(test_json_report);
+    RUN_TEST(test_json_is_formatted_once_at_boot);
+    RUN_TEST(test_json_without_report);
+    RUN_TEST(test_json_drops_oldest_lines_to_fit);
+
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+// HeapMonitor: largest block and fragmentation over time
+// HeapTracer: live allocations charged to the subsystem that made them
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "heap_monitor.h"
+
+static HeapTracer* tracer;
+static HeapMonitor* monitor;
+
+// Fake heap addresses, 8-byte aligned like the real allocator's
+static const void* addr(uint32_t n) { return (const void*)(uintptr_t)(0x3FC90000u + n * 8); }
+
+static HeapReading reading(uint32_t freeBytes, uint32_t largest) {
+    HeapReading r;
+    memset(&r, 0, sizeof(r));
+    r.freeBytes = freeBytes;
+    r.minFreeBytes = freeBytes;
+    r.largestBlock = largest;
+    r.totalBytes = 300000;
+    return r;
+}
+
+void setUp(void) {
+    tracer = new HeapTracer();
+    monitor = new HeapMonitor();
+}
+
+void tearDown(void) {
+    delete tracer;
+    delete monitor;
+}
+
+void test_fragmentation(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, HeapMonitor::fragmentation(reading(100000, 100000)));
+    TEST_ASSERT_EQUAL_UINT8(60, HeapMonitor::fragmentation(reading(100000, 40000)));
+    TEST_ASSERT_EQUAL_UINT8(0, HeapMonitor::fragmentation(reading(0, 0)));
+}
+
+void test_largest_block_low_water(void) {
+    monitor->sample(reading(120000, 90000), 1000);
+    monitor->sample(reading(118000, 40000), 2000);
+    monitor->sample(reading(121000, 70000), 3000);
+
+    const HeapMonitor::Stats& st = monitor->getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, st.samples);
+    TEST_ASSERT_EQUAL_UINT32(70000, st.last.largestBlock);
+    TEST_ASSERT_EQUAL_UINT32(40000, st.minLargestBlock);
+    TEST_ASSERT_EQUAL_UINT32(2000, st.minLargestAt);
+    TEST_ASSERT_EQUAL_UINT8(43, st.fragmentation);
+    TEST_ASSERT_EQUAL_UINT8(67, st.maxFragmentation);
+}
+
+void test_free_is_charged_to_the_allocating_tag(void) {
+    tracer->onAlloc(addr(1), 100, HeapTracer::TAG_MQTT);
+    tracer->onAlloc(addr(2), 40, HeapTracer::TAG_MQTT);
+    tracer->onAlloc(addr(3), 500, HeapTracer::TAG_WEB);
+
+    HeapTracer::Tag tag;
+    uint32_t size;
+    TEST_ASSERT_TRUE(tracer->onFree(addr(1), &tag, &size));
+    TEST_ASSERT_EQUAL_UINT8(HeapTracer::TAG_MQTT, tag);
+    TEST_ASSERT_EQUAL_UINT32(100, size);
+
+    const HeapTracer::TagStats& mqtt = tracer->tagStats(HeapTracer::TAG_MQTT);
+    TEST_ASSERT_EQUAL_UINT32(2, mqtt.allocs);
+    TEST_ASSERT_EQUAL_UINT32(1, mqtt.frees);
+    TEST_ASSERT_EQUAL_UINT32(140, mqtt.bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, mqtt.liveBlocks);
+    TEST_ASSERT_EQUAL_UINT32(40, mqtt.liveBytes);
+    TEST_ASSERT_EQUAL_UINT32(140, mqtt.peakBytes);
+    TEST_ASSERT_EQUAL_UINT32(500, tracer->tagStats(HeapTracer::TAG_WEB).liveBytes);
+    TEST_ASSERT_EQUAL_UINT32(2, tracer->getStats().live);
+}
+
+void test_untracked_free(void) {
+    TEST_ASSERT_FALSE(tracer->onFree(addr(7)));
+    TEST_ASSERT_FALSE(tracer->onFree(nullptr));
+    TEST_ASSERT_EQUAL_UINT32(1, tracer->getStats().untrackedFrees);
+}
+
+void test_table_survives_churn(void) {
+    // Interleaved alloc/free over many addresses exercises probe runs and
+    // backward-shift deletion; every block must still be found afterwards
+    const uint32_t live = HEAP_TRACE_SLOTS / 2;
+    for (uint32_t i = 0; i < live; i++) tracer->onAlloc(addr(i), i + 1, HeapTracer::TAG_TUI);
+    for (uint32_t round = 0; round < 20; round++) {
+        for (uint32_t i = round % 3; i < live; i += 3) {
+            TEST_ASSERT_TRUE(tracer->onFree(addr(i)));
+            tracer->onAlloc(addr(i), i + 1, HeapTracer::TAG_TUI);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(live, tracer->getStats().live);
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; i < live; i++) {
+        uint32_t size = 0;
+        TEST_ASSERT_TRUE(tracer->onFree(addr(i), nullptr, &size));
+        TEST_ASSERT_EQUAL_UINT32(i + 1, size);
+        bytes += size;
+    }
+    TEST_ASSERT_EQUAL_UINT32(live * (live + 1) / 2, bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, tracer->getStats().live);
+    TEST_ASSERT_EQUAL_UINT32(0, tracer->tagStats(HeapTracer::TAG_TUI).liveBytes);
+    TEST_ASSERT_EQUAL_UINT32(0, tracer->getStats().untrackedFrees);
+}
+
+void test_full_table_drops(void) {
+    uint32_t i = 0;
+    while (tracer->getStats().dropped == 0) tracer->onAlloc(addr(i++), 16, HeapTracer::TAG_OTHER);
+    TEST_ASSERT_EQUAL_UINT32(HEAP_TRACE_SLOTS / 4 * 3, tracer->getStats().live);
+
+    // A dropped block's free is untracked; tracked ones still resolve
+    TEST_ASSERT_FALSE(tracer->onFree(addr(i - 1)));
+    TEST_ASSERT_TRUE(tracer->onFree(addr(0)));
+}
+
+void test_reused_address_is_recharged(void) {
+    // The free of addr(1) was missed (freed before tracing or dropped)
+    tracer->onAlloc(addr(1), 64, HeapTracer::TAG_LOG);
+    tracer->onAlloc(addr(1), 32, HeapTracer::TAG_MQTT);
+    TEST_ASSERT_EQUAL_UINT32(1, tracer->getStats().live);
+    TEST_ASSERT_EQUAL_UINT32(0, tracer->tagStats(HeapTracer::TAG_LOG).liveBytes);
+    TEST_ASSERT_EQUAL_UINT32(32, tracer->tagStats(HeapTracer::TAG_MQTT).liveBytes);
+}
+
+void test_reset_counts_keeps_live_blocks(void) {
+    tracer->onAlloc(addr(1), 100, HeapTracer::TAG_HISTORY);
+    tracer->onAlloc(addr(2), 200, HeapTracer::TAG_HISTORY);
+    tracer->onFree(addr(2));
+    tracer->resetCounts();
+
+    const HeapTracer::TagStats& h = tracer->tagStats(HeapTracer::TAG_HISTORY);
+    TEST_ASSERT_EQUAL_UINT32(0, h.allocs);
+    TEST_ASSERT_EQUAL_UINT32(0, h.frees);
+    TEST_ASSERT_EQUAL_UINT32(100, h.liveBytes);
+    TEST_ASSERT_EQUAL_UINT32(100, h.peakBytes);
+    TEST_ASSERT_TRUE(tracer->onFree(addr(1)));
+}
+
+void test_snapshot(void) {
+    tracer->onAlloc(addr(1), 64, HeapTracer::TAG_WEB);
+    tracer->onFree(addr(9));
+
+    HeapTracer::Snapshot snap = tracer->snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, snap.stats.live);
+    TEST_ASSERT_EQUAL_UINT32(1, snap.stats.untrackedFrees);
+    TEST_ASSERT_EQUAL_UINT32(64, snap.tags[HeapTracer::TAG_WEB].liveBytes);
+
+    // A copy: later activity does not show through
+    tracer->onFree(addr(1));
+    TEST_ASSERT_EQUAL_UINT32(64, snap.tags[HeapTracer::TAG_WEB].liveBytes);
+}
+
+void test_json(void) {
+    monitor->sample(reading(120000, 48000), 5000);
+    tracer->onAlloc(addr(1), 96, HeapTracer::TAG_MQTT);
+
+    char buf[HEAP_JSON_BYTES];
+    size_t len = monitor->toJson(buf, sizeof(buf), 6000, nullptr);
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buf), len);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"largest_block\":48000,\"min_largest_block\":48000,"
+                                     "\"min_largest_at\":5000,\"frag_pct\":60"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"trace\":null}"));
+
+    len = monitor->toJson(buf, sizeof(buf), 6000, tracer);
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"trace\":{\"live\":1,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"mqtt\":{\"allocs\":1,\"frees\":0,\"bytes\":96,"
+                                     "\"live_blocks\":1,\"live_bytes\":96,\"peak_bytes\":96}"));
+    TEST_ASSERT_EQUAL_STRING("}}}", buf + len - 3);
+
+    // Too small a buffer reports nothing rather than truncated JSON
+    TEST_ASSERT_EQUAL_UINT32(0, monitor->toJson(buf, 200, 6000, tracer));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_fragmentation);
+    RUN_TEST(test_largest_block_low_water);
+    RUN_TEST(test_free_is_charged_to_the_allocating_tag);
+    RUN_TEST(test_untracked_free);
+    RUN_TEST(test_table_survives_churn);
+    RUN_TEST(test_full_table_drops);
+    RUN_TEST(test_reused_address_is_recharged);
+    RUN_TEST(test_reset_counts_keeps_live_blocks);
+    RUN_TEST(test_snapshot);
+    RUN_TEST(test_json);
+    return UNITY_END();
+}
@@ -0,0 +1,304 @@
+#include <unity.h>
+#include "history_store.h"
+#include "config.h"
+
+static HistoryStore* store;
+static uint32_t nextTime;
+
+void setUp(void) {
+    store = new HistoryStore();
+    nextTime = 0;
+}
+
+void tearDown(void) {
+    delete store;
+}
+
+static void addSample(int16_t temp, int16_t setpoint = 2250, uint8_t state = 3) {
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    s.time = nextTime;
+    s.temp = temp;
+    s.setpoint = setpoint;
+    s.state = state;
+    store->recordSample(s);
+    nextTime += HISTORY_SAMPLE_INTERVAL / 1000;
+}
+
+// Time of the oldest record held by a ring (0 when empty)
+template <typename Ring, typename T>
+static uint32_t oldestTime(const Ring& ring, T& scratch) {
+    if (!ring.read(ring.begin(), scratch)) return 0;
+    return scratch.time;
+}
+
+static uint32_t oldestSampleTime() {
+    HistorySample s;
+    HistoryStore::SampleReader reader(*store);
+    return reader.next(s) ? s.time : 0;
+}
+
+// Record samples until tier 1 holds `buckets` buckets
+static void fillUntilTier1(uint16_t buckets, int16_t temp = 2000) {
+    while (store->tier1().count() < buckets) addSample(temp);
+}
+
+// ============================================================================
+// HISTORY RING
+// ============================================================================
+
+void test_ring_read_rejects_evicted_and_future_indices(void) {
+    HistoryRing<HistoryEvent, 4> ring;
+    HistoryEvent e = {0, 0};
+    for (uint32_t i = 0; i < 4; i++) {
+        e.time = i;
+        ring.push(e);
+    }
+    TEST_ASSERT_TRUE(ring.full());
+
+    ring.evict(2);
+    e.time = 4;
+    ring.push(e);
+
+    HistoryEvent out;
+    TEST_ASSERT_FALSE(ring.read(1, out));   // evicted
+    TEST_ASSERT_FALSE(ring.read(5, out));   // not yet written
+    TEST_ASSERT_TRUE(ring.read(2, out));
+    TEST_ASSERT_EQUAL_UINT32(2, out.time);
+    TEST_ASSERT_TRUE(ring.read(4, out));    // recycled slot 0
+    TEST_ASSERT_EQUAL_UINT32(4, out.time);
+    TEST_ASSERT_EQUAL_UINT16(3, ring.count());
+}
+
+// ============================================================================
+// TIER FOLDING
+// ============================================================================
+
+void test_raw_tier_fills_before_folding(void) {
+    // Slow ramp with small noise: typical probe data
+    uint16_t held = 0;
+    for (int i = 0; store->tier1().count() == 0; i++) {
+        held = store->sampleCount();
+        addSample(2000 + i / 10 + (i % 3) - 1);
+    }
+    TEST_ASSERT_TRUE(store->blocks().full());
+    // At least 3x the 720 samples the uncompressed raw tier held
+    TEST_ASSERT_TRUE(held >= 3 * 720);
+    // Folding moved the oldest block's samples out of the raw tier
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_TIER1_FOLD * store->tier1().count(), store->sampleBegin());
+}
+
+void test_closed_blocks_hold_whole_groups(void) {
+    // Varying deltas so blocks fill at different points within a group
+    for (int i = 0; i < 20000; i++) addSample(2000 + ((i * 37) % 300) - 150);
+    const HistoryStore::BlockRing& blocks = store->blocks();
+    HistoryBlock b;
+    uint32_t expectFirst = store->sampleBegin();
+    for (uint32_t i = blocks.begin(); i < blocks.end(); i++) {
+        TEST_ASSERT_TRUE(blocks.read(i, b));
+        TEST_ASSERT_EQUAL_UINT32(expectFirst, b.first);
+        TEST_ASSERT_EQUAL_UINT32(0, b.first % HISTORY_TIER1_FOLD);
+        TEST_ASSERT_EQUAL_UINT32(0, b.count % HISTORY_TIER1_FOLD);
+        expectFirst += b.count;
+    }
+}
+
+void test_reader_returns_every_held_sample_in_order(void) {
+    for (int i = 0; i < 10000; i++) addSample(2000 + (i % 40), 2250 + (i / 500) * 10, (i / 700) % 7);
+
+    HistoryStore::SampleReader reader(*store);
+    HistorySample s;
+    uint32_t expected = store->sampleBegin();
+    while (reader.next(s)) {
+        TEST_ASSERT_EQUAL_UINT32(expected, reader.index());
+        TEST_ASSERT_EQUAL_UINT32(expected * (HISTORY_SAMPLE_INTERVAL / 1000), s.time);
+        TEST_ASSERT_EQUAL_INT16(2000 + (expected % 40), s.temp);
+        TEST_ASSERT_EQUAL_INT16(2250 + (expected / 500) * 10, s.setpoint);
+        TEST_ASSERT_EQUAL_UINT8((expected / 700) % 7, s.state);
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(store->sampleEnd(), expected);
+}
+
+void test_reader_survives_recording_between_reads(void) {
+    for (int i = 0; i < 8000; i++) addSample(2000 + (i % 17));
+
+    const uint32_t endAtStart = store->sampleEnd();
+    HistoryStore::SampleReader reader(*store);
+    HistorySample s;
+    uint32_t last = 0;
+    bool first = true;
+    int n = 0;
+    // Record while reading so blocks close and the oldest are evicted mid-read
+    while (reader.next(s)) {
+        if (!first) TEST_ASSERT_TRUE(reader.index() > last);
+        TEST_ASSERT_EQUAL_UINT32(reader.index() * (HISTORY_SAMPLE_INTERVAL / 1000), s.time);
+        last = reader.index();
+        first = false;
+        if (++n % 3 == 0) addSample(2000 + ((store->sampleEnd()) % 17));
+    }
+    // Reads at least as far as the store held when the reader was created
+    TEST_ASSERT_TRUE(last >= endAtStart - 1);
+}
+
+void test_skip_through_returns_only_newer_samples(void) {
+    const uint32_t dt = HISTORY_SAMPLE_INTERVAL / 1000;
+    for (int i = 0; i < 6000; i++) addSample(2000 + (i % 23));
+
+    // Cursors inside the open block, deep in the closed blocks, and between
+    // two sample times
+    const uint32_t cursors[] = {5990 * dt, 3000 * dt, 1234 * dt + dt / 2};
+    for (uint32_t cursor : cursors) {
+        HistoryStore::SampleReader reader(*store);
+        reader.skipThrough(cursor);
+        HistorySample s;
+        uint32_t expected = cursor / dt + 1;
+        while (reader.next(s)) {
+            TEST_ASSERT_EQUAL_UINT32(expected * dt, s.time);
+            expected++;
+        }
+        TEST_ASSERT_EQUAL_UINT32(store->sampleEnd(), expected);
+    }
+}
+
+void test_skip_through_edges(void) {
+    for (int i = 0; i < 9000; i++) addSample(2000);
+    HistorySample s;
+
+    // At or past the newest sample: nothing to return
+    HistoryStore::SampleReader atLatest(*store);
+    atLatest.skipThrough(store->latestTime());
+    TEST_ASSERT_FALSE(atLatest.next(s));
+
+    // Older than anything held: everything from the oldest sample
+    HistoryStore::SampleReader all(*store);
+    all.skipThrough(1);
+    uint32_t n = 0;
+    while (all.next(s)) n++;
+    TEST_ASSERT_EQUAL_UINT32(store->sampleCount(), n);
+}
+
+void test_fold_to_tier1_computes_min_max_mean(void) {
+    const int16_t temps[HISTORY_TIER1_FOLD] = {2000, 2100, 1900, 2050, 1950, 2200};
+    for (int i = 0; i < HISTORY_TIER1_FOLD; i++) addSample(temps[i], 2250, i == 5 ? 4 : 3);
+    fillUntilTier1(1);
+
+    HistoryBucket b;
+    TEST_ASSERT_TRUE(store->tier1().read(store->tier1().begin(), b));
+    TEST_ASSERT_EQUAL_UINT32(0, b.time);
+    TEST_ASSERT_EQUAL_INT16(1900, b.minTemp);
+    TEST_ASSERT_EQUAL_INT16(2200, b.maxTemp);
+    TEST_ASSERT_EQUAL_INT16(2033, b.meanTemp);
+    TEST_ASSERT_EQUAL_UINT8(4, b.state);      // state at end of bucket
+}
+
+void test_fold_to_tier2_merges_buckets(void) {
+    // Fill raw and tier 1 until the first tier 1 buckets spill into tier 2.
+    // Give the first tier 2 worth of samples a spike and a dip.
+    const int perTier2 = HISTORY_TIER1_FOLD * HISTORY_TIER2_FOLD;
+    for (int i = 0; i < perTier2; i++) {
+        int16_t t = 2000;
+        if (i == 3) t = 2500;
+        if (i == perTier2 - 1) t = 1500;
+        addSample(t);
+    }
+    while (store->tier2().count() == 0) addSample(2000);
+
+    HistoryBucket b;
+    TEST_ASSERT_TRUE(store->tier2().read(store->tier2().begin(), b));
+    TEST_ASSERT_EQUAL_UINT32(0, b.time);
+    TEST_ASSERT_EQUAL_INT16(1500, b.minTemp);
+    TEST_ASSERT_EQUAL_INT16(2500, b.maxTemp);
+    TEST_ASSERT_INT_WITHIN(1, 2000, b.meanTemp);
+}
+
+void test_tiers_are_contiguous_and_time_ordered(void) {
+    // Three days of samples
+    const int n = 3 * 86400 / (HISTORY_SAMPLE_INTERVAL / 1000);
+    for (int i = 0; i < n; i++) addSample(2000 + (i % 50));
+
+    HistoryBucket b;
+    uint32_t prev = 0;
+    bool first = true;
+
+    const HistoryStore::Tier2Ring& t2 = store->tier2();
+    for (uint32_t i = t2.begin(); i < t2.end(); i++) {
+        TEST_ASSERT_TRUE(t2.read(i, b));
+        if (!first) TEST_ASSERT_EQUAL_UINT32(prev + HistoryStore::tier2Interval(), b.time);
+        prev = b.time;
+        first = false;
+    }
+    // Tier 1 begins exactly where tier 2 ends
+    TEST_ASSERT_EQUAL_UINT32(prev + HistoryStore::tier2Interval(), oldestTime(store->tier1(), b));
+
+    const HistoryStore::Tier1Ring& t1 = store->tier1();
+    for (uint32_t i = t1.begin(); i < t1.end(); i++) {
+        TEST_ASSERT_TRUE(t1.read(i, b));
+        prev = b.time;
+    }
+    TEST_ASSERT_EQUAL_UINT32(prev + HistoryStore::tier1Interval(), oldestSampleTime());
+    TEST_ASSERT_EQUAL_UINT32(nextTime - HISTORY_SAMPLE_INTERVAL / 1000, store->latestTime());
+}
+
+void test_retains_eight_days(void) {
+    // Twelve days in; the oldest tier 2 buckets age out
+    const uint32_t days = 12;
+    const int n = days * 86400 / (HISTORY_SAMPLE_INTERVAL / 1000);
+    for (int i = 0; i < n; i++) addSample(2000);
+
+    TEST_ASSERT_TRUE(store->blocks().full());
+    TEST_ASSERT_TRUE(store->tier1().count() >= HISTORY_TIER1_BUCKETS - HISTORY_TIER2_FOLD);
+    TEST_ASSERT_TRUE(store->tier2().full());
+
+    HistoryBucket b;
+    uint32_t span = store->latestTime() - oldestTime(store->tier2(), b);
+    TEST_ASSERT_TRUE(span >= 8u * 86400u + 86400u);
+    TEST_ASSERT_TRUE(span < days * 86400u);
+}
+
+void test_clear_empties_all_tiers(void) {
+    fillUntilTier1(10);
+    store->recordEvent(10, 1);
+    store->clear();
+    TEST_ASSERT_EQUAL_UINT16(0, store->sampleCount());
+    TEST_ASSERT_EQUAL_UINT16(0, store->blocks().count());
+    TEST_ASSERT_EQUAL_UINT16(0, store->tier1().count());
+    TEST_ASSERT_EQUAL_UINT16(0, store->events().count());
+    TEST_ASSERT_EQUAL_UINT32(0, store->latestTime());
+
+    HistorySample s;
+    HistoryStore::SampleReader reader(*store);
+    TEST_ASSERT_FALSE(reader.next(s));
+}
+
+// ============================================================================
+// EVENTS
+// ============================================================================
+
+void test_events_evict_oldest_when_full(void) {
+    for (uint32_t i = 0; i < HISTORY_MAX_EVENTS + 3; i++) store->recordEvent(i * 10, i % 8);
+    TEST_ASSERT_EQUAL_UINT16(HISTORY_MAX_EVENTS, store->events().count());
+    HistoryEvent e;
+    TEST_ASSERT_EQUAL_UINT32(30, oldestTime(store->events(), e));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ring_read_rejects_evicted_and_future_indices);
+    RUN_TEST(test_raw_tier_fills_before_folding);
+    RUN_TEST(test_closed_blocks_hold_whole_groups);
+    RUN_TEST(test_reader_returns_every_held_sample_in_order);
+    RUN_TEST(test_reader_survives_recording_between_reads);
+    RUN_TEST(test_skip_through_returns_only_newer_samples);
+    RUN_TEST(test_skip_through_edges);
+    RUN_TEST(test_fold_to_tier1_computes_min_max_mean);
+    RUN_TEST(test_fold_to_tier2_merges_buckets);
+    RUN_TEST(test_tiers_are_contiguous_and_time_ordered);
+    RUN_TEST(test_retains_eight_days);
+    RUN_TEST(test_clear_empties_all_tiers);
+    RUN_TEST(test_events_evict_oldest_when_full);
+
+    return UNITY_END();
+}
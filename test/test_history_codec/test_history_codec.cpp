@@ -0,0 +1,236 @@
+// Delta codec round trips, compression ratio on a simulated cook, and a
+// host-side benchmark of encode cost and full-decode throughput.
+
+// std headers must precede the mock Arduino.h min/max macros
+#include <chrono>
+#include <stdio.h>
+
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "smoker_sim.h"
+#include "history_codec.h"
+#include "history_store.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+static const uint32_t DT = HISTORY_SAMPLE_INTERVAL / 1000;
+
+static HistoryBlock block;
+
+static HistorySample sample(uint32_t time, int16_t temp, int16_t setpoint = 2250, uint8_t state = 2) {
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    s.time = time;
+    s.temp = temp;
+    s.setpoint = setpoint;
+    s.state = state;
+    return s;
+}
+
+// Encode `n` samples into `block` and check they decode unchanged
+static void round_trip(const HistorySample* in, uint8_t n) {
+    HistoryCodec::start(block, in[0], 100);
+    for (uint8_t i = 1; i < n; i++) {
+        TEST_ASSERT_TRUE(HistoryCodec::append(block, in[i - 1], in[i]));
+    }
+    HistoryCodec::Decoder decoder(block);
+    HistorySample out;
+    for (uint8_t i = 0; i < n; i++) {
+        TEST_ASSERT_TRUE(decoder.next(out));
+        TEST_ASSERT_EQUAL_UINT32(100 + i, decoder.index());
+        TEST_ASSERT_EQUAL_UINT32(in[i].time, out.time);
+        TEST_ASSERT_EQUAL_INT16(in[i].temp, out.temp);
+        TEST_ASSERT_EQUAL_INT16(in[i].setpoint, out.setpoint);
+        TEST_ASSERT_EQUAL_UINT8(in[i].state, out.state);
+    }
+    TEST_ASSERT_FALSE(decoder.next(out));
+}
+
+// Deterministic ±0.3°F probe noise
+static uint32_t lcg = 1;
+static int16_t noise() {
+    lcg = lcg * 1664525u + 1013904223u;
+    return (int16_t)((lcg >> 16) % 7) - 3;
+}
+
+void setUp(void) {
+    memset(&block, 0, sizeof(block));
+    lcg = 1;
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// CODEC
+// ============================================================================
+
+void test_zigzag_round_trip(void) {
+    const int32_t values[] = {0, -1, 1, -64, 63, 64, -32768, 32767, -65535, 65535};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        TEST_ASSERT_EQUAL_INT32(values[i], HistoryCodec::unzigzag(HistoryCodec::zigzag(values[i])));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, HistoryCodec::zigzag(-1));
+    TEST_ASSERT_EQUAL_UINT32(127, HistoryCodec::zigzag(-64));
+}
+
+void test_steady_sample_codes_to_one_byte(void) {
+    HistorySample in[3] = {sample(0, 2250), sample(DT, 2253), sample(2 * DT, 2190)};
+    round_trip(in, 3);
+    TEST_ASSERT_EQUAL_UINT16(2, block.used);
+}
+
+void test_general_form_fields(void) {
+    HistorySample in[] = {
+        sample(0, 700, 0, 0),
+        sample(DT + 1, 700, 0, 0),          // late sample
+        sample(2 * DT + 1, 1400, 0, 0),     // temp jump past the fast path
+        sample(3 * DT + 1, 1400, 2250, 1),  // setpoint and state change
+        sample(3 * DT + 2, 1400, 2250, 1),  // early sample
+        sample(4 * DT + 2, 1400, 2250, 2),  // state only
+    };
+    round_trip(in, 6);
+}
+
+void test_extreme_values_round_trip(void) {
+    HistorySample in[] = {
+        sample(0, 32767, 32767, 255),
+        sample(DT, -32768, -32768, 0),
+        sample(100000, 32767, 0, 6),
+        sample(100000, 0, 32767, 6),
+        sample(0xFFFFFFF0u, -1, 1, 3),
+    };
+    round_trip(in, 5);
+}
+
+void test_append_fails_cleanly_when_full(void) {
+    HistorySample prev = sample(0, 0);
+    HistoryCodec::start(block, prev, 0);
+    HistorySample s = prev;
+    // Alternate big jumps so every sample takes the general form
+    while (true) {
+        s.time += DT;
+        s.temp = (s.temp == 0) ? 30000 : 0;
+        HistoryBlock before = block;
+        if (!HistoryCodec::append(block, prev, s)) {
+            TEST_ASSERT_EQUAL_MEMORY(&before, &block, sizeof(block));
+            break;
+        }
+        prev = s;
+    }
+    TEST_ASSERT_TRUE(block.used > sizeof(block.data) - HistoryCodec::MAX_SAMPLE_BYTES);
+
+    HistoryCodec::Decoder decoder(block);
+    HistorySample out;
+    uint16_t n = 0;
+    while (decoder.next(out)) n++;
+    TEST_ASSERT_EQUAL_UINT16(block.count, n);
+    TEST_ASSERT_EQUAL_INT16(prev.temp, out.temp);
+}
+
+// ============================================================================
+// CAPACITY
+// ============================================================================
+
+void test_simulated_cook_fits_3x_samples(void) {
+    mock_reset_all();
+    mock_reset_sensor();
+    MAX31865 sensor(5, 4300.0, 1000.0);
+    RelayControl relay;
+    relay.begin();
+    TemperatureController ctrl(&sensor, &relay);
+    ctrl.begin();
+    SmokerSim sim;
+
+    // A long cook, long enough to wrap the raw tier
+    ctrl.startSmoking(225.0f);
+    sim.run(20UL * 3600 * 1000, [&ctrl]() { ctrl.update(); });
+    ctrl.setSetpoint(250.0f);
+    sim.run(20UL * 3600 * 1000, [&ctrl]() { ctrl.update(); });
+
+    const HistoryStore& history = ctrl.getHistory();
+    TEST_ASSERT_TRUE(history.blocks().full());
+    uint16_t held = history.sampleCount();
+    printf("[BENCH] simulated cook: %u samples in %u raw bytes (%.2f bytes/sample, %.1fx)\n",
+           held, (unsigned)HistoryStore::BlockRing::STORAGE_BYTES,
+           (double)HistoryStore::BlockRing::STORAGE_BYTES / held,
+           (double)held * sizeof(HistorySample) / HistoryStore::BlockRing::STORAGE_BYTES);
+    // The uncompressed raw tier held 720 samples in ~8KB
+    TEST_ASSERT_TRUE(held >= 3 * 720);
+}
+
+void test_noisy_probe_fits_3x_samples(void) {
+    HistoryStore* store = new HistoryStore();
+    uint32_t t = 0;
+    int16_t base = 2250;
+    for (uint32_t i = 0; store->tier1().count() == 0; i++) {
+        if (i % 200 == 0) base += (i % 400 == 0) ? 15 : -15;   // slow wander
+        store->recordSample(sample(t, base + noise()));
+        t += DT;
+    }
+    printf("[BENCH] noisy probe: %u samples held when raw tier wrapped\n",
+           (unsigned)store->sampleCount());
+    TEST_ASSERT_TRUE(store->sampleCount() >= 3 * 720);
+    delete store;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+void test_bench_encode_and_decode(void) {
+    typedef std::chrono::steady_clock Clock;
+    const uint32_t N = 500000;   // ~4 months of samples; wraps every tier
+
+    HistoryStore* store = new HistoryStore();
+    uint32_t t = 0;
+    int16_t temp = 2250;
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < N; i++) {
+        temp += noise();
+        if (temp < 2000 || temp > 2500) temp = 2250;
+        store->recordSample(sample(t, temp, 2250, (i / 5000) % 7));
+        t += DT;
+    }
+    double encodeNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / N;
+
+    const int passes = 50;
+    uint32_t decoded = 0;
+    int32_t checksum = 0;
+    HistorySample s;
+    start = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        HistoryStore::SampleReader reader(*store);
+        while (reader.next(s)) {
+            checksum += s.temp;
+            decoded++;
+        }
+    }
+    double decodeSec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("[BENCH] encode: %.0f ns/sample (incl. folding into tiers)\n", encodeNs);
+    printf("[BENCH] decode: %u samples x %d passes, %.1f M samples/s (checksum %d)\n",
+           store->sampleCount(), passes, decoded / decodeSec / 1e6, (int)checksum);
+
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)store->sampleCount() * passes, decoded);
+    delete store;
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_zigzag_round_trip);
+    RUN_TEST(test_steady_sample_codes_to_one_byte);
+    RUN_TEST(test_general_form_fields);
+    RUN_TEST(test_extreme_values_round_trip);
+    RUN_TEST(test_append_fails_cleanly_when_full);
+    RUN_TEST(test_simulated_cook_fits_3x_samples);
+    RUN_TEST(test_noisy_probe_fits_3x_samples);
+    RUN_TEST(test_bench_encode_and_decode);
+
+    return UNITY_END();
+}
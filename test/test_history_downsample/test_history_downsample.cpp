@@ -0,0 +1,314 @@
+// Streaming LTTB reduction of the multi-tier history (HistoryDownsampler)
+
+#include <chrono>
+#include <stdio.h>
+
+#include <unity.h>
+#include "history_downsample.h"
+#include "history_store.h"
+#include "config.h"
+
+static const uint32_t DT = HISTORY_SAMPLE_INTERVAL / 1000;
+
+static HistoryStore* store;
+static uint32_t nextTime;
+
+void setUp(void) {
+    store = new HistoryStore();
+    nextTime = 0;
+}
+
+void tearDown(void) {
+    delete store;
+}
+
+static void addSample(int16_t temp, uint8_t state = 2) {
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    s.time = nextTime;
+    s.temp = temp;
+    s.setpoint = 2250;
+    s.state = state;
+    store->recordSample(s);
+    nextTime += DT;
+}
+
+// Repeating cooks: startup ramp, a wobbling hold, cooldown, idle
+static uint8_t cookState(uint32_t i) {
+    uint32_t phase = i % 2160;    // 12 hours per cycle
+    if (phase < 60) return 1;
+    if (phase < 1800) return 2;
+    if (phase < 1900) return 3;
+    return 0;
+}
+
+static int16_t cookTemp(uint32_t i) {
+    uint32_t phase = i % 2160;
+    if (phase < 60) return (int16_t)(700 + phase * 25);
+    if (phase < 1800) return (int16_t)(2250 + (int32_t)((i * 7919) % 61) - 30);
+    if (phase < 1900) return (int16_t)(2250 - (phase - 1800) * 15);
+    return 700;
+}
+
+static void fillCook(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) addSample(cookTemp(i), cookState(i));
+}
+
+static uint32_t countSeries(void) {
+    HistorySeries series(*store, 0, store->latestTime());
+    HistorySample s;
+    uint32_t n = 0;
+    while (series.next(s)) n++;
+    return n;
+}
+
+static uint32_t countStateChanges(void) {
+    HistorySeries series(*store, 0, store->latestTime());
+    HistorySample s;
+    uint32_t changes = 0;
+    bool first = true;
+    uint8_t prevState = 0;
+    while (series.next(s)) {
+        if (!first && s.state != prevState) changes++;
+        first = false;
+        prevState = s.state;
+    }
+    return changes;
+}
+
+// ============================================================================
+// SERIES
+// ============================================================================
+
+void test_series_covers_every_tier_in_time_order(void) {
+    fillCook(20000);
+    TEST_ASSERT_TRUE(store->tier2().count() > 0);
+
+    HistorySeries series(*store, 0, store->latestTime());
+    HistorySample s;
+    uint32_t prev = 0;
+    uint32_t n = 0;
+    while (series.next(s)) {
+        if (n > 0) TEST_ASSERT_TRUE(s.time > prev);
+        prev = s.time;
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(store->tier2().count() + store->tier1().count() + store->sampleCount(), n);
+    TEST_ASSERT_EQUAL_UINT32(store->latestTime(), prev);
+}
+
+void test_series_respects_since_and_latest(void) {
+    fillCook(1000);
+    HistorySeries series(*store, 100 * DT, 200 * DT);
+    HistorySample s;
+    uint32_t n = 0;
+    while (series.next(s)) {
+        TEST_ASSERT_EQUAL_UINT32((101 + n) * DT, s.time);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, n);
+}
+
+// ============================================================================
+// REDUCTION
+// ============================================================================
+
+void test_short_series_is_returned_whole(void) {
+    for (int i = 0; i < 50; i++) addSample(2000 + i);
+    HistoryDownsampler reduced(*store, 0, store->latestTime(), 500);
+    HistorySample s;
+    uint32_t n = 0;
+    while (reduced.next(s)) {
+        TEST_ASSERT_EQUAL_UINT32(n * DT, s.time);
+        TEST_ASSERT_EQUAL_INT16(2000 + n, s.temp);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(50, n);
+}
+
+void test_empty_store_returns_nothing(void) {
+    HistoryDownsampler reduced(*store, 0, 0, 100);
+    HistorySample s;
+    TEST_ASSERT_FALSE(reduced.next(s));
+}
+
+void test_output_is_bounded_and_keeps_endpoints(void) {
+    fillCook(20000);
+    const uint16_t points = 300;
+
+    // State changes in the input, including those inside folded tiers
+    const uint32_t changes = countStateChanges();
+    HistorySeries series(*store, 0, store->latestTime());
+    HistorySample first;
+    TEST_ASSERT_TRUE(series.next(first));
+    HistorySample s;
+
+    HistoryDownsampler reduced(*store, 0, store->latestTime(), points);
+    uint32_t n = 0;
+    uint32_t prev = 0;
+    uint32_t last = 0;
+    while (reduced.next(s)) {
+        if (n == 0) TEST_ASSERT_EQUAL_UINT32(first.time, s.time);
+        if (n > 0) TEST_ASSERT_TRUE(s.time > prev);
+        prev = s.time;
+        last = s.time;
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(store->latestTime(), last);
+    TEST_ASSERT_TRUE(n <= points + 2 * changes);
+    TEST_ASSERT_TRUE(n >= points / 2);
+}
+
+void test_state_boundaries_are_always_kept(void) {
+    fillCook(6000);    // raw tier only
+    HistoryDownsampler reduced(*store, 0, store->latestTime(), 20);
+    HistorySample s;
+    HistorySample kept[64];
+    uint32_t n = 0;
+    while (reduced.next(s)) {
+        TEST_ASSERT_TRUE(n < 64);
+        kept[n++] = s;
+    }
+
+    // Every sample that starts a new state must be in the output
+    HistoryStore::SampleReader reader(*store);
+    uint8_t prevState = 0xFF;
+    uint32_t boundaries = 0;
+    while (reader.next(s)) {
+        if (prevState != 0xFF && s.state != prevState) {
+            bool found = false;
+            for (uint32_t i = 0; i < n; i++) {
+                if (kept[i].time == s.time && kept[i].state == s.state) found = true;
+            }
+            TEST_ASSERT_TRUE_MESSAGE(found, "state boundary dropped");
+            boundaries++;
+        }
+        prevState = s.state;
+    }
+    TEST_ASSERT_TRUE(boundaries >= 8);
+}
+
+void test_lttb_keeps_spikes(void) {
+    // Flat line with one short excursion: a mean or stride reducer would lose it
+    for (int i = 0; i < 3000; i++) {
+        addSample((i >= 1500 && i < 1502) ? 3500 : 2250);
+    }
+    HistoryDownsampler reduced(*store, 0, store->latestTime(), 50);
+    HistorySample s;
+    int16_t peak = 0;
+    while (reduced.next(s)) {
+        if (s.temp > peak) peak = s.temp;
+    }
+    TEST_ASSERT_EQUAL_INT16(3500, peak);
+}
+
+void test_since_limits_reduction(void) {
+    fillCook(5000);
+    uint32_t since = 4000 * DT;
+    HistoryDownsampler reduced(*store, since, store->latestTime(), 100);
+    HistorySample s;
+    uint32_t n = 0;
+    while (reduced.next(s)) {
+        TEST_ASSERT_TRUE(s.time > since);
+        n++;
+    }
+    TEST_ASSERT_TRUE(n > 0 && n <= 100 + 2 * 4);
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+// Format records the way /api/history's JSON body does, returning the byte count
+static uint32_t formatBucket(const HistoryBucket& b, uint32_t span) {
+    char buf[64];
+    return (uint32_t)snprintf(buf, sizeof(buf), "[%u,%u,%d,%d,%d,%d,%d],", b.time, span,
+                              b.minTemp, b.maxTemp, b.meanTemp, b.setpoint, b.state);
+}
+
+static uint32_t formatSample(const HistorySample& s) {
+    char buf[48];
+    return (uint32_t)snprintf(buf, sizeof(buf), "[%u,%d,%d,%d],", s.time, s.temp, s.setpoint, s.state);
+}
+
+static uint32_t fullDump(uint32_t latest, uint32_t& records) {
+    uint32_t bytes = 64;
+    HistoryBucket b;
+    HistorySample s;
+    records = 0;
+    for (uint32_t i = store->tier2().begin(); i < store->tier2().end(); i++) {
+        if (store->tier2().read(i, b)) bytes += formatBucket(b, HistoryStore::tier2Interval());
+        records++;
+    }
+    for (uint32_t i = store->tier1().begin(); i < store->tier1().end(); i++) {
+        if (store->tier1().read(i, b)) bytes += formatBucket(b, HistoryStore::tier1Interval());
+        records++;
+    }
+    HistoryStore::SampleReader reader(*store);
+    while (reader.next(s) && s.time <= latest) {
+        bytes += formatSample(s);
+        records++;
+    }
+    return bytes;
+}
+
+static uint32_t reducedDump(uint32_t latest, uint16_t points, uint32_t& records) {
+    uint32_t bytes = 64;
+    HistorySample s;
+    records = 0;
+    HistoryDownsampler reduced(*store, 0, latest, points);
+    while (reduced.next(s)) {
+        bytes += formatSample(s);
+        records++;
+    }
+    return bytes;
+}
+
+void test_benchmark_response_size_and_time(void) {
+    typedef std::chrono::steady_clock Clock;
+    fillCook(40000);    // ~9 days: every tier populated
+    const uint32_t latest = store->latestTime();
+    const uint32_t changes = countStateChanges();
+    const int PASSES = 20;
+
+    // Time to format the whole body: the CPU the async_tcp task spends on
+    // one response (it is streamed, so this is not time to first byte)
+    uint32_t fullRecords = 0;
+    uint32_t fullBytes = 0;
+    Clock::time_point start = Clock::now();
+    for (int pass = 0; pass < PASSES; pass++) fullBytes = fullDump(latest, fullRecords);
+    double fullUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / PASSES;
+    printf("[BENCH] full: %u records, JSON %u bytes, %.0f us to format\n",
+           fullRecords, fullBytes, fullUs);
+
+    const uint16_t targets[] = {2000, 800, 300};
+    for (uint16_t points : targets) {
+        uint32_t records = 0;
+        uint32_t bytes = 0;
+        start = Clock::now();
+        for (int pass = 0; pass < PASSES; pass++) bytes = reducedDump(latest, points, records);
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / PASSES;
+        printf("[BENCH] points=%u: %u records, JSON %u bytes (%.1f%%), %.0f us to format (%.0f%%)\n",
+               points, records, bytes, 100.0 * bytes / fullBytes, us, 100.0 * us / fullUs);
+        TEST_ASSERT_TRUE(records <= points + 2 * changes);
+        TEST_ASSERT_TRUE(bytes < fullBytes);
+    }
+    TEST_ASSERT_EQUAL_UINT32(fullRecords, countSeries());
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_series_covers_every_tier_in_time_order);
+    RUN_TEST(test_series_respects_since_and_latest);
+    RUN_TEST(test_short_series_is_returned_whole);
+    RUN_TEST(test_empty_store_returns_nothing);
+    RUN_TEST(test_output_is_bounded_and_keeps_endpoints);
+    RUN_TEST(test_state_boundaries_are_always_kept);
+    RUN_TEST(test_lttb_keeps_spikes);
+    RUN_TEST(test_since_limits_reduction);
+    RUN_TEST(test_benchmark_response_size_and_time);
+
+    return UNITY_END();
+}
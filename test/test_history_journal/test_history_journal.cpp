@@ -0,0 +1,321 @@
+#include <unity.h>
+#include "Arduino.h"
+#include "FS.h"
+#include "mock_helpers.h"
+#include "history_journal.h"
+#include "history_store.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+static const uint32_t DT = HISTORY_SAMPLE_INTERVAL / 1000;
+
+static fs::FS flash;
+static HistoryStore* store;
+static HistoryJournal* journal;
+static uint32_t nextTime;
+
+static HistorySample sample(uint32_t time, int16_t temp) {
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    s.time = time;
+    s.temp = temp;
+    s.setpoint = 2250;
+    s.state = 2;
+    return s;
+}
+
+// Record into the RAM store and the journal, as the controller does
+static void record(int n) {
+    for (int i = 0; i < n; i++) {
+        HistorySample s = sample(nextTime, 2000 + (nextTime / DT) % 37);
+        store->recordSample(s);
+        journal->appendSample(s);
+        nextTime += DT;
+    }
+}
+
+// Power-cycle: drop RAM state and recover from "flash"
+static void reboot(void) {
+    delete journal;
+    delete store;
+    mock_fs_fail_after(-1);
+    store = new HistoryStore();
+    journal = new HistoryJournal(flash);
+    journal->begin(*store);
+}
+
+static uint32_t segmentCount(void) {
+    uint32_t n = 0;
+    File dir = flash.open(HISTORY_JOURNAL_DIR);
+    File f = dir.openNextFile();
+    while (f) {
+        n++;
+        f = dir.openNextFile();
+    }
+    return n;
+}
+
+// Every recovered sample must be the one originally recorded at that time
+static uint32_t checkRecovered(void) {
+    HistoryStore::SampleReader reader(*store);
+    HistorySample s;
+    uint32_t n = 0;
+    uint32_t prevTime = 0;
+    while (reader.next(s)) {
+        if (n > 0) TEST_ASSERT_EQUAL_UINT32(prevTime + DT, s.time);
+        TEST_ASSERT_EQUAL_INT16(2000 + (s.time / DT) % 37, s.temp);
+        prevTime = s.time;
+        n++;
+    }
+    return n;
+}
+
+void setUp(void) {
+    mock_reset_all();
+    mock_fs_reset();
+    nextTime = 0;
+    store = new HistoryStore();
+    journal = new HistoryJournal(flash);
+    journal->begin(*store);
+}
+
+void tearDown(void) {
+    delete journal;
+    delete store;
+}
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+
+void test_empty_journal_recovers_nothing(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, journal->getStats().recoveredSamples);
+    TEST_ASSERT_EQUAL_UINT16(0, store->sampleCount());
+    TEST_ASSERT_TRUE(flash.exists(HISTORY_JOURNAL_DIR));
+}
+
+void test_flushed_history_survives_reboot(void) {
+    record(100);
+    store->recordEvent(40, 1);
+    journal->appendEvent(40, 1);
+    journal->flush();
+    record(50);
+    journal->flush();
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(150, journal->getStats().recoveredSamples);
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().recoveredEvents);
+    TEST_ASSERT_EQUAL_UINT32(0, journal->getStats().corruptRecords);
+    TEST_ASSERT_EQUAL_UINT32(150, checkRecovered());
+    TEST_ASSERT_EQUAL_UINT32(149 * DT, store->latestTime());
+
+    HistoryEvent e;
+    TEST_ASSERT_TRUE(store->events().read(store->events().begin(), e));
+    TEST_ASSERT_EQUAL_UINT32(40, e.time);
+}
+
+void test_unflushed_batch_is_lost(void) {
+    record(30);
+    journal->flush();
+    record(10);    // power lost before the next flush
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(30, checkRecovered());
+}
+
+void test_recovery_rebuilds_tiers(void) {
+    // Enough history to wrap the raw tier into tier 1
+    for (int i = 0; store->tier1().count() < 20; i++) {
+        record(HISTORY_SAMPLE_INTERVAL / 1000);
+        if (i % 4 == 0) journal->flush();
+    }
+    journal->flush();
+    uint16_t tier1 = store->tier1().count();
+    uint32_t latest = store->latestTime();
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT16(tier1, store->tier1().count());
+    TEST_ASSERT_EQUAL_UINT32(latest, store->latestTime());
+}
+
+// ============================================================================
+// TORN AND CORRUPT WRITES
+// ============================================================================
+
+void test_torn_write_keeps_earlier_records(void) {
+    record(60);
+    journal->flush();
+    record(60);
+    journal->flush();
+
+    // Power fails partway through the third batch
+    record(60);
+    mock_fs_fail_after(20);
+    journal->flush();
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().writeErrors);
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(120, checkRecovered());
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().corruptRecords);
+
+    // New records go to a fresh segment, never after the torn tail
+    uint32_t segmentsBefore = segmentCount();
+    nextTime = store->latestTime() + DT;
+    record(30);
+    journal->flush();
+    TEST_ASSERT_EQUAL_UINT32(segmentsBefore + 1, segmentCount());
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(150, journal->getStats().recoveredSamples);
+    TEST_ASSERT_EQUAL_UINT32(150, checkRecovered());
+}
+
+void test_torn_header_is_rejected(void) {
+    record(20);
+    journal->flush();
+    record(20);
+    mock_fs_fail_after(3);    // not even a whole record header
+    journal->flush();
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(20, checkRecovered());
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().corruptRecords);
+}
+
+void test_bit_flip_fails_crc(void) {
+    record(20);
+    journal->flush();
+    record(20);
+    journal->flush();
+
+    char path[40];
+    snprintf(path, sizeof(path), "%s/%08X.seg", HISTORY_JOURNAL_DIR, 1u);
+    size_t size = 0;
+    uint8_t* data = mock_fs_data(path, &size);
+    TEST_ASSERT_NOT_NULL(data);
+    // Flip a bit in the second batch's payload
+    data[size - 3] ^= 0x10;
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(20, journal->getStats().recoveredSamples);
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().corruptRecords);
+}
+
+void test_crc32_reference_value(void) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, HistoryJournal::crc32(check, sizeof(check)));
+    // Chained update equals one pass
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926,
+                            HistoryJournal::crc32(check + 4, 5, HistoryJournal::crc32(check, 4)));
+}
+
+// ============================================================================
+// BATCHING, RETENTION AND WEAR
+// ============================================================================
+
+void test_service_batches_writes(void) {
+    record(1);
+    journal->service();
+    TEST_ASSERT_EQUAL_UINT32(0, mock_fs_write_calls());
+
+    mock_set_millis(HISTORY_JOURNAL_FLUSH_INTERVAL - 1);
+    journal->service();
+    TEST_ASSERT_EQUAL_UINT32(0, mock_fs_write_calls());
+
+    mock_set_millis(HISTORY_JOURNAL_FLUSH_INTERVAL);
+    journal->service();
+    TEST_ASSERT_EQUAL_UINT32(1, mock_fs_write_calls());
+    TEST_ASSERT_EQUAL_UINT32(1, journal->getStats().flushes);
+}
+
+void test_flash_writes_per_cook_are_bounded(void) {
+    // 14-hour cook: a sample every interval, service() every second
+    const uint32_t cookMs = 14UL * 3600 * 1000;
+    for (uint32_t ms = 1000; ms <= cookMs; ms += 1000) {
+        mock_set_millis(ms);
+        if (ms % HISTORY_SAMPLE_INTERVAL == 0) record(1);
+        journal->service();
+    }
+    uint32_t bound = cookMs / HISTORY_JOURNAL_FLUSH_INTERVAL + 1;
+    HistoryJournal::Stats st = journal->getStats();
+    TEST_ASSERT_TRUE(st.flushes <= bound);
+    TEST_ASSERT_TRUE(mock_fs_write_calls() <= bound);
+    TEST_ASSERT_EQUAL_UINT32(0, st.dropped);
+    // Well under one segment per hour of cook
+    TEST_ASSERT_TRUE(st.bytesWritten < 14UL * 3600 / DT * 4);
+}
+
+void test_old_segments_are_deleted(void) {
+    // Write until the journal has rolled well past its retention count
+    while (journal->getStats().segmentsCreated < HISTORY_JOURNAL_SEGMENTS + 3) {
+        record(60);
+        journal->flush();
+    }
+    TEST_ASSERT_EQUAL_UINT32(HISTORY_JOURNAL_SEGMENTS, segmentCount());
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(0, journal->getStats().corruptRecords);
+    TEST_ASSERT_TRUE(journal->getStats().recoveredSamples > 0);
+}
+
+// ============================================================================
+// CONTROLLER
+// ============================================================================
+
+void test_controller_history_clock_continues_after_reboot(void) {
+    MAX31865 sensor(5, 4300.0, 1000.0);
+    RelayControl relay;
+    relay.begin();
+
+    TemperatureController* ctrl = new TemperatureController(&sensor, &relay);
+    ctrl->begin();
+    ctrl->attachJournal(journal);
+    ctrl->setTempOverride(120.0);
+    for (uint32_t ms = 0; ms <= 600000; ms += TEMP_CONTROL_INTERVAL) {
+        mock_set_millis(ms);
+        ctrl->update();
+    }
+    journal->flush();
+    uint32_t before = ctrl->getHistory().latestTime();
+    TEST_ASSERT_TRUE(before >= 580);
+    delete ctrl;
+
+    // Reboot: uptime restarts, history time does not
+    mock_set_millis(0);
+    delete journal;
+    journal = new HistoryJournal(flash);
+    ctrl = new TemperatureController(&sensor, &relay);
+    ctrl->begin();
+    ctrl->attachJournal(journal);
+    TEST_ASSERT_EQUAL_UINT32(before, ctrl->getHistory().latestTime());
+    TEST_ASSERT_TRUE(ctrl->getHistoryTime() >= before);
+
+    for (uint32_t ms = 0; ms <= 60000; ms += TEMP_CONTROL_INTERVAL) {
+        mock_set_millis(ms);
+        ctrl->update();
+    }
+    TEST_ASSERT_TRUE(ctrl->getHistory().latestTime() > before);
+    delete ctrl;
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_journal_recovers_nothing);
+    RUN_TEST(test_flushed_history_survives_reboot);
+    RUN_TEST(test_unflushed_batch_is_lost);
+    RUN_TEST(test_recovery_rebuilds_tiers);
+    RUN_TEST(test_torn_write_keeps_earlier_records);
+    RUN_TEST(test_torn_header_is_rejected);
+    RUN_TEST(test_bit_flip_fails_crc);
+    RUN_TEST(test_crc32_reference_value);
+    RUN_TEST(test_service_batches_writes);
+    RUN_TEST(test_flash_writes_per_cook_are_bounded);
+    RUN_TEST(test_old_segments_are_deleted);
+    RUN_TEST(test_controller_history_clock_continues_after_reboot);
+
+    return UNITY_END();
+}
@@ -0,0 +1,208 @@
+// Chunked /api/history body (HistoryStream)
+
+#include <string>
+
+#include <unity.h>
+#include "history_stream.h"
+#include "history_store.h"
+#include "config.h"
+
+static const uint32_t DT = HISTORY_SAMPLE_INTERVAL / 1000;
+
+static HistoryStore* store;
+static uint32_t nextTime;
+
+void setUp(void) {
+    store = new HistoryStore();
+    nextTime = 0;
+}
+
+void tearDown(void) {
+    delete store;
+}
+
+static void addSample(int16_t temp, uint8_t state = 2) {
+    HistorySample s;
+    memset(&s, 0, sizeof(s));
+    s.time = nextTime;
+    s.temp = temp;
+    s.setpoint = 2250;
+    s.state = state;
+    store->recordSample(s);
+    nextTime += DT;
+}
+
+// Record until both folded tiers hold buckets
+static void fillAllTiers(void) {
+    uint32_t i = 0;
+    while (store->tier2().count() < 3) addSample((int16_t)(2000 + (i++ % 40)));
+    store->recordEvent(nextTime - DT, 3);
+}
+
+// Read a whole body `chunk` bytes at a time
+static std::string readAll(HistoryStream& stream, size_t chunk) {
+    std::string body;
+    uint8_t buf[512];
+    size_t n;
+    while ((n = stream.read(buf, chunk)) > 0) {
+        TEST_ASSERT_TRUE(n <= chunk);
+        body.append((const char*)buf, n);
+    }
+    return body;
+}
+
+static uint32_t u32At(const std::string& body, size_t o) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | (uint8_t)body[o + i];
+    return v;
+}
+
+struct Counts {
+    uint32_t buckets, samples, events;
+    uint32_t firstBucketTime, firstSampleTime;
+    bool valid;
+};
+
+static Counts parseBinary(const std::string& body) {
+    Counts c;
+    memset(&c, 0, sizeof(c));
+    if (body.size() < 12 || body[0] != 'S' || body[1] != 'H') return c;
+    size_t o = 12;
+    while (o < body.size()) {
+        char type = body[o];
+        if (type == 'B' && o + 16 <= body.size()) {
+            if (!c.buckets) c.firstBucketTime = u32At(body, o + 1);
+            c.buckets++;
+            o += 16;
+        } else if (type == 'S' && o + 10 <= body.size()) {
+            if (!c.samples) c.firstSampleTime = u32At(body, o + 1);
+            c.samples++;
+            o += 10;
+        } else if (type == 'E' && o + 6 <= body.size()) {
+            c.events++;
+            o += 6;
+        } else {
+            return c;
+        }
+    }
+    c.valid = true;
+    return c;
+}
+
+static uint32_t countRawSamples(void) {
+    HistoryStore::SampleReader reader(*store);
+    HistorySample s;
+    uint32_t n = 0;
+    while (reader.next(s)) n++;
+    return n;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void test_empty_store_json(void) {
+    HistoryStream stream(*store, 42, 0, 0, false);
+    std::string body = readAll(stream, 512);
+    TEST_ASSERT_EQUAL_STRING("{\"now\":42,\"latest\":0,\"buckets\":[],\"samples\":[],\"events\":[]}",
+                             body.c_str());
+}
+
+void test_read_after_end_returns_zero(void) {
+    HistoryStream stream(*store, 1, 0, 0, true);
+    readAll(stream, 512);
+    uint8_t buf[16];
+    TEST_ASSERT_EQUAL_UINT32(0, stream.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_UINT32(0, stream.read(buf, sizeof(buf)));
+}
+
+void test_binary_holds_every_record(void) {
+    fillAllTiers();
+    HistoryStream stream(*store, nextTime, 0, 0, true);
+    Counts c = parseBinary(readAll(stream, 512));
+    TEST_ASSERT_TRUE(c.valid);
+    TEST_ASSERT_EQUAL_UINT32(store->tier2().count() + store->tier1().count(), c.buckets);
+    TEST_ASSERT_EQUAL_UINT32(countRawSamples(), c.samples);
+    TEST_ASSERT_EQUAL_UINT32(1, c.events);
+}
+
+void test_chunk_size_does_not_change_body(void) {
+    fillAllTiers();
+    for (int binary = 0; binary < 2; binary++) {
+        HistoryStream whole(*store, nextTime, 0, 0, binary);
+        std::string expected = readAll(whole, 512);
+        // Smaller than one record: records must be split across reads
+        const size_t chunks[] = {1, 7, 64, 333};
+        for (size_t chunk : chunks) {
+            HistoryStream pieces(*store, nextTime, 0, 0, binary);
+            TEST_ASSERT_TRUE(expected == readAll(pieces, chunk));
+        }
+    }
+}
+
+void test_json_is_well_formed(void) {
+    fillAllTiers();
+    HistoryStream stream(*store, nextTime, 0, 0, false);
+    std::string body = readAll(stream, 100);
+    TEST_ASSERT_EQUAL(0, (int)body.find("{\"now\":"));
+    TEST_ASSERT_TRUE(body.find("]],\"samples\":[[") != std::string::npos);
+    TEST_ASSERT_TRUE(body.find("]],\"events\":[[") != std::string::npos);
+    TEST_ASSERT_TRUE(body.compare(body.size() - 3, 3, "]]}") == 0);
+    TEST_ASSERT_TRUE(body.find(",,") == std::string::npos);
+    TEST_ASSERT_TRUE(body.find("[,") == std::string::npos);
+
+    // One '[' per record plus the three arrays
+    uint32_t open = 0;
+    for (char ch : body) open += ch == '[';
+    uint32_t records = store->tier2().count() + store->tier1().count() + countRawSamples() + 1;
+    TEST_ASSERT_EQUAL_UINT32(records + 3, open);
+}
+
+void test_since_returns_buckets_ending_after_cursor(void) {
+    fillAllTiers();
+    HistoryBucket b;
+    TEST_ASSERT_TRUE(store->tier1().read(store->tier1().end() - 1, b));
+    // Cursor inside the newest tier 1 bucket
+    uint32_t since = b.time + DT;
+
+    HistoryStream stream(*store, nextTime, since, 0, true);
+    Counts c = parseBinary(readAll(stream, 512));
+    TEST_ASSERT_TRUE(c.valid);
+    TEST_ASSERT_EQUAL_UINT32(1, c.buckets);
+    TEST_ASSERT_EQUAL_UINT32(b.time, c.firstBucketTime);
+    TEST_ASSERT_TRUE(c.firstSampleTime > since);
+}
+
+void test_since_at_latest_returns_header_only(void) {
+    fillAllTiers();
+    HistoryStream stream(*store, nextTime, store->latestTime(), 0, true);
+    std::string body = readAll(stream, 512);
+    TEST_ASSERT_EQUAL_UINT32(12, body.size());
+    TEST_ASSERT_EQUAL_UINT32(store->latestTime(), u32At(body, 8));
+}
+
+void test_points_returns_samples_only(void) {
+    fillAllTiers();
+    HistoryStream stream(*store, nextTime, 0, 200, true);
+    Counts c = parseBinary(readAll(stream, 512));
+    TEST_ASSERT_TRUE(c.valid);
+    TEST_ASSERT_EQUAL_UINT32(0, c.buckets);
+    TEST_ASSERT_TRUE(c.samples >= 3 && c.samples <= 202);
+    TEST_ASSERT_EQUAL_UINT32(1, c.events);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_store_json);
+    RUN_TEST(test_read_after_end_returns_zero);
+    RUN_TEST(test_binary_holds_every_record);
+    RUN_TEST(test_chunk_size_does_not_change_body);
+    RUN_TEST(test_json_is_well_formed);
+    RUN_TEST(test_since_returns_buckets_ending_after_cursor);
+    RUN_TEST(test_since_at_latest_returns_header_only);
+    RUN_TEST(test_points_returns_samples_only);
+
+    return UNITY_END();
+}
@@ -0,0 +1,247 @@
+// Binary LOG_EVENT records: encoding, expansion and UDP frames
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "log_codec.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+template <typename... Args>
+static LogArgs encode(Args... args) {
+    LogArgs a;
+    a.add(args...);
+    return a;
+}
+
+static const char* expand(uint16_t id, const LogArgs& a) {
+    static char buf[256];
+    logExpand(id, a.data(), a.size(), buf, sizeof(buf));
+    return buf;
+}
+
+// The checks LOG_EVENT applies at compile time
+static_assert(decltype(logSignature("a", "b", 1.0f))::matches(LOG_FORMAT_STATE_TRANSITION), "");
+static_assert(!decltype(logSignature("a", 2, 1.0f))::matches(LOG_FORMAT_STATE_TRANSITION), "");
+static_assert(!decltype(logSignature("a", "b"))::matches(LOG_FORMAT_STATE_TRANSITION), "");
+static_assert(decltype(logSignature())::matches(LOG_FORMAT_RTD_FAULT_CLEARED), "");
+static_assert(decltype(logSignature((uint8_t)1, 5))::matches(LOG_FORMAT_SENSOR_FAILURE), "");
+static_assert(logCatalogHash() != 0, "");
+
+// ============================================================================
+// EXPANSION
+// ============================================================================
+
+void test_expansion_matches_printf(void) {
+    char expect[256];
+    snprintf(expect, sizeof(expect), LOG_FORMAT_STATE_TRANSITION, "Startup", "Running", 180.25);
+    TEST_ASSERT_EQUAL_STRING(expect, expand(LOG_MSG_STATE_TRANSITION, encode("Startup", "Running", 180.25f)));
+
+    snprintf(expect, sizeof(expect), LOG_FORMAT_REIGNITE_START, 131.4, 140.0, 300u, 2, 3);
+    TEST_ASSERT_EQUAL_STRING(expect, expand(LOG_MSG_REIGNITE_START,
+                                            encode(131.4f, 140.0, (uint32_t)300, 2, 3)));
+
+    snprintf(expect, sizeof(expect), LOG_FORMAT_RTD_REGISTERS, 0x1A2B, 0xFFFF, 0x0);
+    TEST_ASSERT_EQUAL_STRING(expect, expand(LOG_MSG_RTD_REGISTERS,
+                                            encode((uint16_t)0x1A2B, (uint16_t)0xFFFF, (uint16_t)0)));
+    TEST_ASSERT_EQUAL_STRING("RTD=0x1A2B, HighTh=0xFFFF, LowTh=0x0000",
+                             expand(LOG_MSG_RTD_REGISTERS,
+                                    encode((uint16_t)0x1A2B, (uint16_t)0xFFFF, (uint16_t)0)));
+
+    snprintf(expect, sizeof(expect), LOG_FORMAT_LID_OPEN, -12.345, -10.0);
+    TEST_ASSERT_EQUAL_STRING(expect, expand(LOG_MSG_LID_OPEN, encode(-12.345f, -10.0)));
+}
+
+void test_expanded_line_has_tag_and_newline(void) {
+    LogArgs a = encode((uint8_t)3, 5);
+    char line[128];
+    size_t n = logExpandLine(LOG_MSG_SENSOR_FAILURE, a.data(), a.size(), line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("[TEMP] SENSOR READ FAILURE #3 of 5\n", line);
+    TEST_ASSERT_EQUAL_UINT32(strlen(line), n);
+
+    LogArgs none;
+    logExpandLine(LOG_MSG_RTD_FAULT_CLEARED, none.data(), none.size(), line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("[MAX31865] Fault cleared successfully, reading temp\n", line);
+}
+
+void test_expansion_is_bounded(void) {
+    LogArgs a = encode("Startup", "Running", 180.25f);
+    char small[16];
+    memset(small, 'x', sizeof(small));
+    size_t n = logExpand(LOG_MSG_STATE_TRANSITION, a.data(), a.size(), small, sizeof(small));
+    TEST_ASSERT_EQUAL_UINT32(15, n);
+    TEST_ASSERT_EQUAL_STRING("Transition: Sta", small);
+
+    char line[12];
+    n = logExpandLine(LOG_MSG_STATE_TRANSITION, a.data(), a.size(), line, sizeof(line));
+    TEST_ASSERT_TRUE(n < sizeof(line));
+    TEST_ASSERT_EQUAL_INT('\n', line[n - 1]);
+}
+
+void test_truncated_and_unknown_records_are_safe(void) {
+    LogArgs a = encode("Startup", "Running", 180.25f);
+    // Cut inside the float: the missing argument shows as '?'
+    TEST_ASSERT_EQUAL_STRING("Transition: Startup -> Running (Temp: ?°F)",
+                             [&]() {
+                                 static char buf[128];
+                                 logExpand(LOG_MSG_STATE_TRANSITION, a.data(), a.size() - 2, buf, sizeof(buf));
+                                 return buf;
+                             }());
+    TEST_ASSERT_EQUAL_STRING("<unknown event 999>", expand(999, a));
+    TEST_ASSERT_NULL(logMessageInfo(LOG_MSG_COUNT));
+}
+
+void test_long_strings_are_truncated(void) {
+    LogArgs a = encode("A_STATE_NAME_FAR_LONGER_THAN_THE_LIMIT_ALLOWS", "Idle", 70.0f);
+    char expect[128];
+    snprintf(expect, sizeof(expect), "Transition: %.*s -> Idle (Temp: 70.0°F)",
+             LOG_EVENT_MAX_STRING, "A_STATE_NAME_FAR_LONGER_THAN_THE_LIMIT_ALLOWS");
+    TEST_ASSERT_EQUAL_STRING(expect, expand(LOG_MSG_STATE_TRANSITION, a));
+}
+
+// ============================================================================
+// TYPED FIELDS
+// ============================================================================
+
+void test_fields_json_is_typed(void) {
+    char json[256];
+    LogArgs a = encode(225.5f, 225.0f, "Running", "ON", "OFF");
+    logFieldsJson(LOG_MSG_STATUS, a.data(), a.size(), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"temperature\":225.5,\"setpoint\":225,\"state\":\"Running\","
+                             "\"relay_auger\":\"ON\",\"relay_fan\":\"OFF\"}", json);
+
+    LogArgs b = encode((uint8_t)0x84);
+    logFieldsJson(LOG_MSG_RTD_FAULT, b.data(), b.size(), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"fault\":132}", json);
+
+    LogArgs c = encode(-3, 5);
+    logFieldsJson(LOG_MSG_REIGNITE_RETRY, c.data(), c.size(), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"attempt\":-3,\"max_attempts\":5}", json);
+
+    LogArgs d = encode("say \"hi\"\n", "x", 1.0f);
+    logFieldsJson(LOG_MSG_STATE_TRANSITION, d.data(), d.size(), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"from\":\"say \\\"hi\\\"\\u000a\",\"to\":\"x\",\"temperature\":1}", json);
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+void test_frame_round_trip(void) {
+    uint8_t buf[256];
+    LogFrameWriter w(buf, sizeof(buf));
+    w.begin(42);
+    LogArgs a = encode("Startup", "Running", 180.25f);
+    LogArgs b = encode((uint8_t)0x84);
+    TEST_ASSERT_TRUE(w.append(LOG_MSG_STATE_TRANSITION, 123456, a.data(), a.size()));
+    TEST_ASSERT_TRUE(w.append(LOG_MSG_RTD_FAULT, 123999, b.data(), b.size()));
+    TEST_ASSERT_TRUE(w.append(LOG_MSG_RTD_FAULT_CLEARED, 124000, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT8(3, w.count());
+
+    LogFrameReader r(w.data(), w.size());
+    TEST_ASSERT_TRUE(r.valid());
+    TEST_ASSERT_EQUAL_UINT32(42, r.sequence());
+    TEST_ASSERT_EQUAL_UINT32(logCatalogHash(), r.catalogHash());
+    TEST_ASSERT_EQUAL_UINT8(3, r.count());
+
+    uint16_t id;
+    uint32_t time;
+    const uint8_t* payload;
+    uint8_t len;
+    TEST_ASSERT_TRUE(r.next(id, time, payload, len));
+    TEST_ASSERT_EQUAL_UINT16(LOG_MSG_STATE_TRANSITION, id);
+    TEST_ASSERT_EQUAL_UINT32(123456, time);
+    TEST_ASSERT_EQUAL_UINT8(a.size(), len);
+    TEST_ASSERT_EQUAL_MEMORY(a.data(), payload, len);
+    TEST_ASSERT_TRUE(r.next(id, time, payload, len));
+    TEST_ASSERT_EQUAL_UINT16(LOG_MSG_RTD_FAULT, id);
+    TEST_ASSERT_TRUE(r.next(id, time, payload, len));
+    TEST_ASSERT_EQUAL_UINT16(LOG_MSG_RTD_FAULT_CLEARED, id);
+    TEST_ASSERT_EQUAL_UINT8(0, len);
+    TEST_ASSERT_FALSE(r.next(id, time, payload, len));
+}
+
+void test_full_frame_refuses_record_unchanged(void) {
+    uint8_t buf[64];
+    LogFrameWriter w(buf, sizeof(buf));
+    LogArgs a = encode("Startup", "Running", 180.25f);    // 7 + 23 bytes after the 12-byte header
+    TEST_ASSERT_TRUE(w.append(LOG_MSG_STATE_TRANSITION, 1, a.data(), a.size()));
+    size_t before = w.size();
+    TEST_ASSERT_FALSE(w.append(LOG_MSG_STATE_TRANSITION, 2, a.data(), a.size()));
+    TEST_ASSERT_EQUAL_UINT32(before, w.size());
+    TEST_ASSERT_EQUAL_UINT8(1, w.count());
+}
+
+void test_reader_rejects_garbage_and_truncation(void) {
+    const uint8_t junk[] = "<134>1 2026-01-30T12:34:56Z ESP32Smoker smoker - - - hello";
+    TEST_ASSERT_FALSE(LogFrameReader(junk, sizeof(junk)).valid());
+
+    uint8_t buf[128];
+    LogFrameWriter w(buf, sizeof(buf));
+    LogArgs a = encode("Startup", "Running", 180.25f);
+    w.append(LOG_MSG_STATE_TRANSITION, 1, a.data(), a.size());
+    LogFrameReader r(w.data(), w.size() - 1);
+    uint16_t id;
+    uint32_t time;
+    const uint8_t* payload;
+    uint8_t len;
+    TEST_ASSERT_TRUE(r.valid());
+    TEST_ASSERT_FALSE(r.next(id, time, payload, len));
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+void test_benchmark_encode_vs_format(void) {
+    typedef std::chrono::steady_clock Clock;
+    const int ROUNDS = 100000;
+    volatile float temp = 225.4f;
+    size_t textBytes = 0;
+    size_t binBytes = 0;
+    volatile uint8_t sink = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        char buf[256];
+        textBytes = (size_t)snprintf(buf, sizeof(buf),
+            "[STATUS] Temp: %.1f°F | Setpoint: %.1f°F | State: %s | Auger: %s | Fan: %s\n",
+            (double)temp, 225.0, "Running", "ON", "ON");
+        sink = sink + (uint8_t)buf[textBytes & 15];
+    }
+    double textNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ROUNDS;
+
+    start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        LogArgs a;
+        a.add((float)temp, 225.0f, "Running", "ON", "ON");
+        binBytes = a.size() + LOG_FRAME_RECORD_BYTES;
+        sink = sink + a.data()[binBytes & 15];
+    }
+    double binNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ROUNDS;
+
+    printf("[BENCH] STATUS line: snprintf %.0f ns, %u bytes | LOG_EVENT encode %.0f ns, %u bytes\n",
+           textNs, (unsigned)textBytes, binNs, (unsigned)binBytes);
+    TEST_ASSERT_TRUE(binBytes < textBytes);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_expansion_matches_printf);
+    RUN_TEST(test_expanded_line_has_tag_and_newline);
+    RUN_TEST(test_expansion_is_bounded);
+    RUN_TEST(test_truncated_and_unknown_records_are_safe);
+    RUN_TEST(test_long_strings_are_truncated);
+    RUN_TEST(test_fields_json_is_typed);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_full_frame_refuses_record_unchanged);
+    RUN_TEST(test_reader_rejects_garbage_and_truncation);
+    RUN_TEST(test_benchmark_encode_vs_format);
+
+    return UNITY_END();
+}
@@ -0,0 +1,353 @@
+// Runtime per-tag, per-sink log levels (LogFilter), call-site rate limits and
+// repeat folding, and the DUAL_LOGF gate
+
+#include <chrono>
+#include <stdio.h>
+
+#include <unity.h>
+#include "logger.h"
+
+void setUp(void) {}
+
+void tearDown(void) {
+  logFilter.setLevel("*", LOG_SINK_ALL, LOG_LEVEL_DEFAULT);
+}
+
+static int sideEffects = 0;
+
+static int touch(void) {
+  return ++sideEffects;
+}
+
+// ============================================================================
+// TAGS
+// ============================================================================
+
+void test_tag_parsed_from_format(void) {
+  uint8_t pid = logFilter.tagOf("[PID] P=%.2f\n");
+  TEST_ASSERT_TRUE(pid != LOG_TAG_DEFAULT);
+  TEST_ASSERT_EQUAL_STRING("PID", logFilter.tagName(pid));
+  TEST_ASSERT_EQUAL_UINT8(pid, logFilter.tagOf("\n[PID] other message"));
+  TEST_ASSERT_EQUAL_UINT8(pid, logFilter.tagIndex("PID", 3));
+
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.tagOf("  - indented detail\n"));
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.tagOf("[unterminated"));
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.tagOf("[A_TAG_TOO_LONG_FOR_THE_RING] x"));
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.tagOf("[%s] %s\n"));
+}
+
+void test_lookup_does_not_register(void) {
+  uint8_t count = logFilter.tagCount();
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.lookupTag("[UNSEEN] posted"));
+  TEST_ASSERT_EQUAL_UINT8(count, logFilter.tagCount());
+
+  uint8_t seen = logFilter.tagOf("[SEEN] registered");
+  TEST_ASSERT_EQUAL_UINT8(seen, logFilter.lookupTag("\n[SEEN] posted"));
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.lookupTag("[%s] x"));
+  TEST_ASSERT_EQUAL_UINT8(LOG_TAG_DEFAULT, logFilter.lookupTag("[A_TAG_TOO_LONG_FOR_THE_RING] x"));
+}
+
+void test_call_site_cache_resolves_once(void) {
+  LogSite site;
+  uint8_t tag = logFilter.site(site, "[SITE] first");
+  TEST_ASSERT_EQUAL_UINT8(tag, site.tag.load());
+  // The cache wins over the format from now on
+  TEST_ASSERT_EQUAL_UINT8(tag, logFilter.site(site, "[OTHER] ignored"));
+}
+
+// ============================================================================
+// LEVELS
+// ============================================================================
+
+void test_default_passes_everything(void) {
+  uint8_t tag = logFilter.tagOf("[FRESH] x");
+  for (uint8_t p = LOG_EMERG; p <= LOG_DEBUG; p++) {
+    TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, logFilter.sinks(tag, p));
+  }
+}
+
+void test_per_sink_levels(void) {
+  // PID=debug to syslog only, info everywhere else
+  TEST_ASSERT_TRUE(logFilter.setLevel("PIDX", LOG_SINK_ALL, LOG_INFO));
+  TEST_ASSERT_TRUE(logFilter.setLevel("PIDX", LOG_SINK_SYSLOG, LOG_DEBUG));
+  uint8_t tag = logFilter.tagOf("[PIDX] x");
+
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG, logFilter.sinks(tag, LOG_DEBUG));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, logFilter.sinks(tag, LOG_INFO));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, logFilter.sinks(tag, LOG_ERR));
+  TEST_ASSERT_TRUE(logFilter.hasOwnLevels(tag));
+
+  TEST_ASSERT_TRUE(logFilter.setLevel("PIDX", LOG_SINK_ALL, LOG_LEVEL_OFF));
+  TEST_ASSERT_EQUAL_HEX8(0, logFilter.sinks(tag, LOG_EMERG));
+}
+
+void test_default_row_applies_to_tags_without_own_levels(void) {
+  uint8_t plain = logFilter.tagOf("[PLAIN] x");
+  TEST_ASSERT_TRUE(logFilter.setLevel("OWN", LOG_SINK_ALL, LOG_DEBUG));
+  uint8_t own = logFilter.tagOf("[OWN] x");
+
+  TEST_ASSERT_TRUE(logFilter.setLevel("*", LOG_SINK_SERIAL | LOG_SINK_TELNET, LOG_WARNING));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG | LOG_SINK_RING, logFilter.sinks(plain, LOG_INFO));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, logFilter.sinks(plain, LOG_WARNING));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG | LOG_SINK_RING,
+                         logFilter.sinks(LOG_TAG_DEFAULT, LOG_INFO));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, logFilter.sinks(own, LOG_INFO));
+
+  // Tags registered later start from the current default
+  uint8_t late = logFilter.tagOf("[LATE] x");
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG | LOG_SINK_RING, logFilter.sinks(late, LOG_INFO));
+
+  // Dropping OWN's levels puts it back on the default
+  TEST_ASSERT_TRUE(logFilter.clearLevel("OWN"));
+  TEST_ASSERT_FALSE(logFilter.hasOwnLevels(own));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG | LOG_SINK_RING, logFilter.sinks(own, LOG_INFO));
+  TEST_ASSERT_FALSE(logFilter.clearLevel("NEVER_SEEN"));
+}
+
+void test_rejects_bad_tag_names(void) {
+  TEST_ASSERT_FALSE(logFilter.setLevel("bad\"tag", LOG_SINK_ALL, LOG_INFO));
+  TEST_ASSERT_FALSE(logFilter.setLevel("", LOG_SINK_ALL, LOG_INFO));
+  TEST_ASSERT_FALSE(logFilter.setLevel("A_TAG_TOO_LONG_FOR_THE_RING", LOG_SINK_ALL, LOG_INFO));
+}
+
+// ============================================================================
+// RATE LIMIT
+// ============================================================================
+
+void test_rate_limit_allows_burst_then_refills(void) {
+  LogRateLimit limit(3, 1000);
+  uint32_t now = 50000;
+  TEST_ASSERT_TRUE(limit.allow(now));
+  TEST_ASSERT_TRUE(limit.allow(now));
+  TEST_ASSERT_TRUE(limit.allow(now));
+  TEST_ASSERT_FALSE(limit.allow(now));
+  TEST_ASSERT_FALSE(limit.allow(now + 999));
+  TEST_ASSERT_TRUE(limit.allow(now + 1000));
+  TEST_ASSERT_FALSE(limit.allow(now + 1001));
+  TEST_ASSERT_EQUAL_UINT32(3, limit.takeSuppressed());
+  TEST_ASSERT_EQUAL_UINT32(0, limit.takeSuppressed());
+
+  // A long pause refills to the burst, never beyond it
+  now += 60000;
+  for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(limit.allow(now));
+  TEST_ASSERT_FALSE(limit.allow(now));
+}
+
+void test_rate_limit_survives_millis_wrap(void) {
+  LogRateLimit limit(1, 1000);
+  uint32_t now = 0xFFFFFF00u;
+  TEST_ASSERT_TRUE(limit.allow(now));
+  TEST_ASSERT_FALSE(limit.allow(now + 500));
+  TEST_ASSERT_TRUE(limit.allow(now + 1000));    // wrapped past zero
+}
+
+void test_rate_limit_bounds_a_storm(void) {
+  LogRateLimit limit(LOG_RATE_BURST, LOG_RATE_INTERVAL_MS);
+  uint32_t passed = 0;
+  // One call per millisecond for a minute
+  for (uint32_t t = 1000; t < 61000; t++) {
+    if (limit.allow(t)) passed++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(LOG_RATE_BURST + 60000 / LOG_RATE_INTERVAL_MS - 1, passed);
+  TEST_ASSERT_EQUAL_UINT32(60000 - passed, limit.takeSuppressed());
+}
+
+// ============================================================================
+// REPEAT FOLDING
+// ============================================================================
+
+static uint32_t hashOf(const char* text) {
+  return logHash(text, strlen(text));
+}
+
+void test_fold_counts_identical_messages(void) {
+  LogSite site;
+  uint32_t folded = 99;
+  TEST_ASSERT_TRUE(site.fold(hashOf("fault 0x04"), 1000, folded));
+  TEST_ASSERT_EQUAL_UINT32(0, folded);
+  TEST_ASSERT_FALSE(site.fold(hashOf("fault 0x04"), 2000, folded));
+  TEST_ASSERT_FALSE(site.fold(hashOf("fault 0x04"), 3000, folded));
+
+  // A different message reports the two it replaced
+  TEST_ASSERT_TRUE(site.fold(hashOf("fault 0x40"), 4000, folded));
+  TEST_ASSERT_EQUAL_UINT32(2, folded);
+  TEST_ASSERT_TRUE(site.fold(hashOf("fault 0x04"), 5000, folded));
+  TEST_ASSERT_EQUAL_UINT32(0, folded);
+}
+
+void test_fold_rewrites_after_window(void) {
+  LogSite site;
+  uint32_t folded;
+  TEST_ASSERT_TRUE(site.fold(hashOf("still in error"), 0 + 1, folded));
+  uint32_t written = 1;
+  // An hour of 5 s reminders
+  for (uint32_t t = 5001; t <= 3600001; t += 5000) {
+    if (site.fold(hashOf("still in error"), t, folded)) {
+      written++;
+      TEST_ASSERT_TRUE(folded > 0);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(3600000 / LOG_REPEAT_WINDOW_MS + 1, written);
+}
+
+void test_quiet_site_reports_after_storm(void) {
+    LogSite site;
+    uint32_t folded, limited;
+    TEST_ASSERT_TRUE(site.fold(hashOf("probe open"), 1000, folded));
+    for (uint32_t t = 1100; t <= 2000; t += 100) site.fold(hashOf("probe open"), t, folded);
+
+    // Storm over, no further message: the drain task reports on its timer,
+    // once a next copy could no longer carry the count
+    TEST_ASSERT_FALSE(site.flush(2000 + LOG_SITE_FLUSH_MS, folded, limited));
+    TEST_ASSERT_FALSE(site.flush(2000 + LOG_REPEAT_WINDOW_MS - 1, folded, limited));
+    TEST_ASSERT_FALSE(site.settled(2000 + LOG_REPEAT_WINDOW_MS));    // still unreported
+    TEST_ASSERT_TRUE(site.flush(2000 + LOG_REPEAT_WINDOW_MS, folded, limited));
+    TEST_ASSERT_EQUAL_UINT32(10, folded);
+    TEST_ASSERT_EQUAL_UINT32(0, limited);
+    TEST_ASSERT_TRUE(site.settled(2000 + LOG_REPEAT_WINDOW_MS));
+    TEST_ASSERT_FALSE(site.flush(2000 + LOG_REPEAT_WINDOW_MS + 5000, folded, limited));
+}
+
+void test_quiet_site_reports_suppressed_promptly(void) {
+    LogSite site;
+    uint32_t folded, limited;
+    uint32_t t = 1000;
+    for (int i = 0; i < LOG_RATE_BURST + 5; i++) {
+        if (site.allow(t)) site.fold(hashOf("probe open"), t, folded);
+    }
+    TEST_ASSERT_FALSE(site.flush(t + LOG_SITE_FLUSH_MS - 1, folded, limited));
+    TEST_ASSERT_TRUE(site.flush(t + LOG_SITE_FLUSH_MS, folded, limited));
+    TEST_ASSERT_EQUAL_UINT32(5, limited);
+    // The folded copies go out in the same report
+    TEST_ASSERT_EQUAL_UINT32(LOG_RATE_BURST - 1, folded);
+}
+
+void test_reminder_cadence_does_not_flood_the_ring(void) {
+    // "Still in ERROR state" every 6 s for an hour, through the drain's path:
+    // writeRecord() for each message, flushSites() on the 5 s wake-up
+    LogSite site;
+    uint32_t folded, limited;
+    uint32_t ringWrites = 0;
+    for (uint32_t t = 1000; t <= 3600000 + 1000; t += 1000) {
+        if (t % 6000 == 0 && site.allow(t) && site.fold(hashOf("Still in ERROR state"), t, folded)) {
+            ringWrites++;
+            if (folded || site.limit.takeSuppressed()) ringWrites++;
+        }
+        if (t % 5000 == 0 && site.flush(t, folded, limited)) ringWrites++;
+    }
+    // The first copy, then a copy and its repeat count each time the window
+    // runs out (at 10, 20, ... 50 min), nothing in between
+    TEST_ASSERT_EQUAL_UINT32(1 + 2 * ((3600000 - 6000) / LOG_REPEAT_WINDOW_MS), ringWrites);
+}
+
+void test_settle_covers_rate_limit_refill(void) {
+  // Once settled a site cannot be suppressed without passing a message first
+  LogSite site;
+  uint32_t folded;
+  uint32_t t = 1000;
+  while (site.allow(t)) site.fold(hashOf("storm"), t, folded);
+  TEST_ASSERT_EQUAL_UINT32(1, site.limit.takeSuppressed());
+  site.takeRepeats();
+  TEST_ASSERT_TRUE(site.settled(t + LOG_SITE_SETTLE_MS));
+  TEST_ASSERT_TRUE(site.allow(t + LOG_SITE_SETTLE_MS));
+  for (int i = 1; i < LOG_RATE_BURST; i++) TEST_ASSERT_TRUE(site.allow(t + LOG_SITE_SETTLE_MS));
+}
+
+// ============================================================================
+// PARSING
+// ============================================================================
+
+void test_parse_levels_and_sinks(void) {
+  int8_t level = 0;
+  TEST_ASSERT_TRUE(LogFilter::parseLevel("debug", level));
+  TEST_ASSERT_EQUAL_INT(LOG_DEBUG, level);
+  TEST_ASSERT_TRUE(LogFilter::parseLevel("warn", level));
+  TEST_ASSERT_EQUAL_INT(LOG_WARNING, level);
+  TEST_ASSERT_TRUE(LogFilter::parseLevel("error", level));
+  TEST_ASSERT_EQUAL_INT(LOG_ERR, level);
+  TEST_ASSERT_TRUE(LogFilter::parseLevel("off", level));
+  TEST_ASSERT_EQUAL_INT(LOG_LEVEL_OFF, level);
+  TEST_ASSERT_TRUE(LogFilter::parseLevel("3", level));
+  TEST_ASSERT_EQUAL_INT(LOG_ERR, level);
+  TEST_ASSERT_FALSE(LogFilter::parseLevel("8", level));
+  TEST_ASSERT_FALSE(LogFilter::parseLevel("loud", level));
+  TEST_ASSERT_EQUAL_STRING("notice", LogFilter::levelName(LOG_NOTICE));
+  TEST_ASSERT_EQUAL_STRING("off", LogFilter::levelName(LOG_LEVEL_OFF));
+
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_ALL, LogFilter::parseSinks("all"));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SYSLOG, LogFilter::parseSinks("syslog"));
+  TEST_ASSERT_EQUAL_HEX8(LOG_SINK_SERIAL | LOG_SINK_RING, LogFilter::parseSinks("serial,ring"));
+  TEST_ASSERT_EQUAL_HEX8(0, LogFilter::parseSinks("serial,printer"));
+  TEST_ASSERT_EQUAL_HEX8(0, LogFilter::parseSinks("sys"));
+}
+
+// ============================================================================
+// DUAL_LOGF GATE
+// ============================================================================
+
+void test_filtered_call_does_not_evaluate_arguments(void) {
+  sideEffects = 0;
+  logFilter.setLevel("GATE", LOG_SINK_ALL, LOG_WARNING);
+
+  for (int i = 0; i < 3; i++) {
+    DUAL_LOGF(LOG_DEBUG, "[GATE] value=%d\n", touch());
+  }
+  TEST_ASSERT_EQUAL_INT(0, sideEffects);
+
+  DUAL_LOGF(LOG_WARNING, "[GATE] value=%d\n", touch());
+  TEST_ASSERT_EQUAL_INT(1, sideEffects);
+
+  logFilter.setLevel("GATE", LOG_SINK_SYSLOG, LOG_DEBUG);
+  DUAL_LOGF(LOG_DEBUG, "[GATE] value=%d\n", touch());
+  TEST_ASSERT_EQUAL_INT(2, sideEffects);
+}
+
+void test_benchmark_filtered_call(void) {
+  typedef std::chrono::steady_clock Clock;
+  const int ROUNDS = 1000000;
+  logFilter.setLevel("BENCH", LOG_SINK_ALL, LOG_INFO);
+  volatile float value = 1.5f;
+
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    DUAL_LOGF(LOG_DEBUG, "[BENCH] value=%.2f\n", value);
+  }
+  double filteredNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ROUNDS;
+
+  start = Clock::now();
+  for (int i = 0; i < ROUNDS / 10; i++) {
+    char buf[LOG_BUFFER_SIZE];
+    snprintf(buf, sizeof(buf), "[BENCH] value=%.2f\n", (double)value);
+  }
+  double formatNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (ROUNDS / 10);
+
+  printf("[BENCH] filtered DUAL_LOGF %.1f ns vs snprintf %.0f ns\n", filteredNs, formatNs);
+  TEST_ASSERT_TRUE(filteredNs < formatNs);
+}
+
+int main(int argc, char **argv) {
+  (void)argc; (void)argv;
+  UNITY_BEGIN();
+
+  RUN_TEST(test_tag_parsed_from_format);
+  RUN_TEST(test_lookup_does_not_register);
+  RUN_TEST(test_call_site_cache_resolves_once);
+  RUN_TEST(test_default_passes_everything);
+  RUN_TEST(test_per_sink_levels);
+  RUN_TEST(test_default_row_applies_to_tags_without_own_levels);
+  RUN_TEST(test_rejects_bad_tag_names);
+  RUN_TEST(test_rate_limit_allows_burst_then_refills);
+  RUN_TEST(test_rate_limit_survives_millis_wrap);
+  RUN_TEST(test_rate_limit_bounds_a_storm);
+  RUN_TEST(test_fold_counts_identical_messages);
+  RUN_TEST(test_fold_rewrites_after_window);
+  RUN_TEST(test_quiet_site_reports_after_storm);
+  RUN_TEST(test_quiet_site_reports_suppressed_promptly);
+  RUN_TEST(test_reminder_cadence_does_not_flood_the_ring);
+  RUN_TEST(test_settle_covers_rate_limit_refill);
+  RUN_TEST(test_parse_levels_and_sinks);
+  RUN_TEST(test_filtered_call_does_not_evaluate_arguments);
+  RUN_TEST(test_benchmark_filtered_call);
+
+  return UNITY_END();
+}
@@ -0,0 +1,198 @@
+// MpscQueue: the lock-free queue behind the asynchronous logger
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "mpsc_queue.h"
+
+struct Record {
+    uint32_t producer;
+    uint32_t seq;
+    char text[24];
+};
+
+typedef MpscQueue<Record, 8> SmallQueue;
+
+static SmallQueue* queue;
+
+void setUp(void) {
+    queue = new SmallQueue();
+}
+
+void tearDown(void) {
+    delete queue;
+}
+
+static bool pushSeq(uint32_t seq) {
+    Record r;
+    memset(&r, 0, sizeof(r));
+    r.seq = seq;
+    return queue->push(r);
+}
+
+// ============================================================================
+// SINGLE THREAD
+// ============================================================================
+
+void test_fifo_order(void) {
+    TEST_ASSERT_NULL(queue->front());
+    for (uint32_t i = 0; i < 5; i++) TEST_ASSERT_TRUE(pushSeq(i));
+    for (uint32_t i = 0; i < 5; i++) {
+        Record* r = queue->front();
+        TEST_ASSERT_NOT_NULL(r);
+        TEST_ASSERT_EQUAL_UINT32(i, r->seq);
+        queue->pop();
+    }
+    TEST_ASSERT_NULL(queue->front());
+    TEST_ASSERT_FALSE(queue->ready());
+}
+
+void test_claim_fills_slot_in_place(void) {
+    uint32_t ticket;
+    TEST_ASSERT_TRUE(queue->claim(ticket));
+    snprintf(queue->item(ticket).text, sizeof(Record::text), "fault %d", 42);
+    TEST_ASSERT_FALSE(queue->ready());    // not visible until committed
+    queue->commit(ticket);
+    TEST_ASSERT_TRUE(queue->ready());
+    TEST_ASSERT_EQUAL_STRING("fault 42", queue->front()->text);
+}
+
+void test_full_queue_drops_and_counts(void) {
+    for (uint32_t i = 0; i < SmallQueue::capacity(); i++) TEST_ASSERT_TRUE(pushSeq(i));
+    TEST_ASSERT_FALSE(pushSeq(100));
+    TEST_ASSERT_FALSE(pushSeq(101));
+    TEST_ASSERT_EQUAL_UINT32(2, queue->dropped());
+
+    // The oldest entries survive; space frees up as the consumer catches up
+    TEST_ASSERT_EQUAL_UINT32(0, queue->front()->seq);
+    TEST_ASSERT_EQUAL_UINT32(SmallQueue::capacity(), queue->highWater());
+    queue->pop();
+    TEST_ASSERT_TRUE(pushSeq(102));
+    TEST_ASSERT_EQUAL_UINT32(2, queue->dropped());
+}
+
+void test_uncommitted_claim_holds_back_consumer_only(void) {
+    uint32_t held;
+    TEST_ASSERT_TRUE(queue->claim(held));
+    TEST_ASSERT_TRUE(pushSeq(1));
+    TEST_ASSERT_TRUE(pushSeq(2));
+
+    // Later producers were not blocked, but order is preserved for the reader
+    TEST_ASSERT_NULL(queue->front());
+    queue->item(held).seq = 0;
+    queue->commit(held);
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, queue->front()->seq);
+        queue->pop();
+    }
+}
+
+void test_wraps_around_many_times(void) {
+    uint32_t next = 0;
+    for (uint32_t round = 0; round < 1000; round++) {
+        for (uint32_t i = 0; i < 5; i++) TEST_ASSERT_TRUE(pushSeq(round * 5 + i));
+        Record* r;
+        while ((r = queue->front()) != nullptr) {
+            TEST_ASSERT_EQUAL_UINT32(next++, r->seq);
+            queue->pop();
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(5000, next);
+    TEST_ASSERT_EQUAL_UINT32(0, queue->dropped());
+}
+
+// ============================================================================
+// CONCURRENCY
+// ============================================================================
+
+void test_concurrent_producers_lose_nothing_silently(void) {
+    typedef MpscQueue<Record, 32> LogSizedQueue;
+    LogSizedQueue q;
+    const uint32_t PRODUCERS = 4;
+    const uint32_t PER_PRODUCER = 100000;
+
+    std::atomic<uint32_t> running(PRODUCERS);
+    std::atomic<uint32_t> refused(0);
+    std::vector<std::thread> producers;
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&q, &running, &refused, p, PER_PRODUCER]() {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                uint32_t ticket;
+                if (!q.claim(ticket)) {
+                    refused.fetch_add(1);
+                    std::this_thread::yield();    // let the consumer catch up
+                    continue;
+                }
+                q.item(ticket).producer = p;
+                q.item(ticket).seq = i;
+                q.commit(ticket);
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    // Single consumer: every producer's entries arrive in its own order
+    uint32_t received = 0;
+    uint32_t lastSeq[PRODUCERS];
+    bool seen[PRODUCERS] = {false};
+    bool ordered = true;
+    for (;;) {
+        Record* r = q.front();
+        if (!r) {
+            if (running.load() == 0 && !q.ready()) break;
+            std::this_thread::yield();
+            continue;
+        }
+        if (seen[r->producer] && r->seq <= lastSeq[r->producer]) ordered = false;
+        seen[r->producer] = true;
+        lastSeq[r->producer] = r->seq;
+        received++;
+        q.pop();
+    }
+    for (auto& t : producers) t.join();
+
+    printf("[BENCH] %u producers x %u: %u received, %u dropped, peak backlog %u/32\n",
+           PRODUCERS, PER_PRODUCER, received, q.dropped(), q.highWater());
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_UINT32(refused.load(), q.dropped());
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * PER_PRODUCER, received + q.dropped());
+}
+
+void test_benchmark_enqueue_cost(void) {
+    typedef std::chrono::steady_clock Clock;
+    const int ROUNDS = 200000;
+    Clock::duration spent(0);
+    for (int i = 0; i < ROUNDS; i++) {
+        Clock::time_point start = Clock::now();
+        uint32_t ticket;
+        if (queue->claim(ticket)) {
+            queue->item(ticket).seq = (uint32_t)i;
+            queue->commit(ticket);
+        }
+        spent += Clock::now() - start;
+        if (queue->front()) queue->pop();
+    }
+    printf("[BENCH] claim+commit: %.1f ns per entry\n",
+           std::chrono::duration<double, std::nano>(spent).count() / ROUNDS);
+    TEST_ASSERT_EQUAL_UINT32(0, queue->dropped());
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_claim_fills_slot_in_place);
+    RUN_TEST(test_full_queue_drops_and_counts);
+    RUN_TEST(test_uncommitted_claim_holds_back_consumer_only);
+    RUN_TEST(test_wraps_around_many_times);
+    RUN_TEST(test_concurrent_producers_lose_nothing_silently);
+    RUN_TEST(test_benchmark_enqueue_cost);
+
+    return UNITY_END();
+}
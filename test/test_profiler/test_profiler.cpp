@@ -0,0 +1,180 @@
+// LoopProfiler: per-stage latency histograms and control tick jitter
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "profiler.h"
+#include "config.h"
+
+// Fake cycle counter behind PROFILE_STAGE on the native build
+static uint32_t cycles = 0;
+uint32_t profilerCycles() { return cycles; }
+
+static LoopProfiler* prof;
+
+void setUp(void) {
+    prof = new LoopProfiler();
+    loopProfiler.reset();
+    loopProfiler.setCpuMHz(240);
+    cycles = 0;
+}
+
+void tearDown(void) {
+    delete prof;
+}
+
+void test_bucket_edges(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, LoopProfiler::bucketFor(0));
+    TEST_ASSERT_EQUAL_UINT8(0, LoopProfiler::bucketFor(15));
+    TEST_ASSERT_EQUAL_UINT8(1, LoopProfiler::bucketFor(16));
+    TEST_ASSERT_EQUAL_UINT8(1, LoopProfiler::bucketFor(31));
+    TEST_ASSERT_EQUAL_UINT8(2, LoopProfiler::bucketFor(32));
+    TEST_ASSERT_EQUAL_UINT8(PROFILER_BUCKETS - 2, LoopProfiler::bucketFor((8u << (PROFILER_BUCKETS - 1)) - 1));
+    TEST_ASSERT_EQUAL_UINT8(PROFILER_BUCKETS - 1, LoopProfiler::bucketFor(8u << (PROFILER_BUCKETS - 1)));
+    TEST_ASSERT_EQUAL_UINT8(PROFILER_BUCKETS - 1, LoopProfiler::bucketFor(0xFFFFFFFF));
+
+    // Every bucket's limit is the first value of the next one
+    for (uint8_t b = 0; b < PROFILER_BUCKETS - 1; b++) {
+        uint32_t limit = LoopProfiler::bucketLimitUs(b);
+        TEST_ASSERT_EQUAL_UINT8(b, LoopProfiler::bucketFor(limit - 1));
+        TEST_ASSERT_EQUAL_UINT8(b + 1, LoopProfiler::bucketFor(limit));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, LoopProfiler::bucketLimitUs(PROFILER_BUCKETS - 1));
+}
+
+void test_stage_statistics(void) {
+    prof->record(LoopProfiler::STAGE_MQTT, 100);
+    prof->record(LoopProfiler::STAGE_MQTT, 300);
+    prof->record(LoopProfiler::STAGE_MQTT, 20);
+
+    const ProfileHistogram& h = prof->stage(LoopProfiler::STAGE_MQTT);
+    TEST_ASSERT_EQUAL_UINT32(3, h.count);
+    TEST_ASSERT_EQUAL_UINT32(420, (uint32_t)h.totalUs);
+    TEST_ASSERT_EQUAL_UINT32(300, h.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(20, h.lastUs);
+    TEST_ASSERT_EQUAL_UINT32(1, h.buckets[LoopProfiler::bucketFor(20)]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.buckets[LoopProfiler::bucketFor(100)]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.buckets[LoopProfiler::bucketFor(300)]);
+
+    // Other stages untouched
+    TEST_ASSERT_EQUAL_UINT32(0, prof->stage(LoopProfiler::STAGE_OTA).count);
+}
+
+void test_percentiles(void) {
+    const ProfileHistogram& h = prof->stage(LoopProfiler::STAGE_LOOP);
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+
+    // 98 fast passes, two slow ones
+    for (int i = 0; i < 98; i++) prof->record(LoopProfiler::STAGE_LOOP, 40);
+    prof->record(LoopProfiler::STAGE_LOOP, 5000);
+    prof->record(LoopProfiler::STAGE_LOOP, 700000);
+
+    TEST_ASSERT_EQUAL_UINT32(64, h.percentile(50));         // [32, 64) bucket
+    TEST_ASSERT_EQUAL_UINT32(8192, h.percentile(99));       // [4096, 8192)
+    TEST_ASSERT_EQUAL_UINT32(700000, h.percentile(100));    // open-ended: the max
+}
+
+void test_tick_jitter(void) {
+    prof->recordTick(120, 900);
+    prof->recordTick(-40, 950);
+    prof->recordTick(3000, 1100);
+
+    TEST_ASSERT_EQUAL_INT32(-40, prof->minJitterUs());
+    TEST_ASSERT_EQUAL_INT32(3000, prof->maxJitterUs());
+    TEST_ASSERT_EQUAL_UINT32(3, prof->tickJitter().count);
+    TEST_ASSERT_EQUAL_UINT32(1, prof->tickJitter().buckets[LoopProfiler::bucketFor(40)]);
+    TEST_ASSERT_EQUAL_UINT32(3, prof->stage(LoopProfiler::STAGE_TICK).count);
+    TEST_ASSERT_EQUAL_UINT32(1100, prof->stage(LoopProfiler::STAGE_TICK).maxUs);
+
+    // Late ticks only: the minimum is the smallest seen, not zero
+    prof->reset();
+    prof->recordTick(500, 900);
+    prof->recordTick(800, 900);
+    TEST_ASSERT_EQUAL_INT32(500, prof->minJitterUs());
+}
+
+void test_scope_uses_cycle_counter(void) {
+    {
+        PROFILE_STAGE(LoopProfiler::STAGE_DISPLAY);
+        cycles += 240 * 150;    // 150 us at 240 MHz
+    }
+    PROFILE_START(pass);
+    cycles += 240 * 2000;
+    PROFILE_STOP(pass, LoopProfiler::STAGE_LOOP);
+
+    TEST_ASSERT_EQUAL_UINT32(150, loopProfiler.stage(LoopProfiler::STAGE_DISPLAY).lastUs);
+    TEST_ASSERT_EQUAL_UINT32(2000, loopProfiler.stage(LoopProfiler::STAGE_LOOP).lastUs);
+
+    // Counter wrapping between start and stop
+    cycles = 0xFFFFFFFF - 240 * 10;
+    {
+        PROFILE_STAGE(LoopProfiler::STAGE_ENCODER);
+        cycles += 240 * 30;
+    }
+    TEST_ASSERT_EQUAL_UINT32(30, loopProfiler.stage(LoopProfiler::STAGE_ENCODER).lastUs);
+}
+
+void test_json_report(void) {
+    prof->record(LoopProfiler::STAGE_MQTT, 100);
+    prof->record(LoopProfiler::STAGE_MQTT, 300);
+    prof->recordTick(-250, 1200);
+
+    static char buf[PROFILER_JSON_BYTES];
+    size_t len = prof->toJson(buf, sizeof(buf), 61000);
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)strlen(buf), (uint32_t)len);
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "{\"uptime\":61000,\"bucket_us\":[16,32,64,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, ",null],\"stages\":{\"ota\":{\"count\":0,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"mqtt\":{\"count\":2,\"mean_us\":200,\"max_us\":300,"
+                                     "\"last_us\":300,\"p50_us\":128,\"p99_us\":300,"
+                                     "\"hist\":[0,0,0,1,0,1,0,"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"tick\":{\"interval_ms\":2000,\"count\":1,"
+                                     "\"jitter_min_us\":-250,\"jitter_max_us\":-250,"));
+    TEST_ASSERT_TRUE(buf[len - 1] == '}');
+
+    // Every stage is listed
+    for (uint8_t s = 0; s < LoopProfiler::STAGE_COUNT; s++) {
+        char key[24];
+        snprintf(key, sizeof(key), "\"%s\":{", LoopProfiler::stageName((LoopProfiler::Stage)s));
+        TEST_ASSERT_NOT_NULL(strstr(buf, key));
+    }
+}
+
+void test_json_worst_case_fits(void) {
+    // Every counter at its widest
+    for (uint8_t s = 0; s < LoopProfiler::STAGE_COUNT; s++) {
+        ProfileHistogram& h = const_cast<ProfileHistogram&>(prof->stage((LoopProfiler::Stage)s));
+        h.count = 0xFFFFFFFF;
+        h.totalUs = 0xFFFFFFFFull * 0xFFFFFFFFull;
+        h.maxUs = h.lastUs = 0xFFFFFFFF;
+        for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) h.buckets[b] = 0xFFFFFFFF;
+    }
+    prof->recordTick(-2000000000, 1);
+    prof->recordTick(2000000000, 1);
+
+    static char buf[PROFILER_JSON_BYTES];
+    size_t len = prof->toJson(buf, sizeof(buf), 0xFFFFFFFF);
+    printf("[BENCH] worst-case /api/perf body: %u of %u bytes\n", (unsigned)len,
+           (unsigned)sizeof(buf));
+    TEST_ASSERT_TRUE(len > 0);
+
+    // Too small a buffer is refused, not cut
+    TEST_ASSERT_EQUAL_UINT32(0, prof->toJson(buf, len, 0xFFFFFFFF));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bucket_edges);
+    RUN_TEST(test_stage_statistics);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_tick_jitter);
+    RUN_TEST(test_scope_uses_cycle_counter);
+    RUN_TEST(test_json_report);
+    RUN_TEST(test_json_worst_case_fits);
+
+    return UNITY_END();
+}
@@ -102,6 +102,19 @@ void test_safe_auger_rejected_after_fan_turned_off(void) {
     TEST_ASSERT_EQUAL(RELAY_OFF, relay->getAuger());
 }
 
+void test_quiet_safe_auger_keeps_the_interlock(void) {
+    // Timer-path variant: same interlock, reports whether it switched
+    TEST_ASSERT_FALSE(relay->setSafeAugerQuiet(RELAY_ON));
+    TEST_ASSERT_EQUAL(HIGH, _mock_gpio[PIN_RELAY_AUGER].value);
+    relay->setFan(RELAY_ON);
+    TEST_ASSERT_TRUE(relay->setSafeAugerQuiet(RELAY_ON));
+    TEST_ASSERT_EQUAL(RELAY_ON, relay->getAuger());
+    TEST_ASSERT_EQUAL(LOW, _mock_gpio[PIN_RELAY_AUGER].value);
+    relay->setFan(RELAY_OFF);
+    TEST_ASSERT_TRUE(relay->setSafeAugerQuiet(RELAY_OFF));
+    TEST_ASSERT_EQUAL(RELAY_OFF, relay->getAuger());
+}
+
 // ============================================================================
 // EMERGENCY STOP
 // ============================================================================
@@ -174,6 +187,7 @@ int main(int argc, char **argv) {
     RUN_TEST(test_safe_auger_accepted_with_fan);
     RUN_TEST(test_safe_auger_off_always_allowed);
     RUN_TEST(test_safe_auger_rejected_after_fan_turned_off);
+    RUN_TEST(test_quiet_safe_auger_keeps_the_interlock);
     RUN_TEST(test_emergency_stop_turns_all_off);
     RUN_TEST(test_all_off_turns_all_off);
     RUN_TEST(test_get_states_reports_correctly);
@@ -0,0 +1,237 @@
+// Scheduler: deadline ordering, priorities, fixed-rate periods and overruns
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "scheduler.h"
+
+static uint32_t fakeUs;
+static uint32_t fakeClock() { return fakeUs; }
+
+// Jobs append their tag to the run log and take `execUs` of fake time
+static char runLog[64];
+static uint32_t execUs[4];
+
+static void logRun(char tag, uint8_t slot) {
+    size_t n = strlen(runLog);
+    if (n + 1 < sizeof(runLog)) {
+        runLog[n] = tag;
+        runLog[n + 1] = '\0';
+    }
+    fakeUs += execUs[slot];
+}
+
+static void jobA() { logRun('A', 0); }
+static void jobB() { logRun('B', 1); }
+static void jobC() { logRun('C', 2); }
+static void jobD() { logRun('D', 3); }
+
+static Scheduler* sched;
+
+void setUp(void) {
+    fakeUs = 1000000;
+    runLog[0] = '\0';
+    memset(execUs, 0, sizeof(execUs));
+    sched = new Scheduler(fakeClock);
+}
+
+void tearDown(void) {
+    delete sched;
+}
+
+void test_runs_only_due_jobs(void) {
+    sched->addJob("a", jobA, 100, 0, 10);
+    sched->addJob("b", jobB, 100, 0, 30);
+
+    TEST_ASSERT_EQUAL_UINT32(10000, sched->runDue());
+    TEST_ASSERT_EQUAL_STRING("", runLog);
+    TEST_ASSERT_EQUAL_UINT32(1, sched->getStats().idlePasses);
+
+    fakeUs += 10000;
+    TEST_ASSERT_EQUAL_UINT32(20000, sched->runDue());
+    TEST_ASSERT_EQUAL_STRING("A", runLog);
+
+    fakeUs += 20000;
+    TEST_ASSERT_EQUAL_UINT32(80000, sched->runDue());
+    TEST_ASSERT_EQUAL_STRING("AB", runLog);
+}
+
+void test_priority_orders_jobs_due_together(void) {
+    // Added least urgent first, all due now
+    sched->addJob("d", jobD, 50, 3);
+    sched->addJob("c", jobC, 50, 2);
+    sched->addJob("b", jobB, 50, 1);
+    sched->addJob("a", jobA, 50, 0);
+
+    sched->runDue();
+    TEST_ASSERT_EQUAL_STRING("ABCD", runLog);
+
+    // Different deadlines, both overdue: priority still wins
+    runLog[0] = '\0';
+    fakeUs += 200000;
+    sched->runDue();
+    TEST_ASSERT_EQUAL_STRING("ABCD", runLog);
+}
+
+void test_equal_priority_runs_earliest_deadline_first(void) {
+    sched->addJob("b", jobB, 100, 1, 20);
+    sched->addJob("a", jobA, 100, 1, 10);
+    fakeUs += 25000;
+    sched->runDue();
+    TEST_ASSERT_EQUAL_STRING("AB", runLog);
+}
+
+void test_late_start_keeps_the_period_grid(void) {
+    uint32_t start = fakeUs;
+    sched->addJob("a", jobA, 100, 0);
+
+    // Runs 30 ms late; the next deadline is still start + 100 ms
+    fakeUs += 30000;
+    TEST_ASSERT_EQUAL_UINT32(70000, sched->runDue());
+    const Scheduler::JobStats& js = sched->jobStats(0);
+    TEST_ASSERT_EQUAL_UINT32(30000, js.lastLateUs);
+    TEST_ASSERT_EQUAL_UINT32(0, js.overruns);
+
+    fakeUs = start + 100000;
+    TEST_ASSERT_EQUAL_UINT32(100000, sched->runDue());
+    TEST_ASSERT_EQUAL_UINT32(0, js.lastLateUs);
+    TEST_ASSERT_EQUAL_UINT32(2, js.runs);
+}
+
+void test_overrun_skips_missed_periods(void) {
+    uint32_t start = fakeUs;
+    sched->addJob("a", jobA, 20, 0);
+    sched->addJob("b", jobB, 1000, 1);
+
+    // b blocks for 75 ms: a's 20 ms run starts 55 ms late, the 40 and 60 ms
+    // runs are skipped and it is back on the grid at 80
+    execUs[1] = 75000;
+    TEST_ASSERT_EQUAL_UINT32(0, sched->runDue());
+    TEST_ASSERT_EQUAL_STRING("AB", runLog);
+    TEST_ASSERT_EQUAL_UINT32(0, sched->jobStats(0).overruns);
+
+    sched->runDue();
+    TEST_ASSERT_EQUAL_STRING("ABA", runLog);
+    TEST_ASSERT_EQUAL_UINT32(55000, sched->jobStats(0).lastLateUs);
+    TEST_ASSERT_EQUAL_UINT32(2, sched->jobStats(0).overruns);
+    TEST_ASSERT_EQUAL_UINT32(2, sched->getStats().overruns);
+    TEST_ASSERT_EQUAL_UINT32(start + 80000 - fakeUs, sched->untilNextUs());
+    TEST_ASSERT_EQUAL_UINT32(75000, sched->jobStats(1).maxExecUs);
+}
+
+void test_job_longer_than_its_period_counts_overruns(void) {
+    sched->addJob("a", jobA, 10, 0);
+    execUs[0] = 25000;
+    for (int i = 0; i < 4; i++) {
+        fakeUs += sched->runDue();
+    }
+    // Each run takes 2.5 periods: two missed per run
+    TEST_ASSERT_EQUAL_UINT32(4, sched->jobStats(0).runs);
+    TEST_ASSERT_EQUAL_UINT32(8, sched->jobStats(0).overruns);
+    TEST_ASSERT_EQUAL_UINT32(100000, (uint32_t)sched->getStats().busyUs);
+}
+
+void test_one_shot_runs_once(void) {
+    sched->addJob("once", jobA, 0, 0, 50);
+    sched->addJob("tick", jobB, 1000, 0, 1000);
+
+    fakeUs += 50000;
+    sched->runDue();
+    for (int i = 0; i < 5; i++) {
+        fakeUs += 1000000;
+        sched->runDue();
+    }
+    TEST_ASSERT_EQUAL_STRING("ABBBBB", runLog);
+}
+
+void test_empty_scheduler_sleeps_the_maximum(void) {
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)SCHED_MAX_SLEEP_MS * 1000, sched->runDue());
+}
+
+void test_clock_wraparound(void) {
+    fakeUs = 0xFFFFFFFFu - 5000;    // 5 ms before the clock wraps
+    delete sched;
+    sched = new Scheduler(fakeClock);
+    sched->addJob("a", jobA, 10, 0, 10);
+    sched->addJob("b", jobB, 10, 1, 2);
+
+    TEST_ASSERT_EQUAL_UINT32(2000, sched->runDue());
+    fakeUs += 2000;
+    TEST_ASSERT_EQUAL_UINT32(8000, sched->runDue());    // a is due past the wrap
+    TEST_ASSERT_EQUAL_STRING("B", runLog);
+
+    fakeUs += 8000;
+    sched->runDue();
+    TEST_ASSERT_EQUAL_STRING("A", runLog + 1);
+    TEST_ASSERT_EQUAL_UINT32(0, sched->jobStats(0).lastLateUs);
+    TEST_ASSERT_EQUAL_UINT32(0, sched->getStats().overruns);
+}
+
+void test_job_table_full(void) {
+    for (uint8_t i = 0; i < SCHED_MAX_JOBS; i++) {
+        TEST_ASSERT_EQUAL_UINT8(i, sched->addJob("a", jobA, 100, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT8(Scheduler::INVALID_JOB, sched->addJob("x", jobA, 100, 0));
+    TEST_ASSERT_EQUAL_UINT8(SCHED_MAX_JOBS, sched->jobCount());
+}
+
+void test_reset_stats_keeps_jobs(void) {
+    sched->addJob("a", jobA, 10, 0);
+    execUs[0] = 30000;
+    sched->runDue();
+    sched->runDue();
+    TEST_ASSERT_TRUE(sched->jobStats(0).overruns > 0);
+
+    sched->resetStats();
+    TEST_ASSERT_EQUAL_UINT32(0, sched->jobStats(0).runs);
+    TEST_ASSERT_EQUAL_UINT32(0, sched->jobStats(0).overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, sched->getStats().passes);
+    TEST_ASSERT_EQUAL_STRING("a", sched->jobStats(0).name);
+    TEST_ASSERT_EQUAL_UINT32(10000, sched->jobStats(0).periodUs);
+}
+
+// The firmware's job mix over 60 s, against the old loop() that woke every
+// 10 ms and checked every timer on each pass
+void test_bench_wakeups(void) {
+    static const uint32_t periods[] = {20, 100, 100, 5000, 60000, 1000, 50, 10000, 1000, 1000, 10000};
+    const uint8_t count = sizeof(periods) / sizeof(periods[0]);
+    for (uint8_t i = 0; i < count; i++) sched->addJob("j", jobA, periods[i], 0);
+
+    uint32_t end = fakeUs + 60000000u;
+    uint32_t wakeups = 0;
+    while ((int32_t)(fakeUs - end) < 0) {
+        uint32_t wait = sched->runDue();
+        wakeups++;
+        uint32_t waitMs = (wait + 999) / 1000;
+        fakeUs += (waitMs ? waitMs : 1) * 1000;
+    }
+    Scheduler::Stats st = sched->getStats();
+    uint32_t polledWakeups = 60000 / 10;
+    printf("BENCH scheduler: %u wakeups, %u idle, %u job runs | polling loop: %u wakeups, "
+           "%u timer checks\n",
+           (unsigned)wakeups, (unsigned)st.idlePasses, (unsigned)st.runs,
+           (unsigned)polledWakeups, (unsigned)(polledWakeups * count));
+    TEST_ASSERT_EQUAL_UINT32(0, st.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, st.idlePasses);
+    TEST_ASSERT_TRUE(wakeups < polledWakeups);
+    TEST_ASSERT_TRUE(st.runs * 10 < polledWakeups * count);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_runs_only_due_jobs);
+    RUN_TEST(test_priority_orders_jobs_due_together);
+    RUN_TEST(test_equal_priority_runs_earliest_deadline_first);
+    RUN_TEST(test_late_start_keeps_the_period_grid);
+    RUN_TEST(test_overrun_skips_missed_periods);
+    RUN_TEST(test_job_longer_than_its_period_counts_overruns);
+    RUN_TEST(test_one_shot_runs_once);
+    RUN_TEST(test_empty_scheduler_sleeps_the_maximum);
+    RUN_TEST(test_clock_wraparound);
+    RUN_TEST(test_job_table_full);
+    RUN_TEST(test_reset_stats_keeps_jobs);
+    RUN_TEST(test_bench_wakeups);
+    return UNITY_END();
+}
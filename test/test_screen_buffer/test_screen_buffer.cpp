@@ -0,0 +1,416 @@
+// ScreenBuffer: TUI frames drawn into a grid, sent as the difference
+
+#include <cstdlib>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include <unity.h>
+#include "screen_buffer.h"
+#include "config.h"
+
+// ============================================================================
+// ALLOCATION COUNTER
+// ============================================================================
+
+static size_t allocations = 0;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"    // malloc/free pairing is intended
+#endif
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ============================================================================
+// TERMINAL
+// ============================================================================
+
+// Just enough of a VT100 to replay what present() sends: cursor position,
+// SGR reset/bold/colors, clear screen, hide cursor and UTF-8 text
+struct Terminal {
+    uint16_t chars[TUI_ROWS][TUI_COLS];
+    uint8_t styles[TUI_ROWS][TUI_COLS];
+    int row, col;
+    uint8_t style;
+    std::string pending;    // bytes of an incomplete escape or glyph
+    size_t chunks;
+    size_t maxChunk;
+    bool terminated;        // every chunk was null-terminated
+
+    void reset() {
+        for (int r = 0; r < TUI_ROWS; r++)
+            for (int c = 0; c < TUI_COLS; c++) { chars[r][c] = '#'; styles[r][c] = 0xEE; }
+        row = col = 0;
+        style = 0;
+        pending.clear();
+        chunks = maxChunk = 0;
+        terminated = true;
+    }
+
+    void put(uint16_t g) {
+        TEST_ASSERT_TRUE_MESSAGE(row < TUI_ROWS && col < TUI_COLS, "glyph written off screen");
+        chars[row][col] = g;
+        styles[row][col] = style;
+        col++;
+    }
+
+    void csi(const std::string& params, char final) {
+        int v[8] = {0};
+        int count = 0;
+        const char* p = params.c_str();
+        if (*p == '?') { p++; }
+        while (*p && count < 8) {
+            v[count++] = atoi(p);
+            while (*p && *p != ';') p++;
+            if (*p == ';') p++;
+        }
+        if (final == 'H') {
+            row = (count > 0 ? v[0] : 1) - 1;
+            col = (count > 1 ? v[1] : 1) - 1;
+        } else if (final == 'J') {
+            for (int r = 0; r < TUI_ROWS; r++)
+                for (int c = 0; c < TUI_COLS; c++) { chars[r][c] = ' '; styles[r][c] = 0; }
+        } else if (final == 'm') {
+            if (count == 0) style = 0;
+            for (int i = 0; i < count; i++) {
+                if (v[i] == 0) style = 0;
+                else if (v[i] == 1) style |= ScreenBuffer::BOLD;
+                else if (v[i] >= 30 && v[i] <= 37) style = (style & ~ScreenBuffer::FG_MASK) | (ScreenBuffer::FG_BLACK + v[i] - 30);
+                else if (v[i] >= 90 && v[i] <= 97) style = (style & ~ScreenBuffer::FG_MASK) | (ScreenBuffer::FG_BRIGHT_BLACK + v[i] - 90);
+            }
+        }
+    }
+
+    void feed(const char* data, size_t len) {
+        pending.append(data, len);
+        size_t i = 0;
+        while (i < pending.size()) {
+            unsigned char c = pending[i];
+            if (c == 0x1B) {
+                size_t j = i + 2;
+                while (j < pending.size() && !((pending[j] >= 'A' && pending[j] <= 'Z') ||
+                                               (pending[j] >= 'a' && pending[j] <= 'z'))) j++;
+                if (j >= pending.size()) break;
+                csi(pending.substr(i + 2, j - i - 2), pending[j]);
+                i = j + 1;
+            } else if (c < 0x80) {
+                put(c);
+                i++;
+            } else {
+                size_t n = (c & 0xE0) == 0xC0 ? 2 : 3;
+                if (i + n > pending.size()) break;
+                uint16_t g = n == 2 ? ((c & 0x1F) << 6) | (pending[i + 1] & 0x3F)
+                                    : ((c & 0x0F) << 12) | ((pending[i + 1] & 0x3F) << 6) | (pending[i + 2] & 0x3F);
+                put(g);
+                i += n;
+            }
+        }
+        pending.erase(0, i);
+    }
+
+    // Shows exactly what the buffer holds
+    bool matches(const ScreenBuffer& screen) const {
+        for (int r = 0; r < TUI_ROWS; r++)
+            for (int c = 0; c < TUI_COLS; c++)
+                if (chars[r][c] != screen.glyphAt(r, c) || styles[r][c] != screen.styleAt(r, c)) {
+                    printf("mismatch at %d,%d: %04X/%02X vs %04X/%02X\n", r, c, chars[r][c],
+                           styles[r][c], screen.glyphAt(r, c), screen.styleAt(r, c));
+                    return false;
+                }
+        return true;
+    }
+};
+
+static Terminal term;
+static ScreenBuffer* screen;
+
+static bool termSink(void* ctx, const char* data, size_t len) {
+    Terminal* t = static_cast<Terminal*>(ctx);
+    t->chunks++;
+    if (len > t->maxChunk) t->maxChunk = len;
+    if (data[len] != '\0') t->terminated = false;
+    t->feed(data, len);
+    return true;
+}
+
+// A connection that loses a chunk: the terminal only sees half of it
+static bool lossySink(void* ctx, const char* data, size_t len) {
+    static_cast<Terminal*>(ctx)->feed(data, len / 2);
+    return false;
+}
+
+static size_t present() {
+    return screen->present(termSink, &term);
+}
+
+// A frame shaped like the TUI: boxes of box-drawing glyphs with values inside
+static void drawFrame(float temp, int errors) {
+    screen->clear();
+    for (int box = 0; box < 4; box++) {
+        uint8_t top = box * 4;
+        screen->moveTo(top, 0);
+        screen->print(ScreenBuffer::BOLD | ScreenBuffer::FG_BRIGHT_WHITE, "┌─ PANEL ");
+        screen->setStyle(ScreenBuffer::STYLE_DEFAULT);
+        screen->repeat("─", TUI_COLS - 1 - screen->col());
+        screen->print("┐");
+        screen->moveTo(top + 1, 0);
+        screen->print("│ ");
+        screen->print(ScreenBuffer::FG_YELLOW, "Current Temp: ");
+        screen->setStyle(ScreenBuffer::FG_BRIGHT_YELLOW);
+        char value[16];
+        snprintf(value, sizeof(value), "%.1f°F", temp + box);
+        screen->printPadded(value, 12);
+        screen->print(ScreenBuffer::FG_BRIGHT_RED, "Errors: ");
+        screen->printf("%d", errors);
+        screen->moveTo(top + 1, TUI_COLS - 1);
+        screen->print(ScreenBuffer::STYLE_DEFAULT, "│");
+        screen->moveTo(top + 2, 0);
+        screen->print("└");
+        screen->repeat("─", TUI_COLS - 2);
+        screen->print("┘");
+    }
+}
+
+void setUp(void) {
+    term.reset();
+    screen = new ScreenBuffer();
+}
+
+void tearDown(void) {
+    delete screen;
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+
+void test_utf8_glyphs_take_one_cell(void) {
+    screen->print("┌─°Ω");
+    TEST_ASSERT_EQUAL_HEX16(0x250C, screen->glyphAt(0, 0));
+    TEST_ASSERT_EQUAL_HEX16(0x2500, screen->glyphAt(0, 1));
+    TEST_ASSERT_EQUAL_HEX16(0x00B0, screen->glyphAt(0, 2));
+    TEST_ASSERT_EQUAL_HEX16(0x03A9, screen->glyphAt(0, 3));
+    TEST_ASSERT_EQUAL_UINT8(4, screen->col());
+
+    // Outside the BMP, and control characters
+    screen->print("\xF0\x9F\x94\xA5\t!");
+    TEST_ASSERT_EQUAL_HEX16('?', screen->glyphAt(0, 4));
+    TEST_ASSERT_EQUAL_HEX16(' ', screen->glyphAt(0, 5));
+    TEST_ASSERT_EQUAL_HEX16('!', screen->glyphAt(0, 6));
+}
+
+void test_print_clips_at_right_edge(void) {
+    screen->moveTo(2, TUI_COLS - 3);
+    screen->print("abcdef");
+    TEST_ASSERT_EQUAL_HEX16('c', screen->glyphAt(2, TUI_COLS - 1));
+    TEST_ASSERT_EQUAL_HEX16(' ', screen->glyphAt(3, 0));
+    TEST_ASSERT_EQUAL_UINT8(TUI_COLS, screen->col());
+}
+
+void test_padded_text(void) {
+    screen->printPadded("12.5°F", 8);
+    screen->print("|");
+    screen->printPadded("-3.0°F", 8, true);
+    screen->print("|");
+    screen->printPadded("truncated text", 5);
+    screen->print("|");
+
+    char row[40];
+    for (int c = 0; c < 26; c++) {
+        uint16_t g = screen->glyphAt(0, c);
+        row[c] = g == 0xB0 ? 'o' : (char)g;
+    }
+    row[26] = '\0';
+    TEST_ASSERT_EQUAL_STRING("12.5oF  |  -3.0oF|trunc|  ", row);
+}
+
+void test_styles_recorded_per_cell(void) {
+    screen->print(ScreenBuffer::BOLD | ScreenBuffer::FG_CYAN, "ab");
+    screen->print(ScreenBuffer::FG_BRIGHT_RED, "c");
+    TEST_ASSERT_EQUAL_HEX8(ScreenBuffer::BOLD | ScreenBuffer::FG_CYAN, screen->styleAt(0, 1));
+    TEST_ASSERT_EQUAL_HEX8(ScreenBuffer::FG_BRIGHT_RED, screen->styleAt(0, 2));
+    TEST_ASSERT_EQUAL_HEX8(ScreenBuffer::STYLE_DEFAULT, screen->styleAt(0, 3));
+
+    screen->clear();
+    TEST_ASSERT_EQUAL_HEX8(ScreenBuffer::STYLE_DEFAULT, screen->styleAt(0, 1));
+    TEST_ASSERT_EQUAL_HEX16(' ', screen->glyphAt(0, 1));
+}
+
+// ============================================================================
+// PRESENTING
+// ============================================================================
+
+void test_first_frame_repaints_everything(void) {
+    drawFrame(225.0f, 0);
+    size_t bytes = present();
+
+    TEST_ASSERT_TRUE(bytes > 0);
+    TEST_ASSERT_EQUAL_UINT32(TUI_ROWS * TUI_COLS, screen->lastChangedCells());
+    TEST_ASSERT_TRUE(term.matches(*screen));
+    TEST_ASSERT_TRUE(term.terminated);
+    TEST_ASSERT_TRUE(term.maxChunk <= TUI_CHUNK_BYTES);
+    TEST_ASSERT_TRUE(term.chunks > 1);
+}
+
+void test_unchanged_frame_sends_nothing(void) {
+    drawFrame(225.0f, 0);
+    present();
+
+    size_t chunks = term.chunks;
+    drawFrame(225.0f, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, present());
+    TEST_ASSERT_EQUAL_UINT32(0, screen->lastChangedCells());
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)chunks, (uint32_t)term.chunks);
+}
+
+void test_changed_value_sends_tens_of_bytes(void) {
+    drawFrame(225.0f, 0);
+    present();
+
+    drawFrame(225.5f, 0);    // one digit in each of the four panels
+    size_t bytes = present();
+    printf("[BENCH] one digit in 4 panels: %u bytes, %u cells\n", (unsigned)bytes,
+           (unsigned)screen->lastChangedCells());
+    TEST_ASSERT_EQUAL_UINT32(4, screen->lastChangedCells());
+    TEST_ASSERT_TRUE(bytes <= 4 * 20);
+    TEST_ASSERT_TRUE(term.matches(*screen));
+}
+
+void test_style_change_alone_is_sent(void) {
+    screen->print(ScreenBuffer::FG_GREEN, "ON ");
+    present();
+
+    screen->clear();
+    screen->print(ScreenBuffer::FG_BRIGHT_BLACK, "ON ");
+    size_t bytes = present();
+    TEST_ASSERT_EQUAL_UINT32(3, screen->lastChangedCells());
+    TEST_ASSERT_TRUE(bytes > 0);
+    TEST_ASSERT_TRUE(term.matches(*screen));
+}
+
+void test_nearby_changes_share_one_cursor_move(void) {
+    screen->print("0000000000");
+    present();
+
+    struct Capture {
+        char data[256];
+        size_t len;
+    } cap = {{0}, 0};
+    screen->clear();
+    screen->print("1001000000");
+    screen->present([](void* ctx, const char* data, size_t len) {
+        Capture* c = static_cast<Capture*>(ctx);
+        memcpy(c->data + c->len, data, len);
+        c->len += len;
+        c->data[c->len] = '\0';
+        return true;
+    }, &cap);
+    // Gap of two unchanged cells is resent instead of a second cursor move
+    TEST_ASSERT_EQUAL_STRING("\033[1;1H1001", cap.data);
+
+    cap.len = 0;
+    screen->clear();
+    screen->print("0001000001");
+    screen->present([](void* ctx, const char* data, size_t len) {
+        Capture* c = static_cast<Capture*>(ctx);
+        memcpy(c->data + c->len, data, len);
+        c->len += len;
+        c->data[c->len] = '\0';
+        return true;
+    }, &cap);
+    TEST_ASSERT_EQUAL_STRING("\033[1;1H0\033[1;10H1", cap.data);
+}
+
+void test_invalidate_repaints_for_new_client(void) {
+    drawFrame(225.0f, 3);
+    present();
+
+    // A new client sees a blank terminal
+    term.reset();
+    screen->invalidate();
+    drawFrame(225.0f, 3);
+    present();
+    TEST_ASSERT_EQUAL_UINT32(TUI_ROWS * TUI_COLS, screen->lastChangedCells());
+    TEST_ASSERT_TRUE(term.matches(*screen));
+}
+
+void test_failed_write_repaints_next_frame(void) {
+    drawFrame(225.0f, 3);
+    present();
+
+    drawFrame(231.5f, 4);
+    TEST_ASSERT_EQUAL_UINT32(0, screen->present(lossySink, &term));
+    TEST_ASSERT_FALSE(term.matches(*screen));
+
+    // Same frame again: the buffer must not trust what it recorded as shown
+    drawFrame(231.5f, 4);
+    present();
+    TEST_ASSERT_EQUAL_UINT32(TUI_ROWS * TUI_COLS, screen->lastChangedCells());
+    TEST_ASSERT_TRUE(term.matches(*screen));
+
+    // Back in step: deltas again
+    drawFrame(231.5f, 4);
+    TEST_ASSERT_EQUAL_UINT32(0, present());
+}
+
+void test_frames_replay_to_same_screen(void) {
+    for (int i = 0; i < 50; i++) {
+        drawFrame(200.0f + (float)(i * 7 % 13) * 1.3f, i % 3 ? 0 : i);
+        present();
+        TEST_ASSERT_TRUE(term.matches(*screen));
+    }
+}
+
+void test_bench_no_allocations(void) {
+    drawFrame(225.0f, 0);
+    size_t full = present();
+
+    const int FRAMES = 1000;
+    size_t before = allocations;
+    size_t bytes = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        drawFrame(225.0f + (float)(i % 10) * 0.1f, 0);
+        bytes += present();
+    }
+    printf("[BENCH] full frame %u bytes; %d updates: %u bytes/frame, %u allocations\n",
+           (unsigned)full, FRAMES, (unsigned)(bytes / FRAMES), (unsigned)(allocations - before));
+    TEST_ASSERT_EQUAL_UINT32(0, allocations - before);
+    TEST_ASSERT_TRUE(bytes / FRAMES < 100);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_utf8_glyphs_take_one_cell);
+    RUN_TEST(test_print_clips_at_right_edge);
+    RUN_TEST(test_padded_text);
+    RUN_TEST(test_styles_recorded_per_cell);
+    RUN_TEST(test_first_frame_repaints_everything);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_changed_value_sends_tens_of_bytes);
+    RUN_TEST(test_style_change_alone_is_sent);
+    RUN_TEST(test_nearby_changes_share_one_cursor_move);
+    RUN_TEST(test_invalidate_repaints_for_new_client);
+    RUN_TEST(test_failed_write_repaints_next_frame);
+    RUN_TEST(test_frames_replay_to_same_screen);
+    RUN_TEST(test_bench_no_allocations);
+
+    return UNITY_END();
+}
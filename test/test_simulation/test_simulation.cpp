@@ -0,0 +1,242 @@
+// Closed-loop tests: the real TemperatureController driving the SmokerSim
+// thermal plant through the mock GPIO/sensor layer on the virtual clock.
+
+// std headers must precede the mock Arduino.h min/max macros
+#include <chrono>
+
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "smoker_sim.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+static MAX31865* sensor;
+static RelayControl* relay;
+static TemperatureController* ctrl;
+static SmokerSim* sim;
+
+static const unsigned long MINUTE_MS = 60UL * 1000;
+static const unsigned long HOUR_MS = 60UL * MINUTE_MS;
+
+// Per-run observations gathered by the tick callback
+struct CookStats {
+  unsigned long runningAtMs;   // first tick in STATE_RUNNING (0 = never)
+  float peakF;                 // highest probe reading once RUNNING
+  float minF;                  // lowest probe reading inside the window
+  float maxF;                  // highest probe reading inside the window
+  unsigned long windowStartMs; // window for minF/maxF (0 = disabled)
+};
+
+static void reset_stats(CookStats& s, unsigned long windowStartMs = 0) {
+  s.runningAtMs = 0;
+  s.peakF = 0.0f;
+  s.minF = 1000.0f;
+  s.maxF = 0.0f;
+  s.windowStartMs = windowStartMs;
+}
+
+static void observe(CookStats& s) {
+  unsigned long now = millis();
+  float t = sim->probeTempF();
+  if (ctrl->getState() == STATE_RUNNING && s.runningAtMs == 0) {
+    s.runningAtMs = now;
+  }
+  if (s.runningAtMs != 0 && t > s.peakF) s.peakF = t;
+  if (s.windowStartMs != 0 && now >= s.windowStartMs) {
+    if (t < s.minF) s.minF = t;
+    if (t > s.maxF) s.maxF = t;
+  }
+}
+
+// Advance the plant and controller together for `ms`
+static void cook(unsigned long ms, CookStats& s) {
+  sim->run(ms, [&s]() {
+    ctrl->update();
+    observe(s);
+  });
+}
+
+void setUp(void) {
+  mock_reset_all();
+  mock_reset_sensor();
+  sensor = new MAX31865(5, 4300.0, 1000.0);
+  relay = new RelayControl();
+  relay->begin();
+  ctrl = new TemperatureController(sensor, relay);
+  ctrl->begin();
+  sim = new SmokerSim();
+}
+
+void tearDown(void) {
+  delete sim;
+  delete ctrl;
+  delete relay;
+  delete sensor;
+}
+
+// ============================================================================
+// Startup
+// ============================================================================
+
+void test_sim_cold_start_reaches_running(void) {
+  CookStats s;
+  reset_stats(s);
+  ctrl->startSmoking(225.0f);
+  cook(STARTUP_TIMEOUT, s);
+
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_TRUE(s.runningAtMs > IGNITER_PREHEAT_TIME);
+  TEST_ASSERT_TRUE(s.runningAtMs < STARTUP_TIMEOUT);
+  TEST_ASSERT_TRUE(sim->isFireLit());
+  TEST_ASSERT_EQUAL(1, sim->ignitions());
+}
+
+void test_sim_idle_controller_keeps_plant_cold(void) {
+  CookStats s;
+  reset_stats(s);
+  cook(30 * MINUTE_MS, s);
+
+  TEST_ASSERT_EQUAL(STATE_IDLE, ctrl->getState());
+  TEST_ASSERT_FALSE(sim->isFireLit());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, sim->pelletsFedGrams());
+  TEST_ASSERT_FLOAT_WITHIN(1.0f, SmokerSim::cToF(21.0f), sim->probeTempF());
+}
+
+// ============================================================================
+// Regulation
+// ============================================================================
+
+void test_sim_holds_225_with_bounded_overshoot(void) {
+  CookStats s;
+  reset_stats(s, 45 * MINUTE_MS);
+  ctrl->startSmoking(225.0f);
+  cook(2 * HOUR_MS, s);
+
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_TRUE(s.peakF < 225.0f + 25.0f);
+  // Settled band after the first 45 minutes
+  TEST_ASSERT_TRUE(s.minF > 225.0f - 5.0f);
+  TEST_ASSERT_TRUE(s.maxF < 225.0f + 5.0f);
+  TEST_ASSERT_EQUAL(0, sim->flameouts());
+}
+
+void test_sim_setpoint_step_up(void) {
+  CookStats s;
+  reset_stats(s);
+  ctrl->startSmoking(225.0f);
+  cook(HOUR_MS, s);
+
+  ctrl->setSetpoint(275.0f);
+  reset_stats(s, millis() + 45 * MINUTE_MS);
+  s.runningAtMs = millis();
+  cook(90 * MINUTE_MS, s);
+
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_TRUE(s.peakF < 275.0f + 25.0f);
+  TEST_ASSERT_TRUE(s.minF > 275.0f - 5.0f);
+  TEST_ASSERT_TRUE(s.maxF < 275.0f + 5.0f);
+}
+
+void test_sim_pellet_consumption_plausible(void) {
+  CookStats s;
+  reset_stats(s);
+  ctrl->startSmoking(225.0f);
+  cook(HOUR_MS, s);
+  float settledFed = sim->pelletsFedGrams();
+  cook(4 * HOUR_MS, s);
+
+  // Steady 225°F on a mild day burns roughly 0.3 - 0.5 kg/hr
+  float gramsPerHour = (sim->pelletsFedGrams() - settledFed) / 4.0f;
+  TEST_ASSERT_TRUE(gramsPerHour > 300.0f);
+  TEST_ASSERT_TRUE(gramsPerHour < 700.0f);
+}
+
+// ============================================================================
+// Disturbances
+// ============================================================================
+
+void test_sim_lid_open_recovers(void) {
+  CookStats s;
+  reset_stats(s);
+  ctrl->startSmoking(225.0f);
+  cook(2 * HOUR_MS, s);
+
+  sim->setLidOpen(true);
+  cook(MINUTE_MS, s);
+  sim->setLidOpen(false);
+  float dippedF = sim->probeTempF();
+
+  reset_stats(s, millis() + 30 * MINUTE_MS);
+  s.runningAtMs = millis();
+  cook(HOUR_MS, s);
+
+  TEST_ASSERT_TRUE(dippedF < 225.0f - 20.0f);
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_TRUE(s.peakF < 225.0f + 25.0f);
+  TEST_ASSERT_TRUE(s.minF > 225.0f - 5.0f);
+  TEST_ASSERT_TRUE(s.maxF < 225.0f + 5.0f);
+}
+
+void test_sim_flameout_reignites_and_recovers(void) {
+  CookStats s;
+  reset_stats(s);
+  ctrl->startSmoking(225.0f);
+  cook(2 * HOUR_MS, s);
+
+  // Hopper runs dry; the fire goes out and the controller maxes the auger
+  sim->setHopperEmpty(true);
+  bool sawReignite = false;
+  sim->run(2 * HOUR_MS, [&]() {
+    ctrl->update();
+    if (ctrl->getState() == STATE_REIGNITE) sawReignite = true;
+    // Refill once the cooker has visibly cooled, as a user would
+    if (sim->probeTempF() < 150.0f) sim->setHopperEmpty(false);
+  });
+
+  TEST_ASSERT_TRUE(sawReignite);
+  TEST_ASSERT_EQUAL(1, sim->flameouts());
+  TEST_ASSERT_EQUAL(2, sim->ignitions());
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_FLOAT_WITHIN(10.0f, 225.0f, sim->probeTempF());
+}
+
+// ============================================================================
+// Long cook
+// ============================================================================
+
+void test_sim_14h_cook_runs_fast(void) {
+  CookStats s;
+  reset_stats(s, HOUR_MS);
+  ctrl->startSmoking(225.0f);
+
+  auto t0 = std::chrono::steady_clock::now();
+  cook(14 * HOUR_MS, s);
+  auto t1 = std::chrono::steady_clock::now();
+  long long wallMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+
+  TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+  TEST_ASSERT_TRUE(s.minF > 225.0f - 5.0f);
+  TEST_ASSERT_TRUE(s.maxF < 225.0f + 5.0f);
+  TEST_ASSERT_EQUAL(1, sim->ignitions());
+  TEST_ASSERT_TRUE(wallMs < 1000);
+}
+
+int main(int argc, char **argv) {
+  (void)argc; (void)argv;
+  UNITY_BEGIN();
+
+  RUN_TEST(test_sim_cold_start_reaches_running);
+  RUN_TEST(test_sim_idle_controller_keeps_plant_cold);
+  RUN_TEST(test_sim_holds_225_with_bounded_overshoot);
+  RUN_TEST(test_sim_setpoint_step_up);
+  RUN_TEST(test_sim_pellet_consumption_plausible);
+  RUN_TEST(test_sim_lid_open_recovers);
+  RUN_TEST(test_sim_flameout_reignites_and_recovers);
+  RUN_TEST(test_sim_14h_cook_runs_fast);
+
+  return UNITY_END();
+}
@@ -0,0 +1,161 @@
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "seqlock.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+static MAX31865* sensor;
+static RelayControl* relay;
+static TemperatureController* ctrl;
+
+void setUp(void) {
+    mock_reset_all();
+    mock_reset_sensor();
+    sensor = new MAX31865(5, 4300.0, 1000.0);
+    relay = new RelayControl();
+    relay->begin();
+    ctrl = new TemperatureController(sensor, relay);
+    ctrl->begin();
+}
+
+void tearDown(void) {
+    delete ctrl;
+    delete relay;
+    delete sensor;
+}
+
+// ============================================================================
+// SEQLOCK
+// ============================================================================
+
+struct OddSized {
+    uint32_t a;
+    float b;
+    uint8_t c[5];
+};
+
+void test_seqlock_unwritten_reads_zero(void) {
+    SeqLock<OddSized> lock;
+    OddSized out;
+    out.a = 99;
+    TEST_ASSERT_EQUAL_UINT32(0, lock.read(out));
+    TEST_ASSERT_EQUAL_UINT32(0, out.a);
+    TEST_ASSERT_EQUAL_UINT32(0, lock.sequence());
+}
+
+void test_seqlock_round_trip_and_sequence(void) {
+    SeqLock<OddSized> lock;
+    OddSized in = {0xDEADBEEF, 2.5f, {1, 2, 3, 4, 5}};
+    lock.write(in);
+
+    OddSized out;
+    TEST_ASSERT_EQUAL_UINT32(2, lock.read(out));
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, out.a);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, out.b);
+    TEST_ASSERT_EQUAL_UINT8(5, out.c[4]);
+
+    in.a = 7;
+    lock.write(in);
+    TEST_ASSERT_EQUAL_UINT32(4, lock.read(out));
+    TEST_ASSERT_EQUAL_UINT32(7, out.a);
+    TEST_ASSERT_EQUAL_UINT32(4, lock.sequence());
+}
+
+// ============================================================================
+// CONTROLLER SNAPSHOT
+// ============================================================================
+
+void test_snapshot_published_at_begin(void) {
+    auto snap = ctrl->getSnapshot();
+    TEST_ASSERT_TRUE(snap.seq > 0);
+    TEST_ASSERT_EQUAL(STATE_IDLE, snap.status.state);
+    TEST_ASSERT_EQUAL_UINT32(snap.seq, ctrl->getSnapshotSeq());
+}
+
+void test_snapshot_reflects_commands_immediately(void) {
+    uint32_t before = ctrl->getSnapshotSeq();
+    ctrl->setTempOverride(70.0);
+    ctrl->startSmoking(250.0);
+
+    auto snap = ctrl->getSnapshot();
+    TEST_ASSERT_TRUE(snap.seq > before);
+    TEST_ASSERT_EQUAL(STATE_STARTUP, snap.status.state);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 250.0, snap.status.setpoint);
+}
+
+void test_snapshot_matches_live_state_after_tick(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+    mock_set_millis(66000);
+    ctrl->update();
+    mock_advance_millis(TEMP_CONTROL_INTERVAL);
+    ctrl->update();
+
+    auto snap = ctrl->getSnapshot();
+    auto status = ctrl->getStatus();
+    auto pid = ctrl->getPIDStatus();
+
+    TEST_ASSERT_EQUAL(STATE_RUNNING, snap.status.state);
+    TEST_ASSERT_EQUAL_FLOAT(status.currentTemp, snap.status.currentTemp);
+    TEST_ASSERT_EQUAL(status.auger, snap.status.auger);
+    TEST_ASSERT_EQUAL(status.fan, snap.status.fan);
+    TEST_ASSERT_EQUAL(status.igniter, snap.status.igniter);
+    TEST_ASSERT_EQUAL_FLOAT(pid.output, snap.pid.output);
+    TEST_ASSERT_EQUAL_FLOAT(pid.integralTerm, snap.pid.integralTerm);
+    TEST_ASSERT_EQUAL_UINT32(66000 + TEMP_CONTROL_INTERVAL, snap.publishedAt);
+    TEST_ASSERT_FALSE(snap.lidOpen);
+    TEST_ASSERT_EQUAL_UINT8(0, snap.reigniteAttempts);
+}
+
+void test_snapshot_unchanged_between_ticks(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+    mock_set_millis(66000);
+    ctrl->update();
+    auto first = ctrl->getSnapshot();
+
+    // Live temperature changes, but no tick has run yet
+    ctrl->setTempOverride(130.0);
+    mock_advance_millis(TEMP_CONTROL_INTERVAL / 2);
+    ctrl->update();
+
+    auto second = ctrl->getSnapshot();
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 120.0, second.status.currentTemp);
+    TEST_ASSERT_EQUAL_UINT32(first.publishedAt, second.publishedAt);
+}
+
+void test_snapshot_tracks_history_head(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+    mock_set_millis(66000);
+    ctrl->update();
+
+    auto snap = ctrl->getSnapshot();
+    TEST_ASSERT_EQUAL_UINT16(ctrl->getHistory().sampleCount(), snap.historyCount);
+    TEST_ASSERT_EQUAL_UINT32(66, snap.historyLatestTime);
+    TEST_ASSERT_EQUAL_UINT8(ctrl->getHistory().events().count(), snap.eventCount);
+}
+
+void test_state_name_static(void) {
+    TEST_ASSERT_EQUAL_STRING("Idle", TemperatureController::stateName(STATE_IDLE));
+    TEST_ASSERT_EQUAL_STRING("Reignite", TemperatureController::stateName(STATE_REIGNITE));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_seqlock_unwritten_reads_zero);
+    RUN_TEST(test_seqlock_round_trip_and_sequence);
+    RUN_TEST(test_snapshot_published_at_begin);
+    RUN_TEST(test_snapshot_reflects_commands_immediately);
+    RUN_TEST(test_snapshot_matches_live_state_after_tick);
+    RUN_TEST(test_snapshot_unchanged_between_ticks);
+    RUN_TEST(test_snapshot_tracks_history_head);
+    RUN_TEST(test_state_name_static);
+
+    return UNITY_END();
+}
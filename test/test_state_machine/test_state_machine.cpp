@@ -416,6 +416,25 @@ void test_state_names(void) {
     TEST_ASSERT_EQUAL_STRING("Starting", ctrl->getStateName());
 }
 
+// ============================================================================
+// TICK (control task entry point)
+// ============================================================================
+
+void test_tick_ignores_interval_gate(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+
+    // update() is gated on TEMP_CONTROL_INTERVAL; tick() runs unconditionally
+    mock_set_millis(66000);
+    ctrl->update();
+    ctrl->setTempOverride(600.0);
+    ctrl->update();
+    TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getState());
+
+    ctrl->tick();
+    TEST_ASSERT_EQUAL(STATE_ERROR, ctrl->getState());
+}
+
 int main(int argc, char **argv) {
     (void)argc; (void)argv;
     UNITY_BEGIN();
@@ -452,6 +471,7 @@ int main(int argc, char **argv) {
     RUN_TEST(test_set_setpoint_accepts_min_boundary);
     RUN_TEST(test_set_setpoint_accepts_max_boundary);
     RUN_TEST(test_state_names);
+    RUN_TEST(test_tick_ignores_interval_gate);
 
     return UNITY_END();
 }
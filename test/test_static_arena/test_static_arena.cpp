@@ -0,0 +1,157 @@
+// StaticArena: compile-time sizing, in-order placement, alignment, RAM map,
+// one of each type
+
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+#include "static_arena.h"
+
+static int destroyed;
+
+struct Small {
+    uint8_t id;
+    explicit Small(uint8_t i) : id(i) {}
+};
+
+struct Wide {
+    double value;
+    uint32_t words[3];
+    Wide(double v, uint32_t w) : value(v) {
+        for (int i = 0; i < 3; i++) words[i] = w;
+    }
+    ~Wide() { destroyed++; }
+};
+
+struct Big {
+    uint8_t history[30000];
+    Big() { memset(history, 0xA5, sizeof(history)); }
+};
+
+typedef StaticArena<Small, Wide, Big> Arena;
+
+// Static, as in the firmware
+static Arena arena;
+
+void setUp(void) {
+    destroyed = 0;
+}
+
+void tearDown(void) {}
+
+void test_capacity_is_the_padded_sum(void) {
+    size_t pad = ARENA_ALIGN;
+    size_t expected = ((sizeof(Small) + pad - 1) / pad + (sizeof(Wide) + pad - 1) / pad +
+                       (sizeof(Big) + pad - 1) / pad) * pad;
+    TEST_ASSERT_EQUAL_UINT32(expected, Arena::CAPACITY);
+    TEST_ASSERT_EQUAL_UINT8(3, Arena::MAX_OBJECTS);
+    TEST_ASSERT_TRUE(sizeof(Arena) < Arena::CAPACITY + 128);
+}
+
+void test_objects_are_placed_in_order_and_aligned(void) {
+    Arena a;
+    Small* s = a.make<Small>("Small", 7);
+    Wide* w = a.make<Wide>("Wide", 2.5, 0xDEADBEEFu);
+    Big* b = a.make<Big>("Big");
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_NOT_NULL(w);
+    TEST_ASSERT_NOT_NULL(b);
+
+    // Constructed with their arguments, inside the arena, in call order
+    TEST_ASSERT_EQUAL_UINT8(7, s->id);
+    TEST_ASSERT_TRUE(w->value == 2.5);
+    TEST_ASSERT_EQUAL_UINT32(0xDEADBEEFu, w->words[2]);
+    TEST_ASSERT_EQUAL_UINT8(0xA5, b->history[29999]);
+    const uint8_t* base = (const uint8_t*)a.base();
+    TEST_ASSERT_TRUE((const uint8_t*)s == base);
+    TEST_ASSERT_TRUE((const uint8_t*)w > (const uint8_t*)s);
+    TEST_ASSERT_TRUE((const uint8_t*)b > (const uint8_t*)w);
+    TEST_ASSERT_TRUE((const uint8_t*)b + sizeof(Big) <= base + Arena::CAPACITY);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)w % ARENA_ALIGN);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)b % ARENA_ALIGN);
+    TEST_ASSERT_EQUAL_UINT32(Arena::CAPACITY, a.used());
+}
+
+void test_ram_map_entries(void) {
+    Arena a;
+    a.make<Wide>("Wide", 1.0, 1);
+    a.make<Small>("Small", 1);
+
+    TEST_ASSERT_EQUAL_UINT8(2, a.count());
+    TEST_ASSERT_EQUAL_STRING("Wide", a.entry(0).name);
+    TEST_ASSERT_EQUAL_UINT32(0, a.entry(0).offset);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(Wide), a.entry(0).size);
+    TEST_ASSERT_EQUAL_STRING("Small", a.entry(1).name);
+    TEST_ASSERT_EQUAL_UINT32(ArenaSize<Wide>::value, a.entry(1).offset);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(Small), a.entry(1).size);
+}
+
+void test_optional_objects_leave_room_unused(void) {
+    // Only what is made is constructed; skipped types just leave space
+    Arena a;
+    TEST_ASSERT_NOT_NULL(a.make<Big>("Big"));
+    TEST_ASSERT_EQUAL_UINT32(ArenaSize<Big>::value, a.used());
+    TEST_ASSERT_EQUAL_UINT8(1, a.count());
+}
+
+void test_type_made_twice_returns_null(void) {
+    // Refused even while other types' space is unused
+    Arena a;
+    TEST_ASSERT_NOT_NULL(a.make<Small>("Small", 1));
+    TEST_ASSERT_NULL(a.make<Small>("Small again", 2));
+    TEST_ASSERT_EQUAL_UINT8(1, a.count());
+    TEST_ASSERT_EQUAL_UINT32(ArenaSize<Small>::value, a.used());
+
+    // Also after destroy(): the storage is not reused
+    Wide* w = a.make<Wide>("Wide", 1.0, 1);
+    a.destroy(w);
+    TEST_ASSERT_NULL(a.make<Wide>("Wide again", 1.0, 1));
+    TEST_ASSERT_NOT_NULL(a.make<Big>("Big"));
+    TEST_ASSERT_EQUAL_UINT32(Arena::CAPACITY, a.used());
+}
+
+void test_optional_types_take_no_room(void) {
+    typedef StaticArena<Small, ArenaOptional<false, Big>, Wide> Without;
+    typedef StaticArena<Small, ArenaOptional<true, Big>, Wide> With;
+    TEST_ASSERT_EQUAL_UINT32((ArenaSize<Small, Wide>::value), Without::CAPACITY);
+    TEST_ASSERT_EQUAL_UINT8(2, Without::MAX_OBJECTS);
+    TEST_ASSERT_EQUAL_UINT32(Arena::CAPACITY, With::CAPACITY);
+    TEST_ASSERT_EQUAL_UINT8(3, With::MAX_OBJECTS);
+
+    Without a;
+    TEST_ASSERT_NOT_NULL(a.make<Small>("Small", 1));
+    TEST_ASSERT_NOT_NULL(a.make<Wide>("Wide", 1.0, 1));
+    TEST_ASSERT_EQUAL_UINT32(Without::CAPACITY, a.used());
+}
+
+void test_destroy_runs_the_destructor_only(void) {
+    Arena a;
+    Wide* w = a.make<Wide>("Wide", 1.0, 1);
+    size_t used = a.used();
+    a.destroy(w);
+    a.destroy((Wide*)nullptr);
+    TEST_ASSERT_EQUAL_INT(1, destroyed);
+    // The storage is not reused
+    TEST_ASSERT_EQUAL_UINT32(used, a.used());
+    TEST_ASSERT_EQUAL_UINT8(1, a.count());
+}
+
+void test_static_instance(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, arena.used());
+    Big* b = arena.make<Big>("Big");
+    TEST_ASSERT_TRUE((const void*)b == arena.base());
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_is_the_padded_sum);
+    RUN_TEST(test_objects_are_placed_in_order_and_aligned);
+    RUN_TEST(test_ram_map_entries);
+    RUN_TEST(test_optional_objects_leave_room_unused);
+    RUN_TEST(test_type_made_twice_returns_null);
+    RUN_TEST(test_optional_types_take_no_room);
+    RUN_TEST(test_destroy_runs_the_destructor_only);
+    RUN_TEST(test_static_instance);
+    return UNITY_END();
+}
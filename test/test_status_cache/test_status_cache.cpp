@@ -0,0 +1,211 @@
+// StatusCache: values formatted once per tick, with no heap allocation
+
+#include <cstdlib>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "Arduino.h"
+#include "mock_helpers.h"
+#include "status_cache.h"
+#include "temperature_control.h"
+#include "relay_control.h"
+#include "max31865.h"
+#include "config.h"
+
+// ============================================================================
+// ALLOCATION COUNTER
+// ============================================================================
+
+// Every operator new in the test binary (String temporaries, containers, ...)
+static size_t allocations = 0;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"    // malloc/free pairing is intended
+#endif
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static MAX31865* sensor;
+static RelayControl* relay;
+static TemperatureController* ctrl;
+static StatusCache* cache;
+static unsigned long now;
+
+void setUp(void) {
+    mock_reset_all();
+    mock_reset_sensor();
+    sensor = new MAX31865(5, 4300.0, 1000.0);
+    relay = new RelayControl();
+    relay->begin();
+    ctrl = new TemperatureController(sensor, relay);
+    ctrl->begin();
+    cache = new StatusCache();
+    now = 0;
+}
+
+void tearDown(void) {
+    delete cache;
+    delete ctrl;
+    delete relay;
+    delete sensor;
+}
+
+static void tick(void) {
+    now += TEMP_CONTROL_INTERVAL;
+    mock_set_millis(now);
+    ctrl->update();
+}
+
+// ============================================================================
+// FORMATTING
+// ============================================================================
+
+void test_fields_match_snapshot(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+    tick();
+    TEST_ASSERT_TRUE(cache->refresh(*ctrl, 123456));
+
+    auto snap = ctrl->getSnapshot();
+    char expect[16];
+    const StatusCache::Fields& f = cache->fields();
+    snprintf(expect, sizeof(expect), "%.1f", snap.status.currentTemp);
+    TEST_ASSERT_EQUAL_STRING(expect, f.temp);
+    TEST_ASSERT_EQUAL_STRING("225.0", f.setpoint);
+    snprintf(expect, sizeof(expect), "%.1f", snap.status.currentTemp - snap.status.setpoint);
+    TEST_ASSERT_EQUAL_STRING(expect, f.tempDelta);
+    snprintf(expect, sizeof(expect), "%.4f", snap.pid.proportionalTerm);
+    TEST_ASSERT_EQUAL_STRING(expect, f.pidP);
+    TEST_ASSERT_EQUAL_STRING(TemperatureController::stateName(snap.status.state), f.state);
+    TEST_ASSERT_EQUAL_STRING(snap.status.igniter ? "ON" : "OFF", f.igniter);
+    TEST_ASSERT_EQUAL_STRING("0", f.reigniteAttempts);
+    TEST_ASSERT_EQUAL_UINT32(snap.seq, cache->seq());
+}
+
+void test_json_body(void) {
+    ctrl->setTempOverride(120.0);
+    ctrl->startSmoking(225.0);
+    tick();
+    cache->refresh(*ctrl, 123456);
+
+    const StatusCache::Json& json = cache->json();
+    TEST_ASSERT_EQUAL_UINT16(strlen(json.text), json.length);
+    TEST_ASSERT_EQUAL_INT('{', json.text[0]);
+    TEST_ASSERT_EQUAL_INT('}', json.text[json.length - 1]);
+    TEST_ASSERT_NOT_NULL(strstr(json.text, "\"setpoint\":225.0,"));
+    char state[32];
+    snprintf(state, sizeof(state), "\"state\":\"%s\"",
+             TemperatureController::stateName(ctrl->getSnapshot().status.state));
+    TEST_ASSERT_NOT_NULL(strstr(json.text, state));
+    TEST_ASSERT_NOT_NULL(strstr(json.text, "\"heap\":123456,"));
+    TEST_ASSERT_NOT_NULL(strstr(json.text, "\"version\":\"" FIRMWARE_VERSION "\""));
+    TEST_ASSERT_NOT_NULL(strstr(json.text, "\"pid\":{\"p\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json.text, "\"reigniteAttempts\":0}}"));
+}
+
+void test_json_fits_worst_case(void) {
+    // Widest values every field can take
+    TemperatureController::Snapshot snap;
+    memset(&snap, 0, sizeof(snap));
+    char buf[1024];
+    int n = snprintf(buf, sizeof(buf),
+                     "{\"temp\":%.2f,\"setpoint\":%.1f,\"state\":\"%s\",\"auger\":false,\"fan\":false,"
+                     "\"igniter\":false,\"runtime\":%u,\"errors\":%u,\"version\":\"%s\",\"heap\":%u,"
+                     "\"pid\":{\"p\":%.4f,\"i\":%.4f,\"d\":%.4f,\"output\":%.1f,\"error\":%.1f,"
+                     "\"cycleRemaining\":%u,\"augerOn\":false,\"lidOpen\":false,\"reigniteAttempts\":%u}}",
+                     -9999.99, -9999.9, "Reignite", 4294967295u, 255u, FIRMWARE_VERSION,
+                     4294967295u, -99999.9999, -99999.9999, -99999.9999, -100.0, -9999.9,
+                     4294967295u, 255u);
+    TEST_ASSERT_TRUE(n < STATUS_JSON_BYTES);
+}
+
+void test_readers_on_other_tasks_get_same_json(void) {
+    tick();
+    cache->refresh(*ctrl, 1000);
+    StatusCache::Json copy;
+    cache->readJson(copy);
+    TEST_ASSERT_EQUAL_UINT32(cache->seq(), copy.seq);
+    TEST_ASSERT_EQUAL_STRING(cache->json().text, copy.text);
+}
+
+// ============================================================================
+// ONCE PER TICK
+// ============================================================================
+
+void test_refresh_formats_once_per_snapshot(void) {
+    TEST_ASSERT_FALSE(cache->valid());
+    TEST_ASSERT_TRUE(cache->refresh(*ctrl, 1000));
+    TEST_ASSERT_TRUE(cache->valid());
+
+    // Many consumers between ticks: no further formatting
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_FALSE(cache->refresh(*ctrl, 1000));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, cache->formats());
+
+    tick();
+    TEST_ASSERT_TRUE(cache->refresh(*ctrl, 1000));
+    TEST_ASSERT_EQUAL_UINT32(2, cache->formats());
+}
+
+void test_steady_state_tick_does_not_allocate(void) {
+    ctrl->setTempOverride(225.0);
+    ctrl->startSmoking(225.0);
+    // Through startup into a steady cook
+    for (int i = 0; i < 200; i++) {
+        tick();
+        cache->refresh(*ctrl, 1000);
+    }
+    TEST_ASSERT_EQUAL(STATE_RUNNING, ctrl->getSnapshot().status.state);
+
+    // Control tick, status formatting and every consumer's read path
+    size_t before = allocations;
+    uint32_t formats = cache->formats();
+    size_t bytes = 0;
+    const int TICKS = 500;
+    for (int i = 0; i < TICKS; i++) {
+        tick();
+        cache->refresh(*ctrl, 1000);
+        const StatusCache::Fields& f = cache->fields();
+        bytes += strlen(f.temp) + strlen(f.pidOutput) + cache->json().length;
+        StatusCache::Json copy;
+        cache->readJson(copy);
+        bytes += copy.length;
+    }
+    printf("[BENCH] %d ticks: %u allocations, %u formats, %u bytes read\n", TICKS,
+           (unsigned)(allocations - before), (unsigned)(cache->formats() - formats),
+           (unsigned)bytes);
+    TEST_ASSERT_EQUAL_UINT32(TICKS, cache->formats() - formats);
+    TEST_ASSERT_EQUAL_UINT32(0, allocations - before);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fields_match_snapshot);
+    RUN_TEST(test_json_body);
+    RUN_TEST(test_json_fits_worst_case);
+    RUN_TEST(test_readers_on_other_tasks_get_same_json);
+    RUN_TEST(test_refresh_formats_once_per_snapshot);
+    RUN_TEST(test_steady_state_tick_does_not_allocate);
+
+    return UNITY_END();
+}
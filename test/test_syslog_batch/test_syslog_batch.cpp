@@ -0,0 +1,194 @@
+// SyslogBatch: RFC 5424 messages packed into one UDP datagram or TCP write
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include "syslog_batch.h"
+#include "config.h"
+
+#define FACILITY_LOCAL0 (16 << 3)
+#define BOM "\xEF\xBB\xBF"
+
+static char buf[SYSLOG_BATCH_BYTES];
+
+static SyslogBatch udpBatch() {
+    return SyslogBatch(buf, sizeof(buf), SyslogBatch::FRAMING_NEWLINE, FACILITY_LOCAL0,
+                       "ESP32Smoker", "smoker");
+}
+
+static SyslogBatch tcpBatch() {
+    return SyslogBatch(buf, sizeof(buf), SyslogBatch::FRAMING_OCTET_COUNT, FACILITY_LOCAL0,
+                       "ESP32Smoker", "smoker");
+}
+
+static const char* text(const SyslogBatch& b) {
+    static char out[SYSLOG_BATCH_BYTES + 1];
+    memcpy(out, b.data(), b.size());
+    out[b.size()] = '\0';
+    return out;
+}
+
+void setUp(void) {
+    memset(buf, 0, sizeof(buf));
+}
+
+void tearDown(void) {}
+
+// ============================================================================
+// FORMAT
+// ============================================================================
+
+void test_header_matches_syslog_library(void) {
+    SyslogBatch b = udpBatch();
+    TEST_ASSERT_TRUE(b.append(6, "[PID] Output 43.2%\n", 0));
+    TEST_ASSERT_EQUAL_STRING("<134>1 - ESP32Smoker smoker - - - " BOM "[PID] Output 43.2%\n", text(b));
+}
+
+void test_newline_framing_packs_messages(void) {
+    SyslogBatch b = udpBatch();
+    b.append(6, "[A] one\n", 0);
+    b.append(7, "\n[B] two", 0);
+    b.append(3, "[C] three\r\n", 0);
+    TEST_ASSERT_EQUAL_UINT16(3, b.count());
+    TEST_ASSERT_EQUAL_STRING(
+        "<134>1 - ESP32Smoker smoker - - - " BOM "[A] one\n"
+        "<135>1 - ESP32Smoker smoker - - - " BOM "[B] two\n"
+        "<131>1 - ESP32Smoker smoker - - - " BOM "[C] three\n", text(b));
+}
+
+void test_inner_newlines_do_not_split_messages(void) {
+    SyslogBatch b = udpBatch();
+    b.append(6, "[DIAG] line one\nline two\n", 0);
+    TEST_ASSERT_NOT_NULL(strstr(text(b), "[DIAG] line one line two\n"));
+    TEST_ASSERT_EQUAL_UINT32(1, (uint32_t)(strchr(text(b), '\n') == text(b) + b.size() - 1));
+}
+
+void test_octet_counting(void) {
+    SyslogBatch b = tcpBatch();
+    b.append(6, "[A] one\n", 0);
+    b.append(4, "[B] two", 0);
+
+    // Walk the frames the way an RFC 6587 receiver does
+    const char* p = b.data();
+    const char* end = b.data() + b.size();
+    const char* expect[] = {
+        "<134>1 - ESP32Smoker smoker - - - " BOM "[A] one",
+        "<132>1 - ESP32Smoker smoker - - - " BOM "[B] two",
+    };
+    for (int i = 0; i < 2; i++) {
+        char* sp;
+        unsigned long len = strtoul(p, &sp, 10);
+        TEST_ASSERT_EQUAL_INT(' ', *sp);
+        TEST_ASSERT_EQUAL_UINT32(strlen(expect[i]), (uint32_t)len);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(sp + 1, expect[i], len));
+        p = sp + 1 + len;
+    }
+    TEST_ASSERT_TRUE(p == end);
+}
+
+// ============================================================================
+// CAPACITY
+// ============================================================================
+
+void test_full_batch_refuses_message_unchanged(void) {
+    SyslogBatch b = udpBatch();
+    char msg[200];
+    memset(msg, 'x', sizeof(msg) - 1);
+    msg[sizeof(msg) - 1] = '\0';
+
+    int added = 0;
+    while (b.append(6, msg, 0)) added++;
+    TEST_ASSERT_TRUE(added > 1);
+    TEST_ASSERT_TRUE(b.size() <= SYSLOG_BATCH_BYTES);
+
+    size_t size = b.size();
+    TEST_ASSERT_FALSE(b.append(6, msg, 0));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)size, (uint32_t)b.size());
+    TEST_ASSERT_EQUAL_UINT16(added, b.count());
+
+    b.clear();
+    TEST_ASSERT_TRUE(b.empty());
+    TEST_ASSERT_TRUE(b.append(6, msg, 0));
+}
+
+void test_oversized_message_is_truncated(void) {
+    char small[120];
+    SyslogBatch b(small, sizeof(small), SyslogBatch::FRAMING_OCTET_COUNT, FACILITY_LOCAL0,
+                  "ESP32Smoker", "smoker");
+    char msg[300];
+    memset(msg, 'y', sizeof(msg) - 1);
+    msg[sizeof(msg) - 1] = '\0';
+    TEST_ASSERT_TRUE(b.append(6, msg, 0));
+    TEST_ASSERT_TRUE(b.size() <= sizeof(small));
+
+    char* sp;
+    unsigned long len = strtoul(b.data(), &sp, 10);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)b.size(), (uint32_t)(sp + 1 - b.data() + len));
+}
+
+// ============================================================================
+// FLUSH POLICY
+// ============================================================================
+
+void test_due_after_flush_interval(void) {
+    SyslogBatch b = udpBatch();
+    TEST_ASSERT_FALSE(b.due(0));
+    b.append(6, "[A] info", 1000);
+    b.append(7, "[A] debug", 1000 + SYSLOG_BATCH_FLUSH_MS - 1);
+    TEST_ASSERT_FALSE(b.due(1000 + SYSLOG_BATCH_FLUSH_MS - 1));
+    TEST_ASSERT_TRUE(b.due(1000 + SYSLOG_BATCH_FLUSH_MS));
+
+    // Timed from the oldest message, across millis() wrap
+    b.clear();
+    b.append(6, "[A] info", 0xFFFFFFF0u);
+    TEST_ASSERT_FALSE(b.due(0xFFFFFFF0u + SYSLOG_BATCH_FLUSH_MS - 1));
+    TEST_ASSERT_TRUE(b.due(0xFFFFFFF0u + SYSLOG_BATCH_FLUSH_MS));
+}
+
+void test_severe_message_is_due_at_once(void) {
+    SyslogBatch b = udpBatch();
+    b.append(SYSLOG_BATCH_FLUSH_PRIORITY + 1, "[A] notice", 0);
+    TEST_ASSERT_FALSE(b.due(0));
+    b.append(SYSLOG_BATCH_FLUSH_PRIORITY, "[A] warning", 0);
+    TEST_ASSERT_TRUE(b.due(0));
+    b.clear();
+    b.append(SYSLOG_BATCH_FLUSH_PRIORITY + 1, "[A] notice", 0);
+    TEST_ASSERT_FALSE(b.due(0));
+}
+
+// A burst of typical lines fits in a handful of datagrams
+void test_burst_packing(void) {
+    SyslogBatch b = udpBatch();
+    int datagrams = 0;
+    char msg[96];
+    for (int i = 0; i < 50; i++) {
+        snprintf(msg, sizeof(msg), "[STATE] Transition %d: Startup -> Running (Temp: 180.2F)\n", i);
+        if (!b.append(6, msg, 0)) {
+            datagrams++;
+            b.clear();
+            TEST_ASSERT_TRUE(b.append(6, msg, 0));
+        }
+    }
+    if (!b.empty()) datagrams++;
+    printf("[BENCH] 50 messages -> %d datagrams of <= %d bytes\n", datagrams, SYSLOG_BATCH_BYTES);
+    TEST_ASSERT_TRUE(datagrams <= 5);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_header_matches_syslog_library);
+    RUN_TEST(test_newline_framing_packs_messages);
+    RUN_TEST(test_inner_newlines_do_not_split_messages);
+    RUN_TEST(test_octet_counting);
+    RUN_TEST(test_full_batch_refuses_message_unchanged);
+    RUN_TEST(test_oversized_message_is_truncated);
+    RUN_TEST(test_due_after_flush_interval);
+    RUN_TEST(test_severe_message_is_due_at_once);
+    RUN_TEST(test_burst_packing);
+
+    return UNITY_END();
+}
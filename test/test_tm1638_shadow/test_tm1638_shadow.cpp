@@ -0,0 +1,138 @@
+// TM1638Shadow: only changed digits and LEDs go on the bus
+
+#include <stdio.h>
+
+#include <unity.h>
+#include "tm1638_shadow.h"
+
+static TM1638Shadow* shadow;
+
+void setUp(void) {
+    shadow = new TM1638Shadow();
+}
+
+void tearDown(void) {
+    delete shadow;
+}
+
+void test_first_flush_sends_everything(void) {
+    TEST_ASSERT_TRUE(shadow->dirty());
+    shadow->setDigits(" 225 250");
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shadow->takeDigits());
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shadow->takeLeds());
+    TEST_ASSERT_FALSE(shadow->dirty());
+    TEST_ASSERT_EQUAL_UINT32(16, shadow->sent());
+}
+
+void test_unchanged_sends_nothing(void) {
+    shadow->setDigits(" 225 250");
+    shadow->takeDigits();
+    shadow->takeLeds();
+
+    for (int i = 0; i < 100; i++) {
+        shadow->setDigits(" 225 250");
+        shadow->setLed(0, false);
+        TEST_ASSERT_FALSE(shadow->dirty());
+        TEST_ASSERT_EQUAL_HEX8(0, shadow->takeDigits());
+        TEST_ASSERT_EQUAL_HEX8(0, shadow->takeLeds());
+    }
+    TEST_ASSERT_EQUAL_UINT32(16, shadow->sent());
+}
+
+void test_changed_digit_only(void) {
+    shadow->setDigits(" 225 250");
+    shadow->takeDigits();
+
+    shadow->setDigits(" 226 250");
+    TEST_ASSERT_TRUE(shadow->dirty());
+    TEST_ASSERT_EQUAL_HEX8(1 << 3, shadow->takeDigits());
+    TEST_ASSERT_EQUAL_STRING(" 226 250", shadow->digits());
+
+    // Digits on both sides of the display
+    shadow->setDigits("1000 300");
+    TEST_ASSERT_EQUAL_HEX8(0x0F | (1 << 5) | (1 << 6), shadow->takeDigits());
+}
+
+void test_short_text_is_padded(void) {
+    shadow->setDigits("12345678");
+    shadow->takeDigits();
+    shadow->setDigits("12");
+    TEST_ASSERT_EQUAL_STRING("12      ", shadow->digits());
+    TEST_ASSERT_EQUAL_HEX8(0xFC, shadow->takeDigits());
+
+    shadow->setDigits("123456789");    // cut at 8
+    TEST_ASSERT_EQUAL_STRING("12345678", shadow->digits());
+}
+
+void test_led_changes(void) {
+    shadow->takeLeds();
+
+    shadow->setLed(0, true);
+    shadow->setLed(2, true);
+    shadow->setLed(9, true);    // out of range, ignored
+    TEST_ASSERT_EQUAL_HEX8(0x05, shadow->takeLeds());
+    TEST_ASSERT_EQUAL_UINT8(1, shadow->ledColor(0));
+    TEST_ASSERT_EQUAL_UINT8(0, shadow->ledColor(1));
+
+    // Toggled back and forth between flushes: nothing to send
+    shadow->setLed(0, false);
+    shadow->setLed(0, true);
+    TEST_ASSERT_EQUAL_HEX8(0, shadow->takeLeds());
+
+    // Green lives in the high byte
+    shadow->setLeds(0x0105);
+    TEST_ASSERT_EQUAL_HEX8(0x01, shadow->takeLeds());
+    TEST_ASSERT_EQUAL_UINT8(3, shadow->ledColor(0));
+}
+
+void test_invalidate_resends(void) {
+    shadow->setDigits(" 225 250");
+    shadow->takeDigits();
+    shadow->takeLeds();
+
+    shadow->invalidate();
+    TEST_ASSERT_TRUE(shadow->dirty());
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shadow->takeDigits());
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shadow->takeLeds());
+}
+
+// The main loop's pattern: update() and seven setLED() calls per pass, a
+// flush every TM1638_REFRESH_MS (100 passes here), the temperature moving
+// by a degree now and then
+void test_saved_counter(void) {
+    const int PASSES = 10000;
+    for (int pass = 0; pass < PASSES; pass++) {
+        shadow->request(TM1638_DIGITS);
+        for (uint8_t led = 0; led < 7; led++) {
+            shadow->request(TM1638_DIGITS);
+            shadow->setLed(led, led == 1 || (led == 0 && pass % 500 < 100));
+        }
+        if (pass % 100 == 0) {
+            char text[9];
+            snprintf(text, sizeof(text), "%4d 225", 200 + pass / 1000);
+            shadow->setDigits(text);
+            shadow->takeDigits();
+            shadow->takeLeds();
+        }
+    }
+    printf("[BENCH] %d passes: %u requested, %u sent, %u saved\n", PASSES,
+           (unsigned)shadow->requested(), (unsigned)shadow->sent(), (unsigned)shadow->saved());
+    TEST_ASSERT_EQUAL_UINT32(PASSES * 8 * TM1638_DIGITS, shadow->requested());
+    TEST_ASSERT_EQUAL_UINT32(shadow->requested() - shadow->sent(), shadow->saved());
+    TEST_ASSERT_TRUE(shadow->sent() < 100);
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_flush_sends_everything);
+    RUN_TEST(test_unchanged_sends_nothing);
+    RUN_TEST(test_changed_digit_only);
+    RUN_TEST(test_short_text_is_padded);
+    RUN_TEST(test_led_changes);
+    RUN_TEST(test_invalidate_resends);
+    RUN_TEST(test_saved_counter);
+
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+// WiFiLink: non-blocking connect, backoff, AP fallback
+
+#include <unity.h>
+#include "wifi_link.h"
+
+static WiFiLink* link;
+
+void setUp(void) {
+    link = new WiFiLink();
+}
+
+void tearDown(void) {
+    delete link;
+}
+
+void test_connects_at_once_without_waiting(void) {
+    link->begin(500, true);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_CONNECT, link->update(500));
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(500));
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_CONNECTING, link->state());
+    TEST_ASSERT_EQUAL_UINT32(1, link->attempts());
+
+    link->onGotIp(2300);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_UP, link->state());
+    TEST_ASSERT_TRUE(link->everUp());
+    TEST_ASSERT_EQUAL_UINT32(2300, link->firstUpAt());
+    TEST_ASSERT_EQUAL_UINT32(0, link->attempts());
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(60000));
+    TEST_ASSERT_FALSE(link->apActive());
+}
+
+void test_no_credentials_opens_ap(void) {
+    link->begin(0, false);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_START_AP, link->update(0));
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(100000));
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_OFF, link->state());
+    TEST_ASSERT_TRUE(link->apActive());
+
+    // Stray station events change nothing
+    link->onGotIp(200);
+    link->onDisconnected(300);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_OFF, link->state());
+}
+
+void test_retry_backoff_doubles_and_caps(void) {
+    link->begin(0, true);
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_CONNECT, link->update(now));
+    link->onGotIp(now);
+
+    uint32_t expected = WIFI_RETRY_MIN_MS;
+    for (int i = 0; i < 10; i++) {
+        link->onDisconnected(now);
+        TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_BACKOFF, link->state());
+        TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(now + expected - 1));
+        TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_CONNECT, link->update(now + expected));
+        now += expected;
+        expected = expected * 2 < WIFI_RETRY_MAX_MS ? expected * 2 : WIFI_RETRY_MAX_MS;
+    }
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RETRY_MAX_MS, link->retryDelay());
+    TEST_ASSERT_EQUAL_UINT32(10, link->attempts());
+
+    // An IP resets the delay
+    link->onGotIp(now);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RETRY_MIN_MS, link->retryDelay());
+    TEST_ASSERT_EQUAL_UINT32(2, link->connects());
+}
+
+void test_repeated_disconnect_events_count_once(void) {
+    link->begin(0, true);
+    link->update(0);
+    link->onDisconnected(100);
+    link->onDisconnected(150);
+    link->onDisconnected(200);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RETRY_MIN_MS * 2, link->retryDelay());
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_CONNECT, link->update(100 + WIFI_RETRY_MIN_MS));
+}
+
+void test_attempt_times_out(void) {
+    link->begin(0, true);
+    link->update(0);
+    // (the AP fallback fires first on this timeline; not what is tested here)
+    while (link->update(WIFI_CONNECT_TIMEOUT_MS - 1) != WiFiLink::ACTION_NONE) {}
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_CONNECTING, link->state());
+    link->update(WIFI_CONNECT_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::LINK_BACKOFF, link->state());
+}
+
+void test_ap_fallback_on_timer_and_closes_on_connect(void) {
+    link->begin(1000, true);
+    link->update(1000);
+    link->onDisconnected(3000);    // e.g. no AP found
+
+    uint32_t now = 1000;
+    while (now < 1000 + WIFI_AP_FALLBACK_MS) {
+        WiFiLink::Action a = link->update(now);
+        TEST_ASSERT_TRUE(a != WiFiLink::ACTION_START_AP);
+        if (a == WiFiLink::ACTION_CONNECT) link->onDisconnected(now);
+        now += 100;
+    }
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_START_AP, link->update(now));
+    TEST_ASSERT_TRUE(link->apActive());
+
+    // The station keeps retrying with the AP open
+    bool retried = false;
+    for (int i = 0; i < 1000 && !retried; i++) {
+        now += 100;
+        retried = link->update(now) == WiFiLink::ACTION_CONNECT;
+    }
+    TEST_ASSERT_TRUE(retried);
+
+    link->onGotIp(now + 500);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_STOP_AP, link->update(now + 600));
+    TEST_ASSERT_FALSE(link->apActive());
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(now + 700));
+}
+
+void test_outage_after_first_connect_keeps_ap_closed(void) {
+    link->begin(0, true);
+    link->update(0);
+    link->onGotIp(1500);
+    link->onDisconnected(20000);
+
+    for (uint32_t now = 20000; now < 20000 + 10 * WIFI_AP_FALLBACK_MS; now += 100) {
+        TEST_ASSERT_TRUE(link->update(now) != WiFiLink::ACTION_START_AP);
+    }
+    TEST_ASSERT_FALSE(link->apActive());
+}
+
+void test_millis_wraparound(void) {
+    uint32_t start = 0xFFFFFFFFu - 500;
+    link->begin(start, true);
+    link->update(start);
+    link->onDisconnected(start + 100);
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_NONE, link->update(start + 200));
+    TEST_ASSERT_EQUAL_UINT8(WiFiLink::ACTION_CONNECT, link->update(start + 100 + WIFI_RETRY_MIN_MS));
+}
+
+int main(int argc, char **argv) {
+    (void)argc; (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_connects_at_once_without_waiting);
+    RUN_TEST(test_no_credentials_opens_ap);
+    RUN_TEST(test_retry_backoff_doubles_and_caps);
+    RUN_TEST(test_repeated_disconnect_events_count_once);
+    RUN_TEST(test_attempt_times_out);
+    RUN_TEST(test_ap_fallback_on_timer_and_closes_on_connect);
+    RUN_TEST(test_outage_after_first_connect_keeps_ap_closed);
+    RUN_TEST(test_millis_wraparound);
+    return UNITY_END();
+}
@@ -0,0 +1,187 @@
+// logdecode - host-side decoder for the smoker's binary LOG_EVENT frames
+//
+// The controller sends LOG_EVENT records as compact binary UDP frames
+// (ENABLE_BINARY_LOG, BINARY_LOG_PORT). This tool receives them, expands
+// each record with the same message catalog the firmware was built from
+// (include/log_catalog.h) and prints one JSON object per record, with the
+// arguments as typed fields, for Cribl's TCP JSON source.
+//
+// Build (from the project root):
+//   g++ -std=c++14 -O2 -Iinclude tools/logdecode/logdecode.cpp src/log_codec.cpp -o logdecode
+//
+// Usage:
+//   logdecode [--udp PORT] [--text]      decode frames (default port 9545)
+//   logdecode --catalog                  print the message catalog as JSON
+//
+// Forward to Cribl:  ./logdecode | nc <cribl-host> 10070
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/time.h>
+#include <time.h>
+
+#include "log_codec.h"
+
+static std::string jsonEscape(const char* s) {
+  std::string out;
+  for (; *s; s++) {
+    char c = *s;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if ((unsigned char)c < 0x20) {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)(unsigned char)c);
+      out += esc;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+static std::string isoNow() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  struct tm tm;
+  gmtime_r(&tv.tv_sec, &tm);
+  char buf[40];
+  size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+  snprintf(buf + n, sizeof(buf) - n, ".%03dZ", (int)(tv.tv_usec / 1000));
+  return buf;
+}
+
+static void printCatalog() {
+  printf("{\"hash\":%u,\"messages\":[", (unsigned)logCatalogHash());
+  for (uint16_t id = 0; id < LOG_MSG_COUNT; id++) {
+    const LogMessageInfo* info = logMessageInfo(id);
+    printf("%s{\"id\":%u,\"name\":\"%s\",\"severity\":%u,\"tag\":\"%s\",\"format\":\"%s\",\"fields\":\"%s\"}",
+           id ? "," : "", (unsigned)id, info->name, (unsigned)info->priority,
+           jsonEscape(info->tag).c_str(), jsonEscape(info->format).c_str(), info->fields);
+  }
+  printf("]}\n");
+}
+
+// Last frame sequence per sender, to report frames lost on the way
+static std::map<std::string, uint32_t> lastSequence;
+static bool warnedMismatch = false;
+
+static void decodeFrame(const uint8_t* buf, size_t len, const std::string& host, bool text) {
+  LogFrameReader frame(buf, len);
+  if (!frame.valid()) {
+    fprintf(stderr, "logdecode: %zu-byte datagram from %s is not a log frame\n", len, host.c_str());
+    return;
+  }
+
+  auto last = lastSequence.find(host);
+  if (last != lastSequence.end() && frame.sequence() != last->second + 1) {
+    // A restart starts again at 0; anything else is loss
+    if (frame.sequence() > last->second + 1) {
+      uint32_t lost = frame.sequence() - last->second - 1;
+      if (text) {
+        printf("%s [LOG] %u frames lost\n", host.c_str(), (unsigned)lost);
+      } else {
+        printf("{\"received\":\"%s\",\"host\":\"%s\",\"event\":\"FRAMES_LOST\",\"severity\":%d,"
+               "\"fields\":{\"lost\":%u}}\n",
+               isoNow().c_str(), host.c_str(), LOG_WARNING, (unsigned)lost);
+      }
+    }
+  }
+  lastSequence[host] = frame.sequence();
+
+  bool mismatch = frame.catalogHash() != logCatalogHash();
+  if (mismatch && !warnedMismatch) {
+    fprintf(stderr, "logdecode: %s uses catalog %08x, this build has %08x; rebuild logdecode "
+                    "from the firmware's source\n",
+            host.c_str(), (unsigned)frame.catalogHash(), (unsigned)logCatalogHash());
+    warnedMismatch = true;
+  }
+
+  uint16_t id;
+  uint32_t time;
+  const uint8_t* payload;
+  uint8_t plen;
+  char message[512];
+  char fields[512];
+  while (frame.next(id, time, payload, plen)) {
+    const LogMessageInfo* info = mismatch ? nullptr : logMessageInfo(id);
+    if (text) {
+      if (info) logExpand(id, payload, plen, message, sizeof(message));
+      else snprintf(message, sizeof(message), "<event %u, unknown catalog>", (unsigned)id);
+      printf("%s %10.3f [%s] %s\n", host.c_str(), time / 1000.0, info ? info->tag : "LOG", message);
+      continue;
+    }
+
+    if (!info) {
+      printf("{\"received\":\"%s\",\"host\":\"%s\",\"uptime_ms\":%u,\"frame\":%u,\"event_id\":%u,"
+             "\"catalog_mismatch\":true}\n",
+             isoNow().c_str(), host.c_str(), (unsigned)time, (unsigned)frame.sequence(),
+             (unsigned)id);
+      continue;
+    }
+    logExpand(id, payload, plen, message, sizeof(message));
+    logFieldsJson(id, payload, plen, fields, sizeof(fields));
+    printf("{\"received\":\"%s\",\"host\":\"%s\",\"uptime_ms\":%u,\"frame\":%u,\"event\":\"%s\","
+           "\"tag\":\"%s\",\"severity\":%u,\"message\":\"%s\",\"fields\":%s}\n",
+           isoNow().c_str(), host.c_str(), (unsigned)time, (unsigned)frame.sequence(), info->name,
+           info->tag, (unsigned)info->priority, jsonEscape(message).c_str(), fields);
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+  int port = 9545;
+  bool text = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--catalog")) {
+      printCatalog();
+      return 0;
+    } else if (!strcmp(argv[i], "--text")) {
+      text = true;
+    } else if (!strcmp(argv[i], "--udp") && i + 1 < argc) {
+      port = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [--udp PORT] [--text] | --catalog\n", argv[0]);
+      return 2;
+    }
+  }
+
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) {
+    perror("socket");
+    return 1;
+  }
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    perror("bind");
+    return 1;
+  }
+  fprintf(stderr, "logdecode: listening on UDP %d (catalog %08x, %u messages)\n", port,
+          (unsigned)logCatalogHash(), (unsigned)LOG_MSG_COUNT);
+
+  uint8_t buf[2048];
+  for (;;) {
+    struct sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromLen);
+    if (n < 0) {
+      perror("recvfrom");
+      continue;
+    }
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &from.sin_addr, host, sizeof(host));
+    decodeFrame(buf, (size_t)n, host, text);
+  }
+}